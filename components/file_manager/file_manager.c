@@ -22,25 +22,37 @@
 #include "settings.h"
 #include "fs_navigator.h"
 #include "fs_text_ops.h"
+#include "fs_exif.h"
+#include "sd_file.h"
+#include "sd_io.h"
+#include "sd_journal.h"
 #include "text_viewer_screen.h"
+#include "viewer_registry.h"
 #include "jpg.h"
+#include "jpg_resize.h"
+#include "mem_plan.h"
+#include "worker_pool.h"
 
 #define TAG "file_manager"
 
 #define FILE_BROWSER_MAX_SORTABLE_ITEMS     100  // CAUTION! BIGGER NUMBER OR 0 MEANS MEMORY CRASHES
+#define FILE_BROWSER_GROUP_BY_EXTENSION     true // above the sort limit: folders, then files by type
+#define FILE_BROWSER_TOP_K_SORT             true // above the sort limit: select each window in sort order
 #define FILE_BROWSER_LIST_WINDOW_SIZE       36   // CAUTION! BIGGER NUMBER MEANS MEMORY CRASHES
 #define FILE_BROWSER_LIST_WINDOW_STEP       18   // CAUTION! BIGGER NUMBER MEANS MEMORY CRASHES
-#define FILE_BROWSER_PATH_SCROLL_DELAY_MS   2000
-#define FILE_BROWSER_ENTRY_SCROLL_DELAY_MS  FILE_BROWSER_PATH_SCROLL_DELAY_MS
+#define FILE_BROWSER_ENTRY_SCROLL_DELAY_MS  2000
 #define FILE_BROWSER_SLIDER_GAP             6
+#define FILE_BROWSER_COPY_BUF_B             (4 * 1024)
 
-#define FILE_BROWSER_WAIT_STACK_SIZE_B      (6 * 1024)
-#define FILE_BROWSER_WAIT_PRIO              (4)
+#define FILE_BROWSER_RESIZE_MAX_W           640
+#define FILE_BROWSER_RESIZE_MAX_H           480
+#define FILE_BROWSER_RESIZE_QUALITY         80
 
 typedef struct {
     bool active;
     bool is_dir;
     bool is_txt;
+    bool is_jpeg;
     char name[FS_NAV_MAX_NAME];
     char directory[FS_NAV_MAX_PATH];
 } file_manager_action_item_t;
@@ -48,6 +60,7 @@ typedef struct {
 typedef struct {
     bool has_item;
     bool cut; /* true = cut (move), false = copy */
+    bool resize; /* true = write reduced JPEG copies instead of pasting */
     bool is_dir;
     char name[FS_NAV_MAX_NAME];
     char src_path[FS_NAV_MAX_PATH];
@@ -60,13 +73,14 @@ typedef enum {
     FILE_BROWSER_ACTION_RENAME = 4,
     FILE_BROWSER_ACTION_COPY = 5,
     FILE_BROWSER_ACTION_CUT = 6,
+    FILE_BROWSER_ACTION_RESIZE = 7,
 } file_manager_action_type_t;
 
 typedef struct {
     bool initialized;
     fs_nav_t nav;
     lv_obj_t *screen;
-    lv_obj_t *path_label;
+    lv_obj_t *path_bar;
     lv_obj_t *settings_btn;
     lv_obj_t *tools_dd;
     lv_obj_t *datetime_btn;
@@ -77,6 +91,7 @@ typedef struct {
     lv_obj_t *sort_panel;
     lv_obj_t *sort_criteria_dd;
     lv_obj_t *sort_direction_dd;
+    lv_obj_t *bookmarks_panel;
     lv_obj_t *second_header;
     lv_obj_t *parent_btn;
     lv_obj_t *list;
@@ -96,16 +111,17 @@ typedef struct {
     lv_obj_t *rename_dialog;
     lv_obj_t *rename_textarea;
     lv_obj_t *rename_keyboard;
-    lv_timer_t *path_scroll_timer;
     lv_timer_t *list_scroll_timer;
     file_manager_action_item_t action_item;
     file_manager_clipboard_t clipboard;
     char paste_conflict_path[FS_NAV_MAX_PATH];
     char paste_conflict_name[FS_NAV_MAX_NAME];
     char paste_target_path[FS_NAV_MAX_PATH];
+    char resize_dest_path[FS_NAV_MAX_PATH]; /* Folder the running resize job writes to */
     bool paste_target_valid;
     bool suppress_click;
-    bool pending_go_parent;
+    bool pending_jump;
+    char pending_jump_relative[FS_NAV_MAX_PATH]; /* Location to open once the card is back */
     size_t list_window_start;
     size_t list_window_size;
     bool list_at_top_edge;
@@ -120,7 +136,6 @@ typedef struct {
 } file_manager_ctx_t;
 
 static file_manager_ctx_t s_browser;
-static TaskHandle_t file_manager_wait_task = NULL;
 
 /***************************************** Image Helpers *****************************************/
 /**
@@ -136,34 +151,53 @@ static bool file_manager_is_image(const char *name);
 static bool file_manager_is_jpeg(const char *name);
 
 /**
- * @brief Item click handler for JPEG files (path composition + view stub).
+ * @brief Open a JPEG in the image viewer, prompting on decode errors.
  *
  * @param ctx   Active browser context.
- * @param item  Navigator item selected from the list.
+ * @param path  Absolute path of the file.
+ * @param name  File name, for the logs.
+ * @return Result of jpg_viewer_open() (prompts are shown here).
  */
-static void file_manager_handle_jpeg(file_manager_ctx_t *ctx, const fs_nav_item_t *item);
+static esp_err_t file_manager_handle_jpeg(file_manager_ctx_t *ctx, const char *path, const char *name);
+
+/**
+ * @brief Register the built-in viewers (text, JPEG) once.
+ */
+static void file_manager_register_viewers(void);
+
+/**
+ * @brief Viewer registry entry point for .txt files (read-only text viewer).
+ */
+static esp_err_t file_manager_open_text_viewer(const viewer_open_req_t *req);
+
+/**
+ * @brief Viewer registry entry point for JPEG files.
+ */
+static esp_err_t file_manager_open_jpeg_viewer(const viewer_open_req_t *req);
 
 /************************************ UI & Data Refresh Helpers ***********************************/
 
 /**
- * @brief Launch a helper task that waits for SD reconnection.
+ * @brief Queue a worker pool job that waits for SD reconnection.
  *
- * Creates @c file_manager_wait_for_reconnection_task if it is not already
- * running. The helper blocks on the @ref reconnection_success semaphore and,
- * once the SD retry flow signals recovery, refreshes the browser view.
+ * Submits @c file_manager_wait_for_reconnection_job unless it is already
+ * queued or running. The job blocks on the @ref reconnection_success semaphore
+ * and, once the SD retry flow signals recovery, refreshes the browser view.
  */
 static void file_manager_schedule_wait_for_reconnection(void);
 
 /**
- * @brief Worker that blocks until SD reconnection completes, then reloads UI.
+ * @brief Job that blocks until SD reconnection completes, then reloads UI.
  *
- * Waits indefinitely on @ref reconnection_success. Once the semaphore is given
- * (meaning @ref retry_init_sdspi succeeded) it calls @ref file_manager_reload.
- * If the reload fails the device restarts to recover from the fatal state.
+ * Waits indefinitely on @ref reconnection_success, holding its worker. Once the
+ * semaphore is given (meaning @ref retry_init_sdspi succeeded) it calls
+ * @ref file_manager_reload. If the reload fails the device restarts to recover
+ * from the fatal state.
  *
+ * @param job Unused.
  * @param arg Unused.
  */
-static void file_manager_wait_for_reconnection_task(void* arg);
+static void file_manager_wait_for_reconnection_job(worker_pool_job_t *job, void *arg);
 
 /**
  * @brief Build the LVGL screen hierarchy (main header + path + secondary header + list).
@@ -197,6 +231,16 @@ static void file_manager_on_datetime_click(lv_event_t *e);
  */
 static void file_manager_start_clock_timer(file_manager_ctx_t *ctx);
 
+/**
+ * @brief Render-suspend listener: stop the clock timer while the screen is off.
+ */
+static void file_manager_on_render_suspend(void);
+
+/**
+ * @brief Render-resume listener: refresh the clock label and restart its timer.
+ */
+static void file_manager_on_render_resume(void);
+
 /**
  * @brief esp_timer callback fired every second to request a clock label refresh.
  *
@@ -216,32 +260,6 @@ static void file_manager_clock_timer_cb(void *arg);
  */
 static void file_manager_clock_update_async(void *arg);
 
-/**
- * @brief Restarts the delayed scrolling animation for the path label.
- *
- * This function cancels any existing scroll-start timer, forces the path label into
- * clipped mode, and creates a new one-shot timer that will re-enable circular
- * scrolling after FILE_BROWSER_PATH_SCROLL_DELAY_MS milliseconds.
- *
- * It is typically used whenever the displayed path changes, ensuring the scroll
- * animation restarts cleanly and does not begin immediately.
- *
- * @param ctx Pointer to the file browser UI context. Must contain a valid path_label.
- */
-static void file_manager_restart_path_scroll(file_manager_ctx_t *ctx);
-
-/**
- * @brief Timer callback used to enable scrolling for the file browser path label.
- *
- * This function is invoked after a short delay to switch the path label's long mode
- * from clipped (LV_LABEL_LONG_CLIP) to circular scrolling (LV_LABEL_LONG_SCROLL_CIRCULAR).
- * The delay prevents immediate scrolling and makes the UI feel smoother when paths change.
- *
- * @param timer Pointer to the LVGL timer that triggered the callback.
- *              Its user_data must contain a valid file_manager_ctx_t*.
- */
-static void file_manager_path_scroll_timer_cb(lv_timer_t *timer);
-
 /**
  * @brief Restart delayed scrolling for list item labels.
  *
@@ -331,11 +349,34 @@ static void file_manager_update_second_header(file_manager_ctx_t *ctx);
 static void file_manager_update_parent_button(file_manager_ctx_t *ctx);
 
 /**
- * @brief Update the path label from the current navigator path.
+ * @brief Rebuild the breadcrumb bar from the current navigator path.
+ *
+ * One tappable crumb per ancestor (root first); the current folder is a plain
+ * label. The bar is scrolled so the current folder stays visible.
  *
  * @param[in,out] ctx Browser context.
  */
- static void file_manager_update_path_label(file_manager_ctx_t *ctx);
+static void file_manager_update_breadcrumb(file_manager_ctx_t *ctx);
+
+/**
+ * @brief Breadcrumb crumb handler: jump straight to that ancestor.
+ *
+ * @param e LVGL event (CLICKED); target user data holds the ancestor depth,
+ *          event user data = @c file_manager_ctx_t*.
+ */
+static void file_manager_on_crumb_click(lv_event_t *e);
+
+/**
+ * @brief Finish a direct navigation started by the parent button, a crumb or a bookmark.
+ *
+ * Syncs the view on success. A missing folder is reported to the user; other
+ * errors remember @p target and wait for the card to come back.
+ *
+ * @param[in,out] ctx    Browser context.
+ * @param[in]     err    Result of the navigator call.
+ * @param[in]     target Relative path that was requested.
+ */
+static void file_manager_finish_jump(file_manager_ctx_t *ctx, esp_err_t err, const char *target);
 
 /**
  * @brief Update the sort mode and direction badges.
@@ -373,16 +414,65 @@ static void file_manager_update_parent_button(file_manager_ctx_t *ctx);
  */
  static bool file_manager_count_dir_items(file_manager_ctx_t *ctx, const fs_nav_item_t *item, size_t *out_count);
 
+/**
+ * @brief Build the two-line text of a file row: name, then index, size and,
+ *        for JPEGs with cached metadata, pixel dimensions.
+ *
+ * @param ctx           Browser context.
+ * @param item          File item with metadata populated.
+ * @param display_index 1-based absolute index.
+ * @param[out] out      Output buffer.
+ * @param out_len       Size of @p out.
+ */
+static void file_manager_format_file_text(file_manager_ctx_t *ctx, const fs_nav_item_t *item, size_t display_index,
+                                          char *out, size_t out_len);
+
+/**
+ * @brief Rewrite the text of the visible file rows after new photo metadata arrived.
+ *
+ * @param ctx Browser context.
+ */
+static void file_manager_refresh_file_rows(file_manager_ctx_t *ctx);
+
+/**
+ * @brief Photo metadata progress callback (runs on the extractor task).
+ *
+ * Updates the visible rows, and re-sorts when the scan finished while sorting by capture time.
+ *
+ * @param dir      Directory the extractor scanned.
+ * @param done     true when the scan finished.
+ * @param user_ctx Browser context.
+ */
+static void file_manager_on_exif_update(const char *dir, bool done, void *user_ctx);
+
+/**
+ * @brief Card journal subscriber: drops the cached listings a change affects.
+ *
+ * @param event    Change published to the journal.
+ * @param user_ctx Browser context.
+ */
+static void file_manager_on_card_change(const sd_journal_event_t *event, void *user_ctx);
+
+/**
+ * @brief Navigator capture time provider backed by the photo metadata cache.
+ *
+ * @param dir  Directory holding @p item.
+ * @param item File item.
+ * @param[out] captured Capture time.
+ * @return true if the cache has a capture time for @p item.
+ */
+static bool file_manager_capture_time(const char *dir, const fs_nav_item_t *item, time_t *captured);
+
 /**
  * @brief Format a byte size into a short human-friendly string.
  *
- * Uses B/KB/MB/GB up to 1 decimal place for KB or larger.
+ * Uses B/KB/MB/GB/TB up to 1 decimal place for KB or larger.
  *
  * @param bytes   Size in bytes.
  * @param[out] out Output buffer for the formatted text.
  * @param out_len Length of @p out.
  */
- static void file_manager_format_size(size_t bytes, char *out, size_t out_len);
+ static void file_manager_format_size(uint64_t bytes, char *out, size_t out_len);
 
 /**
  * @brief Refresh the current directory view and redraw the list.
@@ -508,7 +598,7 @@ static void file_manager_on_parent_click(lv_event_t *e);
 static void file_manager_on_settings_click(lv_event_t *e);
 
 /**
- * @brief Tools dropdown handler (New Folder / New TXT / Sort).
+ * @brief Tools dropdown handler (New Folder / New TXT / Sort / Bookmarks).
  *
  * @param e LVGL event (VALUE_CHANGED) with user data = @c file_manager_ctx_t*.
  */
@@ -588,6 +678,54 @@ static void file_manager_on_sort_apply(lv_event_t *e);
  */
 static void file_manager_on_sort_cancel(lv_event_t *e);
 
+/**
+ * @brief Display the bookmarks dialog overlay.
+ *
+ * Lists the bookmarked folders (tap to open, close icon to remove) and offers
+ * to bookmark or un-bookmark the current folder. Any open instance is
+ * replaced, which is also how the list is refreshed after a change.
+ *
+ * @param ctx File browser context that owns the dialog.
+ */
+static void file_manager_show_bookmarks_dialog(file_manager_ctx_t *ctx);
+
+/**
+ * @brief Close and destroy the bookmarks dialog.
+ *
+ * @param ctx File browser context that owns the dialog.
+ */
+static void file_manager_close_bookmarks_dialog(file_manager_ctx_t *ctx);
+
+/**
+ * @brief Bookmark entry handler: close the dialog and open the folder.
+ *
+ * @param e LVGL event (CLICKED); target user data holds the bookmark index,
+ *          event user data = @c file_manager_ctx_t*.
+ */
+static void file_manager_on_bookmark_open(lv_event_t *e);
+
+/**
+ * @brief Bookmark remove handler.
+ *
+ * @param e LVGL event (CLICKED); target user data holds the bookmark index,
+ *          event user data = @c file_manager_ctx_t*.
+ */
+static void file_manager_on_bookmark_remove(lv_event_t *e);
+
+/**
+ * @brief Add or remove the current folder from the bookmarks.
+ *
+ * @param e LVGL event (CLICKED) with user data = @c file_manager_ctx_t*.
+ */
+static void file_manager_on_bookmark_toggle(lv_event_t *e);
+
+/**
+ * @brief "Close" button handler for the bookmarks dialog.
+ *
+ * @param e LVGL event (CLICKED) with user data = @c file_manager_ctx_t*.
+ */
+static void file_manager_on_bookmarks_close(lv_event_t *e);
+
 /**
  * @brief Callback invoked when the text editor/viewer screen is closed.
  *
@@ -802,6 +940,24 @@ static void file_manager_on_paste_click(lv_event_t *e);
  */
 static void file_manager_on_cancel_paste_click(lv_event_t *e);
 
+/**
+ * @brief Start a background resize of the clipboard item into the current folder.
+ *
+ * @param ctx Browser context whose clipboard holds a JPEG or a folder marked for resize.
+ */
+static void file_manager_start_resize(file_manager_ctx_t *ctx);
+
+/**
+ * @brief Resize job completion callback: report the totals and refresh the listing.
+ *
+ * Runs on the resize task, so it takes the display lock itself.
+ *
+ * @param stats    Job totals.
+ * @param err      Job error (ESP_OK if the source could be read).
+ * @param user_ctx Browser context.
+ */
+static void file_manager_on_resize_done(const jpg_resize_stats_t *stats, esp_err_t err, void *user_ctx);
+
 /**
  * @brief Show overwrite/rename prompt when paste destination already exists.
  *
@@ -942,15 +1098,6 @@ static void file_manager_clear_clipboard(file_manager_ctx_t *ctx);
  */
 static void file_manager_show_message(const char *msg);
 
-/**
- * @brief Format a 64-bit byte count into a short human-readable string.
- *
- * @param bytes   Number of bytes.
- * @param out     Output buffer.
- * @param out_len Buffer length.
- */
-static void file_manager_format_size64(uint64_t bytes, char *out, size_t out_len);
-
 /**************************************************************************************************/
 
 
@@ -1176,10 +1323,20 @@ esp_err_t file_manager_start(void)
     file_manager_clear_action_state(ctx);
     file_manager_reset_window(ctx);
     settings_register_time_callbacks(file_manager_on_time_set, file_manager_reset_clock_display);
+    settings_register_render_callbacks(file_manager_on_render_suspend, file_manager_on_render_resume);
+    file_manager_register_viewers();
+
+    esp_err_t exif_err = fs_exif_init(file_manager_on_exif_update, ctx);
+    if (exif_err != ESP_OK && exif_err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGW(TAG_FILE_BROWSER_START, "Photo metadata extractor unavailable: (%s)", esp_err_to_name(exif_err));
+    }
 
     fs_nav_config_t nav_cfg = {
         .root_path = browser_cfg.root_path,
         .max_items = browser_cfg.max_items ? browser_cfg.max_items : FILE_BROWSER_MAX_SORTABLE_ITEMS,
+        .capture_time_cb = file_manager_capture_time,
+        .group_by_ext = FILE_BROWSER_GROUP_BY_EXTENSION,
+        .top_k = FILE_BROWSER_TOP_K_SORT,
     };
 
     esp_err_t nav_err = fs_nav_init(&ctx->nav, &nav_cfg);
@@ -1190,6 +1347,11 @@ esp_err_t file_manager_start(void)
         return nav_err;
     }
     ctx->initialized = true;
+    sd_journal_unsubscribe(file_manager_on_card_change, ctx);
+    esp_err_t journal_err = sd_journal_subscribe(file_manager_on_card_change, ctx);
+    if (journal_err != ESP_OK) {
+        ESP_LOGW(TAG_FILE_BROWSER_START, "Card change journal unavailable: (%s)", esp_err_to_name(journal_err));
+    }
 
     if (!bsp_display_lock(0)) {
         fs_nav_deinit(&ctx->nav);
@@ -1205,6 +1367,33 @@ esp_err_t file_manager_start(void)
     return ESP_OK;
 }
 
+const char *file_manager_current_path(void)
+{
+    file_manager_ctx_t *ctx = &s_browser;
+    return ctx->initialized ? fs_nav_current_path(&ctx->nav) : NULL;
+}
+
+esp_err_t file_manager_open_path(const char *path)
+{
+    file_manager_ctx_t *ctx = &s_browser;
+    if (!ctx->initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!path) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!bsp_display_lock(0)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = fs_nav_go_to_path(&ctx->nav, path);
+    if (err == ESP_OK) {
+        file_manager_sync_view(ctx);
+    }
+    bsp_display_unlock();
+    return err;
+}
+
 static void file_manager_build_screen(file_manager_ctx_t *ctx)
 {
     lv_obj_t *scr = lv_obj_create(NULL);
@@ -1234,7 +1423,7 @@ static void file_manager_build_screen(file_manager_ctx_t *ctx)
     lv_obj_set_style_text_align(settings_lbl, LV_TEXT_ALIGN_CENTER, 0);
 
     ctx->tools_dd = lv_dropdown_create(main_header);
-    lv_dropdown_set_options_static(ctx->tools_dd, "New Folder\nNew TXT\nSort");
+    lv_dropdown_set_options_static(ctx->tools_dd, "New Folder\nNew TXT\nSort\nBookmarks");
     lv_dropdown_set_selected(ctx->tools_dd, 0);
     lv_dropdown_set_text(ctx->tools_dd, "Tools");
     lv_obj_set_width(ctx->tools_dd, 70);
@@ -1272,6 +1461,7 @@ static void file_manager_build_screen(file_manager_ctx_t *ctx)
     lv_obj_remove_style_all(path_row);
     lv_obj_set_size(path_row, LV_PCT(100), LV_SIZE_CONTENT);
     lv_obj_set_flex_flow(path_row, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(path_row, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
     lv_obj_set_style_pad_gap(path_row, 4, 0);
 
     file_manager_start_clock_timer(ctx);
@@ -1280,12 +1470,16 @@ static void file_manager_build_screen(file_manager_ctx_t *ctx)
     lv_label_set_text(path_prefix, "Path: ");
     lv_obj_set_style_text_align(path_prefix, LV_TEXT_ALIGN_LEFT, 0);
 
-    ctx->path_label = lv_label_create(path_row);
-    lv_label_set_long_mode(ctx->path_label, LV_LABEL_LONG_CLIP);
-    lv_obj_set_flex_grow(ctx->path_label, 1);
-    lv_obj_set_width(ctx->path_label, LV_PCT(100));
-    lv_obj_set_style_text_align(ctx->path_label, LV_TEXT_ALIGN_LEFT, 0);
-    lv_label_set_text(ctx->path_label, "/");
+    /* Breadcrumb: one button per ancestor, scrolled horizontally when the path is long. */
+    ctx->path_bar = lv_obj_create(path_row);
+    lv_obj_remove_style_all(ctx->path_bar);
+    lv_obj_set_flex_grow(ctx->path_bar, 1);
+    lv_obj_set_height(ctx->path_bar, LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(ctx->path_bar, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(ctx->path_bar, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_gap(ctx->path_bar, 2, 0);
+    lv_obj_set_scroll_dir(ctx->path_bar, LV_DIR_HOR);
+    lv_obj_set_scrollbar_mode(ctx->path_bar, LV_SCROLLBAR_MODE_OFF);
 
     ctx->second_header = lv_obj_create(scr);
     lv_obj_remove_style_all(ctx->second_header);
@@ -1548,25 +1742,20 @@ static void file_manager_update_slider(file_manager_ctx_t *ctx)
 
 static void file_manager_schedule_wait_for_reconnection(void)
 {
-    if (file_manager_wait_task){
-        return;
+    /* One waiter is enough; a second would hold another worker until the next reconnection */
+    const worker_pool_submit_opts_t opts = {
+        .name = "fm_reconnect",
+        .join_running = true,
+        .cls = WORKER_POOL_INTERACTIVE,
+        .fn = file_manager_wait_for_reconnection_job,
+    };
+    esp_err_t err = worker_pool_submit(&opts, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to queue the SD reconnection wait: %s", esp_err_to_name(err));
     }
-    
-    BaseType_t res = xTaskCreatePinnedToCore(file_manager_wait_for_reconnection_task,
-                                             "file_manager_wait_task",
-                                             FILE_BROWSER_WAIT_STACK_SIZE_B,
-                                             NULL,
-                                             FILE_BROWSER_WAIT_PRIO,
-                                             &file_manager_wait_task,
-                                             tskNO_AFFINITY);
-
-    if (res != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create file browser wait task");
-        file_manager_wait_task = NULL;
-    }                                             
 }
 
-static void file_manager_wait_for_reconnection_task(void* arg)
+static void file_manager_wait_for_reconnection_job(worker_pool_job_t *job, void *arg)
 {
     file_manager_ctx_t *ctx = &s_browser;
     bool restart_required = false;
@@ -1575,11 +1764,14 @@ static void file_manager_wait_for_reconnection_task(void* arg)
         ESP_LOGE(TAG, "Failed to wait for SD reconnection, restarting...");
         restart_required = true;
     } else if (ctx->initialized) {
-        if (ctx->pending_go_parent) {
-            ctx->pending_go_parent = false;
-            esp_err_t nav_err = fs_nav_go_parent(&ctx->nav);
-            if (nav_err != ESP_OK){
-                ESP_LOGE(TAG, "fs_nav_go_parent() failed after reconnection (%s), restarting...", esp_err_to_name(nav_err));
+        /* Cached listings survive unless the remount reported the card as changed (SD_JOURNAL_RESET) */
+        if (ctx->pending_jump) {
+            ctx->pending_jump = false;
+            esp_err_t nav_err = fs_nav_go_to(&ctx->nav, ctx->pending_jump_relative);
+            if (nav_err == ESP_ERR_NOT_FOUND) {
+                ESP_LOGW(TAG, "\"%s\" is gone after reconnection, staying put", ctx->pending_jump_relative);
+            } else if (nav_err != ESP_OK){
+                ESP_LOGE(TAG, "fs_nav_go_to() failed after reconnection (%s), restarting...", esp_err_to_name(nav_err));
                 restart_required = true;
             }
         }
@@ -1605,9 +1797,6 @@ static void file_manager_wait_for_reconnection_task(void* arg)
         }
         esp_restart();
     }
-    
-    file_manager_wait_task = NULL;
-    vTaskDelete(NULL);
 }
 
 static void file_manager_sync_view(file_manager_ctx_t *ctx)
@@ -1630,10 +1819,11 @@ static void file_manager_sync_view(file_manager_ctx_t *ctx)
         ctx->list_suppress_scroll = false;
         ctx->list_has_paged = false;
     }
-    file_manager_update_path_label(ctx);
+    file_manager_update_breadcrumb(ctx);
     file_manager_update_sort_badges(ctx);
     file_manager_update_second_header(ctx);
     file_manager_apply_window(ctx, ctx->list_window_start, anchor, true, true);
+    fs_exif_request_dir(fs_nav_current_path(&ctx->nav));
 }
 
 static bool check_second_header(file_manager_ctx_t *ctx)
@@ -1678,62 +1868,93 @@ static void file_manager_update_parent_button(file_manager_ctx_t *ctx)
     }
 }
 
-static void file_manager_path_scroll_timer_cb(lv_timer_t *timer)
+static void file_manager_update_breadcrumb(file_manager_ctx_t *ctx)
 {
-    file_manager_ctx_t *ctx = (file_manager_ctx_t *)lv_timer_get_user_data(timer);
-    if (ctx) {
-        ctx->path_scroll_timer = NULL;
-        if (ctx->path_label && lv_obj_is_valid(ctx->path_label)) {
-            lv_label_set_long_mode(ctx->path_label, LV_LABEL_LONG_SCROLL_CIRCULAR);
+    if (!ctx || !ctx->path_bar) {
+        return;
+    }
+    lv_obj_clean(ctx->path_bar);
+
+    const char *relative = fs_nav_relative_path(&ctx->nav);
+    size_t depth = fs_nav_depth(&ctx->nav);
+    char segments[FS_NAV_MAX_PATH];
+    strlcpy(segments, relative ? relative : "", sizeof(segments));
+
+    lv_obj_t *last = NULL;
+    char *segment = segments;
+    for (size_t level = 0; level <= depth; level++) {
+        const char *text = LV_SYMBOL_HOME;
+        if (level > 0) {
+            lv_obj_t *sep = lv_label_create(ctx->path_bar);
+            lv_label_set_text(sep, "/");
+
+            text = segment;
+            char *slash = strchr(segment, '/');
+            if (slash) {
+                *slash = '\0';
+                segment = slash + 1;
+            }
+        }
+
+        if (level == depth) {
+            last = lv_label_create(ctx->path_bar);
+            lv_label_set_text(last, text);
+            break;
         }
+
+        lv_obj_t *crumb = lv_button_create(ctx->path_bar);
+        lv_obj_set_style_radius(crumb, 4, 0);
+        lv_obj_set_style_pad_hor(crumb, 6, 0);
+        lv_obj_set_style_pad_ver(crumb, 2, 0);
+        lv_obj_set_user_data(crumb, (void *)(uintptr_t)level);
+        lv_obj_add_event_cb(crumb, file_manager_on_crumb_click, LV_EVENT_CLICKED, ctx);
+        lv_obj_t *crumb_lbl = lv_label_create(crumb);
+        lv_label_set_text(crumb_lbl, text);
+        lv_obj_center(crumb_lbl);
+    }
+
+    if (last) {
+        lv_obj_update_layout(ctx->path_bar);
+        lv_obj_scroll_to_view(last, LV_ANIM_OFF);
     }
-    lv_timer_del(timer);
 }
 
-static void file_manager_restart_path_scroll(file_manager_ctx_t *ctx)
+static void file_manager_on_crumb_click(lv_event_t *e)
 {
-    if (!ctx || !ctx->path_label) {
+    file_manager_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx) {
         return;
     }
+    size_t depth = (size_t)(uintptr_t)lv_obj_get_user_data(lv_event_get_target(e));
 
-    if (ctx->path_scroll_timer) {
-        lv_timer_del(ctx->path_scroll_timer);
-        ctx->path_scroll_timer = NULL;
+    char target[FS_NAV_MAX_PATH];
+    if (fs_nav_ancestor_path(&ctx->nav, depth, target, sizeof(target)) != ESP_OK) {
+        return;
     }
 
-    /* Start clipped, then enable scroll after a short delay. */
-    lv_label_set_long_mode(ctx->path_label, LV_LABEL_LONG_CLIP);
-    ctx->path_scroll_timer = lv_timer_create(file_manager_path_scroll_timer_cb, FILE_BROWSER_PATH_SCROLL_DELAY_MS, ctx);
-    if (ctx->path_scroll_timer) {
-        lv_timer_set_repeat_count(ctx->path_scroll_timer, 1);
-    }
+    file_manager_show_loading(ctx);
+    esp_err_t err = fs_nav_go_to(&ctx->nav, target);
+    file_manager_finish_jump(ctx, err, target);
+    file_manager_hide_loading(ctx);
 }
 
-static void file_manager_update_path_label(file_manager_ctx_t *ctx)
+static void file_manager_finish_jump(file_manager_ctx_t *ctx, esp_err_t err, const char *target)
 {
-    if (!ctx || !ctx->path_label) {
+    if (err == ESP_OK) {
+        file_manager_sync_view(ctx);
         return;
     }
-    const char *path = fs_nav_current_path(&ctx->nav);
-    const char *mount = CONFIG_SDSPI_MOUNT_POINT;
-    char display[FS_NAV_MAX_PATH + 8];
-
-    if (path && mount && strncmp(path, mount, strlen(mount)) == 0) {
-        const char *rest = path + strlen(mount);
-        if (*rest == '/') {
-            rest++;
-        }
-        if (*rest == '\0') {
-            strlcpy(display, "/", sizeof(display));
-        } else {
-            snprintf(display, sizeof(display), "/%s", rest);
-        }
-    } else {
-        snprintf(display, sizeof(display), "%s", path ? path : "-");
+    if (err == ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG, "Folder \"/%s\" no longer exists", target);
+        file_manager_show_message("This folder no longer exists.");
+        return;
     }
 
-    lv_label_set_text(ctx->path_label, display);
-    file_manager_restart_path_scroll(ctx);
+    ESP_LOGE(TAG, "Failed to open \"/%s\": %s", target, esp_err_to_name(err));
+    ctx->pending_jump = true;
+    strlcpy(ctx->pending_jump_relative, target, sizeof(ctx->pending_jump_relative));
+    sdspi_schedule_sd_retry();
+    file_manager_schedule_wait_for_reconnection();
 }
 
 static void file_manager_update_sort_badges(file_manager_ctx_t *ctx)
@@ -1860,9 +2081,7 @@ static void file_manager_populate_list(file_manager_ctx_t *ctx)
 
         char text[FS_NAV_MAX_NAME + 64];
         if (!item->is_dir) {
-            char meta[32];
-            file_manager_format_size(item->size_bytes, meta, sizeof(meta));
-            snprintf(text, sizeof(text), "%s\nItem: %zu | Size: %s", item->name, display_index, meta);
+            file_manager_format_file_text(ctx, item, display_index, text, sizeof(text));
         } else {
             size_t child_count = 0;
             char meta[32];
@@ -1878,8 +2097,7 @@ static void file_manager_populate_list(file_manager_ctx_t *ctx)
                                ? LV_SYMBOL_DIRECTORY
                                : (file_manager_is_image(item->name) ? LV_SYMBOL_IMAGE : LV_SYMBOL_FILE);
 
-        lv_obj_t *btn = lv_list_add_btn(ctx->list, icon, text);
-        lv_obj_set_style_pad_all(btn, 3, LV_PART_MAIN);
+        lv_obj_t *btn = lv_list_add_btn(ctx->list, icon, text);  /* row padding comes from the theme */
         lv_obj_set_user_data(btn, (void *)(uintptr_t)i);
         lv_obj_add_event_cb(btn, file_manager_on_item_click, LV_EVENT_CLICKED, ctx);
         lv_obj_add_event_cb(btn, file_manager_on_item_long_press, LV_EVENT_LONG_PRESSED, ctx);
@@ -1918,23 +2136,93 @@ static bool file_manager_count_dir_items(file_manager_ctx_t *ctx, const fs_nav_i
     return true;
 }
 
-static void file_manager_format_size(size_t bytes, char *out, size_t out_len)
+static void file_manager_format_file_text(file_manager_ctx_t *ctx, const fs_nav_item_t *item, size_t display_index,
+                                          char *out, size_t out_len)
 {
-    static const char *suffixes[] = {"B", "KB", "MB", "GB"};
-    double value = (double)bytes;
-    size_t idx = 0;
-    while (value >= 1024.0 && idx < 3) {
-        value /= 1024.0;
-        idx++;
-    }
-    if (idx == 0) {
-        snprintf(out, out_len, "%u %s", (unsigned int)bytes, suffixes[idx]);
+    char size[32];
+    file_manager_format_size(item->size_bytes, size, sizeof(size));
+
+    fs_exif_info_t info;
+    if (file_manager_is_jpeg(item->name) &&
+        fs_exif_lookup(fs_nav_current_path(&ctx->nav), item->name, item->size_bytes, item->modified, &info) &&
+        info.width && info.height) {
+        snprintf(out, out_len, "%s\nItem: %zu | Size: %s | %ux%u", item->name, display_index, size,
+                 (unsigned)info.width, (unsigned)info.height);
     } else {
-        snprintf(out, out_len, "%.1f %s", value, suffixes[idx]);
+        snprintf(out, out_len, "%s\nItem: %zu | Size: %s", item->name, display_index, size);
     }
 }
 
-static void file_manager_format_size64(uint64_t bytes, char *out, size_t out_len)
+static void file_manager_refresh_file_rows(file_manager_ctx_t *ctx)
+{
+    size_t count = 0;
+    const fs_nav_item_t *items = fs_nav_items(&ctx->nav, &count);
+    if (!items) {
+        return;
+    }
+    size_t window_start = fs_nav_window_start(&ctx->nav);
+
+    uint32_t child_cnt = lv_obj_get_child_count(ctx->list);
+    for (uint32_t c = 0; c < child_cnt; c++) {
+        lv_obj_t *btn = lv_obj_get_child(ctx->list, c);
+        size_t i = (size_t)(uintptr_t)lv_obj_get_user_data(btn);
+        lv_obj_t *label = file_manager_get_list_btn_label(btn);
+        if (!label || i >= count || items[i].is_dir || !file_manager_is_jpeg(items[i].name)) {
+            continue;
+        }
+        char text[FS_NAV_MAX_NAME + 64];
+        file_manager_format_file_text(ctx, &items[i], window_start + i + 1, text, sizeof(text));
+        if (strcmp(lv_label_get_text(label), text) != 0) {
+            lv_label_set_text(label, text);
+        }
+    }
+}
+
+static void file_manager_on_exif_update(const char *dir, bool done, void *user_ctx)
+{
+    file_manager_ctx_t *ctx = (file_manager_ctx_t *)user_ctx;
+    if (!ctx || !bsp_display_lock(0)) {
+        return;
+    }
+
+    const char *current = fs_nav_current_path(&ctx->nav);
+    if (ctx->initialized && ctx->list && current && strcmp(current, dir) == 0) {
+        if (done && fs_nav_get_sort(&ctx->nav) == FS_NAV_SORT_CAPTURED &&
+            fs_nav_resort(&ctx->nav) == ESP_OK) {
+            lv_coord_t scroll_y = lv_obj_get_scroll_y(ctx->list);
+            file_manager_apply_window(ctx, ctx->list_window_start, SIZE_MAX, false, true);
+            lv_obj_scroll_to_y(ctx->list, scroll_y, LV_ANIM_OFF);
+        } else {
+            file_manager_refresh_file_rows(ctx);
+        }
+    }
+    bsp_display_unlock();
+}
+
+static void file_manager_on_card_change(const sd_journal_event_t *event, void *user_ctx)
+{
+    file_manager_ctx_t *ctx = (file_manager_ctx_t *)user_ctx;
+    if (!ctx || !bsp_display_lock(0)) {
+        return;
+    }
+    if (ctx->initialized) {
+        fs_nav_apply_change(&ctx->nav, event);
+    }
+    bsp_display_unlock();
+}
+
+static bool file_manager_capture_time(const char *dir, const fs_nav_item_t *item, time_t *captured)
+{
+    fs_exif_info_t info;
+    if (!file_manager_is_jpeg(item->name) ||
+        !fs_exif_lookup(dir, item->name, item->size_bytes, item->modified, &info) || !info.captured) {
+        return false;
+    }
+    *captured = info.captured;
+    return true;
+}
+
+static void file_manager_format_size(uint64_t bytes, char *out, size_t out_len)
 {
     static const char *suffixes[] = {"B", "KB", "MB", "GB", "TB"};
     double value = (double)bytes;
@@ -1976,16 +2264,10 @@ static bool file_manager_is_jpeg(const char *name)
     return strcasecmp(dot, ".jpg") == 0 || strcasecmp(dot, ".jpeg") == 0;
 }
 
-static void file_manager_handle_jpeg(file_manager_ctx_t *ctx, const fs_nav_item_t *item)
+static esp_err_t file_manager_handle_jpeg(file_manager_ctx_t *ctx, const char *path, const char *name)
 {
-    if (!ctx || !item) {
-        return;
-    }
-
-    char path[FS_NAV_MAX_PATH];
-    if (fs_nav_compose_path(&ctx->nav, item->name, path, sizeof(path)) != ESP_OK) {
-        ESP_LOGE(TAG, "Path too long for \"%s\"", item->name);
-        return;
+    if (!ctx || !path || !name) {
+        return ESP_ERR_INVALID_ARG;
     }
 
     const char *root = CONFIG_SDSPI_MOUNT_POINT;
@@ -1998,8 +2280,8 @@ static void file_manager_handle_jpeg(file_manager_ctx_t *ctx, const fs_nav_item_
     char lv_path[FS_NAV_MAX_PATH + 4];
     int needed = snprintf(lv_path, sizeof(lv_path), "S:%s", relative);
     if (needed < 0 || needed >= (int)sizeof(lv_path)) {
-        ESP_LOGE(TAG, "LVGL path too long for \"%s\"", item->name);
-        return;
+        ESP_LOGE(TAG, "LVGL path too long for \"%s\"", name);
+        return ESP_ERR_INVALID_SIZE;
     }
 
     jpg_viewer_open_opts_t opts = {
@@ -2023,8 +2305,61 @@ static void file_manager_handle_jpeg(file_manager_ctx_t *ctx, const fs_nav_item_
             sdspi_schedule_sd_retry();
         }
     }
+    return err;
+}
+
+static void file_manager_register_viewers(void)
+{
+    static const char *const text_exts[] = { "txt", NULL };
+    static const char *const jpeg_exts[] = { "jpg", "jpeg", NULL };
+    static const uint8_t jpeg_magic[] = { 0xFF, 0xD8, 0xFF };
+    static const viewer_desc_t viewers[] = {
+        {
+            .name = "text",
+            .extensions = text_exts,
+            .open = file_manager_open_text_viewer,
+        },
+        {
+            .name = "jpeg",
+            .extensions = jpeg_exts,
+            .magic = jpeg_magic,
+            .magic_len = sizeof(jpeg_magic),
+            .open = file_manager_open_jpeg_viewer,
+        },
+    };
+
+    for (size_t i = 0; i < sizeof(viewers) / sizeof(viewers[0]); i++) {
+        esp_err_t err = viewer_registry_register(&viewers[i]);
+        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+            ESP_LOGE(TAG, "Failed to register the %s viewer: %s", viewers[i].name, esp_err_to_name(err));
+        }
+    }
+}
+
+static esp_err_t file_manager_open_text_viewer(const viewer_open_req_t *req)
+{
+    text_viewer_open_opts_t opts = {
+        .path = req->path,
+        .return_screen = req->return_screen,
+        .editable = false,
+    };
+    file_manager_ctx_t *ctx = req->user_ctx;
+    file_manager_show_loading(ctx);
+    esp_err_t err = text_viewer_open(&opts);
+    file_manager_hide_loading(ctx);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to view \"%s\": %s", req->name, esp_err_to_name(err));
+        sdspi_schedule_sd_retry();
+    }
+    return err;
 }
 
+static esp_err_t file_manager_open_jpeg_viewer(const viewer_open_req_t *req)
+{
+    return file_manager_handle_jpeg(req->user_ctx, req->path, req->name);
+}
+
+
 static esp_err_t file_manager_reload(void)
 {
     file_manager_ctx_t *ctx = &s_browser;
@@ -2188,6 +2523,25 @@ static void file_manager_start_clock_timer(file_manager_ctx_t *ctx)
     ctx->clock_timer_running = true;
 }
 
+static void file_manager_on_render_suspend(void)
+{
+    file_manager_ctx_t *ctx = &s_browser;
+    if (ctx->clock_timer && ctx->clock_timer_running) {
+        esp_timer_stop(ctx->clock_timer);
+        ctx->clock_timer_running = false;
+    }
+}
+
+static void file_manager_on_render_resume(void)
+{
+    file_manager_ctx_t *ctx = &s_browser;
+    if (!ctx->clock_timer) {
+        return;
+    }
+    file_manager_clock_update_async(NULL);
+    file_manager_start_clock_timer(ctx);
+}
+
 static void file_manager_clock_timer_cb(void *arg)
 {
     /* Run UI update in LVGL context */
@@ -2292,30 +2646,22 @@ static void file_manager_on_item_click(lv_event_t *e)
         return;
     }
 
-    if (fs_text_is_txt(item->name)) {
-        ctx->reload_anchor_index = ctx->list_window_start + index;
-        char path[FS_NAV_MAX_PATH];
-        if (fs_nav_compose_path(&ctx->nav, item->name, path, sizeof(path)) == ESP_OK) {
-            text_viewer_open_opts_t opts = {
-                .path = path,
-                .return_screen = ctx->screen,
-                .editable = false,
-            };
-            file_manager_show_loading(ctx);
-            esp_err_t err = text_viewer_open(&opts);
-            file_manager_hide_loading(ctx);
-            if (err != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to view \"%s\": %s", item->name, esp_err_to_name(err));
-                sdspi_schedule_sd_retry();
-            }
-        } else {
-            ESP_LOGE(TAG, "Path too long for \"%s\"", item->name);
-        }
+    char path[FS_NAV_MAX_PATH];
+    if (fs_nav_compose_path(&ctx->nav, item->name, path, sizeof(path)) != ESP_OK) {
+        ESP_LOGE(TAG, "Path too long for \"%s\"", item->name);
         return;
     }
 
-    if (file_manager_is_jpeg(item->name)) {
-        file_manager_handle_jpeg(ctx, item);
+    const viewer_desc_t *viewer = viewer_registry_find(path, item->name);
+    if (viewer) {
+        ctx->reload_anchor_index = ctx->list_window_start + index;
+        viewer_open_req_t req = {
+            .path = path,
+            .name = item->name,
+            .return_screen = ctx->screen,
+            .user_ctx = ctx,
+        };
+        viewer_registry_open(viewer, &req);
         return;
     }
 
@@ -2474,16 +2820,15 @@ static void file_manager_on_parent_click(lv_event_t *e)
         return;
     }
 
-    file_manager_show_loading(ctx);
-    esp_err_t err = fs_nav_go_parent(&ctx->nav);
-    if (err == ESP_OK) {
-        file_manager_sync_view(ctx);
-    } else {
-        ESP_LOGE(TAG, "Failed to go parent: %s", esp_err_to_name(err));
-        ctx->pending_go_parent = true;
-        sdspi_schedule_sd_retry();
-        file_manager_schedule_wait_for_reconnection();
+    size_t depth = fs_nav_depth(&ctx->nav);
+    char target[FS_NAV_MAX_PATH];
+    if (depth == 0 || fs_nav_ancestor_path(&ctx->nav, depth - 1, target, sizeof(target)) != ESP_OK) {
+        return;
     }
+
+    file_manager_show_loading(ctx);
+    esp_err_t err = fs_nav_go_to(&ctx->nav, target);
+    file_manager_finish_jump(ctx, err, target);
     file_manager_hide_loading(ctx);
 }
 
@@ -2519,6 +2864,7 @@ static void file_manager_on_tools_changed(lv_event_t *e)
         case 0: file_manager_start_new_folder(ctx); break;
         case 1: file_manager_start_new_txt(ctx);    break;
         case 2: file_manager_show_sort_dialog(ctx); break;
+        case 3: file_manager_show_bookmarks_dialog(ctx); break;
         default: break;
     }
 
@@ -2597,7 +2943,7 @@ static void file_manager_show_sort_dialog(file_manager_ctx_t *ctx)
     lv_label_set_text(crit_lbl, "Criteria:");
 
     ctx->sort_criteria_dd = lv_dropdown_create(row_crit);
-    lv_dropdown_set_options_static(ctx->sort_criteria_dd, "Name\nDate\nSize");
+    lv_dropdown_set_options_static(ctx->sort_criteria_dd, "Name\nDate\nSize\nCaptured");
     lv_obj_set_width(ctx->sort_criteria_dd, 120);
     lv_obj_add_event_cb(ctx->sort_criteria_dd, file_manager_on_sort_criteria_changed, LV_EVENT_VALUE_CHANGED, ctx);
 
@@ -2725,6 +3071,175 @@ static void file_manager_on_sort_cancel(lv_event_t *e)
     file_manager_update_sort_badges(ctx);
 }
 
+static void file_manager_close_bookmarks_dialog(file_manager_ctx_t *ctx)
+{
+    if (!ctx || !ctx->bookmarks_panel) {
+        return;
+    }
+    lv_obj_del(ctx->bookmarks_panel);
+    ctx->bookmarks_panel = NULL;
+}
+
+static void file_manager_show_bookmarks_dialog(file_manager_ctx_t *ctx)
+{
+    if (!ctx) {
+        return;
+    }
+    file_manager_close_bookmarks_dialog(ctx);
+
+    lv_obj_t *overlay = lv_obj_create(lv_layer_top());
+    lv_obj_remove_style_all(overlay);
+    lv_obj_set_size(overlay, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_style_bg_color(overlay, lv_color_black(), 0);
+    lv_obj_set_style_bg_opa(overlay, LV_OPA_30, 0);
+    lv_obj_add_flag(overlay, LV_OBJ_FLAG_FLOATING | LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_CLICK_FOCUSABLE);
+    ctx->bookmarks_panel = overlay;
+
+    lv_obj_t *dlg = lv_obj_create(overlay);
+    lv_obj_set_style_radius(dlg, 12, 0);
+    lv_obj_set_style_pad_all(dlg, 12, 0);
+    lv_obj_set_style_pad_gap(dlg, 6, 0);
+    lv_obj_set_size(dlg, lv_pct(82), lv_pct(80));
+    lv_obj_set_flex_flow(dlg, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(dlg, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_center(dlg);
+
+    lv_obj_t *title = lv_label_create(dlg);
+    lv_label_set_text(title, "Bookmarks");
+    lv_obj_set_width(title, LV_PCT(100));
+    lv_obj_set_style_text_align(title, LV_TEXT_ALIGN_CENTER, 0);
+
+    lv_obj_t *entries = lv_obj_create(dlg);
+    lv_obj_remove_style_all(entries);
+    lv_obj_set_width(entries, LV_PCT(100));
+    lv_obj_set_flex_grow(entries, 1);
+    lv_obj_set_flex_flow(entries, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_style_pad_gap(entries, 4, 0);
+    lv_obj_set_scroll_dir(entries, LV_DIR_VER);
+
+    size_t count = fs_nav_bookmark_count(&ctx->nav);
+    if (count == 0) {
+        lv_obj_t *empty = lv_label_create(entries);
+        lv_label_set_text(empty, "No bookmarks yet.");
+        lv_obj_set_width(empty, LV_PCT(100));
+        lv_obj_set_style_text_align(empty, LV_TEXT_ALIGN_CENTER, 0);
+    }
+    for (size_t i = 0; i < count; i++) {
+        const char *relative = fs_nav_bookmark_path(&ctx->nav, i);
+        char display[FS_NAV_MAX_PATH + 2];
+        snprintf(display, sizeof(display), "/%s", relative ? relative : "");
+
+        lv_obj_t *row = lv_obj_create(entries);
+        lv_obj_remove_style_all(row);
+        lv_obj_set_flex_flow(row, LV_FLEX_FLOW_ROW);
+        lv_obj_set_style_pad_gap(row, 6, 0);
+        lv_obj_set_width(row, LV_PCT(100));
+        lv_obj_set_height(row, LV_SIZE_CONTENT);
+        lv_obj_set_flex_align(row, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+        lv_obj_t *open_btn = lv_button_create(row);
+        lv_obj_set_flex_grow(open_btn, 1);
+        lv_obj_set_user_data(open_btn, (void *)(uintptr_t)i);
+        lv_obj_add_event_cb(open_btn, file_manager_on_bookmark_open, LV_EVENT_CLICKED, ctx);
+        lv_obj_t *open_lbl = lv_label_create(open_btn);
+        lv_label_set_text(open_lbl, display);
+        lv_label_set_long_mode(open_lbl, LV_LABEL_LONG_DOT);
+        lv_obj_set_width(open_lbl, LV_PCT(100));
+
+        lv_obj_t *remove_btn = lv_button_create(row);
+        lv_obj_set_user_data(remove_btn, (void *)(uintptr_t)i);
+        lv_obj_add_event_cb(remove_btn, file_manager_on_bookmark_remove, LV_EVENT_CLICKED, ctx);
+        lv_obj_t *remove_lbl = lv_label_create(remove_btn);
+        lv_label_set_text(remove_lbl, LV_SYMBOL_CLOSE);
+        lv_obj_center(remove_lbl);
+    }
+
+    lv_obj_t *actions = lv_obj_create(dlg);
+    lv_obj_remove_style_all(actions);
+    lv_obj_set_flex_flow(actions, LV_FLEX_FLOW_ROW);
+    lv_obj_set_style_pad_gap(actions, 8, 0);
+    lv_obj_set_width(actions, LV_PCT(100));
+    lv_obj_set_height(actions, LV_SIZE_CONTENT);
+    lv_obj_set_flex_align(actions, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+    bool marked = fs_nav_bookmark_find(&ctx->nav, fs_nav_relative_path(&ctx->nav)) >= 0;
+    lv_obj_t *toggle_btn = lv_button_create(actions);
+    lv_obj_set_flex_grow(toggle_btn, 1);
+    lv_obj_t *toggle_lbl = lv_label_create(toggle_btn);
+    lv_label_set_text(toggle_lbl, marked ? "Remove this folder" : "Add this folder");
+    lv_obj_center(toggle_lbl);
+    lv_obj_add_event_cb(toggle_btn, file_manager_on_bookmark_toggle, LV_EVENT_CLICKED, ctx);
+    if (!marked && count >= FS_NAV_MAX_BOOKMARKS) {
+        lv_obj_add_state(toggle_btn, LV_STATE_DISABLED);
+    }
+
+    lv_obj_t *close_btn = lv_button_create(actions);
+    lv_obj_set_flex_grow(close_btn, 1);
+    lv_obj_t *close_lbl = lv_label_create(close_btn);
+    lv_label_set_text(close_lbl, "Close");
+    lv_obj_center(close_lbl);
+    lv_obj_add_event_cb(close_btn, file_manager_on_bookmarks_close, LV_EVENT_CLICKED, ctx);
+}
+
+static void file_manager_on_bookmark_open(lv_event_t *e)
+{
+    file_manager_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx) {
+        return;
+    }
+    size_t index = (size_t)(uintptr_t)lv_obj_get_user_data(lv_event_get_target(e));
+    const char *relative = fs_nav_bookmark_path(&ctx->nav, index);
+    if (!relative) {
+        return;
+    }
+    char target[FS_NAV_MAX_PATH];
+    strlcpy(target, relative, sizeof(target));
+    file_manager_close_bookmarks_dialog(ctx);
+
+    file_manager_show_loading(ctx);
+    esp_err_t err = fs_nav_open_bookmark(&ctx->nav, index);
+    file_manager_finish_jump(ctx, err, target);
+    file_manager_hide_loading(ctx);
+}
+
+static void file_manager_on_bookmark_remove(lv_event_t *e)
+{
+    file_manager_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx) {
+        return;
+    }
+    size_t index = (size_t)(uintptr_t)lv_obj_get_user_data(lv_event_get_target(e));
+    esp_err_t err = fs_nav_bookmark_remove(&ctx->nav, index);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to remove bookmark: %s", esp_err_to_name(err));
+    }
+    file_manager_show_bookmarks_dialog(ctx);
+}
+
+static void file_manager_on_bookmark_toggle(lv_event_t *e)
+{
+    file_manager_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx) {
+        return;
+    }
+    int index = fs_nav_bookmark_find(&ctx->nav, fs_nav_relative_path(&ctx->nav));
+    esp_err_t err = (index >= 0) ? fs_nav_bookmark_remove(&ctx->nav, (size_t)index)
+                                 : fs_nav_bookmark_add(&ctx->nav, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to update bookmarks: %s", esp_err_to_name(err));
+    }
+    file_manager_show_bookmarks_dialog(ctx);
+}
+
+static void file_manager_on_bookmarks_close(lv_event_t *e)
+{
+    file_manager_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx) {
+        return;
+    }
+    file_manager_close_bookmarks_dialog(ctx);
+}
+
 static void file_manager_editor_closed(bool changed, void *user_ctx)
 {
     file_manager_ctx_t *ctx = (file_manager_ctx_t *)user_ctx;
@@ -2918,6 +3433,7 @@ static esp_err_t file_manager_create_folder(file_manager_ctx_t *ctx, const char
         ESP_LOGE(TAG, "mkdir(%s) failed (errno=%d)", path, errno);
         return ESP_FAIL;
     }
+    sd_journal_publish(SD_JOURNAL_CREATED, path, NULL, true);
     return ESP_OK;
 }
 
@@ -3041,7 +3557,7 @@ static esp_err_t file_manager_compute_total_size(const char *path, uint64_t *byt
         return ESP_FAIL;
     }
     if (!S_ISDIR(st.st_mode)) {
-        *bytes += (uint64_t)st.st_size;
+        *bytes += sd_file_size(path, &st);
         return ESP_OK;
     }
 
@@ -3110,6 +3626,7 @@ static void file_manager_update_paste_button(file_manager_ctx_t *ctx)
         lv_obj_add_flag(ctx->cancel_paste_btn, LV_OBJ_FLAG_HIDDEN);
         lv_obj_add_state(ctx->cancel_paste_btn, LV_STATE_DISABLED);
     } else {
+        lv_label_set_text(ctx->paste_label, ctx->clipboard.resize ? "Resize here" : "Paste");
         lv_obj_clear_flag(ctx->paste_btn, LV_OBJ_FLAG_HIDDEN);
         lv_obj_remove_state(ctx->paste_btn, LV_STATE_DISABLED);
         lv_obj_clear_flag(ctx->cancel_paste_btn, LV_OBJ_FLAG_HIDDEN);
@@ -3156,11 +3673,19 @@ static esp_err_t file_manager_copy_file(const char *src, const char *dest)
         return ESP_FAIL;
     }
 
-    uint8_t buf[4096];
+    uint8_t *buf = mem_plan_alloc(MEM_PLAN_FILE_IO, FILE_BROWSER_COPY_BUF_B);
+    if (!buf) {
+        fclose(out);
+        fclose(in);
+        remove(dest);
+        return ESP_ERR_NO_MEM;
+    }
+
     size_t r = 0;
     esp_err_t err = ESP_OK;
-    while ((r = fread(buf, 1, sizeof(buf), in)) > 0) {
-        size_t w = fwrite(buf, 1, r, out);
+    /* Interactive: the browser waits for the paste to finish */
+    while ((r = sd_io_read(buf, FILE_BROWSER_COPY_BUF_B, in, SD_IO_INTERACTIVE)) > 0) {
+        size_t w = sd_io_write(buf, r, out, SD_IO_INTERACTIVE);
         if (w != r) {
             ESP_LOGE(TAG, "fwrite(%s) failed (errno=%d)", dest, errno);
             err = ESP_FAIL;
@@ -3173,6 +3698,7 @@ static esp_err_t file_manager_copy_file(const char *src, const char *dest)
         err = ESP_FAIL;
     }
 
+    mem_plan_free(MEM_PLAN_FILE_IO, buf);
     fclose(out);
     fclose(in);
     if (err != ESP_OK) {
@@ -3360,8 +3886,11 @@ static esp_err_t file_manager_perform_paste(file_manager_ctx_t *ctx, const char
         return ESP_ERR_INVALID_STATE;
     }
 
+    const bool is_dir = ctx->clipboard.is_dir;
     if (allow_overwrite && file_manager_path_exists(dest_path)) {
         esp_err_t del = file_manager_delete_path(dest_path);
+        /* Even a failed delete may have removed part of a folder */
+        sd_journal_publish(SD_JOURNAL_DELETED, dest_path, NULL, true);
         if (del != ESP_OK) {
             ESP_LOGE(TAG, "Failed to delete destination before overwrite: %s", esp_err_to_name(del));
             return del;
@@ -3370,13 +3899,18 @@ static esp_err_t file_manager_perform_paste(file_manager_ctx_t *ctx, const char
 
     esp_err_t err = ESP_OK;
     if (ctx->clipboard.cut) {
-        if (rename(ctx->clipboard.src_path, dest_path) != 0) {
+        /* The journal tells the source folder's cached listing, which is not the current one */
+        if (rename(ctx->clipboard.src_path, dest_path) == 0) {
+            sd_journal_publish(SD_JOURNAL_RENAMED, ctx->clipboard.src_path, dest_path, is_dir);
+        } else {
             if (errno != EXDEV) {
                 ESP_LOGW(TAG, "rename(%s -> %s) failed (errno=%d), falling back to copy+delete", ctx->clipboard.src_path, dest_path, errno);
             }
             err = file_manager_copy_item(ctx->clipboard.src_path, dest_path);
             if (err == ESP_OK) {
+                sd_journal_publish(SD_JOURNAL_CREATED, dest_path, NULL, is_dir);
                 err = file_manager_delete_path(ctx->clipboard.src_path);
+                sd_journal_publish(SD_JOURNAL_DELETED, ctx->clipboard.src_path, NULL, is_dir);
                 if (err != ESP_OK) {
                     ESP_LOGE(TAG, "Failed to remove source after cut: %s", esp_err_to_name(err));
                 }
@@ -3391,6 +3925,7 @@ static esp_err_t file_manager_perform_paste(file_manager_ctx_t *ctx, const char
 
     err = file_manager_copy_item(ctx->clipboard.src_path, dest_path);
     if (err == ESP_OK) {
+        sd_journal_publish(SD_JOURNAL_CREATED, dest_path, NULL, is_dir);
         file_manager_clear_clipboard(ctx);
         file_manager_update_second_header(ctx);
     }else{
@@ -3406,6 +3941,11 @@ static void file_manager_on_paste_click(lv_event_t *e)
         return;
     }
 
+    if (ctx->clipboard.resize) {
+        file_manager_start_resize(ctx);
+        return;
+    }
+
     char dest_path[FS_NAV_MAX_PATH];
     esp_err_t err = fs_nav_compose_path(&ctx->nav, ctx->clipboard.name, dest_path, sizeof(dest_path));
 
@@ -3460,6 +4000,65 @@ static void file_manager_on_paste_click(lv_event_t *e)
     }
 }
 
+static void file_manager_start_resize(file_manager_ctx_t *ctx)
+{
+    const char *dest_dir = fs_nav_current_path(&ctx->nav);
+    if (!dest_dir) {
+        return;
+    }
+    if (jpg_resize_is_running()) {
+        file_manager_show_message("A resize is already running.");
+        return;
+    }
+
+    jpg_resize_opts_t opts = {
+        .src_path = ctx->clipboard.src_path,
+        .dest_dir = dest_dir,
+        .max_width = FILE_BROWSER_RESIZE_MAX_W,
+        .max_height = FILE_BROWSER_RESIZE_MAX_H,
+        .quality = FILE_BROWSER_RESIZE_QUALITY,
+        .on_done = file_manager_on_resize_done,
+        .user_ctx = ctx,
+    };
+    esp_err_t err = jpg_resize_start(&opts);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start resize: %s", esp_err_to_name(err));
+        file_manager_show_message("Could not start resize.");
+        return;
+    }
+    strlcpy(ctx->resize_dest_path, dest_dir, sizeof(ctx->resize_dest_path));
+    file_manager_clear_clipboard(ctx);
+    file_manager_update_second_header(ctx);
+    file_manager_show_message("Resizing in the background.\nCopies are saved here as *" JPG_RESIZE_SUFFIX ".jpg.");
+}
+
+static void file_manager_on_resize_done(const jpg_resize_stats_t *stats, esp_err_t err, void *user_ctx)
+{
+    file_manager_ctx_t *ctx = user_ctx;
+    char msg[160];
+    if (err != ESP_OK) {
+        snprintf(msg, sizeof(msg), "Resize failed (%s).", esp_err_to_name(err));
+    } else {
+        const uint32_t secs_x10 = (stats->elapsed_ms + 50) / 100;
+        snprintf(msg, sizeof(msg), "Resized %lu image(s) in %lu.%lu s\n%llu KB -> %llu KB\nSkipped %lu, failed %lu",
+                 (unsigned long)stats->converted, (unsigned long)(secs_x10 / 10), (unsigned long)(secs_x10 % 10),
+                 (unsigned long long)(stats->bytes_in / 1024), (unsigned long long)(stats->bytes_out / 1024),
+                 (unsigned long)stats->skipped, (unsigned long)stats->failed);
+    }
+
+    bsp_display_lock(0);
+    file_manager_show_message(msg);
+    const char *current = fs_nav_current_path(&ctx->nav);
+    if (ctx->initialized && stats->converted > 0 && current && strcmp(current, ctx->resize_dest_path) == 0) {
+        ctx->preserve_window_on_reload = true;
+        file_manager_set_reload_anchor_current(ctx);
+        if (file_manager_reload() != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to refresh after resize");
+        }
+    }
+    bsp_display_unlock();
+}
+
 static void file_manager_on_paste_conflict(lv_event_t *e)
 {
     file_manager_ctx_t *ctx = lv_event_get_user_data(e);
@@ -3568,7 +4167,7 @@ static void file_manager_show_copy_confirm(file_manager_ctx_t *ctx, uint64_t byt
     file_manager_close_copy_confirm(ctx);
 
     char size_str[32];
-    file_manager_format_size64(bytes, size_str, sizeof(size_str));
+    file_manager_format_size(bytes, size_str, sizeof(size_str));
 
     lv_obj_t *mbox = lv_msgbox_create(NULL);
     ctx->copy_confirm_mbox = mbox;
@@ -3641,6 +4240,7 @@ static void file_manager_prepare_action_item(file_manager_ctx_t *ctx, const fs_n
     ctx->action_item.active = true;
     ctx->action_item.is_dir = item->is_dir;
     ctx->action_item.is_txt = !item->is_dir && fs_text_is_txt(item->name);
+    ctx->action_item.is_jpeg = !item->is_dir && file_manager_is_jpeg(item->name);
     strlcpy(ctx->action_item.name, item->name, sizeof(ctx->action_item.name));
     const char *dir = fs_nav_current_path(&ctx->nav);
     if (!dir) {
@@ -3732,23 +4332,26 @@ static void file_manager_show_action_menu(file_manager_ctx_t *ctx)
         lv_obj_center(edit_lbl);
         lv_obj_set_user_data(edit_btn, (void *)FILE_BROWSER_ACTION_EDIT);
         lv_obj_add_event_cb(edit_btn, file_manager_on_action_button, LV_EVENT_CLICKED, ctx);
+    }
 
-        lv_obj_t *cancel_btn = lv_button_create(row3);
-        lv_obj_set_flex_grow(cancel_btn, 1);
-        lv_obj_t *cancel_lbl = lv_label_create(cancel_btn);
-        lv_label_set_text(cancel_lbl, "Cancel");
-        lv_obj_center(cancel_lbl);
-        lv_obj_set_user_data(cancel_btn, (void *)FILE_BROWSER_ACTION_CANCEL);
-        lv_obj_add_event_cb(cancel_btn, file_manager_on_action_button, LV_EVENT_CLICKED, ctx);
-    } else {
-        lv_obj_t *cancel_btn = lv_button_create(row3);
-        lv_obj_set_flex_grow(cancel_btn, 1);
-        lv_obj_t *cancel_lbl = lv_label_create(cancel_btn);
-        lv_label_set_text(cancel_lbl, "Cancel");
-        lv_obj_center(cancel_lbl);
-        lv_obj_set_user_data(cancel_btn, (void *)FILE_BROWSER_ACTION_CANCEL);
-        lv_obj_add_event_cb(cancel_btn, file_manager_on_action_button, LV_EVENT_CLICKED, ctx);
+    bool has_resize = (ctx->action_item.is_dir || ctx->action_item.is_jpeg);
+    if (has_resize) {
+        lv_obj_t *resize_btn = lv_button_create(row3);
+        lv_obj_set_flex_grow(resize_btn, 1);
+        lv_obj_t *resize_lbl = lv_label_create(resize_btn);
+        lv_label_set_text(resize_lbl, "Resize");
+        lv_obj_center(resize_lbl);
+        lv_obj_set_user_data(resize_btn, (void *)FILE_BROWSER_ACTION_RESIZE);
+        lv_obj_add_event_cb(resize_btn, file_manager_on_action_button, LV_EVENT_CLICKED, ctx);
     }
+
+    lv_obj_t *cancel_btn = lv_button_create(row3);
+    lv_obj_set_flex_grow(cancel_btn, 1);
+    lv_obj_t *cancel_lbl = lv_label_create(cancel_btn);
+    lv_label_set_text(cancel_lbl, "Cancel");
+    lv_obj_center(cancel_lbl);
+    lv_obj_set_user_data(cancel_btn, (void *)FILE_BROWSER_ACTION_CANCEL);
+    lv_obj_add_event_cb(cancel_btn, file_manager_on_action_button, LV_EVENT_CLICKED, ctx);
 }
 
 static void file_manager_close_action_menu(file_manager_ctx_t *ctx)
@@ -3802,7 +4405,8 @@ static void file_manager_on_action_button(lv_event_t *e)
             file_manager_show_delete_confirm(ctx);
             break;
         case FILE_BROWSER_ACTION_COPY:
-        case FILE_BROWSER_ACTION_CUT: {
+        case FILE_BROWSER_ACTION_CUT:
+        case FILE_BROWSER_ACTION_RESIZE: {
             if (!ctx->action_item.active) {
                 return;
             }
@@ -3814,6 +4418,7 @@ static void file_manager_on_action_button(lv_event_t *e)
             memset(&ctx->clipboard, 0, sizeof(ctx->clipboard));
             ctx->clipboard.has_item = true;
             ctx->clipboard.cut = (action == FILE_BROWSER_ACTION_CUT);
+            ctx->clipboard.resize = (action == FILE_BROWSER_ACTION_RESIZE);
             ctx->clipboard.is_dir = ctx->action_item.is_dir;
             strlcpy(ctx->clipboard.name, ctx->action_item.name, sizeof(ctx->clipboard.name));
             strlcpy(ctx->clipboard.src_path, src_path, sizeof(ctx->clipboard.src_path));
@@ -3929,6 +4534,7 @@ static esp_err_t file_manager_delete_selected_item(file_manager_ctx_t *ctx)
     }
 
     err = file_manager_delete_path(path);
+    sd_journal_publish(SD_JOURNAL_DELETED, path, NULL, ctx->action_item.is_dir);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to delete %s: %s", path, esp_err_to_name(err));
         return err;
@@ -3967,6 +4573,7 @@ static void file_manager_clear_action_state(file_manager_ctx_t *ctx)
     ctx->action_item.active = false;
     ctx->action_item.is_dir = false;
     ctx->action_item.is_txt = false;
+    ctx->action_item.is_jpeg = false;
     ctx->action_item.name[0] = '\0';
     ctx->action_item.directory[0] = '\0';
     ctx->paste_target_valid = false;
@@ -4170,6 +4777,7 @@ static esp_err_t file_manager_perform_rename(file_manager_ctx_t *ctx, const char
         return ESP_FAIL;
     }
 
+    sd_journal_publish(SD_JOURNAL_RENAMED, old_path, new_path, ctx->action_item.is_dir);
     return ESP_OK;
 }
 
@@ -0,0 +1,829 @@
+#include "fs_exif.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "fs_navigator.h"
+#include "sd_card.h"
+#include "sd_file.h"
+#include "sd_io.h"
+#include "sd_journal.h"
+#include "stack_monitor.h"
+
+#define TAG "fs_exif"
+
+#define FS_EXIF_CACHE_DIRS      4       /* Directories kept in RAM, least recently used is dropped */
+#define FS_EXIF_MAX_ENTRIES     256     /* JPEGs cached per directory */
+#define FS_EXIF_GROW_STEP       32
+#define FS_EXIF_NOTIFY_BATCH    8       /* New entries between progress callbacks */
+#define FS_EXIF_APP1_MAX_B      4096    /* IFD0 and the Exif IFD sit at the start of APP1; the thumbnail is never read */
+#define FS_EXIF_MAX_MARKERS     32
+#define FS_EXIF_STACK_SIZE_B    (4 * 1024)
+#define FS_EXIF_PRIO            (2)
+#define FS_EXIF_STOP_POLL_MS    10
+#define FS_EXIF_STOP_TIMEOUT_MS 2000    /* A scan notices a stop between two files */
+
+#define FS_EXIF_TAG_ORIENTATION     0x0112
+#define FS_EXIF_TAG_DATETIME        0x0132
+#define FS_EXIF_TAG_EXIF_IFD        0x8769
+#define FS_EXIF_TAG_DATETIME_ORIG   0x9003
+#define FS_EXIF_TAG_PIXEL_X         0xA002
+#define FS_EXIF_TAG_PIXEL_Y         0xA003
+
+typedef struct {
+    uint32_t name_hash;
+    uint64_t size;
+    time_t mtime;
+    fs_exif_info_t info;
+    bool seen;                  /* Found by the running scan; unseen entries are pruned at the end */
+} fs_exif_entry_t;
+
+typedef struct {
+    char path[FS_NAV_MAX_PATH];
+    uint32_t last_used;
+    fs_exif_entry_t *entries;   /* Sorted by name_hash */
+    size_t count;
+    size_t capacity;
+    uint32_t changes;           /* Bumped by journal events touching the directory */
+    uint32_t scanned;           /* Value of changes when the last complete scan started */
+} fs_exif_dir_t;
+
+typedef struct {
+    const uint8_t *base;
+    size_t len;
+    bool little_endian;
+} fs_exif_tiff_t;
+
+typedef struct {
+    uint8_t orientation;
+    time_t datetime;
+    time_t datetime_original;
+    uint32_t exif_ifd;
+    uint32_t pixel_x;
+    uint32_t pixel_y;
+} fs_exif_tags_t;
+
+static SemaphoreHandle_t s_lock;
+static TaskHandle_t s_task;
+static fs_exif_dir_t s_dirs[FS_EXIF_CACHE_DIRS];
+static uint32_t s_use_clock;
+static char s_pending_dir[FS_NAV_MAX_PATH];
+static volatile uint32_t s_request_gen;
+static fs_exif_update_cb_t s_on_update;
+static void *s_user_ctx;
+static bool s_journaled;            /* Subscribed: a directory without changes since its last scan is skipped */
+static bool s_stopped;              /* Card users stopped (reformat): requests wait for the resume */
+static bool s_scanning;             /* The task is inside fs_exif_scan() */
+
+/****************************************** Extractor ********************************************/
+
+/**
+ * @brief Extractor task: waits for a directory request and scans it.
+ *
+ * @param arg Unused.
+ */
+static void fs_exif_task(void *arg);
+
+/**
+ * @brief Refresh the cache of one directory.
+ *
+ * Stops early when a newer request arrives or the directory's cache is full;
+ * entries of deleted files are dropped only after a complete pass.
+ *
+ * @param dir Directory path.
+ * @param gen Request generation this scan serves.
+ */
+static void fs_exif_scan(const char *dir, uint32_t gen);
+
+/**
+ * @brief Card journal subscriber: marks cached directories the event touches as changed.
+ */
+static void fs_exif_on_change(const sd_journal_event_t *event, void *user_ctx);
+
+/**
+ * @brief Card user callback: abandon the running scan and hold new ones until resumed.
+ *
+ * @return ESP_OK, or ESP_ERR_TIMEOUT if the scan did not wind down in time
+ *         (the extractor is then left running).
+ */
+static esp_err_t fs_exif_on_card_stop(bool stop, void *user_ctx);
+
+/**
+ * @brief Check for a .jpg/.jpeg extension (case-insensitive).
+ *
+ * @param name File name.
+ * @return true for JPEG names.
+ */
+static bool fs_exif_is_jpeg(const char *name);
+
+/**************************************************************************************************/
+
+/******************************************** Cache **********************************************/
+
+/**
+ * @brief Find the cache slot of a directory. Call with @c s_lock held.
+ *
+ * @param dir    Directory path.
+ * @param create Reuse the least recently used slot when @p dir has none.
+ * @return Slot, or NULL if absent and @p create is false.
+ */
+static fs_exif_dir_t *fs_exif_find_dir(const char *dir, bool create);
+
+/**
+ * @brief Binary search for a name hash. Call with @c s_lock held.
+ *
+ * @param d    Directory slot.
+ * @param hash Name hash.
+ * @param[out] pos Index of the entry, or where it would be inserted.
+ * @return true if found.
+ */
+static bool fs_exif_find_entry(const fs_exif_dir_t *d, uint32_t hash, size_t *pos);
+
+/**
+ * @brief Insert or replace an entry. Call with @c s_lock held.
+ *
+ * @param d     Directory slot.
+ * @param hash  Name hash.
+ * @param size  File size.
+ * @param mtime File modification time.
+ * @param info  Metadata.
+ * @return false if the slot is full or growing it failed.
+ */
+static bool fs_exif_store(fs_exif_dir_t *d, uint32_t hash, uint64_t size, time_t mtime, const fs_exif_info_t *info);
+
+/**
+ * @brief Drop entries not seen by the last complete scan. Call with @c s_lock held.
+ *
+ * @param d Directory slot.
+ */
+static void fs_exif_prune(fs_exif_dir_t *d);
+
+/**
+ * @brief FNV-1a hash of a file name.
+ *
+ * @param name File name.
+ * @return 32-bit hash.
+ */
+static uint32_t fs_exif_hash(const char *name);
+
+/**************************************************************************************************/
+
+/******************************************** Parser *********************************************/
+
+/**
+ * @brief Parse the TIFF structure inside an APP1 "Exif" block.
+ *
+ * @param data Start of the TIFF header.
+ * @param len  Bytes available (may be truncated).
+ * @param[out] tags Tags found; untouched fields stay 0.
+ */
+static void fs_exif_parse_tiff(const uint8_t *data, size_t len, fs_exif_tags_t *tags);
+
+/**
+ * @brief Walk one IFD and collect the tags of interest.
+ *
+ * @param t      TIFF view.
+ * @param offset IFD offset from the TIFF header.
+ * @param[in,out] tags Collected tags.
+ */
+static void fs_exif_parse_ifd(const fs_exif_tiff_t *t, uint32_t offset, fs_exif_tags_t *tags);
+
+/**
+ * @brief Read a SHORT or LONG tag value.
+ *
+ * @param t        TIFF view.
+ * @param type     TIFF field type.
+ * @param value_at Offset of the entry's 4-byte value field.
+ * @return Value, 0 for other types.
+ */
+static uint32_t fs_exif_tag_uint(const fs_exif_tiff_t *t, uint16_t type, size_t value_at);
+
+/**
+ * @brief Read an ASCII date tag ("YYYY:MM:DD HH:MM:SS").
+ *
+ * @param t        TIFF view.
+ * @param count    Entry count (string length including the NUL).
+ * @param value_at Offset of the entry's 4-byte value field.
+ * @return Seconds since the epoch, 0 if malformed or out of bounds.
+ */
+static time_t fs_exif_tag_datetime(const fs_exif_tiff_t *t, uint32_t count, size_t value_at);
+
+/**
+ * @brief Convert an EXIF date string to seconds since the epoch, without time zone.
+ *
+ * @param s At least 19 characters.
+ * @return Seconds, 0 if malformed.
+ */
+static time_t fs_exif_parse_datetime(const char *s);
+
+/**
+ * @brief Read a 16-bit value in the TIFF byte order (bounds checked by the caller).
+ */
+static uint16_t fs_exif_u16(const fs_exif_tiff_t *t, size_t off);
+
+/**
+ * @brief Read a 32-bit value in the TIFF byte order (bounds checked by the caller).
+ */
+static uint32_t fs_exif_u32(const fs_exif_tiff_t *t, size_t off);
+
+/**************************************************************************************************/
+
+esp_err_t fs_exif_init(fs_exif_update_cb_t on_update, void *user_ctx)
+{
+    if (s_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!s_lock) {
+        s_lock = xSemaphoreCreateMutex();
+        if (!s_lock) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    s_on_update = on_update;
+    s_user_ctx = user_ctx;
+    if (!s_journaled) {
+        esp_err_t err = sd_journal_subscribe(fs_exif_on_change, NULL);
+        if (err == ESP_OK) {
+            s_journaled = true;
+        } else {
+            ESP_LOGW(TAG, "Not subscribed to card changes (%s), every request rescans", esp_err_to_name(err));
+        }
+    }
+
+    stack_monitor_note_task("fs_exif", FS_EXIF_STACK_SIZE_B);
+    BaseType_t res = xTaskCreatePinnedToCore(fs_exif_task,
+                                             "fs_exif",
+                                             FS_EXIF_STACK_SIZE_B,
+                                             NULL,
+                                             FS_EXIF_PRIO,
+                                             &s_task,
+                                             tskNO_AFFINITY);
+    if (res != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create extractor task");
+        s_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t user_err = sd_card_register_user(fs_exif_on_card_stop, NULL);
+    if (user_err != ESP_OK) {
+        ESP_LOGW(TAG, "Not registered as a card user (%s), a reformat will not wait for scans", esp_err_to_name(user_err));
+    }
+    return ESP_OK;
+}
+
+void fs_exif_request_dir(const char *dir)
+{
+    if (!s_task || !dir || dir[0] == '\0') {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    strlcpy(s_pending_dir, dir, sizeof(s_pending_dir));
+    s_request_gen++;
+    xSemaphoreGive(s_lock);
+    xTaskNotifyGive(s_task);
+}
+
+bool fs_exif_lookup(const char *dir, const char *name, uint64_t size, time_t mtime, fs_exif_info_t *out)
+{
+    if (!s_lock || !dir || !name || !out) {
+        return false;
+    }
+
+    bool found = false;
+    uint32_t hash = fs_exif_hash(name);
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    fs_exif_dir_t *d = fs_exif_find_dir(dir, false);
+    size_t pos = 0;
+    if (d && fs_exif_find_entry(d, hash, &pos)) {
+        const fs_exif_entry_t *e = &d->entries[pos];
+        if (e->size == size && e->mtime == mtime) {
+            *out = e->info;
+            found = true;
+        }
+        d->last_used = ++s_use_clock;
+    }
+    xSemaphoreGive(s_lock);
+    return found;
+}
+
+esp_err_t fs_exif_read(const char *path, fs_exif_info_t *out)
+{
+    if (!path || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(out, 0, sizeof(*out));
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return ESP_FAIL;
+    }
+
+    uint8_t hdr[5];
+    if (fread(hdr, 1, 2, f) != 2 || hdr[0] != 0xFF || hdr[1] != 0xD8) {
+        fclose(f);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    esp_err_t err = ESP_OK;
+    fs_exif_tags_t tags = {0};
+    bool have_exif = false;
+    uint16_t sof_w = 0;
+    uint16_t sof_h = 0;
+
+    for (int i = 0; i < FS_EXIF_MAX_MARKERS; i++) {
+        int c = fgetc(f);
+        if (c != 0xFF) {
+            break;
+        }
+        do {
+            c = fgetc(f);
+        } while (c == 0xFF);
+        if (c == EOF || c == 0xD9 || c == 0xDA) {
+            break;  /* End of image or start of scan: nothing useful follows */
+        }
+        if ((c >= 0xD0 && c <= 0xD7) || c == 0x01) {
+            continue;  /* Markers without a length */
+        }
+        if (fread(hdr, 1, 2, f) != 2) {
+            break;
+        }
+        size_t payload = ((size_t)hdr[0] << 8) | hdr[1];
+        if (payload < 2) {
+            break;
+        }
+        payload -= 2;
+
+        if (c == 0xE1 && !have_exif && payload > 6) {
+            size_t n = payload < FS_EXIF_APP1_MAX_B ? payload : FS_EXIF_APP1_MAX_B;
+            uint8_t *buf = malloc(n);
+            if (!buf) {
+                err = ESP_ERR_NO_MEM;
+                break;
+            }
+            if (fread(buf, 1, n, f) != n) {
+                free(buf);
+                break;
+            }
+            if (memcmp(buf, "Exif\0\0", 6) == 0) {
+                have_exif = true;
+                fs_exif_parse_tiff(buf + 6, n - 6, &tags);
+            }
+            free(buf);
+            payload -= n;
+        } else if (c >= 0xC0 && c <= 0xCF && c != 0xC4 && c != 0xC8 && c != 0xCC && payload >= 5) {
+            if (fread(hdr, 1, 5, f) == 5) {
+                sof_h = (uint16_t)((hdr[1] << 8) | hdr[2]);
+                sof_w = (uint16_t)((hdr[3] << 8) | hdr[4]);
+            }
+            break;  /* The frame header is the last thing we need */
+        }
+
+        if (payload > 0 && fseek(f, (long)payload, SEEK_CUR) != 0) {
+            break;
+        }
+    }
+    fclose(f);
+
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    out->captured = tags.datetime_original ? tags.datetime_original : tags.datetime;
+    out->orientation = (tags.orientation >= 1 && tags.orientation <= 8) ? tags.orientation : 0;
+    /* Prefer the frame header; EXIF pixel sizes survive edits that change the image */
+    uint32_t w = sof_w ? sof_w : tags.pixel_x;
+    uint32_t h = sof_h ? sof_h : tags.pixel_y;
+    if (w > UINT16_MAX || h > UINT16_MAX) {
+        w = 0;
+        h = 0;
+    }
+    if (out->orientation >= 5) {
+        /* Orientations 5..8 are stored rotated by 90 degrees */
+        uint32_t tmp = w;
+        w = h;
+        h = tmp;
+    }
+    out->width = (uint16_t)w;
+    out->height = (uint16_t)h;
+    return ESP_OK;
+}
+
+static void fs_exif_task(void *arg)
+{
+    (void)arg;
+    char dir[FS_NAV_MAX_PATH];
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        strlcpy(dir, s_pending_dir, sizeof(dir));
+        uint32_t gen = s_request_gen;
+        const fs_exif_dir_t *d = (dir[0] != '\0') ? fs_exif_find_dir(dir, false) : NULL;
+        bool current = s_journaled && d && d->scanned == d->changes;
+        /* While stopped the request stays pending; the resume wakes the task again */
+        s_scanning = !s_stopped && !current && dir[0] != '\0';
+        const bool scan = s_scanning;
+        xSemaphoreGive(s_lock);
+
+        if (current) {
+            ESP_LOGD(TAG, "%s: unchanged since the last scan", dir);
+        } else if (scan) {
+            fs_exif_scan(dir, gen);
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            s_scanning = false;
+            xSemaphoreGive(s_lock);
+        }
+    }
+}
+
+static void fs_exif_scan(const char *dir, uint32_t gen)
+{
+    DIR *dp = opendir(dir);
+    if (!dp) {
+        ESP_LOGW(TAG, "opendir(%s) failed (errno=%d)", dir, errno);
+        return;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    fs_exif_dir_t *d = fs_exif_find_dir(dir, true);
+    for (size_t i = 0; i < d->count; i++) {
+        d->entries[i].seen = false;
+    }
+    const uint32_t changes = d->changes;
+    xSemaphoreGive(s_lock);
+
+    char path[FS_NAV_MAX_PATH + FS_NAV_MAX_NAME];
+    size_t fresh = 0;
+    size_t unreported = 0;
+    bool complete = true;
+    struct dirent *dent;
+
+    while ((dent = readdir(dp)) != NULL) {
+        if (s_request_gen != gen) {
+            complete = false;
+            break;
+        }
+        if (dent->d_type == DT_DIR || !fs_exif_is_jpeg(dent->d_name)) {
+            continue;
+        }
+        int needed = snprintf(path, sizeof(path), "%s/%s", dir, dent->d_name);
+        if (needed < 0 || needed >= (int)sizeof(path)) {
+            continue;
+        }
+        /* Background requests, never held across s_lock: browsing takes the bus first, then s_lock */
+        struct stat st;
+        sd_io_begin(SD_IO_BACKGROUND);
+        bool stat_ok = stat(path, &st) == 0;
+        uint64_t size = stat_ok ? sd_file_size(path, &st) : 0;
+        sd_io_end();
+        if (!stat_ok) {
+            continue;
+        }
+
+        uint32_t hash = fs_exif_hash(dent->d_name);
+        size_t pos = 0;
+        bool hit = false;
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (fs_exif_find_entry(d, hash, &pos) &&
+            d->entries[pos].size == size && d->entries[pos].mtime == st.st_mtime) {
+            d->entries[pos].seen = true;
+            hit = true;
+        }
+        xSemaphoreGive(s_lock);
+        if (hit) {
+            continue;
+        }
+
+        fs_exif_info_t info;
+        sd_io_begin(SD_IO_BACKGROUND);
+        esp_err_t err = fs_exif_read(path, &info);
+        sd_io_end();
+        if (err != ESP_OK && err != ESP_ERR_NOT_SUPPORTED) {
+            continue;  /* Retry on the next scan */
+        }
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        bool stored = fs_exif_store(d, hash, size, st.st_mtime, &info);
+        xSemaphoreGive(s_lock);
+        if (!stored) {
+            complete = false;
+            break;
+        }
+
+        fresh++;
+        if (++unreported >= FS_EXIF_NOTIFY_BATCH && s_on_update) {
+            unreported = 0;
+            s_on_update(dir, false, s_user_ctx);
+        }
+    }
+    closedir(dp);
+
+    if (complete) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        fs_exif_prune(d);
+        d->scanned = changes;
+        xSemaphoreGive(s_lock);
+    }
+    ESP_LOGD(TAG, "%s: %u new entries%s", dir, (unsigned)fresh, complete ? "" : " (partial)");
+
+    if (fresh > 0 && s_request_gen == gen && s_on_update) {
+        s_on_update(dir, true, s_user_ctx);
+    }
+}
+
+static bool fs_exif_is_jpeg(const char *name)
+{
+    const char *dot = strrchr(name, '.');
+    return dot && (strcasecmp(dot, ".jpg") == 0 || strcasecmp(dot, ".jpeg") == 0);
+}
+
+static fs_exif_dir_t *fs_exif_find_dir(const char *dir, bool create)
+{
+    fs_exif_dir_t *oldest = &s_dirs[0];
+    for (size_t i = 0; i < FS_EXIF_CACHE_DIRS; i++) {
+        fs_exif_dir_t *d = &s_dirs[i];
+        if (d->path[0] != '\0' && strcmp(d->path, dir) == 0) {
+            return d;
+        }
+        if (d->last_used < oldest->last_used) {
+            oldest = d;
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+
+    free(oldest->entries);
+    memset(oldest, 0, sizeof(*oldest));
+    strlcpy(oldest->path, dir, sizeof(oldest->path));
+    oldest->last_used = ++s_use_clock;
+    oldest->changes = 1;    /* never scanned */
+    return oldest;
+}
+
+static void fs_exif_on_change(const sd_journal_event_t *event, void *user_ctx)
+{
+    (void)user_ctx;
+    const bool moves_tree = event->is_dir && (event->op == SD_JOURNAL_DELETED || event->op == SD_JOURNAL_RENAMED);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (size_t i = 0; i < FS_EXIF_CACHE_DIRS; i++) {
+        fs_exif_dir_t *d = &s_dirs[i];
+        if (d->path[0] == '\0') {
+            continue;
+        }
+        if (event->op == SD_JOURNAL_RESET ||
+            sd_journal_in_dir(event->path, d->path) || sd_journal_in_dir(event->new_path, d->path) ||
+            (moves_tree && sd_journal_in_tree(d->path, event->path))) {
+            d->changes++;
+        }
+    }
+    xSemaphoreGive(s_lock);
+}
+
+static esp_err_t fs_exif_on_card_stop(bool stop, void *user_ctx)
+{
+    (void)user_ctx;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_stopped = stop;
+    if (stop) {
+        /* Abandons the running scan at its next file, as a newer request would */
+        s_request_gen++;
+    }
+    xSemaphoreGive(s_lock);
+    if (!stop) {
+        xTaskNotifyGive(s_task);
+        return ESP_OK;
+    }
+
+    for (uint32_t waited_ms = 0;; waited_ms += FS_EXIF_STOP_POLL_MS) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        bool scanning = s_scanning;
+        if (scanning && waited_ms >= FS_EXIF_STOP_TIMEOUT_MS) {
+            s_stopped = false;
+        }
+        xSemaphoreGive(s_lock);
+        if (!scanning) {
+            return ESP_OK;
+        }
+        if (waited_ms >= FS_EXIF_STOP_TIMEOUT_MS) {
+            /* Serve the abandoned request again once that scan returns */
+            xTaskNotifyGive(s_task);
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(FS_EXIF_STOP_POLL_MS));
+    }
+}
+
+static bool fs_exif_find_entry(const fs_exif_dir_t *d, uint32_t hash, size_t *pos)
+{
+    size_t lo = 0;
+    size_t hi = d->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (d->entries[mid].name_hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *pos = lo;
+    return lo < d->count && d->entries[lo].name_hash == hash;
+}
+
+static bool fs_exif_store(fs_exif_dir_t *d, uint32_t hash, uint64_t size, time_t mtime, const fs_exif_info_t *info)
+{
+    size_t pos = 0;
+    if (!fs_exif_find_entry(d, hash, &pos)) {
+        if (d->count == d->capacity) {
+            if (d->capacity >= FS_EXIF_MAX_ENTRIES) {
+                return false;
+            }
+            fs_exif_entry_t *grown = realloc(d->entries, (d->capacity + FS_EXIF_GROW_STEP) * sizeof(*grown));
+            if (!grown) {
+                return false;
+            }
+            d->entries = grown;
+            d->capacity += FS_EXIF_GROW_STEP;
+        }
+        memmove(&d->entries[pos + 1], &d->entries[pos], (d->count - pos) * sizeof(d->entries[0]));
+        d->count++;
+    }
+
+    fs_exif_entry_t *e = &d->entries[pos];
+    e->name_hash = hash;
+    e->size = size;
+    e->mtime = mtime;
+    e->info = *info;
+    e->seen = true;
+    return true;
+}
+
+static void fs_exif_prune(fs_exif_dir_t *d)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < d->count; i++) {
+        if (d->entries[i].seen) {
+            d->entries[kept++] = d->entries[i];
+        }
+    }
+    d->count = kept;
+}
+
+static uint32_t fs_exif_hash(const char *name)
+{
+    uint32_t h = 2166136261u;
+    for (const uint8_t *p = (const uint8_t *)name; *p; p++) {
+        h = (h ^ *p) * 16777619u;
+    }
+    return h;
+}
+
+static void fs_exif_parse_tiff(const uint8_t *data, size_t len, fs_exif_tags_t *tags)
+{
+    if (len < 8) {
+        return;
+    }
+    fs_exif_tiff_t t = {
+        .base = data,
+        .len = len,
+    };
+    if (data[0] == 'I' && data[1] == 'I') {
+        t.little_endian = true;
+    } else if (!(data[0] == 'M' && data[1] == 'M')) {
+        return;
+    }
+    if (fs_exif_u16(&t, 2) != 42) {
+        return;
+    }
+
+    uint32_t ifd0 = fs_exif_u32(&t, 4);
+    fs_exif_parse_ifd(&t, ifd0, tags);
+    if (tags->exif_ifd && tags->exif_ifd != ifd0) {
+        fs_exif_parse_ifd(&t, tags->exif_ifd, tags);
+    }
+}
+
+static void fs_exif_parse_ifd(const fs_exif_tiff_t *t, uint32_t offset, fs_exif_tags_t *tags)
+{
+    /* Offsets come from the file: compare by subtraction, offset + 2 can wrap with a 32-bit size_t */
+    if (offset > t->len || t->len - offset < 2) {
+        return;
+    }
+    size_t count = fs_exif_u16(t, offset);
+    size_t max_count = (t->len - offset - 2) / 12;
+    if (count > max_count) {
+        count = max_count;  /* Truncated by FS_EXIF_APP1_MAX_B */
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        size_t entry = offset + 2 + i * 12;
+        uint16_t tag = fs_exif_u16(t, entry);
+        uint16_t type = fs_exif_u16(t, entry + 2);
+        uint32_t n = fs_exif_u32(t, entry + 4);
+        size_t value_at = entry + 8;
+
+        switch (tag) {
+            case FS_EXIF_TAG_ORIENTATION:
+                tags->orientation = (uint8_t)fs_exif_tag_uint(t, type, value_at);
+                break;
+            case FS_EXIF_TAG_DATETIME:
+                tags->datetime = fs_exif_tag_datetime(t, n, value_at);
+                break;
+            case FS_EXIF_TAG_DATETIME_ORIG:
+                tags->datetime_original = fs_exif_tag_datetime(t, n, value_at);
+                break;
+            case FS_EXIF_TAG_EXIF_IFD:
+                tags->exif_ifd = fs_exif_tag_uint(t, type, value_at);
+                break;
+            case FS_EXIF_TAG_PIXEL_X:
+                tags->pixel_x = fs_exif_tag_uint(t, type, value_at);
+                break;
+            case FS_EXIF_TAG_PIXEL_Y:
+                tags->pixel_y = fs_exif_tag_uint(t, type, value_at);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static uint32_t fs_exif_tag_uint(const fs_exif_tiff_t *t, uint16_t type, size_t value_at)
+{
+    switch (type) {
+        case 3: /* SHORT */
+            return fs_exif_u16(t, value_at);
+        case 4: /* LONG */
+            return fs_exif_u32(t, value_at);
+        default:
+            return 0;
+    }
+}
+
+static time_t fs_exif_tag_datetime(const fs_exif_tiff_t *t, uint32_t count, size_t value_at)
+{
+    if (count < 20) {
+        return 0;
+    }
+    size_t at = fs_exif_u32(t, value_at);
+    if (at > t->len || t->len - at < 19) {
+        return 0;
+    }
+    return fs_exif_parse_datetime((const char *)t->base + at);
+}
+
+static time_t fs_exif_parse_datetime(const char *s)
+{
+    static const uint8_t pos[6] = {0, 5, 8, 11, 14, 17};
+    static const uint8_t width[6] = {4, 2, 2, 2, 2, 2};
+    int v[6];
+    for (int i = 0; i < 6; i++) {
+        v[i] = 0;
+        for (int j = 0; j < width[i]; j++) {
+            char c = s[pos[i] + j];
+            if (c < '0' || c > '9') {
+                return 0;  /* Also rejects the "    :  :  " placeholder some cameras write */
+            }
+            v[i] = v[i] * 10 + (c - '0');
+        }
+    }
+    int year = v[0], mon = v[1], day = v[2];
+    if (year < 1970 || mon < 1 || mon > 12 || day < 1 || day > 31 || v[3] > 23 || v[4] > 59 || v[5] > 60) {
+        return 0;
+    }
+
+    /* Days from 1970-01-01 in the proleptic Gregorian calendar */
+    int y = year - (mon <= 2);
+    int era = y / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (mon + (mon > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = (int64_t)era * 146097 + doe - 719468;
+    return (time_t)(days * 86400 + v[3] * 3600 + v[4] * 60 + v[5]);
+}
+
+static uint16_t fs_exif_u16(const fs_exif_tiff_t *t, size_t off)
+{
+    const uint8_t *p = t->base + off;
+    return t->little_endian ? (uint16_t)(p[0] | (p[1] << 8)) : (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t fs_exif_u32(const fs_exif_tiff_t *t, size_t off)
+{
+    const uint8_t *p = t->base + off;
+    return t->little_endian
+               ? ((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24))
+               : (((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3]);
+}
@@ -1,5 +1,6 @@
 #include "fs_navigator.h"
 
+#include <ctype.h>
 #include <dirent.h>
 #include <errno.h>
 #include <stdint.h>
@@ -13,7 +14,10 @@
 #include "esp_crc.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "mem_plan.h"
 #include "nvs.h"
+#include "sd_file.h"
+#include "sd_io.h"
 
 #define TAG "fs_nav"
 
@@ -21,6 +25,9 @@
 #define FS_NAV_NVS_NAMESPACE "fsnav"
 #define FS_NAV_NVS_KEY "state_v1"
 #define FS_NAV_STATE_VERSION 1u
+#define FS_NAV_BOOKMARKS_MAGIC 0x464E424Du
+#define FS_NAV_NVS_BOOKMARKS_KEY "marks_v1"
+#define FS_NAV_BOOKMARKS_VERSION 1u
 
 typedef struct {
     uint32_t magic;
@@ -32,6 +39,24 @@ typedef struct {
     uint32_t crc32;
 } fs_nav_state_blob_t;
 
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    char relative[FS_NAV_MAX_BOOKMARKS][FS_NAV_MAX_PATH];
+    uint32_t crc32;
+} fs_nav_bookmarks_blob_t;
+
+/* Group ids of unsorted listings; extension groups are 1..ext_count */
+#define FS_NAV_GROUP_DIRS  0
+#define FS_NAV_GROUP_OTHER (FS_NAV_MAX_GROUPS - 1)
+
+/* Entry of a top-K selection; the item's name points at the entry's own buffer */
+typedef struct {
+    fs_nav_item_t item;
+    char name[FS_NAV_MAX_NAME];
+} fs_nav_topk_entry_t;
+
 static fs_nav_sort_mode_t s_cmp_mode = FS_NAV_SORT_NAME;
 static bool s_cmp_ascending = true;
 /**
@@ -52,6 +77,160 @@ static bool fs_nav_is_valid_relative(const char *relative);
  */
 static void fs_nav_clear_items(fs_nav_t *nav);
 
+/**
+ * @brief Free a detached items array and the names it owns.
+ *
+ * @param items Array (may be NULL).
+ * @param count Number of initialized entries.
+ */
+static void fs_nav_free_listing(fs_nav_item_t *items, size_t count);
+
+/**
+ * @brief Scan @c nav->current into the items buffer, without validating the storage first.
+ *
+ * The whole scan is one interactive SD request, so background jobs cannot
+ * slip in between the readdir() calls.
+ *
+ * @param[in,out] nav Navigator.
+ * @return ESP_OK, ESP_FAIL on directory errors, or ESP_ERR_NO_MEM.
+ */
+static esp_err_t fs_nav_scan(fs_nav_t *nav);
+
+/**
+ * @brief Body of fs_nav_scan(), run with the SD bus held.
+ */
+static esp_err_t fs_nav_scan_dir(fs_nav_t *nav);
+
+/**
+ * @brief Group of a directory entry in unsorted listings.
+ *
+ * Folders, then one group per extension (with @c group_by_ext), then everything else.
+ * Depends only on the entry itself, so windows can be placed without an index.
+ *
+ * @param[in,out] nav   Navigator; its extension table grows when @p learn is set.
+ * @param[in]     dent  Entry.
+ * @param[in]     learn Counting pass: give unseen extensions a group while there is room.
+ * @return Group id.
+ */
+static uint8_t fs_nav_entry_group(fs_nav_t *nav, const struct dirent *dent, bool learn);
+
+/**
+ * @brief Turn the per-group counts of the counting pass into listing offsets.
+ *
+ * Order is folders, extension groups alphabetically, then the rest.
+ *
+ * @param[in,out] nav Navigator with @c group_size filled.
+ */
+static void fs_nav_layout_groups(fs_nav_t *nav);
+
+/**
+ * @brief Load the window at @p start in the current sort order without loading the directory.
+ *
+ * A window overlapping the loaded one reuses its overlap and takes the loaded first or
+ * last item as the cursor, so scrolling costs one pass. Any other window is reached by
+ * walking from the top, one pass per @p size entries.
+ *
+ * @param[in,out] nav   Navigator in unsorted mode with @c top_k set.
+ * @param[in]     start First listing index, already clamped.
+ * @param[in]     size  Window size.
+ * @return ESP_OK, ESP_ERR_NO_MEM, ESP_FAIL on read errors, or ESP_ERR_NOT_SUPPORTED if the
+ *         directory cannot be enumerated through FatFs (caller falls back to directory order).
+ */
+static esp_err_t fs_nav_topk_window(fs_nav_t *nav, size_t start, size_t size);
+
+/**
+ * @brief One directory pass keeping the @p k entries that follow @p after, or precede @p before.
+ *
+ * A bounded heap holds the candidates with the worst one at the root, so memory stays
+ * at @p k + 1 entries whatever the directory size. Both cursors NULL selects from the top.
+ *
+ * @param[in]  nav    Navigator (current directory and sort settings).
+ * @param[in]  after  Exclusive lower cursor, or NULL.
+ * @param[in]  before Exclusive upper cursor, or NULL (ignored when @p after is set).
+ * @param[in]  pool   Storage for @p k + 1 entries.
+ * @param[out] heap   @p k + 1 pointers; on return the first @p count are in sort order.
+ * @param[in]  k      Entries to keep.
+ * @param[out] count  Entries selected.
+ * @return ESP_OK, ESP_FAIL on read errors, or errors from @c sd_file_dir_open.
+ */
+static esp_err_t fs_nav_topk_select(const fs_nav_t *nav, const fs_nav_item_t *after, const fs_nav_item_t *before,
+                                    fs_nav_topk_entry_t *pool, fs_nav_topk_entry_t **heap, size_t k, size_t *count);
+
+/**
+ * @brief Total order for top-K selection: the sort comparator with a byte-wise tie break.
+ */
+static int fs_nav_topk_compare(const fs_nav_item_t *a, const fs_nav_item_t *b);
+
+/**
+ * @brief qsort comparator over @c fs_nav_topk_entry_t pointers.
+ */
+static int fs_nav_topk_ptr_compare(const void *lhs, const void *rhs);
+
+/**
+ * @brief Restore the heap property below @p i; the root is the worst entry kept.
+ *
+ * @param heap     Entries.
+ * @param count    Entries in the heap.
+ * @param i        Index to sift down from.
+ * @param backward Keeping the largest entries (worst = smallest) instead of the smallest.
+ */
+static void fs_nav_topk_sift_down(fs_nav_topk_entry_t **heap, size_t count, size_t i, bool backward);
+
+/**
+ * @brief Copy @p src and its name into @p dst, pointing the name at @p dst's buffer.
+ */
+static void fs_nav_topk_copy(fs_nav_topk_entry_t *dst, const fs_nav_item_t *src);
+
+/**
+ * @brief Duplicate selected entries into listing items.
+ *
+ * @param[out] dest  Items to fill.
+ * @param[in]  heap  Selected entries in sort order.
+ * @param[in]  count Number of entries.
+ * @return Items filled; fewer than @p count when out of memory.
+ */
+static size_t fs_nav_topk_emit(fs_nav_item_t *dest, fs_nav_topk_entry_t *const *heap, size_t count);
+
+/**
+ * @brief Take over the cached listing of bookmark @p index as the current listing.
+ *
+ * The caller has already validated the directory. The listing is re-sorted with
+ * the current mode since that may have changed since it was cached.
+ *
+ * @param[in,out] nav   Navigator positioned on the bookmarked directory.
+ * @param[in]     index Bookmark holding a cache.
+ */
+static void fs_nav_adopt_cache(fs_nav_t *nav, size_t index);
+
+/**
+ * @brief Store a detached listing as the cache of bookmark @p index.
+ *
+ * Evicts other caches until the total stays within @c FS_NAV_BOOKMARK_CACHE_ITEMS;
+ * a listing larger than that is freed instead.
+ *
+ * @param[in,out] nav   Navigator.
+ * @param[in]     index Bookmark index.
+ * @param[in]     items Listing whose ownership is transferred.
+ * @param[in]     count Number of items.
+ */
+static void fs_nav_cache_listing(fs_nav_t *nav, size_t index, fs_nav_item_t *items, size_t count);
+
+/**
+ * @brief Persist the bookmark list to NVS.
+ *
+ * @param[in] nav Navigator.
+ * @return ESP_OK, ESP_ERR_NO_MEM, or errors from NVS open/set/commit.
+ */
+static esp_err_t fs_nav_store_bookmarks(const fs_nav_t *nav);
+
+/**
+ * @brief Load the bookmark list from NVS, skipping invalid entries.
+ *
+ * @param[in,out] nav Navigator.
+ * @return ESP_OK, ESP_ERR_NO_MEM, or ESP_ERR_NVS_* / ESP_ERR_INVALID_* on decode failures.
+ */
+static esp_err_t fs_nav_load_bookmarks(fs_nav_t *nav);
+
 /**
  * @brief Recompute absolute current path from root + relative.
  *
@@ -114,10 +293,20 @@ static esp_err_t fs_nav_load_state(fs_nav_t *nav);
  */
 esp_err_t fs_nav_ensure_meta(fs_nav_t *nav, size_t index);
 
+/**
+ * @brief stat() one item and fill is_dir, size and mtime if still pending.
+ *
+ * @param nav  Navigator (for the current directory).
+ * @param item Item to complete.
+ * @return ESP_OK on success; ESP_ERR_INVALID_SIZE if the path does not fit; ESP_FAIL on stat errors.
+ */
+static esp_err_t fs_nav_stat_item(const fs_nav_t *nav, fs_nav_item_t *item);
+
 /**
  * @brief Sort the current items array with current mode and direction.
  *
  * Directories are kept together and sorted by name; files follow the chosen mode.
+ * Date, Size and Captured need metadata, so pending items are stat()ed first.
  *
  * @param[in,out] nav Navigator (no-op for <2 items or null array).
  */
@@ -127,7 +316,7 @@ static void fs_nav_sort_items(fs_nav_t *nav);
  * @brief qsort comparator for @c fs_nav_item_t honoring directories-first and sort settings.
  *
  * Directories are always grouped before files. Within directories, sorting is by name to keep
- * navigation intuitive. Files are sorted by current mode (Name/Date/Size). Ties fall back to name.
+ * navigation intuitive. Files are sorted by current mode (Name/Date/Size/Captured). Ties fall back to name.
  *
  * @param lhs Pointer to @c fs_nav_item_t (left).
  * @param rhs Pointer to @c fs_nav_item_t (right).
@@ -143,6 +332,9 @@ esp_err_t fs_nav_init(fs_nav_t *nav, const fs_nav_config_t *cfg)
 
     memset(nav, 0, sizeof(*nav));
     nav->max_items = cfg->max_items;
+    nav->capture_time_cb = cfg->capture_time_cb;
+    nav->group_by_ext = cfg->group_by_ext;
+    nav->top_k = cfg->top_k;
     nav->sort_mode = FS_NAV_SORT_NAME;
     nav->ascending = true;
     nav->sort_enabled = true;
@@ -178,6 +370,10 @@ esp_err_t fs_nav_init(fs_nav_t *nav, const fs_nav_config_t *cfg)
     if (state_err != ESP_OK) {
         ESP_LOGW(TAG, "Using default navigator state (%s)", esp_err_to_name(state_err));
     }
+    esp_err_t marks_err = fs_nav_load_bookmarks(nav);
+    if (marks_err != ESP_OK && marks_err != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGW(TAG, "Bookmarks not restored (%s)", esp_err_to_name(marks_err));
+    }
 
     err = fs_nav_refresh(nav);
     if (err != ESP_OK) {
@@ -192,6 +388,7 @@ void fs_nav_deinit(fs_nav_t *nav)
         return;
     }
     fs_nav_clear_items(nav);
+    fs_nav_invalidate_cache(nav, NULL);
 }
 
 esp_err_t fs_nav_refresh(fs_nav_t *nav)
@@ -200,17 +397,33 @@ esp_err_t fs_nav_refresh(fs_nav_t *nav)
         return ESP_ERR_INVALID_ARG;
     }
 
-    fs_nav_clear_items(nav);
-    nav->total_items = 0;
-    nav->window_start = 0;
-
     esp_err_t storage_err = fs_nav_check_storage_ready(nav);
     if (storage_err != ESP_OK) {
-        nav->item_count = 0;
+        fs_nav_clear_items(nav);
+        nav->total_items = 0;
+        nav->window_start = 0;
         return storage_err;
     }
+    return fs_nav_scan(nav);
+}
+
+static esp_err_t fs_nav_scan(fs_nav_t *nav)
+{
+    sd_io_begin(SD_IO_INTERACTIVE);
+    esp_err_t err = fs_nav_scan_dir(nav);
+    sd_io_end();
+    return err;
+}
+
+static esp_err_t fs_nav_scan_dir(fs_nav_t *nav)
+{
+    fs_nav_clear_items(nav);
+    nav->total_items = 0;
+    nav->window_start = 0;
 
     size_t total = 0;
+    nav->ext_count = 0;
+    memset(nav->group_size, 0, sizeof(nav->group_size));
 
     DIR *dir = opendir(nav->current);
     if (!dir) {
@@ -225,6 +438,7 @@ esp_err_t fs_nav_refresh(fs_nav_t *nav)
         if (strcmp(dent->d_name, ".") == 0 || strcmp(dent->d_name, "..") == 0) {
             continue;
         }
+        nav->group_size[fs_nav_entry_group(nav, dent, true)]++;
         total++;
     }
     int count_errno = errno;
@@ -243,6 +457,7 @@ esp_err_t fs_nav_refresh(fs_nav_t *nav)
 
     nav->total_items = total;
     nav->sort_enabled = (nav->max_items == 0) ? true : (total <= nav->max_items);
+    fs_nav_layout_groups(nav);
 
     /* default window size if none provided */
     if (nav->window_size == 0) {
@@ -253,9 +468,8 @@ esp_err_t fs_nav_refresh(fs_nav_t *nav)
         /* Load full list (<= limit) */
         size_t target = total;
         if (nav->capacity < target) {
-            fs_nav_item_t *new_items = heap_caps_realloc(nav->items,
-                                                            target * sizeof(fs_nav_item_t),
-                                                            MALLOC_CAP_8BIT);
+            fs_nav_item_t *new_items = mem_plan_realloc(MEM_PLAN_LISTING, nav->items,
+                                                        target * sizeof(fs_nav_item_t));
             if (!new_items) {
                 ESP_LOGE(TAG, "Out of memory while allocating %zu items for \"%s\"", target, nav->current);
                 nav->item_count = 0;
@@ -283,7 +497,7 @@ esp_err_t fs_nav_refresh(fs_nav_t *nav)
             memset(dest, 0, sizeof(*dest));
 
             size_t name_len = strnlen(dent->d_name, FS_NAV_MAX_NAME - 1);
-            dest->name = (char *)heap_caps_malloc(name_len + 1, MALLOC_CAP_8BIT);
+            dest->name = (char *)mem_plan_alloc(MEM_PLAN_LISTING, name_len + 1);
             if (!dest->name) {
                 load_errno = ENOMEM;
                 ESP_LOGE(TAG, "Out of memory duplicating item name");
@@ -388,66 +602,314 @@ esp_err_t fs_nav_enter(fs_nav_t *nav, size_t index)
         return ESP_ERR_INVALID_STATE;
     }
 
-    char prev_relative[FS_NAV_MAX_PATH];
-    strlcpy(prev_relative, nav->relative, sizeof(prev_relative));
-
     char next_relative[FS_NAV_MAX_PATH];
-    if (prev_relative[0] == '\0') {
+    if (nav->relative[0] == '\0') {
         strlcpy(next_relative, item->name, sizeof(next_relative));
     } else {
-        int written = snprintf(next_relative, sizeof(next_relative), "%s/%s", prev_relative, item->name);
+        int written = snprintf(next_relative, sizeof(next_relative), "%s/%s", nav->relative, item->name);
         if (written <= 0 || (size_t)written >= sizeof(next_relative)) {
             return ESP_ERR_INVALID_SIZE;
         }
     }
+    return fs_nav_go_to(nav, next_relative);
+}
+
+esp_err_t fs_nav_go_parent(fs_nav_t *nav)
+{
+    if (!fs_nav_can_go_parent(nav)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return fs_nav_go_ancestor(nav, fs_nav_depth(nav) - 1);
+}
 
-    esp_err_t err = fs_nav_set_relative(nav, next_relative);
+esp_err_t fs_nav_go_to(fs_nav_t *nav, const char *relative)
+{
+    if (!nav) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char prev_relative[FS_NAV_MAX_PATH];
+    strlcpy(prev_relative, nav->relative, sizeof(prev_relative));
+
+    esp_err_t err = fs_nav_set_relative(nav, relative);
     if (err != ESP_OK) {
         return err;
     }
 
-    err = fs_nav_refresh(nav);
-    if (err == ESP_OK) {
-        fs_nav_store_state(nav);
+    struct stat st = {0};
+    if (stat(nav->current, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        int target_errno = errno;
+        bool root_ok = stat(nav->root, &st) == 0 && S_ISDIR(st.st_mode);
+        ESP_LOGE(TAG, "Directory \"%s\" unavailable (errno=%d)", nav->current, target_errno);
+        fs_nav_set_relative(nav, prev_relative);
+        return root_ok ? ESP_ERR_NOT_FOUND : ESP_ERR_INVALID_STATE;
+    }
+
+    /* Keep the listing being left if it is a fully loaded bookmark; it becomes that bookmark's cache. */
+    bool same_dir = strcmp(prev_relative, nav->relative) == 0;
+    int prev_mark = same_dir ? -1 : fs_nav_bookmark_find(nav, prev_relative);
+    fs_nav_item_t *kept_items = NULL;
+    size_t kept_count = 0;
+    if (prev_mark >= 0 && nav->sort_enabled && nav->items &&
+        nav->item_count == nav->total_items && nav->item_count <= FS_NAV_BOOKMARK_CACHE_ITEMS) {
+        kept_items = nav->items;
+        kept_count = nav->item_count;
+        nav->items = NULL;
+        nav->item_count = 0;
+        nav->capacity = 0;
+    }
+
+    int next_mark = same_dir ? -1 : fs_nav_bookmark_find(nav, nav->relative);
+    if (next_mark >= 0 && nav->bookmarks[next_mark].items) {
+        fs_nav_adopt_cache(nav, (size_t)next_mark);
+        err = ESP_OK;
     } else {
-        // best-effort restore previous location if refresh failed
+        err = fs_nav_scan(nav);
+    }
+
+    if (err != ESP_OK) {
         fs_nav_set_relative(nav, prev_relative);
+        if (kept_items) {
+            fs_nav_clear_items(nav);
+            nav->items = kept_items;
+            nav->item_count = kept_count;
+            nav->capacity = kept_count;
+            nav->total_items = kept_count;
+            nav->window_start = 0;
+            nav->sort_enabled = true;
+        }
+        return err;
     }
-    return err;
+
+    if (kept_items) {
+        fs_nav_cache_listing(nav, (size_t)prev_mark, kept_items, kept_count);
+    }
+    fs_nav_store_state(nav);
+    return ESP_OK;
 }
 
-esp_err_t fs_nav_go_parent(fs_nav_t *nav)
+esp_err_t fs_nav_go_to_path(fs_nav_t *nav, const char *path)
 {
-    if (!fs_nav_can_go_parent(nav)) {
-        return ESP_ERR_INVALID_STATE;
+    if (!nav || !path) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-    char prev_relative[FS_NAV_MAX_PATH];
-    strlcpy(prev_relative, nav->relative, sizeof(prev_relative));
-
-    char new_relative[FS_NAV_MAX_PATH];
-    strlcpy(new_relative, prev_relative, sizeof(new_relative));
+    size_t root_len = strlen(nav->root);
+    if (strncmp(path, nav->root, root_len) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const char *rest = path + root_len;
+    if (root_len > 1 && *rest != '\0' && *rest != '/') {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-    char *slash = strrchr(new_relative, '/');
-    if (slash) {
-        *slash = '\0';
-    } else {
-        new_relative[0] = '\0';
+    char relative[FS_NAV_MAX_PATH];
+    if (strlcpy(relative, rest, sizeof(relative)) >= sizeof(relative)) {
+        return ESP_ERR_INVALID_SIZE;
     }
+    size_t len = strlen(relative);
+    while (len > 0 && relative[len - 1] == '/') {
+        relative[--len] = '\0';
+    }
+    return fs_nav_go_to(nav, relative);
+}
 
-    esp_err_t err = fs_nav_set_relative(nav, new_relative);
+esp_err_t fs_nav_go_ancestor(fs_nav_t *nav, size_t depth)
+{
+    char relative[FS_NAV_MAX_PATH];
+    esp_err_t err = fs_nav_ancestor_path(nav, depth, relative, sizeof(relative));
     if (err != ESP_OK) {
         return err;
     }
+    return fs_nav_go_to(nav, relative);
+}
 
-    err = fs_nav_refresh(nav);
-    if (err == ESP_OK) {
-        fs_nav_store_state(nav);
-    } else {
-        // Restore previous relative path so navigation state doesn't drift
-        fs_nav_set_relative(nav, prev_relative);
+esp_err_t fs_nav_ancestor_path(const fs_nav_t *nav, size_t depth, char *out, size_t out_len)
+{
+    if (!nav || !out || out_len == 0 || depth > fs_nav_depth(nav)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (strlcpy(out, nav->relative, out_len) >= out_len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (depth == 0) {
+        out[0] = '\0';
+        return ESP_OK;
+    }
+
+    /* Cut at the separator that follows the depth-th segment. */
+    size_t seen = 0;
+    for (char *p = out; *p; p++) {
+        if (*p == '/' && ++seen == depth) {
+            *p = '\0';
+            break;
+        }
+    }
+    return ESP_OK;
+}
+
+size_t fs_nav_depth(const fs_nav_t *nav)
+{
+    if (!nav || nav->relative[0] == '\0') {
+        return 0;
+    }
+    size_t depth = 1;
+    for (const char *p = nav->relative; *p; p++) {
+        if (*p == '/') {
+            depth++;
+        }
+    }
+    return depth;
+}
+
+esp_err_t fs_nav_bookmark_add(fs_nav_t *nav, const char *relative)
+{
+    if (!nav) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const char *clean = relative ? relative : nav->relative;
+    while (*clean == '/') {
+        clean++;
+    }
+    if (!fs_nav_is_valid_relative(clean) || strlen(clean) >= FS_NAV_MAX_PATH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (fs_nav_bookmark_find(nav, clean) >= 0) {
+        return ESP_OK;
+    }
+    if (nav->bookmark_count >= FS_NAV_MAX_BOOKMARKS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    fs_nav_bookmark_t *mark = &nav->bookmarks[nav->bookmark_count++];
+    memset(mark, 0, sizeof(*mark));
+    strlcpy(mark->relative, clean, sizeof(mark->relative));
+    return fs_nav_store_bookmarks(nav);
+}
+
+esp_err_t fs_nav_bookmark_remove(fs_nav_t *nav, size_t index)
+{
+    if (!nav || index >= nav->bookmark_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    fs_nav_free_listing(nav->bookmarks[index].items, nav->bookmarks[index].item_count);
+    memmove(&nav->bookmarks[index], &nav->bookmarks[index + 1],
+            (nav->bookmark_count - index - 1) * sizeof(nav->bookmarks[0]));
+    nav->bookmark_count--;
+    memset(&nav->bookmarks[nav->bookmark_count], 0, sizeof(nav->bookmarks[0]));
+    return fs_nav_store_bookmarks(nav);
+}
+
+size_t fs_nav_bookmark_count(const fs_nav_t *nav)
+{
+    return nav ? nav->bookmark_count : 0;
+}
+
+const char *fs_nav_bookmark_path(const fs_nav_t *nav, size_t index)
+{
+    if (!nav || index >= nav->bookmark_count) {
+        return NULL;
+    }
+    return nav->bookmarks[index].relative;
+}
+
+int fs_nav_bookmark_find(const fs_nav_t *nav, const char *relative)
+{
+    if (!nav || !relative) {
+        return -1;
+    }
+    for (size_t i = 0; i < nav->bookmark_count; i++) {
+        if (strcmp(nav->bookmarks[i].relative, relative) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+bool fs_nav_bookmark_is_cached(const fs_nav_t *nav, size_t index)
+{
+    return nav && index < nav->bookmark_count && nav->bookmarks[index].items;
+}
+
+esp_err_t fs_nav_open_bookmark(fs_nav_t *nav, size_t index)
+{
+    if (!nav || index >= nav->bookmark_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    char relative[FS_NAV_MAX_PATH];
+    strlcpy(relative, nav->bookmarks[index].relative, sizeof(relative));
+    return fs_nav_go_to(nav, relative);
+}
+
+void fs_nav_invalidate_cache(fs_nav_t *nav, const char *path)
+{
+    if (!nav) {
+        return;
+    }
+
+    const char *relative = NULL;
+    size_t rel_len = 0;
+    if (path) {
+        size_t root_len = strlen(nav->root);
+        if (strncmp(path, nav->root, root_len) != 0) {
+            return;
+        }
+        relative = path + root_len;
+        while (*relative == '/') {
+            relative++;
+        }
+        rel_len = strlen(relative);
+        while (rel_len > 0 && relative[rel_len - 1] == '/') {
+            rel_len--;
+        }
+    }
+
+    for (size_t i = 0; i < nav->bookmark_count; i++) {
+        fs_nav_bookmark_t *mark = &nav->bookmarks[i];
+        if (!mark->items) {
+            continue;
+        }
+        if (relative && rel_len > 0 &&
+            (strncmp(mark->relative, relative, rel_len) != 0 ||
+             (mark->relative[rel_len] != '\0' && mark->relative[rel_len] != '/'))) {
+            continue;
+        }
+        fs_nav_free_listing(mark->items, mark->item_count);
+        mark->items = NULL;
+        mark->item_count = 0;
+    }
+}
+
+void fs_nav_apply_change(fs_nav_t *nav, const sd_journal_event_t *event)
+{
+    if (!nav || !event) {
+        return;
+    }
+    if (event->op == SD_JOURNAL_RESET) {
+        fs_nav_invalidate_cache(nav, NULL);
+        return;
+    }
+
+    const bool moves_tree = event->is_dir && (event->op == SD_JOURNAL_DELETED || event->op == SD_JOURNAL_RENAMED);
+    char dir[FS_NAV_MAX_PATH];
+    for (size_t i = 0; i < nav->bookmark_count; i++) {
+        fs_nav_bookmark_t *mark = &nav->bookmarks[i];
+        if (!mark->items) {
+            continue;
+        }
+        int needed = mark->relative[0] ? snprintf(dir, sizeof(dir), "%s/%s", nav->root, mark->relative)
+                                        : snprintf(dir, sizeof(dir), "%s", nav->root);
+        bool stale = needed < 0 || needed >= (int)sizeof(dir) ||
+                     sd_journal_in_dir(event->path, dir) || sd_journal_in_dir(event->new_path, dir) ||
+                     (moves_tree && sd_journal_in_tree(dir, event->path));
+        if (!stale) {
+            continue;
+        }
+        fs_nav_free_listing(mark->items, mark->item_count);
+        mark->items = NULL;
+        mark->item_count = 0;
     }
-    return err;
 }
 
 esp_err_t fs_nav_set_sort(fs_nav_t *nav, fs_nav_sort_mode_t mode, bool ascending)
@@ -460,10 +922,28 @@ esp_err_t fs_nav_set_sort(fs_nav_t *nav, fs_nav_sort_mode_t mode, bool ascending
     nav->ascending = ascending;
     if (nav->sort_enabled) {
         fs_nav_sort_items(nav);
+    } else {
+        nav->top_k_valid = false; /* next fs_nav_set_window selects again */
     }
     return fs_nav_store_state(nav);
 }
 
+esp_err_t fs_nav_resort(fs_nav_t *nav)
+{
+    if (!nav) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!nav->sort_enabled) {
+        if (!nav->top_k) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        nav->top_k_valid = false;
+        return fs_nav_set_window(nav, nav->window_start, nav->window_size);
+    }
+    fs_nav_sort_items(nav);
+    return ESP_OK;
+}
+
 fs_nav_sort_mode_t fs_nav_get_sort(const fs_nav_t *nav)
 {
     return nav ? nav->sort_mode : FS_NAV_SORT_NAME;
@@ -476,7 +956,7 @@ bool fs_nav_is_sort_ascending(const fs_nav_t *nav)
 
 bool fs_nav_is_sort_enabled(const fs_nav_t *nav)
 {
-    return nav ? nav->sort_enabled : true;
+    return nav ? (nav->sort_enabled || nav->top_k) : true;
 }
 
 esp_err_t fs_nav_set_window(fs_nav_t *nav, size_t start, size_t size)
@@ -496,6 +976,13 @@ esp_err_t fs_nav_set_window(fs_nav_t *nav, size_t start, size_t size)
         start = nav->total_items ? (nav->total_items - 1) : 0;
     }
 
+    if (!nav->sort_enabled && nav->top_k) {
+        esp_err_t err = fs_nav_topk_window(nav, start, size);
+        if (err != ESP_ERR_NOT_SUPPORTED) {
+            return err;
+        }
+    }
+
     nav->window_start = start;
     nav->window_size = size;
 
@@ -507,9 +994,8 @@ esp_err_t fs_nav_set_window(fs_nav_t *nav, size_t start, size_t size)
     fs_nav_clear_items(nav);
 
     if (nav->capacity < size) {
-        fs_nav_item_t *new_items = heap_caps_realloc(nav->items,
-                                                        size * sizeof(fs_nav_item_t),
-                                                        MALLOC_CAP_8BIT);
+        fs_nav_item_t *new_items = mem_plan_realloc(MEM_PLAN_LISTING, nav->items,
+                                                    size * sizeof(fs_nav_item_t));
         if (!new_items) {
             ESP_LOGE(TAG, "Out of memory while allocating window of %zu items for \"%s\"", size, nav->current);
             return ESP_ERR_NO_MEM;
@@ -518,39 +1004,44 @@ esp_err_t fs_nav_set_window(fs_nav_t *nav, size_t start, size_t size)
         nav->capacity = size;
     }
 
+    sd_io_begin(SD_IO_INTERACTIVE);
     DIR *dir = opendir(nav->current);
     if (!dir) {
         ESP_LOGE(TAG, "opendir(%s) failed while setting window: errno=%d", nav->current, errno);
+        sd_io_end();
         nav->item_count = 0;
         return ESP_FAIL;
     }
 
+    /*
+     * One pass in directory order: each entry's listing index is its group's offset
+     * plus how many of that group came before it. Stop once the window is full.
+     */
+    const size_t end = (nav->total_items - start < size) ? nav->total_items : start + size;
+    const size_t want = end - start;
+    size_t seen[FS_NAV_MAX_GROUPS] = {0};
+    size_t filled = 0;
+    memset(nav->items, 0, want * sizeof(fs_nav_item_t));
+
     struct dirent *dent = NULL;
     errno = 0;
-    /* Skip to start */
-    size_t skipped = 0;
-    while (skipped < start && (dent = readdir(dir)) != NULL) {
+    while (filled < want && (dent = readdir(dir)) != NULL) {
         if (strcmp(dent->d_name, ".") == 0 || strcmp(dent->d_name, "..") == 0) {
             continue;
         }
-        skipped++;
-    }
-
-    size_t idx = 0;
-    errno = 0;
-    while ((dent = readdir(dir)) != NULL) {
-        if (strcmp(dent->d_name, ".") == 0 || strcmp(dent->d_name, "..") == 0) {
-            continue;
+        uint8_t group = fs_nav_entry_group(nav, dent, false);
+        size_t ordinal = seen[group]++;
+        if (ordinal >= nav->group_size[group]) {
+            continue; /* created since the count; shows up on the next refresh */
         }
-        if (idx >= size) {
-            break;
+        size_t pos = nav->group_start[group] + ordinal;
+        if (pos < start || pos >= end) {
+            continue;
         }
 
-        fs_nav_item_t *dest = &nav->items[idx];
-        memset(dest, 0, sizeof(*dest));
-
+        fs_nav_item_t *dest = &nav->items[pos - start];
         size_t name_len = strnlen(dent->d_name, FS_NAV_MAX_NAME - 1);
-        dest->name = (char *)heap_caps_malloc(name_len + 1, MALLOC_CAP_8BIT);
+        dest->name = (char *)mem_plan_alloc(MEM_PLAN_LISTING, name_len + 1);
         if (!dest->name) {
             ESP_LOGE(TAG, "Out of memory duplicating item name");
             break;
@@ -560,15 +1051,23 @@ esp_err_t fs_nav_set_window(fs_nav_t *nav, size_t start, size_t size)
 
         dest->needs_stat = true;
         dest->is_dir = (dent->d_type == DT_DIR);
-        dest->size_bytes = 0;
-        dest->modified = 0;
-
-        idx++;
+        filled++;
     }
     int load_errno = errno;
     closedir(dir);
+    sd_io_end();
 
-    nav->item_count = idx;
+    if (filled < want) {
+        /* Entries deleted since the count (or out of memory) leave holes; close them up */
+        size_t idx = 0;
+        for (size_t i = 0; i < want; i++) {
+            if (nav->items[i].name) {
+                nav->items[idx++] = nav->items[i];
+            }
+        }
+        filled = idx;
+    }
+    nav->item_count = filled;
 
     if (load_errno != 0) {
         fs_nav_clear_items(nav);
@@ -611,30 +1110,344 @@ esp_err_t fs_nav_ensure_meta(fs_nav_t *nav, size_t index)
         return ESP_ERR_INVALID_ARG;
     }
 
-    fs_nav_item_t *e = &nav->items[actual_index];
-    if (!e->needs_stat) {
+    return fs_nav_stat_item(nav, &nav->items[actual_index]);
+}
+
+static esp_err_t fs_nav_stat_item(const fs_nav_t *nav, fs_nav_item_t *item)
+{
+    if (!item->needs_stat) {
         return ESP_OK;
     }
 
     char path[FS_NAV_MAX_PATH * 2];
-    int written = snprintf(path, sizeof(path), "%s/%s", nav->current, e->name ? e->name : "");
+    int written = snprintf(path, sizeof(path), "%s/%s", nav->current, item->name ? item->name : "");
     if (written <= 0 || (size_t)written >= sizeof(path)) {
         return ESP_ERR_INVALID_SIZE;
     }
 
     struct stat st = {0};
+    sd_io_begin(SD_IO_INTERACTIVE);
     if (stat(path, &st) != 0) {
         ESP_LOGE(TAG, "stat(%s) failed: errno=%d", path, errno);
+        sd_io_end();
         return ESP_FAIL;
     }
+    item->size_bytes = sd_file_size(path, &st);
+    sd_io_end();
 
-    e->is_dir = S_ISDIR(st.st_mode);
-    e->size_bytes = st.st_size;
-    e->modified = st.st_mtime;
-    e->needs_stat = false;
+    item->is_dir = S_ISDIR(st.st_mode);
+    item->modified = st.st_mtime;
+    item->needs_stat = false;
     return ESP_OK;
 }
 
+static uint8_t fs_nav_entry_group(fs_nav_t *nav, const struct dirent *dent, bool learn)
+{
+    if (dent->d_type == DT_DIR) {
+        return FS_NAV_GROUP_DIRS;
+    }
+    if (!nav->group_by_ext) {
+        return FS_NAV_GROUP_OTHER;
+    }
+    const char *dot = strrchr(dent->d_name, '.');
+    if (!dot || dot == dent->d_name || dot[1] == '\0' || strlen(dot + 1) >= FS_NAV_EXT_LEN) {
+        return FS_NAV_GROUP_OTHER;
+    }
+
+    char ext[FS_NAV_EXT_LEN];
+    size_t len = 0;
+    for (const char *c = dot + 1; *c; c++) {
+        ext[len++] = (char)tolower((unsigned char)*c);
+    }
+    ext[len] = '\0';
+
+    for (uint8_t i = 0; i < nav->ext_count; i++) {
+        if (strcmp(nav->ext[i], ext) == 0) {
+            return (uint8_t)(i + 1);
+        }
+    }
+    if (!learn || nav->ext_count >= FS_NAV_MAX_GROUPS - 2) {
+        return FS_NAV_GROUP_OTHER;
+    }
+    memcpy(nav->ext[nav->ext_count], ext, len + 1);
+    return ++nav->ext_count;
+}
+
+static void fs_nav_layout_groups(fs_nav_t *nav)
+{
+    size_t offset = nav->group_size[FS_NAV_GROUP_DIRS];
+    nav->group_start[FS_NAV_GROUP_DIRS] = 0;
+
+    /* Selection by name over at most 14 extensions; cheaper than keeping a sorted table */
+    bool placed[FS_NAV_MAX_GROUPS - 2] = {0};
+    for (uint8_t n = 0; n < nav->ext_count; n++) {
+        int pick = -1;
+        for (uint8_t i = 0; i < nav->ext_count; i++) {
+            if (!placed[i] && (pick < 0 || strcmp(nav->ext[i], nav->ext[pick]) < 0)) {
+                pick = i;
+            }
+        }
+        placed[pick] = true;
+        nav->group_start[pick + 1] = offset;
+        offset += nav->group_size[pick + 1];
+    }
+    nav->group_start[FS_NAV_GROUP_OTHER] = offset;
+}
+
+static esp_err_t fs_nav_topk_window(fs_nav_t *nav, size_t start, size_t size)
+{
+    const size_t want = (nav->total_items - start < size) ? (nav->total_items - start) : size;
+    const size_t step_max = (nav->total_items < size) ? nav->total_items : size;
+    const size_t ws = nav->window_start;
+    const size_t n = nav->item_count;
+    const bool valid = nav->top_k_valid && n > 0;
+
+    if (valid && start == ws && n == want) {
+        nav->window_size = size;
+        return ESP_OK;
+    }
+
+    fs_nav_topk_entry_t *pool = mem_plan_alloc(MEM_PLAN_LISTING, (step_max + 1) * sizeof(*pool));
+    fs_nav_topk_entry_t **heap = mem_plan_alloc(MEM_PLAN_LISTING, (step_max + 1) * sizeof(*heap));
+    fs_nav_item_t *fresh = mem_plan_calloc(MEM_PLAN_LISTING, want, sizeof(*fresh));
+    if (!pool || !heap || !fresh) {
+        mem_plan_free(MEM_PLAN_LISTING, pool);
+        mem_plan_free(MEM_PLAN_LISTING, heap);
+        mem_plan_free(MEM_PLAN_LISTING, fresh);
+        ESP_LOGE(TAG, "Out of memory selecting %zu items for \"%s\"", want, nav->current);
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = ESP_OK;
+    size_t got = 0;
+    size_t filled = 0;
+    size_t new_start = start;
+    fs_nav_topk_entry_t cursor;
+
+    if (valid && start > ws && start <= ws + n) {
+        /* Scrolled forward: keep the overlap, select what follows the last loaded item */
+        size_t keep = ws + n - start;
+        if (keep > want) {
+            keep = want;
+        }
+        fs_nav_topk_copy(&cursor, &nav->items[n - 1]);
+        err = fs_nav_topk_select(nav, &cursor.item, NULL, pool, heap, want - keep, &got);
+        if (err == ESP_OK) {
+            for (size_t i = 0; i < keep; i++) {
+                fresh[i] = nav->items[start - ws + i];
+                nav->items[start - ws + i].name = NULL;
+            }
+            filled = keep + fs_nav_topk_emit(fresh + keep, heap, got);
+        }
+    } else if (valid && start < ws && ws < start + want) {
+        /* Scrolled back: select what precedes the first loaded item, then the overlap */
+        size_t keep = start + want - ws;
+        if (keep > n) {
+            keep = n;
+        }
+        fs_nav_topk_copy(&cursor, &nav->items[0]);
+        err = fs_nav_topk_select(nav, NULL, &cursor.item, pool, heap, ws - start, &got);
+        if (err == ESP_OK) {
+            filled = fs_nav_topk_emit(fresh, heap, got);
+            new_start = ws - got;
+            if (filled == got) {
+                for (size_t i = 0; i < keep; i++) {
+                    fresh[filled++] = nav->items[i];
+                    nav->items[i].name = NULL;
+                }
+            }
+        }
+    } else {
+        /*
+         * Anywhere else: walk forward from the loaded window if it is above @p start, from
+         * the top otherwise, carrying only the boundary entry from one pass to the next.
+         */
+        size_t pos = 0;
+        bool have_cursor = false;
+        if (valid && start > ws + n) {
+            pos = ws + n;
+            fs_nav_topk_copy(&cursor, &nav->items[n - 1]);
+            have_cursor = true;
+        }
+        while (pos < start) {
+            size_t step = (start - pos < step_max) ? (start - pos) : step_max;
+            err = fs_nav_topk_select(nav, have_cursor ? &cursor.item : NULL, NULL, pool, heap, step, &got);
+            if (err != ESP_OK || got == 0) {
+                break; /* directory shrank since the count */
+            }
+            fs_nav_topk_copy(&cursor, &heap[got - 1]->item);
+            have_cursor = true;
+            pos += got;
+        }
+        if (err == ESP_OK) {
+            err = fs_nav_topk_select(nav, have_cursor ? &cursor.item : NULL, NULL, pool, heap, want, &got);
+        }
+        if (err == ESP_OK) {
+            filled = fs_nav_topk_emit(fresh, heap, got);
+            new_start = pos;
+        }
+    }
+
+    mem_plan_free(MEM_PLAN_LISTING, pool);
+    mem_plan_free(MEM_PLAN_LISTING, heap);
+    if (err != ESP_OK) {
+        fs_nav_free_listing(fresh, want);
+        if (err != ESP_ERR_NOT_SUPPORTED) {
+            ESP_LOGE(TAG, "Top-K selection in \"%s\" failed (%s)", nav->current, esp_err_to_name(err));
+        }
+        return err;
+    }
+
+    fs_nav_clear_items(nav);
+    nav->items = fresh;
+    nav->capacity = want;
+    nav->item_count = filled;
+    nav->window_start = new_start;
+    nav->window_size = size;
+    nav->top_k_valid = true;
+    return ESP_OK;
+}
+
+static esp_err_t fs_nav_topk_select(const fs_nav_t *nav, const fs_nav_item_t *after, const fs_nav_item_t *before,
+                                    fs_nav_topk_entry_t *pool, fs_nav_topk_entry_t **heap, size_t k, size_t *count)
+{
+    *count = 0;
+    if (k == 0) {
+        return ESP_OK;
+    }
+    if (after) {
+        before = NULL;
+    }
+    const bool backward = (before != NULL);
+    const bool captured = (nav->sort_mode == FS_NAV_SORT_CAPTURED && nav->capture_time_cb);
+
+    s_cmp_mode = nav->sort_mode;
+    s_cmp_ascending = nav->ascending;
+    for (size_t i = 0; i <= k; i++) {
+        heap[i] = &pool[i];
+    }
+
+    /* FatFs directly: the listing carries size and date, so no stat() per entry */
+    sd_io_begin(SD_IO_INTERACTIVE);
+    sd_file_dir_t *dir = NULL;
+    esp_err_t err = sd_file_dir_open(nav->current, &dir);
+    if (err != ESP_OK) {
+        sd_io_end();
+        return err;
+    }
+
+    size_t used = 0;
+    sd_file_dirent_t ent;
+    while ((err = sd_file_dir_next(dir, &ent)) == ESP_OK) {
+        /* heap[k] is the scratch slot for the candidate */
+        fs_nav_topk_entry_t *cand = heap[used < k ? used : k];
+        strlcpy(cand->name, ent.name, sizeof(cand->name));
+        cand->item = (fs_nav_item_t){
+            .name = cand->name,
+            .is_dir = ent.is_dir,
+            .needs_stat = false,
+            .size_bytes = ent.size,
+            .modified = ent.modified,
+        };
+        /* Before the cursor test: in Captured order the cursor carries its capture time too */
+        if (captured && !ent.is_dir) {
+            nav->capture_time_cb(nav->current, &cand->item, &cand->item.captured);
+        }
+        if ((after && fs_nav_topk_compare(&cand->item, after) <= 0) ||
+            (before && fs_nav_topk_compare(&cand->item, before) >= 0)) {
+            continue;
+        }
+
+        if (used < k) {
+            /* Sift up */
+            size_t i = used++;
+            while (i > 0) {
+                size_t parent = (i - 1) / 2;
+                int cmp = fs_nav_topk_compare(&heap[i]->item, &heap[parent]->item);
+                if (backward ? (cmp >= 0) : (cmp <= 0)) {
+                    break;
+                }
+                fs_nav_topk_entry_t *tmp = heap[i];
+                heap[i] = heap[parent];
+                heap[parent] = tmp;
+                i = parent;
+            }
+            continue;
+        }
+
+        int cmp = fs_nav_topk_compare(&cand->item, &heap[0]->item);
+        if (backward ? (cmp > 0) : (cmp < 0)) {
+            heap[k] = heap[0];
+            heap[0] = cand;
+            fs_nav_topk_sift_down(heap, k, 0, backward);
+        }
+    }
+    sd_file_dir_close(dir);
+    sd_io_end();
+    if (err != ESP_ERR_NOT_FOUND) {
+        return ESP_FAIL;
+    }
+
+    qsort(heap, used, sizeof(*heap), fs_nav_topk_ptr_compare);
+    *count = used;
+    return ESP_OK;
+}
+
+static int fs_nav_topk_compare(const fs_nav_item_t *a, const fs_nav_item_t *b)
+{
+    int cmp = fs_nav_item_compare(a, b);
+    return cmp ? cmp : strcmp(a->name, b->name);
+}
+
+static int fs_nav_topk_ptr_compare(const void *lhs, const void *rhs)
+{
+    const fs_nav_topk_entry_t *a = *(fs_nav_topk_entry_t *const *)lhs;
+    const fs_nav_topk_entry_t *b = *(fs_nav_topk_entry_t *const *)rhs;
+    return fs_nav_topk_compare(&a->item, &b->item);
+}
+
+static void fs_nav_topk_sift_down(fs_nav_topk_entry_t **heap, size_t count, size_t i, bool backward)
+{
+    for (;;) {
+        size_t worst = i;
+        for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < count; child++) {
+            int cmp = fs_nav_topk_compare(&heap[child]->item, &heap[worst]->item);
+            if (backward ? (cmp < 0) : (cmp > 0)) {
+                worst = child;
+            }
+        }
+        if (worst == i) {
+            return;
+        }
+        fs_nav_topk_entry_t *tmp = heap[i];
+        heap[i] = heap[worst];
+        heap[worst] = tmp;
+        i = worst;
+    }
+}
+
+static void fs_nav_topk_copy(fs_nav_topk_entry_t *dst, const fs_nav_item_t *src)
+{
+    dst->item = *src;
+    strlcpy(dst->name, src->name, sizeof(dst->name));
+    dst->item.name = dst->name;
+}
+
+static size_t fs_nav_topk_emit(fs_nav_item_t *dest, fs_nav_topk_entry_t *const *heap, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        size_t name_len = strlen(heap[i]->name);
+        dest[i] = heap[i]->item;
+        dest[i].name = (char *)mem_plan_alloc(MEM_PLAN_LISTING, name_len + 1);
+        if (!dest[i].name) {
+            ESP_LOGE(TAG, "Out of memory duplicating item name");
+            return i;
+        }
+        memcpy(dest[i].name, heap[i]->name, name_len + 1);
+    }
+    return count;
+}
+
 static bool fs_nav_is_valid_relative(const char *relative)
 {
     if (!relative || relative[0] == '\0') {
@@ -673,14 +1486,74 @@ static void fs_nav_clear_items(fs_nav_t *nav)
     }
     for (size_t i = 0; i < nav->item_count; ++i) {
         if (nav->items[i].name) {
-            heap_caps_free(nav->items[i].name);
+            mem_plan_free(MEM_PLAN_LISTING, nav->items[i].name);
             nav->items[i].name = NULL;
         }
     }
-    heap_caps_free(nav->items);
+    mem_plan_free(MEM_PLAN_LISTING, nav->items);
     nav->items = NULL;
     nav->capacity = 0;
     nav->item_count = 0;
+    nav->top_k_valid = false;
+}
+
+static void fs_nav_free_listing(fs_nav_item_t *items, size_t count)
+{
+    if (!items) {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        mem_plan_free(MEM_PLAN_LISTING, items[i].name);
+    }
+    mem_plan_free(MEM_PLAN_LISTING, items);
+}
+
+static void fs_nav_adopt_cache(fs_nav_t *nav, size_t index)
+{
+    fs_nav_bookmark_t *mark = &nav->bookmarks[index];
+
+    fs_nav_clear_items(nav);
+    nav->items = mark->items;
+    nav->item_count = mark->item_count;
+    nav->capacity = mark->item_count;
+    nav->total_items = mark->item_count;
+    nav->window_start = 0;
+    nav->sort_enabled = true;
+    mark->items = NULL;
+    mark->item_count = 0;
+
+    fs_nav_sort_items(nav);
+}
+
+static void fs_nav_cache_listing(fs_nav_t *nav, size_t index, fs_nav_item_t *items, size_t count)
+{
+    fs_nav_bookmark_t *mark = &nav->bookmarks[index];
+    fs_nav_free_listing(mark->items, mark->item_count);
+    mark->items = NULL;
+    mark->item_count = 0;
+
+    if (count > FS_NAV_BOOKMARK_CACHE_ITEMS) {
+        fs_nav_free_listing(items, count);
+        return;
+    }
+
+    size_t cached = 0;
+    for (size_t i = 0; i < nav->bookmark_count; i++) {
+        cached += nav->bookmarks[i].item_count;
+    }
+    for (size_t i = 0; i < nav->bookmark_count && cached + count > FS_NAV_BOOKMARK_CACHE_ITEMS; i++) {
+        fs_nav_bookmark_t *other = &nav->bookmarks[i];
+        if (!other->items) {
+            continue;
+        }
+        cached -= other->item_count;
+        fs_nav_free_listing(other->items, other->item_count);
+        other->items = NULL;
+        other->item_count = 0;
+    }
+
+    mark->items = items;
+    mark->item_count = count;
 }
 
 static void fs_nav_update_current_path(fs_nav_t *nav)
@@ -821,11 +1694,94 @@ static esp_err_t fs_nav_load_state(fs_nav_t *nav)
     return ESP_OK;
 }
 
+static esp_err_t fs_nav_store_bookmarks(const fs_nav_t *nav)
+{
+    fs_nav_bookmarks_blob_t *blob = heap_caps_calloc(1, sizeof(*blob), MALLOC_CAP_8BIT);
+    if (!blob) {
+        return ESP_ERR_NO_MEM;
+    }
+    blob->magic = FS_NAV_BOOKMARKS_MAGIC;
+    blob->version = FS_NAV_BOOKMARKS_VERSION;
+    blob->count = nav->bookmark_count;
+    for (size_t i = 0; i < nav->bookmark_count; i++) {
+        strlcpy(blob->relative[i], nav->bookmarks[i].relative, sizeof(blob->relative[i]));
+    }
+    blob->crc32 = esp_crc32_le(0, (const uint8_t *)blob, sizeof(*blob) - sizeof(blob->crc32));
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(FS_NAV_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, FS_NAV_NVS_BOOKMARKS_KEY, blob, sizeof(*blob));
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    heap_caps_free(blob);
+    return err;
+}
+
+static esp_err_t fs_nav_load_bookmarks(fs_nav_t *nav)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(FS_NAV_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    fs_nav_bookmarks_blob_t *blob = heap_caps_calloc(1, sizeof(*blob), MALLOC_CAP_8BIT);
+    if (!blob) {
+        nvs_close(handle);
+        return ESP_ERR_NO_MEM;
+    }
+    size_t blob_size = sizeof(*blob);
+    err = nvs_get_blob(handle, FS_NAV_NVS_BOOKMARKS_KEY, blob, &blob_size);
+    nvs_close(handle);
+
+    if (err == ESP_OK && blob_size != sizeof(*blob)) {
+        err = ESP_ERR_INVALID_SIZE;
+    }
+    if (err == ESP_OK && (blob->magic != FS_NAV_BOOKMARKS_MAGIC || blob->version != FS_NAV_BOOKMARKS_VERSION)) {
+        err = ESP_ERR_INVALID_VERSION;
+    }
+    if (err == ESP_OK &&
+        esp_crc32_le(0, (const uint8_t *)blob, sizeof(*blob) - sizeof(blob->crc32)) != blob->crc32) {
+        err = ESP_ERR_INVALID_CRC;
+    }
+
+    if (err == ESP_OK) {
+        nav->bookmark_count = 0;
+        for (uint32_t i = 0; i < blob->count && i < FS_NAV_MAX_BOOKMARKS; i++) {
+            blob->relative[i][FS_NAV_MAX_PATH - 1] = '\0';
+            if (!fs_nav_is_valid_relative(blob->relative[i])) {
+                continue;
+            }
+            fs_nav_bookmark_t *mark = &nav->bookmarks[nav->bookmark_count++];
+            memset(mark, 0, sizeof(*mark));
+            strlcpy(mark->relative, blob->relative[i], sizeof(mark->relative));
+        }
+    }
+    heap_caps_free(blob);
+    return err;
+}
+
 static void fs_nav_sort_items(fs_nav_t *nav)
 {
     if (!nav || nav->item_count < 2 || !nav->items || !nav->sort_enabled) {
         return;
     }
+    if (nav->sort_mode != FS_NAV_SORT_NAME) {
+        for (size_t i = 0; i < nav->item_count; i++) {
+            fs_nav_item_t *item = &nav->items[i];
+            fs_nav_stat_item(nav, item);
+            if (nav->sort_mode == FS_NAV_SORT_CAPTURED && !item->is_dir) {
+                item->captured = 0;
+                if (nav->capture_time_cb) {
+                    nav->capture_time_cb(nav->current, item, &item->captured);
+                }
+            }
+        }
+    }
     s_cmp_mode = nav->sort_mode;
     s_cmp_ascending = nav->ascending;
     qsort(nav->items, nav->item_count, sizeof(fs_nav_item_t), fs_nav_item_compare);
@@ -850,6 +1806,16 @@ static int fs_nav_item_compare(const void *lhs, const void *rhs)
                 cmp = (a->modified < b->modified) ? -1 : 1;
             }
             break;
+        case FS_NAV_SORT_CAPTURED: {
+            time_t ka = a->captured ? a->captured : a->modified;
+            time_t kb = b->captured ? b->captured : b->modified;
+            if (ka == kb) {
+                cmp = 0;
+            } else {
+                cmp = (ka < kb) ? -1 : 1;
+            }
+            break;
+        }
         case FS_NAV_SORT_SIZE:
             if (a->size_bytes == b->size_bytes) {
                 cmp = 0;
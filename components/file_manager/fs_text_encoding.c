@@ -0,0 +1,254 @@
+#include "fs_text_encoding.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "fs_text_ops.h"
+#include "mem_plan.h"
+
+#define FS_TEXT_REPLACEMENT_CHAR 0xFFFDu
+
+/* Windows-1252 code points for 0x80-0x9F; the five unassigned bytes keep their C1 value */
+static const uint16_t s_cp1252_high[32] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178,
+};
+
+/**
+ * @brief Whether @p buf is well-formed UTF-8, ignoring a sequence cut by the end of the sample.
+ */
+static bool fs_text_is_utf8(const uint8_t *buf, size_t len);
+
+/**
+ * @brief Append @p cp to @p out as UTF-8.
+ *
+ * @return Bytes written (1 to 4).
+ */
+static size_t fs_text_put_utf8(char *out, uint32_t cp);
+
+/**
+ * @brief Record map marks for every stride boundary up to source offset @p src_pos.
+ */
+static void fs_text_map_advance(fs_text_map_t *map, size_t *next_mark, size_t stride, size_t src_pos, size_t utf8_pos);
+
+fs_text_encoding_t fs_text_detect_encoding(const char *buf, size_t len)
+{
+    const uint8_t *b = (const uint8_t *)buf;
+    if (!b || len == 0) {
+        return FS_TEXT_ENC_UTF8;
+    }
+    if (len >= 3 && b[0] == 0xEF && b[1] == 0xBB && b[2] == 0xBF) {
+        return FS_TEXT_ENC_UTF8;
+    }
+    if (len >= 2 && b[0] == 0xFF && b[1] == 0xFE) {
+        return FS_TEXT_ENC_UTF16LE;
+    }
+    if (len >= 2 && b[0] == 0xFE && b[1] == 0xFF) {
+        return FS_TEXT_ENC_UTF16BE;
+    }
+
+    /* Mostly-Latin text in UTF-16 has a zero in one byte of nearly every unit */
+    size_t pairs = len / 2;
+    if (pairs >= 4) {
+        size_t zero_even = 0;
+        size_t zero_odd = 0;
+        for (size_t i = 0; i < pairs; i++) {
+            zero_even += (b[2 * i] == 0);
+            zero_odd += (b[2 * i + 1] == 0);
+        }
+        if (zero_odd >= pairs / 4 && zero_even <= pairs / 16) {
+            return FS_TEXT_ENC_UTF16LE;
+        }
+        if (zero_even >= pairs / 4 && zero_odd <= pairs / 16) {
+            return FS_TEXT_ENC_UTF16BE;
+        }
+    }
+
+    return fs_text_is_utf8(b, len) ? FS_TEXT_ENC_UTF8 : FS_TEXT_ENC_LATIN1;
+}
+
+const char *fs_text_encoding_name(fs_text_encoding_t enc)
+{
+    switch (enc) {
+    case FS_TEXT_ENC_UTF8:
+        return "UTF-8";
+    case FS_TEXT_ENC_UTF16LE:
+        return "UTF-16LE";
+    case FS_TEXT_ENC_UTF16BE:
+        return "UTF-16BE";
+    case FS_TEXT_ENC_LATIN1:
+        return "Latin-1";
+    default:
+        return "?";
+    }
+}
+
+bool fs_text_encoding_needs_transcode(fs_text_encoding_t enc)
+{
+    return enc == FS_TEXT_ENC_UTF16LE || enc == FS_TEXT_ENC_UTF16BE || enc == FS_TEXT_ENC_LATIN1;
+}
+
+esp_err_t fs_text_to_utf8(fs_text_encoding_t enc, const char *src, size_t len, bool file_start,
+                          size_t mark_stride, char **out, size_t *out_len, fs_text_map_t *map)
+{
+    if (!out || (!src && len > 0) || !fs_text_encoding_needs_transcode(enc)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const uint8_t *s = (const uint8_t *)src;
+    const bool utf16 = (enc != FS_TEXT_ENC_LATIN1);
+    /* Worst case: three UTF-8 bytes per Latin-1 byte or per UTF-16 unit */
+    size_t cap = (utf16 ? (len / 2) : len) * 3 + 1;
+    char *dst = (char *)mem_plan_alloc(MEM_PLAN_FILE_IO, cap);
+    if (!dst) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    fs_text_map_t scratch;
+    if (!map) {
+        map = &scratch;
+    }
+    memset(map, 0, sizeof(*map));
+    size_t next_mark = 0;
+
+    size_t i = 0;
+    size_t o = 0;
+    if (file_start && utf16 && len >= 2 &&
+        ((enc == FS_TEXT_ENC_UTF16LE && s[0] == 0xFF && s[1] == 0xFE) ||
+         (enc == FS_TEXT_ENC_UTF16BE && s[0] == 0xFE && s[1] == 0xFF))) {
+        i = 2;
+    }
+
+    if (!utf16) {
+        for (; i < len; i++) {
+            fs_text_map_advance(map, &next_mark, mark_stride, i, o);
+            uint8_t c = s[i];
+            if (c == 0) {
+                continue;
+            }
+            uint32_t cp = (c >= 0x80 && c < 0xA0) ? s_cp1252_high[c - 0x80] : c;
+            o += fs_text_put_utf8(dst + o, cp);
+        }
+    } else {
+        const bool le = (enc == FS_TEXT_ENC_UTF16LE);
+        while (i + 1 < len) {
+            fs_text_map_advance(map, &next_mark, mark_stride, i, o);
+            uint32_t unit = le ? (uint32_t)(s[i] | (s[i + 1] << 8)) : (uint32_t)((s[i] << 8) | s[i + 1]);
+            size_t used = 2;
+            uint32_t cp = unit;
+            if (unit >= 0xD800 && unit <= 0xDBFF) {
+                if (i + 3 >= len) {
+                    break; /* pair cut by the end of the window */
+                }
+                uint32_t low = le ? (uint32_t)(s[i + 2] | (s[i + 3] << 8)) : (uint32_t)((s[i + 2] << 8) | s[i + 3]);
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000u + ((unit - 0xD800u) << 10) + (low - 0xDC00u);
+                    used = 4;
+                } else {
+                    cp = FS_TEXT_REPLACEMENT_CHAR;
+                }
+            } else if (unit >= 0xDC00 && unit <= 0xDFFF) {
+                /* At the window start this is the tail of a pair shown in the previous window */
+                cp = (i == 0) ? 0 : FS_TEXT_REPLACEMENT_CHAR;
+            }
+            if (cp != 0) {
+                o += fs_text_put_utf8(dst + o, cp);
+            }
+            i += used;
+        }
+    }
+
+    fs_text_map_advance(map, &next_mark, mark_stride, len, o);
+    if (map->count < FS_TEXT_MAP_MAX_MARKS && (map->count == 0 || map->src[map->count - 1] != len)) {
+        map->src[map->count] = len;
+        map->utf8[map->count] = o;
+        map->count++;
+    }
+
+    dst[o] = '\0';
+    *out = dst;
+    if (out_len) {
+        *out_len = o;
+    }
+    return ESP_OK;
+}
+
+size_t fs_text_map_to_utf8(const fs_text_map_t *map, size_t src_off)
+{
+    size_t pos = 0;
+    if (!map) {
+        return 0;
+    }
+    for (size_t i = 0; i < map->count && map->src[i] <= src_off; i++) {
+        pos = map->utf8[i];
+    }
+    return pos;
+}
+
+static bool fs_text_is_utf8(const uint8_t *buf, size_t len)
+{
+    size_t i = 0;
+    while (i < len) {
+        uint8_t c = buf[i];
+        size_t extra;
+        if (c < 0x80) {
+            i++;
+            continue;
+        } else if (c >= 0xC2 && c <= 0xDF) {
+            extra = 1;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            extra = 2;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            extra = 3;
+        } else {
+            return false;
+        }
+        for (size_t k = 1; k <= extra; k++) {
+            if (i + k >= len) {
+                return true; /* cut by the end of the sample */
+            }
+            if ((buf[i + k] & 0xC0) != 0x80) {
+                return false;
+            }
+        }
+        i += extra + 1;
+    }
+    return true;
+}
+
+static size_t fs_text_put_utf8(char *out, uint32_t cp)
+{
+    uint8_t *o = (uint8_t *)out;
+    if (cp < 0x80) {
+        o[0] = (uint8_t)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        o[0] = (uint8_t)(0xC0 | (cp >> 6));
+        o[1] = (uint8_t)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        o[0] = (uint8_t)(0xE0 | (cp >> 12));
+        o[1] = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+        o[2] = (uint8_t)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    o[0] = (uint8_t)(0xF0 | (cp >> 18));
+    o[1] = (uint8_t)(0x80 | ((cp >> 12) & 0x3F));
+    o[2] = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+    o[3] = (uint8_t)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+static void fs_text_map_advance(fs_text_map_t *map, size_t *next_mark, size_t stride, size_t src_pos, size_t utf8_pos)
+{
+    while (*next_mark <= src_pos && *next_mark != SIZE_MAX && map->count < FS_TEXT_MAP_MAX_MARKS) {
+        map->src[map->count] = *next_mark;
+        map->utf8[map->count] = utf8_pos;
+        map->count++;
+        *next_mark = stride ? *next_mark + stride : SIZE_MAX;
+    }
+}
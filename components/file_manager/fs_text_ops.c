@@ -8,6 +8,10 @@
 #include <sys/stat.h>
 
 #include "esp_log.h"
+#include "mem_plan.h"
+#include "sd_file.h"
+#include "sd_io.h"
+#include "sd_journal.h"
 
 static const char *TAG = "fs_text";
 
@@ -80,6 +84,7 @@ esp_err_t fs_text_create(const char *path)
         return ESP_FAIL;
     }
     fclose(f);
+    sd_journal_publish(SD_JOURNAL_CREATED, path, NULL, false);
     return ESP_OK;
 }
 
@@ -95,21 +100,18 @@ esp_err_t fs_text_read_range(const char *path, size_t offset_kb, char **out_buf,
         return ESP_FAIL;
     }
 
-    if (offset_kb > SIZE_MAX / 1024) {
-        return ESP_ERR_INVALID_ARG; 
-    }
-    size_t offset_bytes = offset_kb * 1024u;
+    uint64_t offset_bytes = (uint64_t)offset_kb * 1024u;
 
-    size_t file_size = (size_t)st.st_size;
-    size_t file_size_kb = file_size / 1024;
+    uint64_t file_size = sd_file_size(path, &st);
+    uint64_t file_size_kb = file_size / 1024;
     if (offset_bytes >= file_size) {
         offset_bytes = file_size_kb * 1024;
     }
 
-    size_t max_available = file_size - offset_bytes;
+    uint64_t max_available = file_size - offset_bytes;
     size_t to_read = READ_CHUNK_SIZE_B;
     if (to_read > max_available) {
-        to_read = max_available; 
+        to_read = (size_t)max_available; 
     }
 
 #ifdef FS_TEXT_MAX_BYTES
@@ -125,22 +127,24 @@ esp_err_t fs_text_read_range(const char *path, size_t offset_kb, char **out_buf,
         return ESP_FAIL;
     }
 
-    if (fseek(f, (long)offset_bytes, SEEK_SET) != 0) {
-        ESP_LOGE(TAG, "fseek(%s, %zu) failed (errno=%d)", path, offset_bytes, errno);
+    esp_err_t seek_err = sd_file_seek(f, offset_bytes);
+    if (seek_err != ESP_OK) {
+        ESP_LOGE(TAG, "fseek(%s, %llu) failed (%s, errno=%d)", path, (unsigned long long)offset_bytes,
+                 esp_err_to_name(seek_err), errno);
         fclose(f);
-        return ESP_FAIL;
+        return (seek_err == ESP_ERR_INVALID_SIZE) ? seek_err : ESP_FAIL;
     }
 
-    char *buf = (char *)malloc(to_read + 1);
+    char *buf = (char *)mem_plan_alloc(MEM_PLAN_FILE_IO, to_read + 1);
     if (!buf) {
         fclose(f);
         return ESP_ERR_NO_MEM;
     }
 
-    size_t read = fread(buf, 1, to_read, f);
+    size_t read = sd_io_read(buf, to_read, f, SD_IO_INTERACTIVE);
     if (read == 0 && ferror(f)) {
         ESP_LOGE(TAG, "fread(%s) failed (errno=%d)", path, errno);
-        free(buf);
+        fs_text_release(buf);
         fclose(f);
         return ESP_FAIL;
     }
@@ -155,6 +159,11 @@ esp_err_t fs_text_read_range(const char *path, size_t offset_kb, char **out_buf,
     return ESP_OK;
 }
 
+void fs_text_release(char *buf)
+{
+    mem_plan_free(MEM_PLAN_FILE_IO, buf);
+}
+
 esp_err_t fs_text_write(const char *path, const char *data, size_t len)
 {
     if (!fs_text_check_path(path) || (!data && len > 0)) {
@@ -163,7 +172,13 @@ esp_err_t fs_text_write(const char *path, const char *data, size_t len)
     if (!data) {
         len = 0;
     }
-    return fs_text_write_atomic(path, data, len);
+    struct stat st;
+    bool existed = stat(path, &st) == 0;
+    esp_err_t err = fs_text_write_atomic(path, data, len);
+    if (err == ESP_OK) {
+        sd_journal_publish(existed ? SD_JOURNAL_MODIFIED : SD_JOURNAL_CREATED, path, NULL, false);
+    }
+    return err;
 }
 
 esp_err_t fs_text_append(const char *path, const char *data, size_t len)
@@ -182,14 +197,17 @@ esp_err_t fs_text_append(const char *path, const char *data, size_t len)
         }
     }
 
-    size_t written = fwrite(data, 1, len, f);
+    size_t written = sd_io_write(data, len, f, SD_IO_INTERACTIVE);
     if (written != len) {
         ESP_LOGE(TAG, "append fwrite(%s) failed (errno=%d)", path, errno);
         fclose(f);
+        sd_journal_publish(SD_JOURNAL_MODIFIED, path, NULL, false);
         return ESP_FAIL;
     }
     fflush(f);
     fclose(f);
+    /* "ab" also creates; the listing of the parent is dropped either way */
+    sd_journal_publish(SD_JOURNAL_MODIFIED, path, NULL, false);
     return ESP_OK;
 }
 
@@ -202,6 +220,7 @@ esp_err_t fs_text_delete(const char *path)
         ESP_LOGE(TAG, "remove(%s) failed (errno=%d)", path, errno);
         return ESP_FAIL;
     }
+    sd_journal_publish(SD_JOURNAL_DELETED, path, NULL, false);
     return ESP_OK;
 }
 
@@ -237,7 +256,7 @@ static esp_err_t fs_text_write_atomic(const char *path, const char *data, size_t
         return ESP_FAIL;
     }
 
-    size_t written = fwrite(data, 1, len, f);
+    size_t written = sd_io_write(data, len, f, SD_IO_INTERACTIVE);
     if (written != len) {
         ESP_LOGE(TAG, "fwrite(%s) failed (errno=%d)", tmp_path, errno);
         fclose(f);
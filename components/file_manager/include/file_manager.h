@@ -29,6 +29,23 @@ typedef struct {
  */
 esp_err_t file_manager_start(void);
 
+/**
+ * @brief Absolute path of the folder the browser shows.
+ *
+ * @return Path, or NULL before the browser is started.
+ */
+const char *file_manager_current_path(void);
+
+/**
+ * @brief Show the folder at absolute @p path (below the SD mount point).
+ *
+ * Takes the display lock itself.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE before file_manager_start(), ESP_ERR_TIMEOUT
+ *         if the display lock is unavailable, or errors from @c fs_nav_go_to_path.
+ */
+esp_err_t file_manager_open_path(const char *path);
+
 /**
  * @brief Reset the header clock display to default (show button, hide label).
  */
@@ -0,0 +1,84 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "esp_err.h"
+
+typedef struct {
+    time_t captured;        /* DateTimeOriginal (or DateTime), camera wall clock read as UTC; 0 if absent */
+    uint16_t width;         /* Pixel size as displayed (orientation applied); 0 if unknown */
+    uint16_t height;
+    uint8_t orientation;    /* EXIF orientation 1..8; 0 if absent */
+} fs_exif_info_t;
+
+/**
+ * @brief Extraction progress callback.
+ *
+ * Called from the extractor task (not the LVGL task) after a batch of new
+ * entries for @p dir has been cached, and once more with @p done set when the
+ * scan of @p dir finished and changed the cache. Take the display lock before
+ * touching LVGL.
+ *
+ * @param dir      Directory being scanned.
+ * @param done     true for the final call of a scan.
+ * @param user_ctx Context passed to fs_exif_init().
+ */
+typedef void (*fs_exif_update_cb_t)(const char *dir, bool done, void *user_ctx);
+
+/**
+ * @brief Create the metadata cache and start the background extractor task.
+ *
+ * @param on_update Optional progress callback.
+ * @param user_ctx  Passed to @p on_update.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if already started, or ESP_ERR_NO_MEM.
+ */
+esp_err_t fs_exif_init(fs_exif_update_cb_t on_update, void *user_ctx);
+
+/**
+ * @brief Ask the extractor to bring the cache for @p dir up to date.
+ *
+ * Returns immediately. A scan of another directory still in progress is
+ * abandoned. The scan stats every JPEG in @p dir (not recursive) and reads the
+ * APP1 header only of files whose size or mtime differ from the cached entry.
+ * A directory with no card journal event since its last complete scan is not
+ * read at all.
+ *
+ * @param dir Absolute directory path.
+ */
+void fs_exif_request_dir(const char *dir);
+
+/**
+ * @brief Look up cached metadata without touching the card.
+ *
+ * @param dir   Directory holding the file.
+ * @param name  File name.
+ * @param size  Current file size; a mismatch means the entry is stale.
+ * @param mtime Current modification time; a mismatch means the entry is stale.
+ * @param[out] out Metadata.
+ * @return true if a fresh entry exists (fields may still be 0 if the file had no EXIF).
+ */
+bool fs_exif_lookup(const char *dir, const char *name, uint64_t size, time_t mtime, fs_exif_info_t *out);
+
+/**
+ * @brief Read capture time, orientation and pixel size from one JPEG.
+ *
+ * Reads the APP1 EXIF block (first 4 KB at most) and the marker headers up to
+ * the frame header; scan data is never read.
+ *
+ * @param path Absolute file path.
+ * @param[out] out Metadata; zeroed fields where the file has none.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NOT_SUPPORTED if the file is not
+ *         a JPEG, ESP_ERR_NO_MEM, or ESP_FAIL on I/O errors.
+ */
+esp_err_t fs_exif_read(const char *path, fs_exif_info_t *out);
+
+#ifdef __cplusplus
+}
+#endif
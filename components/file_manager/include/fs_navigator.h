@@ -6,17 +6,24 @@ extern "C" {
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 
 #include "esp_err.h"
+#include "sd_journal.h"
 
 #define FS_NAV_MAX_PATH 256
 #define FS_NAV_MAX_NAME 96
+#define FS_NAV_MAX_BOOKMARKS 8
+#define FS_NAV_BOOKMARK_CACHE_ITEMS 128    /* items kept across all cached bookmark listings */
+#define FS_NAV_MAX_GROUPS 16    /* unsorted listings: folders, up to 14 extensions, everything else */
+#define FS_NAV_EXT_LEN 8        /* longest extension grouped on its own, plus NUL */
 
 typedef enum {
     FS_NAV_SORT_NAME = 0,
     FS_NAV_SORT_DATE = 1,
     FS_NAV_SORT_SIZE = 2,
+    FS_NAV_SORT_CAPTURED = 3,   /* Photo capture time where known, otherwise mtime */
     FS_NAV_SORT_COUNT
 } fs_nav_sort_mode_t;
 
@@ -24,10 +31,29 @@ typedef struct {
     char *name;
     bool is_dir;
     bool needs_stat;
-    size_t size_bytes;
+    uint64_t size_bytes;
     time_t modified;
+    time_t captured;    /* filled by the capture time callback before a Captured sort, 0 if unknown */
 } fs_nav_item_t;
 
+/**
+ * @brief Provide the capture time of a file for @c FS_NAV_SORT_CAPTURED.
+ *
+ * Called from the sorting task for every file, so it must not block on I/O.
+ *
+ * @param dir  Directory holding the item.
+ * @param item Item with size and mtime populated.
+ * @param[out] captured Capture time.
+ * @return true if @p captured was set.
+ */
+typedef bool (*fs_nav_capture_time_cb_t)(const char *dir, const fs_nav_item_t *item, time_t *captured);
+
+typedef struct {
+    char relative[FS_NAV_MAX_PATH];     /* bookmarked folder, relative to root ('' = root) */
+    fs_nav_item_t *items;               /* listing kept from the last visit, NULL if none */
+    size_t item_count;
+} fs_nav_bookmark_t;
+
 typedef struct fs_nav {
     char root[FS_NAV_MAX_PATH];
     char current[FS_NAV_MAX_PATH];
@@ -42,18 +68,42 @@ typedef struct fs_nav {
     fs_nav_sort_mode_t sort_mode;
     bool ascending;
     bool sort_enabled;
+    fs_nav_capture_time_cb_t capture_time_cb;
+    /*
+     * Unsorted listings are served folders first, then files (grouped by extension
+     * when group_by_ext is set), each group in directory order. The counting pass
+     * fills the group layout; windows are then read in one pass without holding
+     * anything but the window.
+     */
+    bool group_by_ext;
+    uint8_t ext_count;                          /* extensions seen by the counting pass */
+    char ext[FS_NAV_MAX_GROUPS - 2][FS_NAV_EXT_LEN];
+    size_t group_start[FS_NAV_MAX_GROUPS];      /* first listing index of each group */
+    size_t group_size[FS_NAV_MAX_GROUPS];
+    /*
+     * With top_k, unsorted windows are instead selected in the current sort order:
+     * one pass over the directory per window keeps only the best window_size
+     * entries, and the loaded window's first/last item is the cursor for the next.
+     */
+    bool top_k;
+    bool top_k_valid;                           /* items hold a top-K window in the current order */
+    fs_nav_bookmark_t bookmarks[FS_NAV_MAX_BOOKMARKS];
+    size_t bookmark_count;
 } fs_nav_t;
 
 typedef struct {
     const char *root_path;
     size_t max_items;
+    fs_nav_capture_time_cb_t capture_time_cb;  /* optional; without it Captured sorts by mtime */
+    bool group_by_ext;                          /* unsorted listings: group files by extension */
+    bool top_k;                                 /* unsorted listings: select windows in sort order */
 } fs_nav_config_t;
 
 /**
  * @brief Initialize a navigator rooted at @p cfg->root_path and load persisted state if present.
  *
  * Trims trailing slashes, validates root is an absolute directory, restores last relative path,
- * sort mode and direction from NVS (best effort), then performs an initial directory scan.
+ * sort mode, direction and bookmarks from NVS (best effort), then performs an initial directory scan.
  *
  * @param[out] nav Navigator instance to initialize.
  * @param[in]  cfg Configuration (root path and item cap).
@@ -66,7 +116,7 @@ typedef struct {
 esp_err_t fs_nav_init(fs_nav_t *nav, const fs_nav_config_t *cfg);
 
 /**
- * @brief Release resources held by the navigator (directory items).
+ * @brief Release resources held by the navigator (directory items and cached bookmark listings).
  *
  * @param[in,out] nav Navigator to deinitialize (safe to pass NULL).
  */
@@ -78,6 +128,7 @@ void fs_nav_deinit(fs_nav_t *nav);
  * Computes @c total_items. If @c total_items <= @c max_items (or @c max_items==0),
  * sorting stays enabled and all items are loaded/sorted. Otherwise, sorting is disabled and
  * only the first window is loaded; additional windows must be fetched via @c fs_nav_set_window().
+ * Unsorted listings still put folders first, then files in directory order.
  *
  * @param[in,out] nav Navigator.
  * @return
@@ -132,7 +183,7 @@ bool fs_nav_can_go_parent(const fs_nav_t *nav);
  * - ESP_OK on success
  * - ESP_ERR_INVALID_ARG for bad args/index
  * - ESP_ERR_INVALID_STATE if selected item is not a directory
- * - Errors from internal path set/refresh/store
+ * - Errors from @c fs_nav_go_to
  */
 esp_err_t fs_nav_enter(fs_nav_t *nav, size_t index);
 
@@ -143,15 +194,149 @@ esp_err_t fs_nav_enter(fs_nav_t *nav, size_t index);
  * @return
  * - ESP_OK on success
  * - ESP_ERR_INVALID_STATE if already at root
- * - Errors from internal path set/refresh/store
+ * - Errors from @c fs_nav_go_to
  */
 esp_err_t fs_nav_go_parent(fs_nav_t *nav);
 
+/**
+ * @brief Jump straight to a directory given relative to root.
+ *
+ * The target is validated once, then either scanned or, for a bookmark with a
+ * cached listing, adopted without touching the directory. The new location is
+ * persisted with a single NVS commit. On failure the previous location and
+ * listing are kept.
+ *
+ * @param[in,out] nav      Navigator.
+ * @param[in]     relative Target path relative to root (NULL or "" for root).
+ * @return
+ * - ESP_OK on success
+ * - ESP_ERR_INVALID_ARG if @p relative is malformed or contains '.'/'..' segments
+ * - ESP_ERR_INVALID_SIZE if the path does not fit
+ * - ESP_ERR_NOT_FOUND if the storage is available but the target is not a directory
+ * - ESP_ERR_INVALID_STATE if the storage root is unavailable
+ * - ESP_FAIL / ESP_ERR_NO_MEM from the scan
+ */
+esp_err_t fs_nav_go_to(fs_nav_t *nav, const char *relative);
+
+/**
+ * @brief Jump to an absolute directory path below the navigator root.
+ *
+ * @param[in,out] nav  Navigator.
+ * @param[in]     path Absolute path; trailing slashes are ignored.
+ * @return ESP_ERR_INVALID_ARG if @p path is outside the root, otherwise as @c fs_nav_go_to.
+ */
+esp_err_t fs_nav_go_to_path(fs_nav_t *nav, const char *path);
+
+/**
+ * @brief Jump to the ancestor that is @p depth levels below root.
+ *
+ * Depth 0 is the root and @c fs_nav_depth() is the current directory, so
+ * every breadcrumb segment maps to one depth.
+ *
+ * @param[in,out] nav   Navigator.
+ * @param[in]     depth Target depth (<= current depth).
+ * @return ESP_ERR_INVALID_ARG if @p depth is deeper than the current directory, otherwise as @c fs_nav_go_to.
+ */
+esp_err_t fs_nav_go_ancestor(fs_nav_t *nav, size_t depth);
+
+/**
+ * @brief Relative path of the ancestor @p depth levels below root.
+ *
+ * @param[in]  nav     Navigator.
+ * @param[in]  depth   Ancestor depth (<= current depth).
+ * @param[out] out     Buffer for the relative path ('' for root).
+ * @param[in]  out_len Size of @p out.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for bad inputs or depth, or ESP_ERR_INVALID_SIZE if @p out is too small.
+ */
+esp_err_t fs_nav_ancestor_path(const fs_nav_t *nav, size_t depth, char *out, size_t out_len);
+
+/**
+ * @brief Number of path segments below root in the current directory (0 at root).
+ */
+size_t fs_nav_depth(const fs_nav_t *nav);
+
+/**
+ * @brief Bookmark a directory and persist the bookmark list.
+ *
+ * @param[in,out] nav      Navigator.
+ * @param[in]     relative Directory relative to root; NULL bookmarks the current directory.
+ * @return
+ * - ESP_OK on success or if already bookmarked
+ * - ESP_ERR_INVALID_ARG if @p relative is malformed
+ * - ESP_ERR_NO_MEM if @c FS_NAV_MAX_BOOKMARKS are already set
+ * - Errors from NVS
+ */
+esp_err_t fs_nav_bookmark_add(fs_nav_t *nav, const char *relative);
+
+/**
+ * @brief Remove a bookmark (and its cached listing) and persist the bookmark list.
+ *
+ * @param[in,out] nav   Navigator.
+ * @param[in]     index Bookmark index.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a bad index, or errors from NVS.
+ */
+esp_err_t fs_nav_bookmark_remove(fs_nav_t *nav, size_t index);
+
+/**
+ * @brief Number of bookmarks.
+ */
+size_t fs_nav_bookmark_count(const fs_nav_t *nav);
+
+/**
+ * @brief Relative path of a bookmark ('' means root), or NULL for a bad index.
+ */
+const char *fs_nav_bookmark_path(const fs_nav_t *nav, size_t index);
+
+/**
+ * @brief Find the bookmark for @p relative.
+ *
+ * @return Bookmark index, or -1 if @p relative is not bookmarked.
+ */
+int fs_nav_bookmark_find(const fs_nav_t *nav, const char *relative);
+
+/**
+ * @brief Whether a bookmark currently holds a cached listing.
+ */
+bool fs_nav_bookmark_is_cached(const fs_nav_t *nav, size_t index);
+
+/**
+ * @brief Open a bookmark, using its cached listing when present.
+ *
+ * @param[in,out] nav   Navigator.
+ * @param[in]     index Bookmark index.
+ * @return ESP_ERR_INVALID_ARG for a bad index, otherwise as @c fs_nav_go_to.
+ */
+esp_err_t fs_nav_open_bookmark(fs_nav_t *nav, size_t index);
+
+/**
+ * @brief Drop cached bookmark listings that may no longer match the card.
+ *
+ * A bookmarked directory keeps the listing it had when it was left. FAT does not
+ * update directory timestamps reliably, so changes published to the card journal
+ * reach these caches through @c fs_nav_apply_change; this is for everything else.
+ *
+ * @param[in,out] nav  Navigator.
+ * @param[in]     path Absolute directory whose contents changed; caches of it and
+ *                     of bookmarks below it are dropped. NULL drops every cache.
+ */
+void fs_nav_invalidate_cache(fs_nav_t *nav, const char *path);
+
+/**
+ * @brief Drop the cached bookmark listings a journal event makes stale.
+ *
+ * Only listings of the directories holding @p event's paths go, plus every listing
+ * below a deleted or renamed directory; @c SD_JOURNAL_RESET drops them all.
+ *
+ * @param[in,out] nav   Navigator.
+ * @param[in]     event Card change.
+ */
+void fs_nav_apply_change(fs_nav_t *nav, const sd_journal_event_t *event);
+
 /**
  * @brief Set sort mode and direction, then sort current items and persist state.
  *
  * @param[in,out] nav       Navigator.
- * @param[in]     mode      Sort mode (Name/Date/Size).
+ * @param[in]     mode      Sort mode (Name/Date/Size/Captured).
  * @param[in]     ascending true for ascending, false for descending.
  * @return
  * - ESP_OK on success
@@ -160,6 +345,18 @@ esp_err_t fs_nav_go_parent(fs_nav_t *nav);
  */
 esp_err_t fs_nav_set_sort(fs_nav_t *nav, fs_nav_sort_mode_t mode, bool ascending);
 
+/**
+ * @brief Sort the loaded items again with the current mode, without persisting anything.
+ *
+ * Used when sort keys that come from outside the directory listing (capture
+ * times) have changed. In @c top_k mode the loaded window is selected again.
+ *
+ * @param[in,out] nav Navigator.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if @p nav is NULL, ESP_ERR_INVALID_STATE when sorting is
+ *         disabled, or errors from @c fs_nav_set_window.
+ */
+esp_err_t fs_nav_resort(fs_nav_t *nav);
+
 /**
  * @brief Get current sort mode.
  * @param[in] nav Navigator.
@@ -175,7 +372,8 @@ fs_nav_sort_mode_t fs_nav_get_sort(const fs_nav_t *nav);
 bool fs_nav_is_sort_ascending(const fs_nav_t *nav);
 
 /**
- * @brief Check if sorting is currently enabled (total_items <= max_items or max_items==0).
+ * @brief Check if listings follow the sort settings: everything is loaded and sorted
+ *        (total_items <= max_items or max_items==0), or windows are selected with @c top_k.
  */
 bool fs_nav_is_sort_enabled(const fs_nav_t *nav);
 
@@ -184,7 +382,13 @@ bool fs_nav_is_sort_enabled(const fs_nav_t *nav);
  *
  * When sorting is enabled (item count <= max_items), only the view window is adjusted.
  * When sorting is disabled (item count > max_items or max_items==0), this will reload
- * just the requested window from the filesystem without holding all items.
+ * just the requested window from the filesystem without holding all items. Offsets then
+ * count folders first, then files (grouped by extension with @c group_by_ext), each in
+ * directory order.
+ *
+ * With @c top_k the window is selected in the current sort order instead, in one
+ * directory pass with O(@p size) memory. Moving to a window that overlaps the loaded
+ * one costs one pass; a jump elsewhere costs one pass per window in between.
  *
  * @param nav   Navigator.
  * @param start Zero-based offset into the directory items.
@@ -0,0 +1,93 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "esp_err.h"
+
+#define FS_TEXT_MAP_MAX_MARKS 4     /* window of two chunks: start, boundary, end, spare */
+
+typedef enum {
+    FS_TEXT_ENC_UNKNOWN = 0,    /* not detected yet */
+    FS_TEXT_ENC_UTF8,           /* also plain ASCII; shown as stored */
+    FS_TEXT_ENC_UTF16LE,
+    FS_TEXT_ENC_UTF16BE,
+    FS_TEXT_ENC_LATIN1,         /* 0x80-0x9F follow Windows-1252, as Windows tools write them */
+} fs_text_encoding_t;
+
+/**
+ * @brief Sparse map from source offsets to offsets in the transcoded UTF-8 text.
+ *
+ * One mark per chunk boundary of the decoded window rather than one per
+ * character, so its size does not depend on the file.
+ */
+typedef struct {
+    size_t count;
+    size_t src[FS_TEXT_MAP_MAX_MARKS];      /* source offset relative to the window start */
+    size_t utf8[FS_TEXT_MAP_MAX_MARKS];     /* offset of the first character at or after it */
+} fs_text_map_t;
+
+/**
+ * @brief Guess the encoding of a file from its first bytes.
+ *
+ * A byte order mark decides on its own. Without one, a sample whose odd (or even)
+ * bytes are mostly zero is taken as UTF-16LE (BE), a sample that is not valid
+ * UTF-8 as Latin-1, and anything else as UTF-8.
+ *
+ * @param buf Bytes from the start of the file.
+ * @param len Number of bytes in @p buf.
+ * @return Detected encoding (UTF-8 for an empty sample).
+ */
+fs_text_encoding_t fs_text_detect_encoding(const char *buf, size_t len);
+
+/**
+ * @brief Short display name of @p enc, e.g. "UTF-16LE".
+ */
+const char *fs_text_encoding_name(fs_text_encoding_t enc);
+
+/**
+ * @brief Whether text in @p enc must be transcoded before it reaches the editor.
+ *
+ * Such text is shown read-only: the editor would save it back as UTF-8.
+ */
+bool fs_text_encoding_needs_transcode(fs_text_encoding_t enc);
+
+/**
+ * @brief Transcode a window of a file to NUL-terminated UTF-8.
+ *
+ * A character cut by either edge of the window is dropped; it shows up whole in
+ * the neighbouring window. A byte order mark is skipped when @p file_start is set.
+ * Unpaired surrogates become U+FFFD and NUL characters are left out.
+ *
+ * @param enc         Source encoding (must need transcoding).
+ * @param src         Source bytes.
+ * @param len         Number of bytes in @p src.
+ * @param file_start  @p src starts at offset 0 of the file.
+ * @param mark_stride Record a map mark every @p mark_stride source bytes (0 = edges only).
+ * @param[out] out     UTF-8 text from the MEM_PLAN_FILE_IO region; free with fs_text_release().
+ * @param[out] out_len Optional; bytes in @p out without the terminator.
+ * @param[out] map     Optional offset map of the window.
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG on bad arguments or an encoding that needs no transcoding
+ *      - ESP_ERR_NO_MEM if the output buffer cannot be allocated
+ */
+esp_err_t fs_text_to_utf8(fs_text_encoding_t enc, const char *src, size_t len, bool file_start,
+                          size_t mark_stride, char **out, size_t *out_len, fs_text_map_t *map);
+
+/**
+ * @brief UTF-8 offset of the last mark at or before source offset @p src_off.
+ *
+ * @param map     Map filled by fs_text_to_utf8().
+ * @param src_off Source offset relative to the window start.
+ * @return Offset into the transcoded text (0 for an empty map).
+ */
+size_t fs_text_map_to_utf8(const fs_text_map_t *map, size_t src_off);
+
+#ifdef __cplusplus
+}
+#endif
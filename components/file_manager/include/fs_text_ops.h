@@ -46,7 +46,8 @@ esp_err_t fs_text_create(const char *path);
  * ensures the offset does not exceed the file size, adjusts the read length
  * when near EOF, and allocates a null-terminated buffer for the output.
  *
- * The caller takes ownership of the allocated buffer and must free it.
+ * The caller takes ownership of the allocated buffer and must release it with
+ * fs_text_release().
  *
  * @param[in]  path        Absolute file path to read from.
  * @param[in]  offset_kb   Offset in kilobytes from the start of the file.
@@ -59,7 +60,8 @@ esp_err_t fs_text_create(const char *path);
  * @return
  *      - ESP_OK                   On success.
  *      - ESP_ERR_INVALID_ARG      If parameters are invalid or the path fails validation.
- *      - ESP_ERR_INVALID_SIZE     If the requested read size exceeds FS_TEXT_MAX_BYTES.
+ *      - ESP_ERR_INVALID_SIZE     If the requested read size exceeds FS_TEXT_MAX_BYTES, or the
+ *                                 offset is beyond what the stream can address (2 GB with a 32-bit off_t).
  *      - ESP_ERR_NO_MEM           If memory allocation fails.
  *      - ESP_FAIL                 If file operations (stat, fopen, fseek, fread) fail.
  *
@@ -71,6 +73,15 @@ esp_err_t fs_text_create(const char *path);
  */
 esp_err_t fs_text_read_range(const char *path, size_t offset_kb, char **out_buf, size_t *out_len);
 
+/**
+ * @brief Release a buffer returned by fs_text_read_range() (NULL is ignored).
+ *
+ * Chunks come from the MEM_PLAN_FILE_IO region, not necessarily from malloc().
+ *
+ * @param buf Buffer to release.
+ */
+void fs_text_release(char *buf);
+
 /**
  * @brief Atomically replace (or create) a text file with the provided buffer.
  *
@@ -0,0 +1,200 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+/**
+ * @brief Create a multi-line text editor widget.
+ *
+ * The widget keeps its text in a gap buffer and caches the wrapped layout per
+ * visual line, so an edit only re-wraps the paragraph it touches and only the
+ * affected lines are invalidated. It is a plain scrollable @c lv_obj drawn by
+ * the module; use the functions below instead of the @c lv_textarea API.
+ *
+ * Emits @c LV_EVENT_VALUE_CHANGED after every text modification.
+ *
+ * @param parent Parent object.
+ * @return The new editor object, or NULL on allocation failure.
+ */
+lv_obj_t *text_editor_create(lv_obj_t *parent);
+
+/**
+ * @brief Replace the whole content and re-layout it.
+ *
+ * The cursor is moved to the beginning and the undo history is cleared.
+ * No change event is sent.
+ *
+ * @param obj  Editor object.
+ * @param text Text to copy (may be NULL when @p len is 0).
+ * @param len  Number of bytes in @p text.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG or ESP_ERR_NO_MEM.
+ */
+esp_err_t text_editor_set_text(lv_obj_t *obj, const char *text, size_t len);
+
+/**
+ * @brief Get the content as a contiguous, NUL-terminated string.
+ *
+ * Closes the gap (O(n)); intended for save paths, not per keystroke.
+ * The pointer stays valid until the next modification.
+ *
+ * @param obj Editor object.
+ * @return Content string (never NULL for a valid editor).
+ */
+const char *text_editor_get_text(lv_obj_t *obj);
+
+/**
+ * @brief Get the content length in bytes.
+ *
+ * @param obj Editor object.
+ * @return Length in bytes.
+ */
+size_t text_editor_get_length(lv_obj_t *obj);
+
+/**
+ * @brief Compare the content with a reference buffer without closing the gap.
+ *
+ * @param obj  Editor object.
+ * @param text Reference text (may be NULL when @p len is 0).
+ * @param len  Length of @p text in bytes.
+ * @return true if the content is byte-identical.
+ */
+bool text_editor_equals(lv_obj_t *obj, const char *text, size_t len);
+
+/**
+ * @brief Replace @p del bytes at @p pos with @p ins_len bytes from @p ins.
+ *
+ * This is the single edit primitive: insertion and deletion are special cases.
+ * The cursor is left after the inserted text.
+ *
+ * @param obj     Editor object.
+ * @param pos     Byte offset of the edit.
+ * @param del     Number of bytes to remove at @p pos.
+ * @param ins     Bytes to insert (may be NULL when @p ins_len is 0).
+ * @param ins_len Number of bytes to insert.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG or ESP_ERR_NO_MEM.
+ */
+esp_err_t text_editor_replace(lv_obj_t *obj, size_t pos, size_t del, const char *ins, size_t ins_len);
+
+/**
+ * @brief Insert text at the cursor.
+ *
+ * @param obj  Editor object.
+ * @param text Null-terminated UTF-8 text.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG or ESP_ERR_NO_MEM.
+ */
+esp_err_t text_editor_insert(lv_obj_t *obj, const char *text);
+
+/**
+ * @brief Delete the character before the cursor (backspace).
+ *
+ * @param obj Editor object.
+ */
+void text_editor_delete_backward(lv_obj_t *obj);
+
+/**
+ * @brief Move the cursor one character left.
+ *
+ * @param obj Editor object.
+ */
+void text_editor_cursor_left(lv_obj_t *obj);
+
+/**
+ * @brief Move the cursor one character right.
+ *
+ * @param obj Editor object.
+ */
+void text_editor_cursor_right(lv_obj_t *obj);
+
+/**
+ * @brief Place the cursor and scroll it into view without animation.
+ *
+ * @param obj Editor object.
+ * @param pos Byte offset (clamped and snapped to a UTF-8 boundary).
+ */
+void text_editor_set_cursor_pos(lv_obj_t *obj, size_t pos);
+
+/**
+ * @brief Get the cursor byte offset.
+ *
+ * @param obj Editor object.
+ * @return Cursor offset in bytes.
+ */
+size_t text_editor_get_cursor_pos(lv_obj_t *obj);
+
+/**
+ * @brief Enable or disable editing (cursor, tap-to-place, keyboard input).
+ *
+ * @param obj      Editor object.
+ * @param editable true to allow editing.
+ */
+void text_editor_set_editable(lv_obj_t *obj, bool editable);
+
+/**
+ * @brief Revert the most recent edit from the in-memory history.
+ *
+ * Consecutive typing or backspacing (up to a short run, until the cursor moves,
+ * a newline is entered or the user pauses) is undone as one step. The history
+ * is a fixed-size ring: the oldest steps are forgotten first.
+ *
+ * @param obj Editor object.
+ * @return true if an edit was undone.
+ */
+bool text_editor_undo(lv_obj_t *obj);
+
+/**
+ * @brief Re-apply the most recently undone edit.
+ *
+ * Any new edit discards the redo steps.
+ *
+ * @param obj Editor object.
+ * @return true if an edit was redone.
+ */
+bool text_editor_redo(lv_obj_t *obj);
+
+/**
+ * @brief Check whether @ref text_editor_undo has anything to revert.
+ *
+ * @param obj Editor object.
+ * @return true if at least one step can be undone.
+ */
+bool text_editor_can_undo(lv_obj_t *obj);
+
+/**
+ * @brief Check whether @ref text_editor_redo has anything to re-apply.
+ *
+ * @param obj Editor object.
+ * @return true if at least one step can be redone.
+ */
+bool text_editor_can_redo(lv_obj_t *obj);
+
+/**
+ * @brief Forget the undo/redo history and release its storage.
+ *
+ * @ref text_editor_set_text does this implicitly.
+ *
+ * @param obj Editor object.
+ */
+void text_editor_clear_history(lv_obj_t *obj);
+
+/**
+ * @brief Route an @c lv_keyboard to the editor.
+ *
+ * @c lv_keyboard only targets @c lv_textarea objects; keys are forwarded to the
+ * editor whenever the keyboard has no textarea assigned, so the same keyboard
+ * can still serve regular textareas (e.g. a filename dialog).
+ *
+ * @param obj      Editor object.
+ * @param keyboard Keyboard object.
+ */
+void text_editor_attach_keyboard(lv_obj_t *obj, lv_obj_t *keyboard);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+#define VIEWER_REGISTRY_MAX_VIEWERS 8
+#define VIEWER_REGISTRY_MAX_EXTS 32     /* extensions across all viewers */
+#define VIEWER_REGISTRY_MAGIC_LEN 8     /* longest signature, read from offset 0 */
+
+/**
+ * @brief What a viewer gets asked to open.
+ */
+typedef struct {
+    const char *path;           /**< Absolute path of the file. */
+    const char *name;           /**< File name as listed. */
+    lv_obj_t *return_screen;    /**< Screen to restore when the viewer closes. */
+    void *user_ctx;             /**< Passed through from viewer_registry_open(). */
+} viewer_open_req_t;
+
+/**
+ * @brief A viewer module, registered once and kept by pointer.
+ *
+ * A viewer builds its screen and buffers in @c open, not at registration, so
+ * registering one costs no RAM until a file of its type is opened.
+ */
+typedef struct {
+    const char *name;
+    const char *const *extensions;  /**< NULL-terminated, lowercase, without the dot; may be NULL. */
+    const uint8_t *magic;           /**< Optional signature at offset 0, for files with an unknown extension. */
+    size_t magic_len;               /**< Up to VIEWER_REGISTRY_MAGIC_LEN. */
+    esp_err_t (*open)(const viewer_open_req_t *req);
+    /**
+     * Optional: free whatever the viewer keeps between opens. Called from the LVGL
+     * task while the viewer is closed, when another viewer is about to open on a
+     * low heap.
+     */
+    void (*release)(void);
+} viewer_desc_t;
+
+/**
+ * @brief Add @p desc to the registry and hash its extensions.
+ *
+ * @param desc Viewer; must outlive the registry.
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if @p desc has no name or open callback, or a signature is too long
+ *      - ESP_ERR_INVALID_STATE if @p desc is already registered
+ *      - ESP_ERR_NO_MEM if the viewer or extension table is full
+ */
+esp_err_t viewer_registry_register(const viewer_desc_t *desc);
+
+/**
+ * @brief Find the viewer for a file.
+ *
+ * The extension of @p name is looked up in the hash table first; only if that
+ * misses are the first bytes of @p path read and matched against the signatures.
+ *
+ * @param path Absolute path (NULL skips the signature check).
+ * @param name File name.
+ * @return Viewer, or NULL if none handles the file.
+ */
+const viewer_desc_t *viewer_registry_find(const char *path, const char *name);
+
+/**
+ * @brief Open @p req with @p viewer, releasing idle viewers first if the heap is low.
+ *
+ * @param viewer Viewer returned by viewer_registry_find().
+ * @param req    Request.
+ * @return ESP_ERR_INVALID_ARG on bad arguments, otherwise the result of the viewer's open.
+ */
+esp_err_t viewer_registry_open(const viewer_desc_t *viewer, const viewer_open_req_t *req);
+
+/**
+ * @brief Call the release hook of every opened viewer except @p keep.
+ *
+ * @param keep Viewer to leave alone (may be NULL).
+ */
+void viewer_registry_release_idle(const viewer_desc_t *keep);
+
+#ifdef __cplusplus
+}
+#endif
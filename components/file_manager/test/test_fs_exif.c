@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fs_exif.h"
+#include "sd_card.h"
+#include "sdkconfig.h"
+#include "unity.h"
+
+#define TEST_JPEG           CONFIG_SDSPI_MOUNT_POINT "/.test_exif.jpg"
+#define TEST_IFD0           8
+#define TEST_DATETIME_AT    50      /* after IFD0: count, three entries, next IFD */
+#define TEST_TIFF_LEN       70
+#define TEST_CAPTURED       1623760200  /* 2021:06:15 12:30:00 */
+
+static void test_put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void test_put_u32(uint8_t *p, uint32_t v)
+{
+    test_put_u16(p, (uint16_t)v);
+    test_put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void test_put_entry(uint8_t *p, uint16_t tag, uint16_t type, uint32_t count, uint32_t value)
+{
+    test_put_u16(p, tag);
+    test_put_u16(p + 2, type);
+    test_put_u32(p + 4, count);
+    if (type == 3) {
+        test_put_u32(p + 8, 0);
+        test_put_u16(p + 8, (uint16_t)value);
+    } else {
+        test_put_u32(p + 8, value);
+    }
+}
+
+/**
+ * @brief Write a JPEG whose little-endian APP1 holds IFD0 with Orientation 6, DateTime and an Exif IFD pointer.
+ *
+ * @param ifd0        Offset of IFD0 written in the TIFF header.
+ * @param datetime_at Offset of the DateTime string written in its entry.
+ * @param exif_ifd    Exif IFD pointer (0: none).
+ */
+static void test_write_jpeg(uint32_t ifd0, uint32_t datetime_at, uint32_t exif_ifd)
+{
+    uint8_t tiff[TEST_TIFF_LEN] = {'I', 'I'};
+    test_put_u16(tiff + 2, 42);
+    test_put_u32(tiff + 4, ifd0);
+    test_put_u16(tiff + TEST_IFD0, 3);
+    test_put_entry(tiff + TEST_IFD0 + 2, 0x0112, 3, 1, 6);
+    test_put_entry(tiff + TEST_IFD0 + 14, 0x0132, 2, 20, datetime_at);
+    test_put_entry(tiff + TEST_IFD0 + 26, 0x8769, 4, 1, exif_ifd);
+    memcpy(tiff + TEST_DATETIME_AT, "2021:06:15 12:30:00", 20);
+
+    FILE *f = fopen(TEST_JPEG, "wb");
+    TEST_ASSERT_NOT_NULL(f);
+    const uint8_t soi_app1[] = {0xFF, 0xD8, 0xFF, 0xE1, 0, 2 + 6 + TEST_TIFF_LEN};
+    const uint8_t eoi[] = {0xFF, 0xD9};
+    fwrite(soi_app1, 1, sizeof(soi_app1), f);
+    fwrite("Exif\0\0", 1, 6, f);
+    fwrite(tiff, 1, sizeof(tiff), f);
+    fwrite(eoi, 1, sizeof(eoi), f);
+    TEST_ASSERT_EQUAL(0, fclose(f));
+}
+
+TEST_CASE("EXIF offsets from the file are bounds-checked without wrapping", "[fs_exif]")
+{
+    TEST_ASSERT_EQUAL(ESP_OK, init_sdspi());
+    fs_exif_info_t info;
+
+    /* Well-formed: proves the crafted layout parses at all */
+    test_write_jpeg(TEST_IFD0, TEST_DATETIME_AT, 0);
+    TEST_ASSERT_EQUAL(ESP_OK, fs_exif_read(TEST_JPEG, &info));
+    TEST_ASSERT_EQUAL(TEST_CAPTURED, info.captured);
+    TEST_ASSERT_EQUAL(6, info.orientation);
+
+    /* IFD0 offset that wraps a 32-bit size_t when 2 is added */
+    test_write_jpeg(0xFFFFFFFFu, TEST_DATETIME_AT, 0);
+    TEST_ASSERT_EQUAL(ESP_OK, fs_exif_read(TEST_JPEG, &info));
+    TEST_ASSERT_EQUAL(0, info.captured);
+    TEST_ASSERT_EQUAL(0, info.orientation);
+
+    /* Exif IFD pointer just as far out; IFD0 is still read */
+    test_write_jpeg(TEST_IFD0, TEST_DATETIME_AT, 0xFFFFFFFEu);
+    TEST_ASSERT_EQUAL(ESP_OK, fs_exif_read(TEST_JPEG, &info));
+    TEST_ASSERT_EQUAL(TEST_CAPTURED, info.captured);
+    TEST_ASSERT_EQUAL(6, info.orientation);
+
+    /* DateTime offset that wraps when the 19 characters are added */
+    test_write_jpeg(TEST_IFD0, 0xFFFFFFF0u, 0);
+    TEST_ASSERT_EQUAL(ESP_OK, fs_exif_read(TEST_JPEG, &info));
+    TEST_ASSERT_EQUAL(0, info.captured);
+    TEST_ASSERT_EQUAL(6, info.orientation);
+
+    /* DateTime string cut off by the end of the block */
+    test_write_jpeg(TEST_IFD0, TEST_TIFF_LEN - 10, 0);
+    TEST_ASSERT_EQUAL(ESP_OK, fs_exif_read(TEST_JPEG, &info));
+    TEST_ASSERT_EQUAL(0, info.captured);
+
+    unlink(TEST_JPEG);
+}
@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "fs_navigator.h"
+#include "nvs_flash.h"
+#include "sd_card.h"
+#include "sdkconfig.h"
+#include "unity.h"
+
+#define TEST_DIR        CONFIG_SDSPI_MOUNT_POINT "/.test_fs_nav"
+#define TEST_FILES      40
+#define TEST_SORT_LIMIT 8       /* far below TEST_FILES, so windows are selected with top-K */
+#define TEST_WINDOW     8
+#define TEST_EPOCH      1600000000
+
+/**
+ * @brief Capture time of test file @p i: a permutation of the indices, so EXIF order differs from mtime order.
+ */
+static time_t test_captured(unsigned i)
+{
+    return TEST_EPOCH + (time_t)((i * 7) % TEST_FILES) * 3600;
+}
+
+/**
+ * @brief Capture time callback standing in for the EXIF cache.
+ */
+static bool test_capture_time_cb(const char *dir, const fs_nav_item_t *item, time_t *captured)
+{
+    unsigned i = 0;
+    (void)dir;
+    if (sscanf(item->name, "IMG_%02u.jpg", &i) != 1) {
+        return false;
+    }
+    *captured = test_captured(i);
+    return true;
+}
+
+/**
+ * @brief Mount the card and create TEST_FILES photos whose mtimes follow their names.
+ */
+static void test_make_dir(void)
+{
+    esp_err_t err = nvs_flash_init();
+    TEST_ASSERT_TRUE(err == ESP_OK || err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND);
+    TEST_ASSERT_EQUAL(ESP_OK, init_sdspi());
+
+    mkdir(TEST_DIR, 0775);
+    char path[64];
+    for (unsigned i = 0; i < TEST_FILES; i++) {
+        snprintf(path, sizeof(path), TEST_DIR "/IMG_%02u.jpg", i);
+        FILE *f = fopen(path, "w");
+        TEST_ASSERT_NOT_NULL(f);
+        fputc(0, f);
+        fclose(f);
+        const struct utimbuf times = { .actime = TEST_EPOCH + i * 60, .modtime = TEST_EPOCH + i * 60 };
+        TEST_ASSERT_EQUAL(0, utime(path, &times));
+    }
+}
+
+static void test_remove_dir(void)
+{
+    char path[64];
+    for (unsigned i = 0; i < TEST_FILES; i++) {
+        snprintf(path, sizeof(path), TEST_DIR "/IMG_%02u.jpg", i);
+        unlink(path);
+    }
+    rmdir(TEST_DIR);
+}
+
+/**
+ * @brief Load the window at @p start and check it is exactly that slice of @p expected.
+ */
+static void test_check_window(fs_nav_t *nav, const unsigned *expected, size_t start)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, fs_nav_set_window(nav, start, TEST_WINDOW));
+    TEST_ASSERT_EQUAL(start, fs_nav_window_start(nav));
+
+    size_t count = 0;
+    const fs_nav_item_t *items = fs_nav_items(nav, &count);
+    size_t want = (TEST_FILES - start < TEST_WINDOW) ? (TEST_FILES - start) : TEST_WINDOW;
+    TEST_ASSERT_EQUAL(want, count);
+    for (size_t i = 0; i < count; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "IMG_%02u.jpg", expected[start + i]);
+        TEST_ASSERT_EQUAL_STRING(name, items[i].name);
+    }
+}
+
+TEST_CASE("top-K windows in Captured order join without gaps or duplicates", "[fs_nav]")
+{
+    test_make_dir();
+
+    /* Expected listing: file indices by ascending capture time */
+    unsigned expected[TEST_FILES];
+    for (unsigned i = 0; i < TEST_FILES; i++) {
+        expected[(i * 7) % TEST_FILES] = i;
+    }
+
+    fs_nav_t nav;
+    const fs_nav_config_t cfg = {
+        .root_path = TEST_DIR,
+        .max_items = TEST_SORT_LIMIT,
+        .capture_time_cb = test_capture_time_cb,
+        .top_k = true,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, fs_nav_init(&nav, &cfg));
+    TEST_ASSERT_EQUAL(ESP_OK, fs_nav_go_to(&nav, ""));
+    TEST_ASSERT_EQUAL(TEST_FILES, fs_nav_total_items(&nav));
+    TEST_ASSERT_EQUAL(ESP_OK, fs_nav_set_sort(&nav, FS_NAV_SORT_CAPTURED, true));
+
+    /* Forward in overlapping steps: the cursor is the last loaded item */
+    int start = 0;
+    for (; start < TEST_FILES; start += 5) {
+        test_check_window(&nav, expected, start);
+    }
+    /* Back in overlapping steps from the last window: the cursor is the first loaded item */
+    for (start -= 10; start >= 0; start -= 5) {
+        test_check_window(&nav, expected, start);
+    }
+    /* Adjacent windows, then a jump past the loaded one and a fresh selection from the top */
+    test_check_window(&nav, expected, TEST_WINDOW);
+    test_check_window(&nav, expected, 2 * TEST_WINDOW);
+    test_check_window(&nav, expected, 4 * TEST_WINDOW);
+    TEST_ASSERT_EQUAL(ESP_OK, fs_nav_set_sort(&nav, FS_NAV_SORT_CAPTURED, true));
+    test_check_window(&nav, expected, 3 * TEST_WINDOW + 3);
+
+    fs_nav_deinit(&nav);
+    test_remove_dir();
+}
@@ -0,0 +1,1348 @@
+#include "text_editor.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+
+#define TEXT_EDITOR_GAP_MIN_B      256 /* Minimum text gap added when the buffer grows */
+#define TEXT_EDITOR_LINE_GAP_MIN   32  /* Minimum line slots added when the line cache grows */
+#define TEXT_EDITOR_CURSOR_W       2   /* Cursor bar width in pixels */
+
+#define TEXT_EDITOR_UNDO_BYTES     4096 /* Ring storage for removed/inserted bytes */
+#define TEXT_EDITOR_UNDO_RECORDS   128  /* Maximum number of undo steps kept */
+#define TEXT_EDITOR_UNDO_RUN_MAX_B 64   /* Longest typing/backspace run merged into one step */
+#define TEXT_EDITOR_UNDO_IDLE_MS   1000 /* Pause that starts a new undo step */
+
+/**
+ * @brief One undoable edit: @c del_len bytes at @c pos were replaced by @c ins_len bytes.
+ *
+ * The removed bytes followed by the inserted bytes are stored in the history byte
+ * ring starting at @c data.
+ */
+typedef struct
+{
+    uint32_t pos;              /**< Byte offset of the edit */
+    uint16_t del_len;          /**< Bytes removed by the edit */
+    uint16_t ins_len;          /**< Bytes inserted by the edit */
+    size_t data;               /**< Monotonic byte-ring offset of the record payload */
+} text_editor_undo_rec_t;
+
+/**
+ * @brief Bounded undo/redo history (fixed-size rings, allocated on first edit).
+ *
+ * All counters are monotonic; ring slots are taken modulo the ring size.
+ * Records [rec_tail, rec_cursor) can be undone, [rec_cursor, rec_head) redone.
+ */
+typedef struct
+{
+    char bytes[TEXT_EDITOR_UNDO_BYTES];                   /**< Payload ring */
+    text_editor_undo_rec_t recs[TEXT_EDITOR_UNDO_RECORDS]; /**< Record ring */
+    size_t byte_tail;                                     /**< Oldest payload byte kept */
+    size_t byte_head;                                     /**< Next payload byte to write */
+    size_t rec_tail;                                      /**< Oldest record kept */
+    size_t rec_cursor;                                    /**< Next record to redo */
+    size_t rec_head;                                      /**< Next record slot to write */
+    uint32_t last_tick;                                   /**< Time of the last recorded edit */
+    bool sealed;                                          /**< Next edit must start a new record */
+} text_editor_undo_t;
+
+/**
+ * @brief Editor state attached to the LVGL object as user data.
+ *
+ * Text is a gap buffer: bytes [0, gap_start) and [gap_end, cap) hold the content.
+ *
+ * The layout cache is a gap array of visual line starts. Slots before
+ * @c line_gap_start store absolute byte offsets; slots after @c line_gap_end store
+ * the distance from the end of the text. An edit inside the gap therefore leaves
+ * every following entry valid, and only the edited paragraph is re-wrapped.
+ */
+typedef struct
+{
+    char *buf;                 /**< Gap buffer storage */
+    size_t cap;                /**< Allocated bytes in @c buf */
+    size_t gap_start;          /**< First byte of the gap */
+    size_t gap_end;            /**< First byte after the gap */
+    uint32_t *lines;           /**< Visual line starts (see struct description) */
+    size_t line_cap;           /**< Allocated slots in @c lines */
+    size_t line_gap_start;     /**< First free slot of the line gap */
+    size_t line_gap_end;       /**< First used slot after the line gap */
+    size_t cursor;             /**< Cursor byte offset */
+    int32_t wrap_width;        /**< Wrap width used by the cached layout (<=0: no wrapping) */
+    int32_t line_height;       /**< Font line height plus line spacing */
+    int32_t letter_space;      /**< Extra space between characters */
+    const lv_font_t *font;     /**< Font used by the cached layout */
+    bool editable;             /**< Cursor visible and input accepted */
+    char *scratch;             /**< Copy of a line that straddles the gap while drawing */
+    size_t scratch_cap;        /**< Allocated bytes in @c scratch */
+    text_editor_undo_t *undo;  /**< Edit history, NULL until the first edit */
+} text_editor_t;
+
+static const char *TAG = "text_editor";
+
+/************************************** Gap buffer *************************************/
+
+/**
+ * @brief Get the editor state of an object.
+ *
+ * @param obj Editor object (may be NULL).
+ * @return State pointer or NULL.
+ */
+static text_editor_t *text_editor_get(lv_obj_t *obj);
+
+/**
+ * @brief Current content length in bytes.
+ */
+static size_t text_editor_len(const text_editor_t *te);
+
+/**
+ * @brief Read the byte at logical offset @p i (must be < length).
+ */
+static uint8_t text_editor_byte(const text_editor_t *te, size_t i);
+
+/**
+ * @brief Move the gap so that it starts at logical offset @p pos.
+ *
+ * Costs O(distance), which is zero while typing at the same spot.
+ */
+static void text_editor_move_gap(text_editor_t *te, size_t pos);
+
+/**
+ * @brief Grow the buffer so the gap can take @p need bytes plus a NUL.
+ *
+ * @return ESP_OK or ESP_ERR_NO_MEM.
+ */
+static esp_err_t text_editor_reserve(text_editor_t *te, size_t need);
+
+/**
+ * @brief Decode one UTF-8 code point at @p i without reading past @p end.
+ *
+ * Malformed sequences decode as a single byte so the caller always advances.
+ *
+ * @param[out] cp Decoded code point.
+ * @return Number of bytes consumed (>=1).
+ */
+static size_t text_editor_decode(const text_editor_t *te, size_t i, size_t end, uint32_t *cp);
+
+/**
+ * @brief Snap @p pos back to the start of the UTF-8 sequence containing it.
+ */
+static size_t text_editor_snap(const text_editor_t *te, size_t pos);
+
+/*********************************************************************************************/
+
+/************************************** Layout cache *************************************/
+
+/**
+ * @brief Number of cached visual lines.
+ */
+static size_t text_editor_line_count(const text_editor_t *te);
+
+/**
+ * @brief Absolute byte offset of visual line @p i.
+ */
+static size_t text_editor_line_start(const text_editor_t *te, size_t i);
+
+/**
+ * @brief End offset of visual line @p i (start of the next line or text end).
+ */
+static size_t text_editor_line_end(const text_editor_t *te, size_t i);
+
+/**
+ * @brief Index of the visual line containing byte @p pos (binary search).
+ */
+static size_t text_editor_find_line(const text_editor_t *te, size_t pos);
+
+/**
+ * @brief Move the line gap to slot @p index, converting entries it passes over.
+ */
+static void text_editor_line_move_gap(text_editor_t *te, size_t index);
+
+/**
+ * @brief Append a line start at the line gap.
+ *
+ * @return ESP_OK or ESP_ERR_NO_MEM.
+ */
+static esp_err_t text_editor_line_push(text_editor_t *te, size_t start);
+
+/**
+ * @brief Width of a glyph as drawn by @c lv_draw_label (kerning and letter space).
+ */
+static int32_t text_editor_glyph_width(const text_editor_t *te, uint32_t cp, uint32_t next);
+
+/**
+ * @brief Word-wrap paragraph [start, end) and push its line starts.
+ *
+ * @return ESP_OK or ESP_ERR_NO_MEM.
+ */
+static esp_err_t text_editor_wrap_paragraph(text_editor_t *te, size_t start, size_t end);
+
+/**
+ * @brief Wrap every paragraph from @p start up to @p end.
+ *
+ * @p end is either the index of a '\n' (which closes the last paragraph of the
+ * range) or the text length.
+ *
+ * @return ESP_OK or ESP_ERR_NO_MEM.
+ */
+static esp_err_t text_editor_wrap_range(text_editor_t *te, size_t start, size_t end);
+
+/**
+ * @brief Drop the cache and wrap the whole text (load, resize, font change).
+ */
+static void text_editor_layout_all(lv_obj_t *obj, text_editor_t *te);
+
+/**
+ * @brief Refresh font metrics and wrap width from the object's style and size.
+ *
+ * @return true if anything that affects wrapping changed.
+ */
+static bool text_editor_update_metrics(lv_obj_t *obj, text_editor_t *te);
+
+/*********************************************************************************************/
+
+/**
+ * @brief Apply an edit to the buffer and the layout cache, without recording it.
+ *
+ * Arguments must already be validated by the caller.
+ *
+ * @return ESP_OK or ESP_ERR_NO_MEM.
+ */
+static esp_err_t text_editor_apply(lv_obj_t *obj, text_editor_t *te, size_t pos, size_t del, const char *ins, size_t ins_len);
+
+/*********************************************************************************************/
+
+/************************************** Undo history *************************************/
+
+/**
+ * @brief Copy @p len payload bytes out of the history ring starting at @p at.
+ */
+static void text_editor_undo_read(const text_editor_undo_t *u, size_t at, char *dst, size_t len);
+
+/**
+ * @brief Drop the oldest record and its payload.
+ */
+static void text_editor_undo_drop_oldest(text_editor_undo_t *u);
+
+/**
+ * @brief Append a record, evicting the oldest ones until it fits.
+ *
+ * Drops any redo records first. An edit larger than the whole ring cannot be
+ * undone, so it clears the history instead.
+ */
+static void text_editor_undo_push(text_editor_undo_t *u, size_t pos, const char *removed, size_t del,
+                                  const char *ins, size_t ins_len);
+
+/**
+ * @brief Record an applied edit, merging it into the previous typing/backspace run if possible.
+ */
+static void text_editor_undo_record(text_editor_t *te, size_t pos, const char *removed, size_t del,
+                                    const char *ins, size_t ins_len);
+
+/*********************************************************************************************/
+
+/************************************** Drawing & input *************************************/
+
+/**
+ * @brief Screen coordinates of the text origin (content area minus scroll).
+ */
+static void text_editor_origin(lv_obj_t *obj, int32_t *x0, int32_t *y0);
+
+/**
+ * @brief Invalidate visual lines [first, last]; @p last = SIZE_MAX extends to the bottom.
+ */
+static void text_editor_invalidate_lines(lv_obj_t *obj, const text_editor_t *te, size_t first, size_t last);
+
+/**
+ * @brief Horizontal pixel offset of byte @p pos inside visual line @p line.
+ */
+static int32_t text_editor_cursor_x(const text_editor_t *te, size_t line, size_t pos);
+
+/**
+ * @brief Move the cursor, redraw the old and new cursor lines and scroll it into view.
+ */
+static void text_editor_move_cursor(lv_obj_t *obj, text_editor_t *te, size_t pos);
+
+/**
+ * @brief Scroll vertically (no animation) so the cursor line is visible.
+ */
+static void text_editor_scroll_to_cursor(lv_obj_t *obj, const text_editor_t *te);
+
+/**
+ * @brief Draw the visible lines that intersect the layer clip area, plus the cursor.
+ */
+static void text_editor_draw(lv_obj_t *obj, text_editor_t *te, lv_layer_t *layer);
+
+/**
+ * @brief Place the cursor at the character nearest to the active input point.
+ */
+static void text_editor_click_to_cursor(lv_obj_t *obj, text_editor_t *te);
+
+/**
+ * @brief Object event handler (draw, self size, resize, click, delete).
+ */
+static void text_editor_event_cb(lv_event_t *e);
+
+/**
+ * @brief Keyboard VALUE_CHANGED handler forwarding keys to the editor.
+ */
+static void text_editor_keyboard_cb(lv_event_t *e);
+
+/*********************************************************************************************/
+
+lv_obj_t *text_editor_create(lv_obj_t *parent)
+{
+    text_editor_t *te = (text_editor_t *)calloc(1, sizeof(*te));
+    if (!te) {
+        return NULL;
+    }
+    te->cap = TEXT_EDITOR_GAP_MIN_B;
+    te->buf = (char *)malloc(te->cap);
+    te->line_cap = TEXT_EDITOR_LINE_GAP_MIN;
+    te->lines = (uint32_t *)malloc(te->line_cap * sizeof(uint32_t));
+    if (!te->buf || !te->lines) {
+        free(te->buf);
+        free(te->lines);
+        free(te);
+        return NULL;
+    }
+    te->gap_start = 0;
+    te->gap_end = te->cap;
+    te->line_gap_start = 0;
+    te->line_gap_end = te->line_cap;
+
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_set_user_data(obj, te);
+    lv_obj_set_scroll_dir(obj, LV_DIR_VER);
+    lv_obj_add_event_cb(obj, text_editor_event_cb, LV_EVENT_ALL, te);
+
+    text_editor_update_metrics(obj, te);
+    text_editor_layout_all(obj, te);
+    return obj;
+}
+
+esp_err_t text_editor_set_text(lv_obj_t *obj, const char *text, size_t len)
+{
+    text_editor_t *te = text_editor_get(obj);
+    if (!te || (!text && len > 0) || len >= UINT32_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t cap = len + TEXT_EDITOR_GAP_MIN_B;
+    char *buf = (char *)malloc(cap);
+    if (!buf) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (len) {
+        memcpy(buf, text, len);
+    }
+    free(te->buf);
+    te->buf = buf;
+    te->cap = cap;
+    te->gap_start = len;
+    te->gap_end = cap;
+    te->cursor = 0;
+    free(te->undo);
+    te->undo = NULL;
+
+    lv_obj_update_layout(obj);
+    text_editor_update_metrics(obj, te);
+    text_editor_layout_all(obj, te);
+    return ESP_OK;
+}
+
+const char *text_editor_get_text(lv_obj_t *obj)
+{
+    text_editor_t *te = text_editor_get(obj);
+    if (!te) {
+        return NULL;
+    }
+    size_t len = text_editor_len(te);
+    text_editor_move_gap(te, len);
+    te->buf[len] = '\0'; /* the gap always keeps at least one spare byte */
+    return te->buf;
+}
+
+size_t text_editor_get_length(lv_obj_t *obj)
+{
+    text_editor_t *te = text_editor_get(obj);
+    return te ? text_editor_len(te) : 0;
+}
+
+bool text_editor_equals(lv_obj_t *obj, const char *text, size_t len)
+{
+    text_editor_t *te = text_editor_get(obj);
+    if (!te || text_editor_len(te) != len) {
+        return false;
+    }
+    if (len == 0) {
+        return true;
+    }
+    if (!text) {
+        return false;
+    }
+    size_t head = te->gap_start;
+    return memcmp(te->buf, text, head) == 0 &&
+           memcmp(te->buf + te->gap_end, text + head, len - head) == 0;
+}
+
+esp_err_t text_editor_replace(lv_obj_t *obj, size_t pos, size_t del, const char *ins, size_t ins_len)
+{
+    text_editor_t *te = text_editor_get(obj);
+    size_t old_len = te ? text_editor_len(te) : 0;
+    if (!te || (!ins && ins_len > 0) || pos > old_len || del > old_len - pos) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (del == 0 && ins_len == 0) {
+        return ESP_OK;
+    }
+    if (old_len - del + ins_len >= UINT32_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    /* Keep a copy of the removed bytes for the history; edits that do not fit
+     * the ring are applied but not recorded. */
+    char small[TEXT_EDITOR_UNDO_RUN_MAX_B];
+    char *removed = NULL;
+    bool recordable = del <= TEXT_EDITOR_UNDO_BYTES && ins_len <= TEXT_EDITOR_UNDO_BYTES - del;
+    if (recordable && del > 0) {
+        removed = (del <= sizeof(small)) ? small : (char *)malloc(del);
+        if (!removed) {
+            recordable = false;
+        }
+        else {
+            for (size_t i = 0; i < del; i++) {
+                removed[i] = (char)text_editor_byte(te, pos + i);
+            }
+        }
+    }
+
+    esp_err_t err = text_editor_apply(obj, te, pos, del, ins, ins_len);
+    if (err == ESP_OK) {
+        if (recordable) {
+            text_editor_undo_record(te, pos, removed, del, ins, ins_len);
+        }
+        else {
+            /* Older records no longer apply to the text; drop them. */
+            free(te->undo);
+            te->undo = NULL;
+        }
+        lv_obj_send_event(obj, LV_EVENT_VALUE_CHANGED, NULL);
+    }
+    if (removed != small) {
+        free(removed);
+    }
+    return err;
+}
+
+bool text_editor_undo(lv_obj_t *obj)
+{
+    text_editor_t *te = text_editor_get(obj);
+    text_editor_undo_t *u = te ? te->undo : NULL;
+    if (!u || u->rec_cursor == u->rec_tail) {
+        return false;
+    }
+    const text_editor_undo_rec_t *rec = &u->recs[(u->rec_cursor - 1) % TEXT_EDITOR_UNDO_RECORDS];
+    char *removed = NULL;
+    if (rec->del_len) {
+        removed = (char *)malloc(rec->del_len);
+        if (!removed) {
+            return false;
+        }
+        text_editor_undo_read(u, rec->data, removed, rec->del_len);
+    }
+    esp_err_t err = text_editor_apply(obj, te, rec->pos, rec->ins_len, removed, rec->del_len);
+    free(removed);
+    if (err != ESP_OK) {
+        return false;
+    }
+    u->rec_cursor--;
+    u->sealed = true;
+    lv_obj_send_event(obj, LV_EVENT_VALUE_CHANGED, NULL);
+    return true;
+}
+
+bool text_editor_redo(lv_obj_t *obj)
+{
+    text_editor_t *te = text_editor_get(obj);
+    text_editor_undo_t *u = te ? te->undo : NULL;
+    if (!u || u->rec_cursor == u->rec_head) {
+        return false;
+    }
+    const text_editor_undo_rec_t *rec = &u->recs[u->rec_cursor % TEXT_EDITOR_UNDO_RECORDS];
+    char *inserted = NULL;
+    if (rec->ins_len) {
+        inserted = (char *)malloc(rec->ins_len);
+        if (!inserted) {
+            return false;
+        }
+        text_editor_undo_read(u, rec->data + rec->del_len, inserted, rec->ins_len);
+    }
+    esp_err_t err = text_editor_apply(obj, te, rec->pos, rec->del_len, inserted, rec->ins_len);
+    free(inserted);
+    if (err != ESP_OK) {
+        return false;
+    }
+    u->rec_cursor++;
+    u->sealed = true;
+    lv_obj_send_event(obj, LV_EVENT_VALUE_CHANGED, NULL);
+    return true;
+}
+
+bool text_editor_can_undo(lv_obj_t *obj)
+{
+    text_editor_t *te = text_editor_get(obj);
+    return te && te->undo && te->undo->rec_cursor != te->undo->rec_tail;
+}
+
+bool text_editor_can_redo(lv_obj_t *obj)
+{
+    text_editor_t *te = text_editor_get(obj);
+    return te && te->undo && te->undo->rec_cursor != te->undo->rec_head;
+}
+
+void text_editor_clear_history(lv_obj_t *obj)
+{
+    text_editor_t *te = text_editor_get(obj);
+    if (te) {
+        free(te->undo);
+        te->undo = NULL;
+    }
+}
+
+static esp_err_t text_editor_apply(lv_obj_t *obj, text_editor_t *te, size_t pos, size_t del, const char *ins, size_t ins_len)
+{
+    size_t old_len = text_editor_len(te);
+    esp_err_t err = text_editor_reserve(te, ins_len);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    /* The affected region spans whole paragraphs: from the '\n' before the edit
+     * to the '\n' after the removed bytes (or the end of the text). */
+    size_t para_start = pos;
+    while (para_start > 0 && text_editor_byte(te, para_start - 1) != '\n') {
+        para_start--;
+    }
+    size_t old_para_end = pos + del;
+    while (old_para_end < old_len && text_editor_byte(te, old_para_end) != '\n') {
+        old_para_end++;
+    }
+
+    size_t first = text_editor_find_line(te, para_start);
+    size_t last_excl = text_editor_find_line(te, old_para_end) + 1;
+    size_t old_count = text_editor_line_count(te);
+    size_t old_cursor_line = text_editor_find_line(te, te->cursor);
+
+    /* Lines after the region become end-relative, lines of the region are dropped. */
+    text_editor_line_move_gap(te, last_excl);
+    te->line_gap_start = first;
+
+    text_editor_move_gap(te, pos);
+    te->gap_end += del;
+    if (ins_len) {
+        memcpy(te->buf + te->gap_start, ins, ins_len);
+        te->gap_start += ins_len;
+    }
+
+    size_t new_para_end = old_para_end - del + ins_len;
+    err = text_editor_wrap_range(te, para_start, new_para_end);
+    if (err != ESP_OK) {
+        /* Out of line slots: the cache is inconsistent, rebuild it from scratch. */
+        ESP_LOGE(TAG, "Line cache grow failed, rebuilding layout");
+        text_editor_layout_all(obj, te);
+        te->cursor = pos + ins_len;
+        text_editor_scroll_to_cursor(obj, te);
+        return ESP_OK;
+    }
+    size_t new_lines = te->line_gap_start - first;
+    size_t new_count = text_editor_line_count(te);
+
+    if (old_cursor_line < first || old_cursor_line >= last_excl) {
+        text_editor_invalidate_lines(obj, te, old_cursor_line, old_cursor_line);
+    }
+    te->cursor = pos + ins_len;
+
+    if (new_count == old_count) {
+        text_editor_invalidate_lines(obj, te, first, first + (new_lines ? new_lines - 1 : 0));
+    }
+    else {
+        text_editor_invalidate_lines(obj, te, first, SIZE_MAX);
+        lv_obj_refresh_self_size(obj);
+    }
+    text_editor_scroll_to_cursor(obj, te);
+    return ESP_OK;
+}
+
+esp_err_t text_editor_insert(lv_obj_t *obj, const char *text)
+{
+    text_editor_t *te = text_editor_get(obj);
+    if (!te || !text) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return text_editor_replace(obj, te->cursor, 0, text, strlen(text));
+}
+
+void text_editor_delete_backward(lv_obj_t *obj)
+{
+    text_editor_t *te = text_editor_get(obj);
+    if (!te || te->cursor == 0) {
+        return;
+    }
+    size_t prev = text_editor_snap(te, te->cursor - 1);
+    text_editor_replace(obj, prev, te->cursor - prev, NULL, 0);
+}
+
+void text_editor_cursor_left(lv_obj_t *obj)
+{
+    text_editor_t *te = text_editor_get(obj);
+    if (!te || te->cursor == 0) {
+        return;
+    }
+    text_editor_move_cursor(obj, te, text_editor_snap(te, te->cursor - 1));
+}
+
+void text_editor_cursor_right(lv_obj_t *obj)
+{
+    text_editor_t *te = text_editor_get(obj);
+    size_t len = te ? text_editor_len(te) : 0;
+    if (!te || te->cursor >= len) {
+        return;
+    }
+    uint32_t cp = 0;
+    text_editor_move_cursor(obj, te, te->cursor + text_editor_decode(te, te->cursor, len, &cp));
+}
+
+void text_editor_set_cursor_pos(lv_obj_t *obj, size_t pos)
+{
+    text_editor_t *te = text_editor_get(obj);
+    if (!te) {
+        return;
+    }
+    size_t len = text_editor_len(te);
+    text_editor_move_cursor(obj, te, text_editor_snap(te, pos > len ? len : pos));
+}
+
+size_t text_editor_get_cursor_pos(lv_obj_t *obj)
+{
+    text_editor_t *te = text_editor_get(obj);
+    return te ? te->cursor : 0;
+}
+
+void text_editor_set_editable(lv_obj_t *obj, bool editable)
+{
+    text_editor_t *te = text_editor_get(obj);
+    if (!te || te->editable == editable) {
+        return;
+    }
+    te->editable = editable;
+    size_t line = text_editor_find_line(te, te->cursor);
+    text_editor_invalidate_lines(obj, te, line, line);
+}
+
+void text_editor_attach_keyboard(lv_obj_t *obj, lv_obj_t *keyboard)
+{
+    if (!text_editor_get(obj) || !keyboard) {
+        return;
+    }
+    lv_obj_add_event_cb(keyboard, text_editor_keyboard_cb, LV_EVENT_VALUE_CHANGED, obj);
+}
+
+/************************************** Gap buffer *************************************/
+
+static text_editor_t *text_editor_get(lv_obj_t *obj)
+{
+    return obj ? (text_editor_t *)lv_obj_get_user_data(obj) : NULL;
+}
+
+static size_t text_editor_len(const text_editor_t *te)
+{
+    return te->cap - (te->gap_end - te->gap_start);
+}
+
+static uint8_t text_editor_byte(const text_editor_t *te, size_t i)
+{
+    return (uint8_t)(i < te->gap_start ? te->buf[i] : te->buf[i + (te->gap_end - te->gap_start)]);
+}
+
+static void text_editor_move_gap(text_editor_t *te, size_t pos)
+{
+    if (pos < te->gap_start) {
+        size_t n = te->gap_start - pos;
+        memmove(te->buf + te->gap_end - n, te->buf + pos, n);
+        te->gap_start -= n;
+        te->gap_end -= n;
+    }
+    else if (pos > te->gap_start) {
+        size_t n = pos - te->gap_start;
+        memmove(te->buf + te->gap_start, te->buf + te->gap_end, n);
+        te->gap_start += n;
+        te->gap_end += n;
+    }
+}
+
+static esp_err_t text_editor_reserve(text_editor_t *te, size_t need)
+{
+    size_t gap = te->gap_end - te->gap_start;
+    if (gap > need) {
+        return ESP_OK;
+    }
+    size_t grow = need + 1 - gap;
+    if (grow < TEXT_EDITOR_GAP_MIN_B) {
+        grow = TEXT_EDITOR_GAP_MIN_B;
+    }
+    if (grow < te->cap / 2) {
+        grow = te->cap / 2;
+    }
+    size_t new_cap = te->cap + grow;
+    char *buf = (char *)realloc(te->buf, new_cap);
+    if (!buf) {
+        ESP_LOGE(TAG, "Gap buffer grow to %zu bytes failed", new_cap);
+        return ESP_ERR_NO_MEM;
+    }
+    size_t tail = te->cap - te->gap_end;
+    memmove(buf + new_cap - tail, buf + te->gap_end, tail);
+    te->buf = buf;
+    te->gap_end = new_cap - tail;
+    te->cap = new_cap;
+    return ESP_OK;
+}
+
+static size_t text_editor_decode(const text_editor_t *te, size_t i, size_t end, uint32_t *cp)
+{
+    uint8_t c = text_editor_byte(te, i);
+    size_t n = (c < 0x80) ? 1 : ((c & 0xE0) == 0xC0) ? 2 : ((c & 0xF0) == 0xE0) ? 3 : ((c & 0xF8) == 0xF0) ? 4 : 1;
+    if (n == 1 || i + n > end) {
+        *cp = c;
+        return 1;
+    }
+    uint32_t value = c & (0x7Fu >> n);
+    for (size_t k = 1; k < n; k++) {
+        uint8_t b = text_editor_byte(te, i + k);
+        if ((b & 0xC0) != 0x80) {
+            *cp = c;
+            return 1;
+        }
+        value = (value << 6) | (b & 0x3Fu);
+    }
+    *cp = value;
+    return n;
+}
+
+static size_t text_editor_snap(const text_editor_t *te, size_t pos)
+{
+    size_t len = text_editor_len(te);
+    size_t limit = pos > 3 ? pos - 3 : 0;
+    while (pos > limit && pos < len && (text_editor_byte(te, pos) & 0xC0) == 0x80) {
+        pos--;
+    }
+    return pos;
+}
+
+/************************************** Layout cache *************************************/
+
+static size_t text_editor_line_count(const text_editor_t *te)
+{
+    return te->line_cap - (te->line_gap_end - te->line_gap_start);
+}
+
+static size_t text_editor_line_start(const text_editor_t *te, size_t i)
+{
+    if (i < te->line_gap_start) {
+        return te->lines[i];
+    }
+    return text_editor_len(te) - te->lines[i + (te->line_gap_end - te->line_gap_start)];
+}
+
+static size_t text_editor_line_end(const text_editor_t *te, size_t i)
+{
+    return (i + 1 < text_editor_line_count(te)) ? text_editor_line_start(te, i + 1) : text_editor_len(te);
+}
+
+static size_t text_editor_find_line(const text_editor_t *te, size_t pos)
+{
+    size_t count = text_editor_line_count(te);
+    if (count == 0) {
+        return 0;
+    }
+    size_t lo = 0;
+    size_t hi = count - 1;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo + 1) / 2;
+        if (text_editor_line_start(te, mid) <= pos) {
+            lo = mid;
+        }
+        else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+static void text_editor_line_move_gap(text_editor_t *te, size_t index)
+{
+    size_t len = text_editor_len(te);
+    size_t gap = te->line_gap_end - te->line_gap_start;
+    while (te->line_gap_start > index) {
+        te->line_gap_start--;
+        te->line_gap_end--;
+        te->lines[te->line_gap_end] = (uint32_t)(len - te->lines[te->line_gap_start]);
+    }
+    while (te->line_gap_start < index) {
+        te->lines[te->line_gap_start] = (uint32_t)(len - te->lines[te->line_gap_start + gap]);
+        te->line_gap_start++;
+        te->line_gap_end++;
+    }
+}
+
+static esp_err_t text_editor_line_push(text_editor_t *te, size_t start)
+{
+    if (te->line_gap_start == te->line_gap_end) {
+        size_t grow = te->line_cap / 2;
+        if (grow < TEXT_EDITOR_LINE_GAP_MIN) {
+            grow = TEXT_EDITOR_LINE_GAP_MIN;
+        }
+        size_t new_cap = te->line_cap + grow;
+        uint32_t *lines = (uint32_t *)realloc(te->lines, new_cap * sizeof(uint32_t));
+        if (!lines) {
+            return ESP_ERR_NO_MEM;
+        }
+        size_t tail = te->line_cap - te->line_gap_end;
+        memmove(lines + new_cap - tail, lines + te->line_gap_end, tail * sizeof(uint32_t));
+        te->lines = lines;
+        te->line_gap_end = new_cap - tail;
+        te->line_cap = new_cap;
+    }
+    te->lines[te->line_gap_start++] = (uint32_t)start;
+    return ESP_OK;
+}
+
+static int32_t text_editor_glyph_width(const text_editor_t *te, uint32_t cp, uint32_t next)
+{
+    if (cp == '\n' || cp == '\r' || !te->font) {
+        return 0;
+    }
+    return (int32_t)lv_font_get_glyph_width(te->font, cp, next) + te->letter_space;
+}
+
+static esp_err_t text_editor_wrap_paragraph(text_editor_t *te, size_t start, size_t end)
+{
+    esp_err_t err = text_editor_line_push(te, start);
+    if (err != ESP_OK || te->wrap_width <= 0) {
+        return err;
+    }
+
+    size_t line_start = start;
+    size_t brk = SIZE_MAX;    /* first byte after the last space on this line */
+    int32_t width = 0;        /* width of the current line */
+    int32_t width_brk = 0;    /* width of the current line after @c brk */
+    uint32_t cp = 0;
+    size_t n = (start < end) ? text_editor_decode(te, start, end, &cp) : 0;
+    size_t i = start;
+    while (i < end) {
+        uint32_t next = 0;
+        size_t next_n = (i + n < end) ? text_editor_decode(te, i + n, end, &next) : 0;
+        int32_t cw = text_editor_glyph_width(te, cp, next);
+
+        if (width + cw > te->wrap_width && i > line_start) {
+            if (brk != SIZE_MAX && brk > line_start && brk <= i) {
+                line_start = brk;
+                width = width_brk;
+            }
+            else {
+                line_start = i;
+                width = 0;
+            }
+            brk = SIZE_MAX;
+            width_brk = width;
+            err = text_editor_line_push(te, line_start);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+
+        width += cw;
+        if (cp == ' ') {
+            brk = i + n;
+            width_brk = 0;
+        }
+        else {
+            width_brk += cw;
+        }
+        i += n;
+        cp = next;
+        n = next_n;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t text_editor_wrap_range(text_editor_t *te, size_t start, size_t end)
+{
+    size_t p = start;
+    for (;;) {
+        size_t para_end = p;
+        while (para_end < end && text_editor_byte(te, para_end) != '\n') {
+            para_end++;
+        }
+        esp_err_t err = text_editor_wrap_paragraph(te, p, para_end);
+        if (err != ESP_OK) {
+            return err;
+        }
+        if (para_end >= end) {
+            return ESP_OK;
+        }
+        p = para_end + 1;
+    }
+}
+
+static void text_editor_layout_all(lv_obj_t *obj, text_editor_t *te)
+{
+    te->line_gap_start = 0;
+    te->line_gap_end = te->line_cap;
+    if (text_editor_wrap_range(te, 0, text_editor_len(te)) != ESP_OK) {
+        ESP_LOGE(TAG, "Layout failed: out of memory for %zu lines", te->line_cap);
+        if (te->line_gap_start == 0) {
+            te->lines[te->line_gap_start++] = 0; /* keep at least one line */
+        }
+    }
+    lv_obj_refresh_self_size(obj);
+    lv_obj_invalidate(obj);
+}
+
+static bool text_editor_update_metrics(lv_obj_t *obj, text_editor_t *te)
+{
+    const lv_font_t *font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+    int32_t letter_space = lv_obj_get_style_text_letter_space(obj, LV_PART_MAIN);
+    int32_t line_space = lv_obj_get_style_text_line_space(obj, LV_PART_MAIN);
+    int32_t line_height = (font ? font->line_height : 16) + line_space;
+    int32_t wrap_width = lv_obj_get_content_width(obj) - TEXT_EDITOR_CURSOR_W;
+
+    bool changed = font != te->font || letter_space != te->letter_space || wrap_width != te->wrap_width;
+    if (line_height != te->line_height) {
+        lv_obj_invalidate(obj);
+    }
+    te->font = font;
+    te->letter_space = letter_space;
+    te->line_height = line_height > 0 ? line_height : 1;
+    te->wrap_width = wrap_width;
+    return changed;
+}
+
+/************************************** Undo history *************************************/
+
+static void text_editor_undo_read(const text_editor_undo_t *u, size_t at, char *dst, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = u->bytes[(at + i) % TEXT_EDITOR_UNDO_BYTES];
+    }
+}
+
+static void text_editor_undo_drop_oldest(text_editor_undo_t *u)
+{
+    u->rec_tail++;
+    if (u->rec_cursor < u->rec_tail) {
+        u->rec_cursor = u->rec_tail;
+    }
+    u->byte_tail = (u->rec_tail < u->rec_head) ? u->recs[u->rec_tail % TEXT_EDITOR_UNDO_RECORDS].data : u->byte_head;
+}
+
+static void text_editor_undo_push(text_editor_undo_t *u, size_t pos, const char *removed, size_t del,
+                                  const char *ins, size_t ins_len)
+{
+    /* A new edit invalidates everything that could be redone. */
+    u->rec_head = u->rec_cursor;
+    u->byte_head = (u->rec_head > u->rec_tail)
+                       ? u->recs[(u->rec_head - 1) % TEXT_EDITOR_UNDO_RECORDS].data +
+                             u->recs[(u->rec_head - 1) % TEXT_EDITOR_UNDO_RECORDS].del_len +
+                             u->recs[(u->rec_head - 1) % TEXT_EDITOR_UNDO_RECORDS].ins_len
+                       : u->byte_tail;
+
+    if (del > TEXT_EDITOR_UNDO_BYTES || ins_len > TEXT_EDITOR_UNDO_BYTES - del) {
+        u->rec_tail = u->rec_cursor = u->rec_head;
+        u->byte_tail = u->byte_head;
+        return;
+    }
+
+    size_t need = del + ins_len;
+    while (u->rec_head > u->rec_tail &&
+           (u->byte_head + need - u->byte_tail > TEXT_EDITOR_UNDO_BYTES ||
+            u->rec_head - u->rec_tail >= TEXT_EDITOR_UNDO_RECORDS)) {
+        text_editor_undo_drop_oldest(u);
+    }
+
+    text_editor_undo_rec_t *rec = &u->recs[u->rec_head % TEXT_EDITOR_UNDO_RECORDS];
+    rec->pos = (uint32_t)pos;
+    rec->del_len = (uint16_t)del;
+    rec->ins_len = (uint16_t)ins_len;
+    rec->data = u->byte_head;
+    for (size_t i = 0; i < del; i++) {
+        u->bytes[(u->byte_head++) % TEXT_EDITOR_UNDO_BYTES] = removed[i];
+    }
+    for (size_t i = 0; i < ins_len; i++) {
+        u->bytes[(u->byte_head++) % TEXT_EDITOR_UNDO_BYTES] = ins[i];
+    }
+    u->rec_head++;
+    u->rec_cursor = u->rec_head;
+}
+
+static void text_editor_undo_record(text_editor_t *te, size_t pos, const char *removed, size_t del,
+                                    const char *ins, size_t ins_len)
+{
+    if (!te->undo) {
+        te->undo = (text_editor_undo_t *)calloc(1, sizeof(text_editor_undo_t));
+        if (!te->undo) {
+            ESP_LOGW(TAG, "No memory for undo history");
+            return;
+        }
+    }
+    text_editor_undo_t *u = te->undo;
+    uint32_t now = lv_tick_get();
+    bool newline = (ins_len && memchr(ins, '\n', ins_len)) || (del && memchr(removed, '\n', del));
+
+    bool merged = false;
+    if (!u->sealed && !newline && u->rec_cursor == u->rec_head && u->rec_head > u->rec_tail &&
+        lv_tick_diff(now, u->last_tick) < TEXT_EDITOR_UNDO_IDLE_MS) {
+        /* Pop the last record and push the merged run in its place. */
+        text_editor_undo_rec_t last = u->recs[(u->rec_head - 1) % TEXT_EDITOR_UNDO_RECORDS];
+        char run[2 * TEXT_EDITOR_UNDO_RUN_MAX_B];
+        bool typing = del == 0 && last.del_len == 0 && pos == last.pos + last.ins_len;
+        bool backspace = ins_len == 0 && last.ins_len == 0 && pos + del == last.pos;
+        bool forward_del = ins_len == 0 && last.ins_len == 0 && pos == last.pos;
+
+        if (typing && last.ins_len + ins_len <= TEXT_EDITOR_UNDO_RUN_MAX_B) {
+            text_editor_undo_read(u, last.data, run, last.ins_len);
+            memcpy(run + last.ins_len, ins, ins_len);
+            u->rec_head--;
+            u->rec_cursor = u->rec_head;
+            text_editor_undo_push(u, last.pos, NULL, 0, run, last.ins_len + ins_len);
+            merged = true;
+        }
+        else if ((backspace || forward_del) && last.del_len + del <= TEXT_EDITOR_UNDO_RUN_MAX_B) {
+            if (backspace) {
+                memcpy(run, removed, del);
+                text_editor_undo_read(u, last.data, run + del, last.del_len);
+            }
+            else {
+                text_editor_undo_read(u, last.data, run, last.del_len);
+                memcpy(run + last.del_len, removed, del);
+            }
+            u->rec_head--;
+            u->rec_cursor = u->rec_head;
+            text_editor_undo_push(u, pos, run, last.del_len + del, NULL, 0);
+            merged = true;
+        }
+    }
+    if (!merged) {
+        text_editor_undo_push(u, pos, removed, del, ins, ins_len);
+    }
+    u->last_tick = now;
+    u->sealed = newline;
+}
+
+/************************************** Drawing & input *************************************/
+
+static void text_editor_origin(lv_obj_t *obj, int32_t *x0, int32_t *y0)
+{
+    lv_area_t content;
+    lv_obj_get_content_coords(obj, &content);
+    *x0 = content.x1 - lv_obj_get_scroll_x(obj);
+    *y0 = content.y1 - lv_obj_get_scroll_y(obj);
+}
+
+static void text_editor_invalidate_lines(lv_obj_t *obj, const text_editor_t *te, size_t first, size_t last)
+{
+    int32_t x0 = 0;
+    int32_t y0 = 0;
+    text_editor_origin(obj, &x0, &y0);
+
+    lv_area_t area;
+    lv_obj_get_coords(obj, &area);
+    int32_t top = y0 + (int32_t)first * te->line_height;
+    if (top > area.y2) {
+        return;
+    }
+    if (last != SIZE_MAX) {
+        int32_t bottom = y0 + (int32_t)(last + 1) * te->line_height - 1;
+        if (bottom < area.y1) {
+            return;
+        }
+        if (bottom < area.y2) {
+            area.y2 = bottom;
+        }
+    }
+    if (top > area.y1) {
+        area.y1 = top;
+    }
+    lv_obj_invalidate_area(obj, &area);
+}
+
+static int32_t text_editor_cursor_x(const text_editor_t *te, size_t line, size_t pos)
+{
+    size_t end = text_editor_line_end(te, line);
+    if (pos > end) {
+        pos = end;
+    }
+    int32_t x = 0;
+    size_t i = text_editor_line_start(te, line);
+    while (i < pos) {
+        uint32_t cp = 0;
+        uint32_t next = 0;
+        size_t n = text_editor_decode(te, i, end, &cp);
+        if (i + n < end) {
+            text_editor_decode(te, i + n, end, &next);
+        }
+        x += text_editor_glyph_width(te, cp, next);
+        i += n;
+    }
+    return x;
+}
+
+static void text_editor_move_cursor(lv_obj_t *obj, text_editor_t *te, size_t pos)
+{
+    size_t old_line = text_editor_find_line(te, te->cursor);
+    te->cursor = pos;
+    if (te->undo) {
+        te->undo->sealed = true;
+    }
+    size_t new_line = text_editor_find_line(te, pos);
+    text_editor_invalidate_lines(obj, te, old_line, old_line);
+    if (new_line != old_line) {
+        text_editor_invalidate_lines(obj, te, new_line, new_line);
+    }
+    text_editor_scroll_to_cursor(obj, te);
+}
+
+static void text_editor_scroll_to_cursor(lv_obj_t *obj, const text_editor_t *te)
+{
+    int32_t top = (int32_t)text_editor_find_line(te, te->cursor) * te->line_height;
+    int32_t bottom = top + te->line_height;
+    int32_t scroll_y = lv_obj_get_scroll_y(obj);
+    int32_t view_h = lv_obj_get_content_height(obj);
+    if (top < scroll_y) {
+        lv_obj_scroll_to_y(obj, top, LV_ANIM_OFF);
+    }
+    else if (view_h > 0 && bottom > scroll_y + view_h) {
+        lv_obj_scroll_to_y(obj, bottom - view_h, LV_ANIM_OFF);
+    }
+}
+
+static void text_editor_draw(lv_obj_t *obj, text_editor_t *te, lv_layer_t *layer)
+{
+    size_t count = text_editor_line_count(te);
+    if (count == 0) {
+        return;
+    }
+    int32_t x0 = 0;
+    int32_t y0 = 0;
+    text_editor_origin(obj, &x0, &y0);
+
+    lv_area_t content;
+    lv_obj_get_content_coords(obj, &content);
+    const lv_area_t *clip = &layer->_clip_area;
+    if (clip->y2 < y0) {
+        return;
+    }
+    size_t first = (clip->y1 > y0) ? (size_t)((clip->y1 - y0) / te->line_height) : 0;
+    size_t last = (size_t)((clip->y2 - y0) / te->line_height);
+    if (last >= count) {
+        last = count - 1;
+    }
+
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    lv_obj_init_draw_label_dsc(obj, LV_PART_MAIN, &dsc);
+    dsc.align = LV_TEXT_ALIGN_LEFT;
+    dsc.flag = LV_TEXT_FLAG_EXPAND;
+
+    size_t gap = te->gap_end - te->gap_start;
+    for (size_t i = first; i <= last; i++) {
+        size_t s = text_editor_line_start(te, i);
+        size_t e = text_editor_line_end(te, i);
+        while (e > s && (text_editor_byte(te, e - 1) == '\n' || text_editor_byte(te, e - 1) == '\r')) {
+            e--;
+        }
+        if (e == s) {
+            continue;
+        }
+        size_t n = e - s;
+        dsc.text_local = 0;
+        if (e <= te->gap_start) {
+            dsc.text = te->buf + s;
+        }
+        else if (s >= te->gap_start) {
+            dsc.text = te->buf + s + gap;
+        }
+        else {
+            /* Only the line holding the gap needs a copy; LVGL duplicates it. */
+            if (n > te->scratch_cap) {
+                char *scratch = (char *)realloc(te->scratch, n);
+                if (!scratch) {
+                    continue;
+                }
+                te->scratch = scratch;
+                te->scratch_cap = n;
+            }
+            size_t head = te->gap_start - s;
+            memcpy(te->scratch, te->buf + s, head);
+            memcpy(te->scratch + head, te->buf + te->gap_end, n - head);
+            dsc.text = te->scratch;
+            dsc.text_local = 1;
+        }
+        dsc.text_length = (uint32_t)n;
+
+        lv_area_t area = {
+            .x1 = x0,
+            .y1 = y0 + (int32_t)i * te->line_height,
+            .x2 = content.x2,
+            .y2 = y0 + (int32_t)(i + 1) * te->line_height - 1,
+        };
+        lv_draw_label(layer, &dsc, &area);
+    }
+
+    if (te->editable) {
+        size_t line = text_editor_find_line(te, te->cursor);
+        if (line >= first && line <= last) {
+            lv_draw_rect_dsc_t cursor_dsc;
+            lv_draw_rect_dsc_init(&cursor_dsc);
+            cursor_dsc.bg_color = dsc.color;
+            cursor_dsc.bg_opa = LV_OPA_COVER;
+            int32_t cx = x0 + text_editor_cursor_x(te, line, te->cursor);
+            lv_area_t area = {
+                .x1 = cx,
+                .y1 = y0 + (int32_t)line * te->line_height,
+                .x2 = cx + TEXT_EDITOR_CURSOR_W - 1,
+                .y2 = y0 + (int32_t)(line + 1) * te->line_height - 1,
+            };
+            lv_draw_rect(layer, &cursor_dsc, &area);
+        }
+    }
+}
+
+static void text_editor_click_to_cursor(lv_obj_t *obj, text_editor_t *te)
+{
+    lv_indev_t *indev = lv_indev_active();
+    if (!indev) {
+        return;
+    }
+    lv_point_t point;
+    lv_indev_get_point(indev, &point);
+
+    int32_t x0 = 0;
+    int32_t y0 = 0;
+    text_editor_origin(obj, &x0, &y0);
+    size_t count = text_editor_line_count(te);
+    size_t line = (point.y > y0) ? (size_t)((point.y - y0) / te->line_height) : 0;
+    if (line >= count) {
+        line = count ? count - 1 : 0;
+    }
+
+    size_t end = text_editor_line_end(te, line);
+    while (end > text_editor_line_start(te, line) &&
+           (text_editor_byte(te, end - 1) == '\n' || text_editor_byte(te, end - 1) == '\r')) {
+        end--;
+    }
+    int32_t target = point.x - x0;
+    int32_t x = 0;
+    size_t i = text_editor_line_start(te, line);
+    while (i < end) {
+        uint32_t cp = 0;
+        uint32_t next = 0;
+        size_t n = text_editor_decode(te, i, end, &cp);
+        if (i + n < end) {
+            text_editor_decode(te, i + n, end, &next);
+        }
+        int32_t cw = text_editor_glyph_width(te, cp, next);
+        if (x + cw / 2 > target) {
+            break;
+        }
+        x += cw;
+        i += n;
+    }
+    text_editor_move_cursor(obj, te, i);
+}
+
+static void text_editor_event_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    text_editor_t *te = lv_event_get_user_data(e);
+    if (!te) {
+        return;
+    }
+
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_DRAW_MAIN:
+        text_editor_draw(obj, te, lv_event_get_layer(e));
+        break;
+    case LV_EVENT_GET_SELF_SIZE: {
+        lv_point_t *size = lv_event_get_param(e);
+        int32_t h = (int32_t)text_editor_line_count(te) * te->line_height;
+        if (size->y < h) {
+            size->y = h;
+        }
+        break;
+    }
+    case LV_EVENT_SIZE_CHANGED:
+    case LV_EVENT_STYLE_CHANGED:
+        if (text_editor_update_metrics(obj, te)) {
+            text_editor_layout_all(obj, te);
+        }
+        break;
+    case LV_EVENT_CLICKED:
+        if (te->editable && !lv_obj_has_state(obj, LV_STATE_DISABLED)) {
+            text_editor_click_to_cursor(obj, te);
+        }
+        break;
+    case LV_EVENT_DELETE:
+        lv_obj_set_user_data(obj, NULL);
+        free(te->buf);
+        free(te->lines);
+        free(te->scratch);
+        free(te->undo);
+        free(te);
+        break;
+    default:
+        break;
+    }
+}
+
+static void text_editor_keyboard_cb(lv_event_t *e)
+{
+    lv_obj_t *kb = lv_event_get_target(e);
+    lv_obj_t *obj = lv_event_get_user_data(e);
+    text_editor_t *te = text_editor_get(obj);
+    if (!te || !te->editable || lv_keyboard_get_textarea(kb)) {
+        return;
+    }
+
+    uint32_t btn_id = lv_buttonmatrix_get_selected_button(kb);
+    if (btn_id == LV_BUTTONMATRIX_BUTTON_NONE) {
+        return;
+    }
+    const char *txt = lv_buttonmatrix_get_button_text(kb, btn_id);
+    if (!txt) {
+        return;
+    }
+
+    /* Mode switches, close and OK are handled by the keyboard itself. */
+    if (strcmp(txt, "abc") == 0 || strcmp(txt, "ABC") == 0 || strcmp(txt, "1#") == 0 ||
+        strcmp(txt, LV_SYMBOL_CLOSE) == 0 || strcmp(txt, LV_SYMBOL_KEYBOARD) == 0 ||
+        strcmp(txt, LV_SYMBOL_OK) == 0 || strcmp(txt, "+/-") == 0) {
+        return;
+    }
+    if (strcmp(txt, "Enter") == 0 || strcmp(txt, LV_SYMBOL_NEW_LINE) == 0) {
+        text_editor_insert(obj, "\n");
+    }
+    else if (strcmp(txt, LV_SYMBOL_LEFT) == 0) {
+        text_editor_cursor_left(obj);
+    }
+    else if (strcmp(txt, LV_SYMBOL_RIGHT) == 0) {
+        text_editor_cursor_right(obj);
+    }
+    else if (strcmp(txt, LV_SYMBOL_BACKSPACE) == 0) {
+        text_editor_delete_backward(obj);
+    }
+    else {
+        text_editor_insert(obj, txt);
+    }
+}
@@ -8,9 +8,14 @@
 #include <errno.h>
 
 #include "fs_navigator.h"
+#include "fs_text_encoding.h"
 #include "fs_text_ops.h"
+#include "text_editor.h"
 #include "esp_log.h"
+#include "mem_plan.h"
 #include "sd_card.h"
+#include "sd_file.h"
+#include "sd_journal.h"
 
 #define TEXT_VIEWER_PATH_SCROLL_DELAY_MS 2000
 
@@ -48,12 +53,16 @@ typedef struct
     size_t lasf_file_offset_kb;                 /**< Offset (in KB) used for the last read chunk */
     size_t current_file_offset_kb;              /**< Offset (in KB) used for the current/next chunk */
     size_t max_file_offset_kb;                  /**< Maximum readable offset (in KB) for the loaded file */
+    size_t window_boundary;                     /**< Text offset where the second chunk of the window starts */
+    fs_text_encoding_t encoding;                /**< Encoding detected when the file was opened */
     lv_obj_t *screen;                           /**< Root LVGL screen object */
     lv_obj_t *toolbar;                          /**< Toolbar container */
     lv_obj_t *path_label;                       /**< Label showing the file path */
     lv_obj_t *status_label;                     /**< Label showing transient status messages */
     lv_obj_t *save_btn;                         /**< Save button (hidden/disabled in view mode) */
-    lv_obj_t *text_area;                        /**< Text area for viewing/editing content */
+    lv_obj_t *undo_btn;                         /**< Undo button (hidden in view mode) */
+    lv_obj_t *redo_btn;                         /**< Redo button (hidden in view mode) */
+    lv_obj_t *text_area;                        /**< Editor widget for viewing/editing content */
     lv_obj_t *keyboard;                         /**< On-screen keyboard */
     lv_obj_t *chunk_slider;                     /**< Vertical slider for chunk navigation */
     lv_obj_t *return_screen;                    /**< Screen to return to on close */
@@ -69,6 +78,7 @@ typedef struct
     char directory[FS_TEXT_MAX_PATH];           /**< Directory used for new files */
     char pending_name[FS_NAV_MAX_NAME];         /**< Suggested filename for new files */
     char *original_text;                        /**< Snapshot of text at load/save time */
+    size_t original_len;                        /**< Length of @c original_text in bytes */
     size_t pending_first_offset_kb;             /**< Pending first chunk offset when prompting */
     size_t pending_second_offset_kb;            /**< Pending second chunk offset when prompting */
     bool pending_scroll_up;                     /**< True if pending load comes from top edge */
@@ -210,7 +220,27 @@ static void text_viewer_on_slider_value_changed(lv_event_t *e);
 static esp_err_t text_viewer_load_window(text_viewer_ctx_t *ctx, size_t first_offset_kb, size_t second_offset_kb);
 
 /**
- * @brief Enable/disable the Save button based on @c editable and @c dirty.
+ * @brief Read two consecutive chunks as UTF-8 text.
+ *
+ * Files in other encodings are transcoded; the chunk boundary is located through
+ * the offset map of the window, since the text no longer has one byte per source byte.
+ *
+ * @param path             File to read.
+ * @param[in,out] encoding Encoding of the file; detected from the first chunk if unknown.
+ * @param first_offset_kb  Offset (KB) of the first chunk.
+ * @param second_offset_kb Offset (KB) of the second chunk (equal to the first for a single chunk).
+ * @param[out] out_text     Text from MEM_PLAN_FILE_IO; free with mem_plan_free().
+ * @param[out] out_len      Length of @p out_text in bytes.
+ * @param[out] out_boundary Offset in @p out_text where the second chunk starts.
+ * @return ESP_OK, fs_text_read_range() errors, or ESP_ERR_NO_MEM.
+ */
+static esp_err_t text_viewer_read_window(const char *path, fs_text_encoding_t *encoding,
+                                         size_t first_offset_kb, size_t second_offset_kb,
+                                         char **out_text, size_t *out_len, size_t *out_boundary);
+
+/**
+ * @brief Enable/disable the Save button based on @c editable and @c dirty,
+ *        and Undo/Redo based on the editor history.
  *
  * @param ctx Viewer context.
  */
@@ -241,17 +271,6 @@ static void text_viewer_hide_keyboard(text_viewer_ctx_t *ctx);
  * @param e LVGL event.
  */
 static void text_viewer_on_text_area_clicked(lv_event_t *e);
-/**
- * @brief Immediately jump the text area's scroll to the cursor position.
- *
- * Skips LVGL's default smooth scroll animation and forces the text area
- * to scroll instantly to the final cursor location. Useful when loading
- * a new text chunk and repositioning the cursor manually.
- *
- * @param ctx Pointer to the text viewer context. Must not be NULL.
- */
-static void text_viewer_skip_cursor_animation(text_viewer_ctx_t *ctx);
-
 /**
  * @brief Handle scroll events and load new text chunks when reaching edges.
  *
@@ -313,7 +332,7 @@ static void text_viewer_on_text_changed(lv_event_t *e);
 /**
  * @brief Save the currently loaded text chunk back to the underlying file.
  *
- * This function writes the contents of the LVGL textarea in @p ctx->text_area
+ * This function writes the contents of the editor widget in @p ctx->text_area
  * into the backing file at @p ctx->path, only within the byte window
  * corresponding to the currently loaded chunks (defined by
  * ctx->lasf_file_offset_kb and ctx->current_file_offset_kb).
@@ -330,7 +349,7 @@ static void text_viewer_on_text_changed(lv_event_t *e);
  * - Opens the existing file (if any) as @p src and a temporary file as @p tmp.
  * - Writes:
  *      1) Prefix (bytes [0, window_start)) from @p src into @p tmp.
- *      2) The current textarea contents into @p tmp.
+ *      2) The current editor contents into @p tmp.
  *      3) Suffix (bytes [window_end, file_end)) from @p src into @p tmp.
  * - Renames the temporary file over the destination file for an atomic-ish
  *   replacement.
@@ -359,6 +378,20 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx);
  */
 static void text_viewer_on_save(lv_event_t *e);
 
+/**
+ * @brief "Undo" button handler: reverts the last edit step from memory.
+ *
+ * @param e LVGL event.
+ */
+static void text_viewer_on_undo(lv_event_t *e);
+
+/**
+ * @brief "Redo" button handler: re-applies the last undone step.
+ *
+ * @param e LVGL event.
+ */
+static void text_viewer_on_redo(lv_event_t *e);
+
 /**
  * @brief "Back" button handler: closes the screen or prompts to save/discard.
  *
@@ -536,12 +569,14 @@ esp_err_t text_viewer_open(const text_viewer_open_opts_t *opts)
     }
 
     char *content = NULL;
+    fs_text_encoding_t encoding = FS_TEXT_ENC_UTF8;
+    size_t boundary = 0;
     size_t file_size_kb = 0;
     size_t first_offset_kb = 0;
     size_t second_offset_kb = 0;
     if (new_file)
     {
-        content = strdup("");
+        content = (char *)mem_plan_calloc(MEM_PLAN_FILE_IO, 1, 1);
         if (!content)
         {
             return ESP_ERR_NO_MEM;
@@ -549,55 +584,22 @@ esp_err_t text_viewer_open(const text_viewer_open_opts_t *opts)
     }
     else
     {
-        char *chunk_a = NULL;
-        char *chunk_b = NULL;
-        size_t len_a = 0;
-        size_t len_b = 0;
+        encoding = FS_TEXT_ENC_UNKNOWN;
         struct stat st = {0};
         if (stat(opts->path, &st) == 0 && S_ISREG(st.st_mode))
         {
-            file_size_kb = (st.st_size > 0) ? ((size_t)st.st_size - 1u) / 1024u : 0;
+            uint64_t file_size = sd_file_size(opts->path, &st);
+            file_size_kb = (file_size > 0) ? (size_t)((file_size - 1u) / 1024u) : 0;
         }
         second_offset_kb = (file_size_kb > 0) ? 1 : 0;
 
-        esp_err_t err = fs_text_read_range(opts->path, first_offset_kb, &chunk_a, &len_a);
+        size_t len = 0;
+        esp_err_t err = text_viewer_read_window(opts->path, &encoding, first_offset_kb, second_offset_kb,
+                                                &content, &len, &boundary);
         if (err != ESP_OK)
         {
-            free(chunk_a);
             return err;
         }
-
-        if (second_offset_kb != first_offset_kb)
-        {
-            err = fs_text_read_range(opts->path, second_offset_kb, &chunk_b, &len_b);
-            if (err != ESP_OK)
-            {
-                free(chunk_a);
-                free(chunk_b);
-                return err;
-            }
-        }
-
-        size_t total = len_a + len_b;
-        content = (char *)malloc(total + 1);
-        if (!content)
-        {
-            free(chunk_a);
-            free(chunk_b);
-            return ESP_ERR_NO_MEM;
-        }
-        if (len_a)
-        {
-            memcpy(content, chunk_a, len_a);
-        }
-        if (len_b)
-        {
-            memcpy(content + len_a, chunk_b, len_b);
-        }
-        content[total] = '\0';
-
-        free(chunk_a);
-        free(chunk_b);
     }
 
     text_viewer_ctx_t *ctx = &s_viewer;
@@ -608,7 +610,9 @@ esp_err_t text_viewer_open(const text_viewer_open_opts_t *opts)
 
     text_viewer_close_confirm(ctx);
     ctx->active = true;
-    ctx->editable = new_file ? true : opts->editable;
+    /* Transcoded text would be saved back as UTF-8, so it is only viewed */
+    bool transcoded = fs_text_encoding_needs_transcode(encoding);
+    ctx->editable = new_file ? true : (opts->editable && !transcoded);
     ctx->new_file = new_file;
     ctx->dirty = new_file ? true : false;
     ctx->suppress_events = true;
@@ -619,6 +623,8 @@ esp_err_t text_viewer_open(const text_viewer_open_opts_t *opts)
     ctx->current_file_offset_kb = second_offset_kb;
     ctx->lasf_file_offset_kb = first_offset_kb;
     ctx->max_file_offset_kb = file_size_kb;
+    ctx->window_boundary = boundary;
+    ctx->encoding = encoding;
 
     ctx->name_dialog = NULL;
     ctx->name_textarea = NULL;
@@ -652,14 +658,20 @@ esp_err_t text_viewer_open(const text_viewer_open_opts_t *opts)
         text_viewer_set_path_label(ctx, ctx->path);
     }
 
-    lv_textarea_set_text(ctx->text_area, content);
+    text_editor_set_text(ctx->text_area, content, strlen(content));
     text_viewer_set_original(ctx, content);
-    free(content);
+    mem_plan_free(MEM_PLAN_FILE_IO, content);
     ctx->suppress_events = false;
     if (ctx->new_file)
     {
         text_viewer_set_status(ctx, "New TXT");
     }
+    else if (transcoded)
+    {
+        char status[32];
+        snprintf(status, sizeof(status), "View mode (%s)", fs_text_encoding_name(encoding));
+        text_viewer_set_status(ctx, status);
+    }
     else
     {
         text_viewer_set_status(ctx, ctx->editable ? "Edit mode" : "View mode");
@@ -669,7 +681,7 @@ esp_err_t text_viewer_open(const text_viewer_open_opts_t *opts)
     lv_screen_load(ctx->screen);
     if (ctx->new_file)
     {
-        lv_textarea_set_cursor_pos(ctx->text_area, 0);
+        text_editor_set_cursor_pos(ctx->text_area, 0);
         lv_obj_add_state(ctx->text_area, LV_STATE_FOCUSED);
         text_viewer_show_keyboard(ctx, ctx->text_area);
     }
@@ -712,6 +724,22 @@ static void text_viewer_build_screen(text_viewer_ctx_t *ctx)
     lv_label_set_text(save_lbl, LV_SYMBOL_SAVE " Save");
     lv_obj_center(save_lbl);
 
+    ctx->undo_btn = lv_button_create(toolbar);
+    lv_obj_set_style_radius(ctx->undo_btn, 6, 0);
+    lv_obj_set_style_pad_all(ctx->undo_btn, 6, 0);
+    lv_obj_add_event_cb(ctx->undo_btn, text_viewer_on_undo, LV_EVENT_CLICKED, ctx);
+    lv_obj_t *undo_lbl = lv_label_create(ctx->undo_btn);
+    lv_label_set_text(undo_lbl, "Undo");
+    lv_obj_center(undo_lbl);
+
+    ctx->redo_btn = lv_button_create(toolbar);
+    lv_obj_set_style_radius(ctx->redo_btn, 6, 0);
+    lv_obj_set_style_pad_all(ctx->redo_btn, 6, 0);
+    lv_obj_add_event_cb(ctx->redo_btn, text_viewer_on_redo, LV_EVENT_CLICKED, ctx);
+    lv_obj_t *redo_lbl = lv_label_create(ctx->redo_btn);
+    lv_label_set_text(redo_lbl, "Redo");
+    lv_obj_center(redo_lbl);
+
     lv_obj_t *status_spacer_left = lv_obj_create(toolbar);
     lv_obj_remove_style_all(status_spacer_left);
     lv_obj_set_flex_grow(status_spacer_left, 1);
@@ -759,11 +787,10 @@ static void text_viewer_build_screen(text_viewer_ctx_t *ctx)
     lv_obj_set_style_pad_right(text_row, slider_gap, 0);
     lv_obj_set_flex_grow(text_row, 1);    
 
-    ctx->text_area = lv_textarea_create(text_row);
+    ctx->text_area = text_editor_create(text_row);
     lv_obj_set_flex_grow(ctx->text_area, 1);
     lv_obj_set_height(ctx->text_area, LV_PCT(100));
     lv_obj_set_style_pad_all(ctx->text_area, 0, 0);
-    lv_textarea_set_cursor_click_pos(ctx->text_area, false);
     lv_obj_set_scrollbar_mode(ctx->text_area, LV_SCROLLBAR_MODE_AUTO);
     //lv_obj_set_width(ctx->text_area, LV_PCT(100));
     lv_obj_add_event_cb(ctx->text_area, text_viewer_on_text_changed, LV_EVENT_VALUE_CHANGED, ctx);
@@ -802,7 +829,7 @@ static void text_viewer_build_screen(text_viewer_ctx_t *ctx)
     ctx->chunk_slider = list_slider;
     
     ctx->keyboard = lv_keyboard_create(scr);
-    lv_keyboard_set_textarea(ctx->keyboard, ctx->text_area);
+    text_editor_attach_keyboard(ctx->text_area, ctx->keyboard);
     lv_obj_add_flag(ctx->keyboard, LV_OBJ_FLAG_HIDDEN);
     lv_obj_add_event_cb(ctx->keyboard, text_viewer_on_keyboard_cancel, LV_EVENT_CANCEL, ctx);
     lv_obj_add_event_cb(ctx->keyboard, text_viewer_on_keyboard_ready, LV_EVENT_READY, ctx);
@@ -813,20 +840,23 @@ static void text_viewer_apply_mode(text_viewer_ctx_t *ctx)
     if (ctx->editable)
     {
         lv_obj_clear_state(ctx->text_area, LV_STATE_DISABLED);
-        lv_textarea_set_cursor_click_pos(ctx->text_area, true);
+        text_editor_set_editable(ctx->text_area, true);
         lv_obj_add_flag(ctx->text_area, LV_OBJ_FLAG_CLICK_FOCUSABLE);
         text_viewer_hide_keyboard(ctx);
         lv_obj_clear_flag(ctx->save_btn, LV_OBJ_FLAG_HIDDEN);
-        lv_textarea_set_cursor_pos(ctx->text_area, 0);
+        lv_obj_clear_flag(ctx->undo_btn, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_clear_flag(ctx->redo_btn, LV_OBJ_FLAG_HIDDEN);
+        text_editor_set_cursor_pos(ctx->text_area, 0);
     }
     else
     {
-        lv_textarea_set_cursor_click_pos(ctx->text_area, false);
+        text_editor_set_editable(ctx->text_area, false);
         lv_obj_clear_flag(ctx->text_area, LV_OBJ_FLAG_CLICK_FOCUSABLE);
         text_viewer_hide_keyboard(ctx);
         lv_obj_add_flag(ctx->save_btn, LV_OBJ_FLAG_HIDDEN);
-        lv_textarea_clear_selection(ctx->text_area);
-        lv_textarea_set_cursor_pos(ctx->text_area, 0);
+        lv_obj_add_flag(ctx->undo_btn, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_add_flag(ctx->redo_btn, LV_OBJ_FLAG_HIDDEN);
+        text_editor_set_cursor_pos(ctx->text_area, 0);
     }
     lv_obj_scroll_to_y(ctx->text_area, 0, LV_ANIM_OFF);
     text_viewer_update_buttons(ctx);
@@ -908,8 +938,19 @@ static void text_viewer_restart_path_scroll(text_viewer_ctx_t *ctx)
 
 static void text_viewer_set_original(text_viewer_ctx_t *ctx, const char *text)
 {
-    free(ctx->original_text);
-    ctx->original_text = text ? strdup(text) : NULL;
+    mem_plan_free(MEM_PLAN_FILE_IO, ctx->original_text);
+    ctx->original_text = NULL;
+    ctx->original_len = 0;
+    if (text)
+    {
+        size_t len = strlen(text);
+        ctx->original_text = (char *)mem_plan_alloc(MEM_PLAN_FILE_IO, len + 1);
+        if (ctx->original_text)
+        {
+            memcpy(ctx->original_text, text, len + 1);
+            ctx->original_len = len;
+        }
+    }
 }
 
 static void text_viewer_get_slider_params(text_viewer_ctx_t *ctx, size_t *window_size, size_t *step)
@@ -1078,13 +1119,41 @@ static esp_err_t text_viewer_load_window(text_viewer_ctx_t *ctx, size_t first_of
         return ESP_ERR_INVALID_ARG;
     }
 
+    char *text = NULL;
+    size_t len = 0;
+    size_t boundary = 0;
+    esp_err_t err = text_viewer_read_window(ctx->path, &ctx->encoding, first_offset_kb, second_offset_kb,
+                                            &text, &len, &boundary);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    bool prev_suppress = ctx->suppress_events;
+    ctx->suppress_events = true;
+    text_editor_set_text(ctx->text_area, text, len);
+    text_viewer_set_original(ctx, text);
+    ctx->window_boundary = boundary;
+    ctx->dirty = false;
+    text_viewer_update_buttons(ctx);
+
+    ctx->suppress_events = prev_suppress;
+
+    mem_plan_free(MEM_PLAN_FILE_IO, text);
+    return ESP_OK;
+}
+
+static esp_err_t text_viewer_read_window(const char *path, fs_text_encoding_t *encoding,
+                                         size_t first_offset_kb, size_t second_offset_kb,
+                                         char **out_text, size_t *out_len, size_t *out_boundary)
+{
     char *chunk_a = NULL;
     char *chunk_b = NULL;
     char *joined = NULL;
     size_t len_a = 0;
     size_t len_b = 0;
 
-    esp_err_t err = fs_text_read_range(ctx->path, first_offset_kb, &chunk_a, &len_a);
+    esp_err_t err = fs_text_read_range(path, first_offset_kb, &chunk_a, &len_a);
     if (err != ESP_OK)
     {
         goto cleanup;
@@ -1092,7 +1161,7 @@ static esp_err_t text_viewer_load_window(text_viewer_ctx_t *ctx, size_t first_of
 
     if (second_offset_kb != first_offset_kb)
     {
-        err = fs_text_read_range(ctx->path, second_offset_kb, &chunk_b, &len_b);
+        err = fs_text_read_range(path, second_offset_kb, &chunk_b, &len_b);
         if (err != ESP_OK)
         {
             goto cleanup;
@@ -1100,7 +1169,7 @@ static esp_err_t text_viewer_load_window(text_viewer_ctx_t *ctx, size_t first_of
     }
 
     size_t total = len_a + len_b;
-    joined = (char *)malloc(total + 1);
+    joined = (char *)mem_plan_alloc(MEM_PLAN_FILE_IO, total + 1);
     if (!joined)
     {
         err = ESP_ERR_NO_MEM;
@@ -1117,19 +1186,36 @@ static esp_err_t text_viewer_load_window(text_viewer_ctx_t *ctx, size_t first_of
     }
     joined[total] = '\0';
 
-    bool prev_suppress = ctx->suppress_events;
-    ctx->suppress_events = true;
-    lv_textarea_set_text(ctx->text_area, joined);
-    text_viewer_set_original(ctx, joined);
-    ctx->dirty = false;
-    text_viewer_update_buttons(ctx);
+    if (*encoding == FS_TEXT_ENC_UNKNOWN)
+    {
+        *encoding = fs_text_detect_encoding(joined, total);
+        if (fs_text_encoding_needs_transcode(*encoding))
+        {
+            ESP_LOGI(TAG, "%s looks like %s, showing it as UTF-8", path, fs_text_encoding_name(*encoding));
+        }
+    }
 
-    ctx->suppress_events = prev_suppress;
+    if (!fs_text_encoding_needs_transcode(*encoding))
+    {
+        *out_text = joined;
+        *out_len = total;
+        *out_boundary = len_a;
+        joined = NULL;
+        goto cleanup;
+    }
+
+    fs_text_map_t map;
+    err = fs_text_to_utf8(*encoding, joined, total, first_offset_kb == 0, READ_CHUNK_SIZE_B,
+                          out_text, out_len, &map);
+    if (err == ESP_OK)
+    {
+        *out_boundary = fs_text_map_to_utf8(&map, len_a);
+    }
 
 cleanup:
-    free(joined);
-    free(chunk_a);
-    free(chunk_b);
+    mem_plan_free(MEM_PLAN_FILE_IO, joined);
+    fs_text_release(chunk_a);
+    fs_text_release(chunk_b);
     return err;
 }
 
@@ -1147,6 +1233,8 @@ static void text_viewer_update_buttons(text_viewer_ctx_t *ctx)
     {
         lv_obj_add_state(ctx->save_btn, LV_STATE_DISABLED);
     }
+    lv_obj_set_state(ctx->undo_btn, LV_STATE_DISABLED, !text_editor_can_undo(ctx->text_area));
+    lv_obj_set_state(ctx->redo_btn, LV_STATE_DISABLED, !text_editor_can_redo(ctx->text_area));
 }
 
 static void text_viewer_show_keyboard(text_viewer_ctx_t *ctx, lv_obj_t *target)
@@ -1157,11 +1245,8 @@ static void text_viewer_show_keyboard(text_viewer_ctx_t *ctx, lv_obj_t *target)
     }
     if (target)
     {
-        lv_keyboard_set_textarea(ctx->keyboard, target);
-    }
-    else if (!lv_keyboard_get_textarea(ctx->keyboard))
-    {
-        lv_keyboard_set_textarea(ctx->keyboard, ctx->text_area);
+        /* The editor receives keys while the keyboard has no textarea assigned. */
+        lv_keyboard_set_textarea(ctx->keyboard, target == ctx->text_area ? NULL : target);
     }
     lv_obj_clear_flag(ctx->keyboard, LV_OBJ_FLAG_HIDDEN);
 }
@@ -1192,14 +1277,6 @@ static void text_viewer_on_text_area_clicked(lv_event_t *e)
     text_viewer_show_keyboard(ctx, ctx->text_area);
 }
 
-static void text_viewer_skip_cursor_animation(text_viewer_ctx_t *ctx)
-{
-    // Jump to the new cursor position immediately (skip the default scroll animation)
-    lv_point_t target_scroll = {0};
-    lv_obj_get_scroll_end(ctx->text_area, &target_scroll);
-    lv_obj_scroll_to(ctx->text_area, target_scroll.x, target_scroll.y, LV_ANIM_OFF);    
-}
-
 static void text_viewer_on_text_scrolled(lv_event_t *e)
 {
     text_viewer_ctx_t *ctx = lv_event_get_user_data(e);
@@ -1313,15 +1390,13 @@ static void text_viewer_on_text_changed(lv_event_t *e)
     {
         return;
     }
-    const char *text = lv_textarea_get_text(ctx->text_area);
-    const char *orig = ctx->original_text ? ctx->original_text : "";
-    bool dirty = strcmp(text, orig) != 0;
+    bool dirty = !text_editor_equals(ctx->text_area, ctx->original_text, ctx->original_len);
     if (dirty != ctx->dirty)
     {
         ctx->dirty = dirty;
-        text_viewer_update_buttons(ctx);
         text_viewer_set_status(ctx, dirty ? "Modified" : "Saved");
     }
+    text_viewer_update_buttons(ctx);
 }
 
 static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
@@ -1341,7 +1416,7 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
         return;
     }
 
-    const char *text = lv_textarea_get_text(ctx->text_area);
+    const char *text = text_editor_get_text(ctx->text_area);
     if (!text)
     {
         text = "";
@@ -1359,23 +1434,13 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
     size_t chunk_count = (second_kb > first_kb) ? (second_kb - first_kb + 1u) : 1u;
 
     /* Compute byte window for the currently loaded textarea (two chunks) */
-    if (first_kb > SIZE_MAX / 1024u || chunk_count > SIZE_MAX / READ_CHUNK_SIZE_B)
-    {
-        text_viewer_set_status(ctx, "Range overflow");
-        return;
-    }
-    size_t window_start = first_kb * 1024u;
-    size_t window_span = chunk_count * READ_CHUNK_SIZE_B;
-    size_t window_end = window_start + window_span;
-    if (window_end < window_start)
-    {
-        text_viewer_set_status(ctx, "Range overflow");
-        return;
-    }
+    uint64_t window_start = (uint64_t)first_kb * 1024u;
+    uint64_t window_span = (uint64_t)chunk_count * READ_CHUNK_SIZE_B;
+    uint64_t window_end = window_start + window_span;
 
     struct stat st = {0};
     bool have_existing = (stat(dest_path, &st) == 0 && S_ISREG(st.st_mode));
-    size_t file_size = have_existing ? (size_t)st.st_size : 0u;
+    uint64_t file_size = have_existing ? sd_file_size(dest_path, &st) : 0u;
 
     /* Clamp window to current file size to avoid seeking past EOF */
     if (window_start > file_size)
@@ -1387,9 +1452,9 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
         window_end = file_size;
     }
 
-    size_t prefix_size = window_start;
-    size_t suffix_start = window_end;
-    size_t suffix_size = (suffix_start < file_size) ? (file_size - suffix_start) : 0u;
+    uint64_t prefix_size = window_start;
+    uint64_t suffix_start = window_end;
+    uint64_t suffix_size = (suffix_start < file_size) ? (file_size - suffix_start) : 0u;
 
     /* Build temp path in same dir for atomic-ish replacement */
     char dir[FS_TEXT_MAX_PATH];
@@ -1454,10 +1519,10 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
     }
 
     char buf[READ_CHUNK_SIZE_B];
-    size_t remaining = prefix_size;
+    uint64_t remaining = prefix_size;
     while (remaining > 0)
     {
-        size_t chunk = remaining > sizeof(buf) ? sizeof(buf) : remaining;
+        size_t chunk = remaining > sizeof(buf) ? sizeof(buf) : (size_t)remaining;
         if (!src || fread(buf, 1, chunk, src) != chunk)
         {
             text_viewer_set_status(ctx, "Read failed");
@@ -1475,7 +1540,7 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
         remaining -= chunk;
     }
 
-    size_t text_len = strlen(text);
+    size_t text_len = text_editor_get_length(ctx->text_area);
     if (text_len > 0)
     {
         if (fwrite(text, 1, text_len, tmp) != text_len)
@@ -1489,10 +1554,18 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
 
     if (suffix_size > 0 && src)
     {
-        if (fseek(src, (long)suffix_start, SEEK_SET) != 0)
+        esp_err_t seek_err = sd_file_seek(src, suffix_start);
+        if (seek_err != ESP_OK)
         {
+            ESP_LOGE(TAG, "Failed to seek %s to %llu: %s", dest_path, (unsigned long long)suffix_start,
+                     esp_err_to_name(seek_err));
+            if (seek_err == ESP_ERR_INVALID_SIZE)
+            {
+                /* Beyond what stdio can address here; retrying would not help */
+                text_viewer_set_status(ctx, "File too large to save");
+                goto save_cleanup;
+            }
             text_viewer_set_status(ctx, "Seek failed");
-            ESP_LOGE(TAG, "Failed to seek %s to %zu", dest_path, suffix_start);
             text_viewer_schedule_sd_retry(ctx, TEXT_VIEWER_SD_SAVE);
             goto save_cleanup;
         }
@@ -1500,7 +1573,7 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
         remaining = suffix_size;
         while (remaining > 0)
         {
-            size_t chunk = remaining > sizeof(buf) ? sizeof(buf) : remaining;
+            size_t chunk = remaining > sizeof(buf) ? sizeof(buf) : (size_t)remaining;
             size_t got = fread(buf, 1, chunk, src);
             if (got != chunk)
             {
@@ -1543,9 +1616,10 @@ static void text_viewer_handle_save(text_viewer_ctx_t *ctx)
             return;
         }
     }
+    sd_journal_publish(have_existing ? SD_JOURNAL_MODIFIED : SD_JOURNAL_CREATED, dest_path, NULL, false);
 
-    size_t new_size = prefix_size + text_len + suffix_size;
-    ctx->max_file_offset_kb = (new_size > 0) ? ((new_size - 1u) / 1024u) : 0u;
+    uint64_t new_size = prefix_size + text_len + suffix_size;
+    ctx->max_file_offset_kb = (new_size > 0) ? (size_t)((new_size - 1u) / 1024u) : 0u;
     if (ctx->lasf_file_offset_kb > ctx->max_file_offset_kb)
     {
         ctx->lasf_file_offset_kb = ctx->max_file_offset_kb;
@@ -1582,6 +1656,26 @@ static void text_viewer_on_save(lv_event_t *e)
     text_viewer_handle_save(ctx);
 }
 
+static void text_viewer_on_undo(lv_event_t *e)
+{
+    text_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->editable)
+    {
+        return;
+    }
+    text_editor_undo(ctx->text_area);
+}
+
+static void text_viewer_on_redo(lv_event_t *e)
+{
+    text_viewer_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->editable)
+    {
+        return;
+    }
+    text_editor_redo(ctx->text_area);
+}
+
 static void text_viewer_on_back(lv_event_t *e)
 {
     text_viewer_ctx_t *ctx = lv_event_get_user_data(e);
@@ -1655,16 +1749,16 @@ static void text_viewer_apply_pending_chunk(text_viewer_ctx_t *ctx)
     esp_err_t err = text_viewer_load_window(ctx, ctx->pending_first_offset_kb, ctx->pending_second_offset_kb);
     if (err == ESP_OK)
     {
-        lv_coord_t content_h = lv_obj_get_content_height(ctx->text_area);
+        /* The editor scrolls to the cursor without animation. */
+        size_t content_h = (size_t)lv_obj_get_content_height(ctx->text_area);
         if (ctx->pending_scroll_up)
         {
-            lv_textarea_set_cursor_pos(ctx->text_area, (int32_t)READ_CHUNK_SIZE_B + content_h);
-            text_viewer_skip_cursor_animation(ctx);
+            text_editor_set_cursor_pos(ctx->text_area, ctx->window_boundary + content_h);
         }
         else
         {
-            lv_textarea_set_cursor_pos(ctx->text_area, (int32_t)READ_CHUNK_SIZE_B - content_h);
-            text_viewer_skip_cursor_animation(ctx);
+            size_t boundary = ctx->window_boundary;
+            text_editor_set_cursor_pos(ctx->text_area, boundary > content_h ? boundary - content_h : 0);
         }
         ctx->lasf_file_offset_kb = ctx->pending_first_offset_kb;
         ctx->current_file_offset_kb = ctx->pending_second_offset_kb;
@@ -1921,7 +2015,7 @@ static void text_viewer_show_name_dialog(text_viewer_ctx_t *ctx)
     lv_obj_add_state(ctx->name_textarea, LV_STATE_FOCUSED);
     lv_obj_clear_state(ctx->text_area, LV_STATE_FOCUSED);
     lv_obj_add_state(ctx->text_area, LV_STATE_DISABLED);
-    lv_textarea_set_cursor_click_pos(ctx->text_area, false);
+    text_editor_set_editable(ctx->text_area, false);
 
     lv_obj_t *save_btn = lv_msgbox_add_footer_button(dlg, "Save");
     lv_obj_set_user_data(save_btn, (void *)1);
@@ -1968,7 +2062,7 @@ static void text_viewer_close_name_dialog(text_viewer_ctx_t *ctx)
     ctx->name_dialog = NULL;
     ctx->name_textarea = NULL;
     lv_obj_clear_state(ctx->text_area, LV_STATE_DISABLED);
-    lv_textarea_set_cursor_click_pos(ctx->text_area, true);
+    text_editor_set_editable(ctx->text_area, ctx->editable);
     text_viewer_hide_keyboard(ctx);
 }
 
@@ -2122,12 +2216,15 @@ static void text_viewer_close(text_viewer_ctx_t *ctx, bool changed)
         ctx->path_label = NULL;
         ctx->status_label = NULL;
         ctx->save_btn = NULL;
+        ctx->undo_btn = NULL;
+        ctx->redo_btn = NULL;
         ctx->text_area = NULL;
         ctx->keyboard = NULL;
         ctx->chunk_slider = NULL;
     }
-    free(ctx->original_text);
+    mem_plan_free(MEM_PLAN_FILE_IO, ctx->original_text);
     ctx->original_text = NULL;
+    ctx->original_len = 0;
     if (ctx->return_screen)
     {
         lv_screen_load(ctx->return_screen);
@@ -0,0 +1,205 @@
+#include "viewer_registry.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "sd_io.h"
+
+#define TAG "viewer_reg"
+
+#define VIEWER_REGISTRY_HASH_SLOTS  64      /* power of two, at least twice VIEWER_REGISTRY_MAX_EXTS */
+#define VIEWER_REGISTRY_EXT_LEN     8       /* longest extension that can be registered, plus NUL */
+#define VIEWER_REGISTRY_LOW_HEAP_B  (32 * 1024)
+
+typedef struct {
+    uint32_t hash;
+    const char *ext;            /* NULL = empty slot */
+    uint8_t viewer;
+} viewer_ext_slot_t;
+
+static const viewer_desc_t *s_viewers[VIEWER_REGISTRY_MAX_VIEWERS];
+static bool s_opened[VIEWER_REGISTRY_MAX_VIEWERS];     /* opened since its last release */
+static size_t s_viewer_count;
+static viewer_ext_slot_t s_ext_table[VIEWER_REGISTRY_HASH_SLOTS];
+static size_t s_ext_count;
+
+/**
+ * @brief FNV-1a hash of @p ext, lowercased.
+ */
+static uint32_t viewer_registry_hash(const char *ext);
+
+/**
+ * @brief Copy the extension of @p name, lowercased, into @p out.
+ *
+ * @return false if @p name has no extension or it is too long to be registered.
+ */
+static bool viewer_registry_ext_of(const char *name, char *out, size_t out_len);
+
+/**
+ * @brief Match the first bytes of @p path against the registered signatures.
+ */
+static const viewer_desc_t *viewer_registry_find_magic(const char *path);
+
+esp_err_t viewer_registry_register(const viewer_desc_t *desc)
+{
+    if (!desc || !desc->name || !desc->open || desc->magic_len > VIEWER_REGISTRY_MAGIC_LEN ||
+        (desc->magic_len > 0 && !desc->magic)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < s_viewer_count; i++) {
+        if (s_viewers[i] == desc) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    if (s_viewer_count >= VIEWER_REGISTRY_MAX_VIEWERS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t ext_total = 0;
+    for (const char *const *ext = desc->extensions; ext && *ext; ext++) {
+        if ((*ext)[0] == '\0' || strlen(*ext) >= VIEWER_REGISTRY_EXT_LEN) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        ext_total++;
+    }
+    if (s_ext_count + ext_total > VIEWER_REGISTRY_MAX_EXTS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint8_t index = (uint8_t)s_viewer_count;
+    for (const char *const *ext = desc->extensions; ext && *ext; ext++) {
+        uint32_t hash = viewer_registry_hash(*ext);
+        size_t slot = hash & (VIEWER_REGISTRY_HASH_SLOTS - 1);
+        while (s_ext_table[slot].ext) {
+            if (s_ext_table[slot].hash == hash && strcasecmp(s_ext_table[slot].ext, *ext) == 0) {
+                /* First registration keeps the extension */
+                ESP_LOGW(TAG, "\".%s\" already belongs to %s, not to %s", *ext,
+                         s_viewers[s_ext_table[slot].viewer]->name, desc->name);
+                break;
+            }
+            slot = (slot + 1) & (VIEWER_REGISTRY_HASH_SLOTS - 1);
+        }
+        if (!s_ext_table[slot].ext) {
+            s_ext_table[slot] = (viewer_ext_slot_t){ .hash = hash, .ext = *ext, .viewer = index };
+            s_ext_count++;
+        }
+    }
+
+    s_viewers[index] = desc;
+    s_opened[index] = false;
+    s_viewer_count++;
+    return ESP_OK;
+}
+
+const viewer_desc_t *viewer_registry_find(const char *path, const char *name)
+{
+    char ext[VIEWER_REGISTRY_EXT_LEN];
+    if (name && viewer_registry_ext_of(name, ext, sizeof(ext))) {
+        uint32_t hash = viewer_registry_hash(ext);
+        size_t slot = hash & (VIEWER_REGISTRY_HASH_SLOTS - 1);
+        while (s_ext_table[slot].ext) {
+            if (s_ext_table[slot].hash == hash && strcasecmp(s_ext_table[slot].ext, ext) == 0) {
+                return s_viewers[s_ext_table[slot].viewer];
+            }
+            slot = (slot + 1) & (VIEWER_REGISTRY_HASH_SLOTS - 1);
+        }
+    }
+    return path ? viewer_registry_find_magic(path) : NULL;
+}
+
+esp_err_t viewer_registry_open(const viewer_desc_t *viewer, const viewer_open_req_t *req)
+{
+    if (!viewer || !req) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t index = s_viewer_count;
+    for (size_t i = 0; i < s_viewer_count; i++) {
+        if (s_viewers[i] == viewer) {
+            index = i;
+            break;
+        }
+    }
+    if (index == s_viewer_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t free_b = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (free_b < VIEWER_REGISTRY_LOW_HEAP_B) {
+        ESP_LOGI(TAG, "%u bytes free, releasing idle viewers before %s", (unsigned)free_b, viewer->name);
+        viewer_registry_release_idle(viewer);
+    }
+
+    s_opened[index] = true;
+    return viewer->open(req);
+}
+
+void viewer_registry_release_idle(const viewer_desc_t *keep)
+{
+    for (size_t i = 0; i < s_viewer_count; i++) {
+        if (s_viewers[i] == keep || !s_opened[i]) {
+            continue;
+        }
+        if (s_viewers[i]->release) {
+            s_viewers[i]->release();
+        }
+        s_opened[i] = false;
+    }
+}
+
+static uint32_t viewer_registry_hash(const char *ext)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *c = ext; *c; c++) {
+        hash ^= (uint8_t)tolower((unsigned char)*c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool viewer_registry_ext_of(const char *name, char *out, size_t out_len)
+{
+    const char *dot = strrchr(name, '.');
+    if (!dot || dot[1] == '\0') {
+        return false;
+    }
+    size_t len = strlen(dot + 1);
+    if (len >= out_len) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        out[i] = (char)tolower((unsigned char)dot[1 + i]);
+    }
+    out[len] = '\0';
+    return true;
+}
+
+static const viewer_desc_t *viewer_registry_find_magic(const char *path)
+{
+    bool any = false;
+    for (size_t i = 0; i < s_viewer_count; i++) {
+        any |= (s_viewers[i]->magic_len > 0);
+    }
+    if (!any) {
+        return NULL;
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    uint8_t head[VIEWER_REGISTRY_MAGIC_LEN];
+    size_t len = sd_io_read(head, sizeof(head), f, SD_IO_INTERACTIVE);
+    fclose(f);
+
+    for (size_t i = 0; i < s_viewer_count; i++) {
+        const viewer_desc_t *v = s_viewers[i];
+        if (v->magic_len > 0 && v->magic_len <= len && memcmp(head, v->magic, v->magic_len) == 0) {
+            return v;
+        }
+    }
+    return NULL;
+}
@@ -19,6 +19,10 @@ typedef struct {
  * whose source is the provided @p path. On close, it returns to @p return_screen
  * if provided; otherwise it loads the previously active screen.
  *
+ * Only the JPEG header is parsed before returning. The picture is decoded by a
+ * background task that draws it top to bottom, one MCU row at a time, while
+ * LVGL keeps running; closing the viewer cancels the decode.
+ *
  * @param opts Options struct (must not be NULL); @p path must be non-empty.
  * @return 
  *         - ESP_OK on success
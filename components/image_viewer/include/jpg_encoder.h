@@ -0,0 +1,74 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/**
+ * @brief Sink for encoded bytes.
+ *
+ * @param data     Encoded bytes.
+ * @param len      Number of bytes in @p data.
+ * @param user_ctx Context given to jpg_encoder_create().
+ * @return ESP_OK to continue; any other value aborts the encode and is
+ *         returned by the encoder call that triggered the write.
+ */
+typedef esp_err_t (*jpg_encoder_write_cb_t)(const void *data, size_t len, void *user_ctx);
+
+typedef struct jpg_encoder jpg_encoder_t;
+
+/**
+ * @brief Create a streaming baseline JPEG encoder (YCbCr 4:2:0, standard tables).
+ *
+ * Memory is bounded by one MCU row (16 lines) of the image width, independent
+ * of the image height. The headers are written immediately.
+ *
+ * @param width    Image width in pixels (1..65535).
+ * @param height   Image height in pixels (1..65535).
+ * @param quality  Quality 1..100 (IJG scaling of the Annex K tables).
+ * @param write_cb Output sink.
+ * @param user_ctx Passed to @p write_cb.
+ * @param[out] ret_enc New encoder; delete it with jpg_encoder_delete().
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM or the sink's error.
+ */
+esp_err_t jpg_encoder_create(uint16_t width, uint16_t height, uint8_t quality,
+                             jpg_encoder_write_cb_t write_cb, void *user_ctx,
+                             jpg_encoder_t **ret_enc);
+
+/**
+ * @brief Feed the next source lines, top to bottom.
+ *
+ * Each completed 16-line band is compressed and handed to the sink right away.
+ *
+ * @param enc    Encoder.
+ * @param rgb    First line, RGB888 (R, G, B byte order), @c width pixels.
+ * @param stride Distance between lines in bytes.
+ * @param rows   Number of lines.
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if more lines than the image height are
+ *         given, or the sink's error.
+ */
+esp_err_t jpg_encoder_write_rows(jpg_encoder_t *enc, const uint8_t *rgb, size_t stride, uint16_t rows);
+
+/**
+ * @brief Compress the last partial band and write the end-of-image marker.
+ *
+ * @param enc Encoder that has received exactly @c height lines.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if lines are missing, or the sink's error.
+ */
+esp_err_t jpg_encoder_finish(jpg_encoder_t *enc);
+
+/**
+ * @brief Release an encoder. Does not write anything.
+ *
+ * @param enc Encoder (may be NULL).
+ */
+void jpg_encoder_delete(jpg_encoder_t *enc);
+
+#ifdef __cplusplus
+}
+#endif
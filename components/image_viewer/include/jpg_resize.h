@@ -0,0 +1,76 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/** Suffix appended to the file stem of every resized copy ("IMG_1.JPG" -> "IMG_1_small.jpg"). */
+#define JPG_RESIZE_SUFFIX "_small"
+
+typedef struct {
+    uint32_t converted;     /**< Images written. */
+    uint32_t skipped;       /**< Sources whose output already existed. */
+    uint32_t failed;        /**< Unsupported, unreadable or unwritable images. */
+    uint64_t bytes_in;      /**< Size of the converted sources. */
+    uint64_t bytes_out;     /**< Size of the written copies. */
+    uint64_t pixels_in;     /**< Source pixels of the converted images (before DCT scaling). */
+    uint32_t elapsed_ms;    /**< Wall time of the whole job. */
+} jpg_resize_stats_t;
+
+/**
+ * @brief Completion callback.
+ *
+ * Runs on the job task. Take the display lock before touching LVGL.
+ *
+ * @param stats    Totals for the job.
+ * @param err      ESP_OK, or the error that stopped the job early (e.g. the
+ *                 source folder could not be opened).
+ * @param user_ctx Context from @ref jpg_resize_opts_t.
+ */
+typedef void (*jpg_resize_done_cb_t)(const jpg_resize_stats_t *stats, esp_err_t err, void *user_ctx);
+
+typedef struct {
+    const char *src_path;           /**< A JPEG file, or a folder whose JPEGs are all converted (not recursive). */
+    const char *dest_dir;           /**< Existing folder receiving the copies. */
+    uint16_t max_width;             /**< Copies fit in max_width x max_height; smaller images keep their size. */
+    uint16_t max_height;
+    uint8_t quality;                /**< JPEG quality 1..100. */
+    jpg_resize_done_cb_t on_done;   /**< Optional completion callback. */
+    void *user_ctx;                 /**< Passed to @p on_done. */
+} jpg_resize_opts_t;
+
+/**
+ * @brief Start a background job writing reduced JPEG copies to a folder.
+ *
+ * Each image is decoded at the largest DCT scale (1/1..1/8) that still covers
+ * the target size, area-resampled to the target and re-encoded as baseline
+ * JPEG, all one MCU row at a time. Memory use depends on the image width only.
+ * Per-image timing and throughput are logged; totals go to @p on_done.
+ *
+ * Sources whose names already end in @ref JPG_RESIZE_SUFFIX are ignored, and
+ * existing outputs are never overwritten.
+ *
+ * @param opts Options; the strings are copied.
+ * @return
+ *      - ESP_OK if the job was started
+ *      - ESP_ERR_INVALID_ARG on bad options or paths that don't fit
+ *      - ESP_ERR_INVALID_STATE if a job is already running or the card is being reformatted
+ *      - ESP_ERR_NO_MEM if the job task can't be created
+ */
+esp_err_t jpg_resize_start(const jpg_resize_opts_t *opts);
+
+/**
+ * @brief Check whether a resize job is in progress.
+ *
+ * @return true while the job task is alive.
+ */
+bool jpg_resize_is_running(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -6,23 +6,37 @@
 #include "bsp/esp-bsp.h"
 #include "esp_err.h"
 #include "esp_log.h"
-#include "esp_heap_caps.h"
 #include "esp_lcd_panel_ops.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "lvgl/src/libs/tjpgd/tjpgd.h"
 #include "lvgl/src/misc/lv_fs.h"
+#include "mem_plan.h"
+#include "sd_io.h"
+#include "worker_pool.h"
 
 #define TAG "jpg_viewer"
 #define IMG_VIEWER_MAX_PATH 256
 
+#define JPG_DECODE_WORKBUF_SIZE_B   (4096)
+
 typedef struct {
     lv_fs_file_t file;
     esp_lcd_panel_handle_t panel;
-    uint16_t *stripe;               /* DMA-capable stripe buffer */
+    JDEC jd;
+    uint32_t workb[JPG_DECODE_WORKBUF_SIZE_B / sizeof(uint32_t)];  /* tjpgd work buffer (word aligned) */
+    uint16_t *stripe[2];            /* DMA-capable stripe buffers: one is filled while the other is sent */
+    uint8_t fill;                   /* Index of the stripe currently being filled */
+    bool drawn;                     /* At least one stripe was handed to the panel */
+    int32_t row_top;                /* First line of the MCU row being collected, -1 when empty */
+    int32_t row_bottom;             /* Last line of the MCU row being collected */
     uint32_t stripe_w;
     uint32_t stripe_h;
     uint16_t disp_w;
     uint16_t disp_h;
     uint8_t scale;
+    uint32_t generation;            /* Viewer generation this decode belongs to */
+    lv_obj_t *close_btn;
 } jpg_stripe_ctx_t;
 
 typedef struct {
@@ -38,12 +52,20 @@ typedef struct {
 
 static jpg_viewer_ctx_t s_jpg_viewer;
 
+/*
+ * Bumped (under the display lock) whenever the viewer screen goes away or is
+ * replaced. A decode job whose generation no longer matches stops at its next
+ * stripe. Kept outside s_jpg_viewer because jpg_viewer_reset() wipes the context.
+ */
+static volatile uint32_t s_jpg_decode_gen;
+
 /**
  * @brief Destroy the currently active JPG viewer screen and reset its context.
  *
  * This helper deletes the LVGL screen associated with the viewer (if any)
- * under a display lock, then calls jpg_viewer_reset() to clear the context.
- * If the context is NULL or not active, it simply resets the context.
+ * under a display lock, cancels a decode still in progress, then calls
+ * jpg_viewer_reset() to clear the context. If the context is NULL or not
+ * active, it simply resets the context.
  *
  * @param ctx Pointer to the viewer context to destroy.
  */
@@ -63,47 +85,97 @@ static void jpg_viewer_destroy_active(jpg_viewer_ctx_t *ctx);
 static void jpg_viewer_build_ui(jpg_viewer_ctx_t *ctx, const char *path);
 
 /**
- * @brief Render the JPEG at the given path to the display panel.
+ * @brief Reset the JPG viewer context to a clean state.
  *
- * This function validates the LVGL image object and path, retrieves the
- * display panel from the BSP and calls jpg_draw_striped() to decode and
- * draw the JPEG in stripes.
+ * This function clears the entire context structure to zero. It is safe to
+ * call with a NULL ctx pointer (no action is taken in that case).
  *
- * @param img  LVGL image object associated with the viewer (not used for
- *             rendering in this implementation, but kept for API symmetry).
- * @param path Path to the JPEG file to be rendered.
+ * @param ctx Pointer to the viewer context to reset.
+ */
+static void jpg_viewer_reset(jpg_viewer_ctx_t *ctx);
+
+/**
+ * @brief LVGL event callback used to close the JPG viewer.
+ *
+ * This callback is attached to the close button. It retrieves the viewer
+ * context from the event user data, switches back to the return screen
+ * (or the previous screen if no explicit return screen is set), deletes
+ * the viewer screen and resets the context. A decode still in progress is
+ * cancelled and draws nothing after this returns.
+ *
+ * @param e Pointer to the LVGL event descriptor.
+ */
+static void jpg_viewer_on_close(lv_event_t *e);
+
+/**
+ * @brief Open a JPEG file and prepare it for striped decoding.
+ *
+ * Parses the JPEG header, picks the smallest power-of-two downscale that fits
+ * the panel and allocates the stripe buffers. Nothing is drawn yet; the
+ * returned context is handed to jpg_decode_run().
+ *
+ * @param path    Path to the JPEG file in the LVGL filesystem.
+ * @param panel   Handle to the LCD panel used for drawing.
+ * @param ret_ctx Receives the prepared context; free it with jpg_decode_free().
  *
  * @return
  *      - ESP_OK on success
- *      - ESP_ERR_INVALID_ARG if img or path is invalid
- *      - ESP_ERR_INVALID_STATE if no valid panel is available
+ *      - ESP_FAIL on file open or decoder prepare failure
+ *      - ESP_ERR_NO_MEM if the context or stripe buffers can't be allocated
  *      - ESP_ERR_NOT_SUPPORTED if the jpg file is corrupted or it's specific type is not supported
  *      - ESP_ERR_INVALID_SIZE if the image can't fit in the screen even after the downscale
  */
-static esp_err_t jpg_handler_set_src(lv_obj_t *img, const char *path);
+static esp_err_t jpg_decode_prepare(const char *path, esp_lcd_panel_handle_t panel, jpg_stripe_ctx_t **ret_ctx);
 
 /**
- * @brief Reset the JPG viewer context to a clean state.
+ * @brief Worker pool job decoding a prepared JPEG to the panel.
  *
- * This function stops and deletes the dim timer (if any) and clears the
- * entire context structure to zero. It is safe to call with a NULL ctx
- * pointer (no action is taken in that case).
+ * Runs jd_decomp(), which streams MCU rows to the panel top to bottom through
+ * output_cb(). The display lock is only held while a finished row is sent, so
+ * LVGL keeps rendering and handling touch between rows. Frees @p arg when done
+ * or cancelled; cancellation goes through the viewer generation, not the pool.
  *
- * @param ctx Pointer to the viewer context to reset.
+ * @param job Unused.
+ * @param arg Context returned by jpg_decode_prepare().
  */
-static void jpg_viewer_reset(jpg_viewer_ctx_t *ctx);
+static void jpg_decode_run(worker_pool_job_t *job, void *arg);
 
 /**
- * @brief LVGL event callback used to close the JPG viewer.
+ * @brief Pool discard callback: free a decode context that never ran.
  *
- * This callback is attached to the close button. It retrieves the viewer
- * context from the event user data, switches back to the return screen
- * (or the previous screen if no explicit return screen is set), deletes
- * the viewer screen and resets the context.
+ * @param arg Context returned by jpg_decode_prepare().
+ */
+static void jpg_decode_discard(void *arg);
+
+/**
+ * @brief Send the collected MCU row to the panel and switch stripe buffers.
  *
- * @param e Pointer to the LVGL event descriptor.
+ * Takes the display lock for the duration of the transfer setup. If the close
+ * button overlaps the row it is invalidated, so LVGL repaints it on top of the
+ * image in its next frame.
+ *
+ * @param ctx Decode context.
+ * @return false if the decode was cancelled, true otherwise.
  */
-static void jpg_viewer_on_close(lv_event_t *e);
+static bool jpg_decode_flush_row(jpg_stripe_ctx_t *ctx);
+
+/**
+ * @brief Check whether the viewer that started this decode has gone away.
+ *
+ * @param ctx Decode context.
+ * @return true if the decode should stop.
+ */
+static inline bool jpg_decode_cancelled(const jpg_stripe_ctx_t *ctx);
+
+/**
+ * @brief Close the file and release a decode context and its stripe buffers.
+ *
+ * If a stripe was sent to the panel, waits for the transfer to complete before
+ * the buffers are freed.
+ *
+ * @param ctx Decode context (may be NULL).
+ */
+static void jpg_decode_free(jpg_stripe_ctx_t *ctx);
 
 /**
  * @brief TJpgDec input callback for reading from LVGL filesystem.
@@ -116,17 +188,17 @@ static void jpg_viewer_on_close(lv_event_t *e);
  * @param buff   Destination buffer to read into, or NULL to skip data.
  * @param nbytes Number of bytes to read or skip.
  *
- * @return Number of bytes actually read or skipped, or 0 on error.
+ * @return Number of bytes actually read or skipped, or 0 on error or cancellation.
  */
 static size_t input_cb(JDEC *jd, uint8_t *buff, size_t nbytes);
 
 /**
- * @brief TJpgDec output callback to convert and push decoded pixels to the panel.
+ * @brief TJpgDec output callback collecting decoded MCUs into a row stripe.
  *
- * The decoder provides a rectangular block of pixels in RGB888 format. This
- * callback converts the block to RGB565, applying the required BGR swap, and
- * stores it into a stripe buffer. The buffer is then drawn to the display
- * using esp_lcd_panel_draw_bitmap().
+ * The decoder provides a rectangular block of pixels in RGB888 format, already
+ * reduced to the requested scale. This callback converts the block to RGB565,
+ * applying the required BGR swap, and stores it at its column in the current stripe buffer. When the decoder moves
+ * on to the next MCU row, the finished row is sent with jpg_decode_flush_row().
  *
  * @param jd      Pointer to the TJpgDec decoder object.
  * @param bitmap  Pointer to the decoded pixel data (RGB888).
@@ -134,30 +206,24 @@ static size_t input_cb(JDEC *jd, uint8_t *buff, size_t nbytes);
  *
  * @return
  *      - 1 to continue decoding
- *      - 0 to abort decoding due to error or invalid parameters
+ *      - 0 to abort decoding due to error, invalid parameters or cancellation
  */
 static int output_cb(JDEC *jd, void *bitmap, JRECT *rect);
 
 /**
- * @brief Decode and draw a JPEG image in stripes directly to an LCD panel.
+ * @brief Pack an RGB888 pixel into RGB565 in the panel's byte order.
  *
- * This function opens the JPEG file using LVGL's filesystem API, prepares
- * a TJpgDec decoder instance and allocates a stripe buffer sized according
- * to the MCU height and image width. The image is then decompressed via
- * jd_decomp(), which repeatedly calls input_cb() and output_cb() to stream
- * the image to the panel without loading it fully into memory.
+ * Produces the same layout LVGL renders with (RGB565_SWAPPED on big-endian
+ * SPI panels), so stripes can be sent with esp_lcd_panel_draw_bitmap()
+ * without a separate byte-swap step.
  *
- * @param path  Path to the JPEG file in the LVGL filesystem.
- * @param panel Handle to the LCD panel used for drawing.
+ * @param r Red channel (8 bit).
+ * @param g Green channel (8 bit).
+ * @param b Blue channel (8 bit).
  *
- * @return
- *      - ESP_OK on successful decode and draw
- *      - ESP_FAIL on file open, decoder prepare or decode failure
- *      - ESP_ERR_NO_MEM if the stripe buffer allocation fails
- *      - ESP_ERR_NOT_SUPPORTED if the jpg file is corrupted or it's specific type is not supported
- *      - ESP_ERR_INVALID_SIZE if the image can't fit in the screen even after the downscale
+ * @return Pixel ready to be written to the panel.
  */
-static esp_err_t jpg_draw_striped(const char *path, esp_lcd_panel_handle_t panel);
+static inline uint16_t jpg_pack_panel_rgb565(uint8_t r, uint8_t g, uint8_t b);
 
 esp_err_t jpg_viewer_open(const jpg_viewer_open_opts_t *opts)
 {
@@ -171,10 +237,25 @@ esp_err_t jpg_viewer_open(const jpg_viewer_open_opts_t *opts)
         jpg_viewer_destroy_active(ctx);
     }
 
+    esp_lcd_panel_handle_t panel = bsp_display_get_panel();
+    if (!panel) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* Header errors are reported synchronously so the caller can show its prompts */
+    jpg_stripe_ctx_t *job = NULL;
+    esp_err_t err = jpg_decode_prepare(opts->path, panel, &job);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to render image: (%s)", esp_err_to_name(err));
+        jpg_viewer_reset(ctx);
+        return err;
+    }
+
     ctx->return_screen = opts->return_screen;
     strlcpy(ctx->path, opts->path, sizeof(ctx->path));
 
     if (!bsp_display_lock(0)) {
+        jpg_decode_free(job);
         return ESP_ERR_TIMEOUT;
     }
 
@@ -186,24 +267,37 @@ esp_err_t jpg_viewer_open(const jpg_viewer_open_opts_t *opts)
     /* Force a refresh now so subsequent LVGL cycles don't clear our direct draw */
     lv_refr_now(NULL);
 
-    esp_err_t err = jpg_handler_set_src(ctx->image, opts->path);
+    job->generation = ++s_jpg_decode_gen;
+    job->close_btn = ctx->close_btn;
+
+    /*
+     * Interactive class, still below LVGL: it won't draw before we release the lock anyway.
+     * Never coalesced: a decode left over from the previous image stops on its own.
+     */
+    const worker_pool_submit_opts_t pool_opts = {
+        .name = "jpg_decode",
+        .key = "",
+        .cls = WORKER_POOL_INTERACTIVE,
+        .fn = jpg_decode_run,
+        .arg = job,
+        .discard = jpg_decode_discard,
+    };
+    err = worker_pool_submit(&pool_opts, NULL);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to render image: (%s)", esp_err_to_name(err));
+        ESP_LOGE(TAG, "Failed to queue JPEG decode: %s", esp_err_to_name(err));
         if (ctx->previous_screen) {
             lv_screen_load(ctx->previous_screen);
         }
         lv_obj_del(ctx->screen);
         ctx->screen = NULL;
         bsp_display_unlock();
+        jpg_decode_free(job);
         jpg_viewer_reset(ctx);
         return err;
     }
 
-    lv_obj_set_style_opa(ctx->close_btn, LV_OPA_100, LV_PART_MAIN);
-
-    bsp_display_unlock();
-
     ctx->active = true;
+    bsp_display_unlock();
     return ESP_OK;
 }
 
@@ -215,6 +309,7 @@ static void jpg_viewer_destroy_active(jpg_viewer_ctx_t *ctx)
     }
 
     if (bsp_display_lock(0)) {
+        s_jpg_decode_gen++;
         if (ctx->screen) {
             lv_obj_del(ctx->screen);
         }
@@ -246,22 +341,6 @@ static void jpg_viewer_build_ui(jpg_viewer_ctx_t *ctx, const char *path)
     lv_obj_center(close_lbl);
 }
 
-static esp_err_t jpg_handler_set_src(lv_obj_t *img, const char *path)
-{
-    if (!img || !path || path[0] == '\0') {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    esp_lcd_panel_handle_t panel = bsp_display_get_panel();
-    if (!panel) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    esp_err_t err = jpg_draw_striped(path, panel);
-
-    return err;
-}
-
 static void jpg_viewer_reset(jpg_viewer_ctx_t *ctx)
 {
     if (!ctx) {
@@ -281,6 +360,9 @@ static void jpg_viewer_on_close(lv_event_t *e)
         return;
     }
 
+    /* The decode job checks this under the same lock before every stripe */
+    s_jpg_decode_gen++;
+
     lv_obj_t *old_screen = ctx->screen;
     lv_obj_t *target = ctx->return_screen ? ctx->return_screen : ctx->previous_screen;
     if (target) {
@@ -295,17 +377,202 @@ static void jpg_viewer_on_close(lv_event_t *e)
     jpg_viewer_reset(ctx);
 }
 
+static esp_err_t jpg_decode_prepare(const char *path, esp_lcd_panel_handle_t panel, jpg_stripe_ctx_t **ret_ctx)
+{
+    esp_err_t err = ESP_OK;
+
+    /* Internal RAM: tjpgd hits its work buffer for every MCU */
+    jpg_stripe_ctx_t *ctx = mem_plan_calloc(MEM_PLAN_IMAGE, 1, sizeof(*ctx));
+    if (!ctx) {
+        ESP_LOGE(TAG, "Failed to allocate memory for the JPEG decoder");
+        return ESP_ERR_NO_MEM;
+    }
+    ctx->panel = panel;
+    ctx->disp_w = BSP_LCD_H_RES;
+    ctx->disp_h = BSP_LCD_V_RES;
+    ctx->row_top = -1;
+
+    lv_fs_res_t res = lv_fs_open(&ctx->file, path, LV_FS_MODE_RD);
+    if (res != LV_FS_RES_OK) {
+        ESP_LOGE(TAG, "Failed to open image file, lv_fs_res: (%d)", res);
+        mem_plan_free(MEM_PLAN_IMAGE, ctx);
+        return ESP_FAIL;
+    }
+
+    JDEC *jd = &ctx->jd;
+    JRESULT rc = jd_prepare(jd, input_cb, ctx->workb, sizeof(ctx->workb), ctx);
+    if (rc != JDR_OK) {
+        ESP_LOGE(TAG, "Failed to initialize tjpgd decoder, JRESULT: (%d)", rc);
+        if (rc == JDR_INP || rc == JDR_FMT1 || rc == JDR_FMT2 || rc == JDR_FMT3){
+            err = ESP_ERR_NOT_SUPPORTED;
+        }else{
+            err = ESP_FAIL;
+        }
+        goto cleanup;
+    }
+
+    /* Choose the smallest power-of-two downscale that fits the panel */
+    uint32_t scaled_w = jd->width;
+    uint32_t scaled_h = jd->height;
+    while (ctx->scale < 3 && (scaled_w > ctx->disp_w || scaled_h > ctx->disp_h)) {
+        ctx->scale++;
+        scaled_w = (scaled_w + 1) >> 1;
+        scaled_h = (scaled_h + 1) >> 1;
+    }
+
+    if (scaled_w > ctx->disp_w || scaled_h > ctx->disp_h) {
+        ESP_LOGE(TAG, "Image %ux%u is too large to fit display %ux%u even at 1/%u scale",
+                 jd->width, jd->height, ctx->disp_w, ctx->disp_h, 1U << ctx->scale);
+        err = ESP_ERR_INVALID_SIZE;
+        goto cleanup;
+    }
+
+    ESP_LOGD(TAG, "Drawing JPEG %ux%u scaled 1/%u -> %lux%lu",
+             jd->width, jd->height, 1U << ctx->scale,
+             (unsigned long)scaled_w, (unsigned long)scaled_h);
+
+    /*
+     * A stripe holds one full MCU row. tjpgd scales each MCU separately and
+     * rounds down, so the row is the sum of the per-MCU widths.
+     */
+    const uint32_t mcu_w = jd->msx * 8u;
+    ctx->stripe_w = (jd->width / mcu_w) * (mcu_w >> ctx->scale) + ((jd->width % mcu_w) >> ctx->scale);
+    ctx->stripe_h = (uint32_t)((jd->msy * 8u) >> ctx->scale);
+    if (ctx->stripe_w == 0 || ctx->stripe_h == 0) {
+        err = ESP_ERR_INVALID_SIZE;
+        goto cleanup;
+    }
+    size_t stripe_size = ctx->stripe_w * ctx->stripe_h * sizeof(uint16_t);
+    ESP_LOGD(TAG, "Stripe size is 2x%u", (unsigned)stripe_size);
+    for (int i = 0; i < 2; i++) {
+        ctx->stripe[i] = mem_plan_alloc(MEM_PLAN_IMAGE, stripe_size);
+        if (!ctx->stripe[i]) {
+            ESP_LOGE(TAG, "Failed to allocate memory for the stripe buffer used for image draw");
+            err = ESP_ERR_NO_MEM;
+            goto cleanup;
+        }
+    }
+
+    *ret_ctx = ctx;
+    return ESP_OK;
+
+cleanup:
+    jpg_decode_free(ctx);
+    return err;
+}
+
+static void jpg_decode_run(worker_pool_job_t *job, void *arg)
+{
+    jpg_stripe_ctx_t *ctx = arg;
+
+    JRESULT rc = jd_decomp(&ctx->jd, output_cb, ctx->scale); /* scale: 0=full, 1=1/2, 2=1/4, 3=1/8 */
+    if (rc == JDR_OK && !jpg_decode_flush_row(ctx)) {
+        rc = JDR_INTR;
+    }
+
+    if (jpg_decode_cancelled(ctx)) {
+        ESP_LOGD(TAG, "JPEG decode cancelled");
+    } else if (rc != JDR_OK) {
+        /* The screen stays up with whatever was drawn; the close button still works */
+        ESP_LOGE(TAG, "Failed to draw image, JRESULT: (%d)", rc);
+    }
+
+    if (bsp_display_lock(0)) {
+        if (!jpg_decode_cancelled(ctx)) {
+            /* Dim the close button once the picture is complete */
+            lv_obj_set_style_opa(ctx->close_btn, LV_OPA_100, LV_PART_MAIN);
+        }
+        bsp_display_unlock();
+    }
+
+    jpg_decode_free(ctx);
+}
+
+static void jpg_decode_discard(void *arg)
+{
+    jpg_decode_free(arg);
+}
+
+static bool jpg_decode_flush_row(jpg_stripe_ctx_t *ctx)
+{
+    if (ctx->row_top < 0) {
+        return !jpg_decode_cancelled(ctx);
+    }
+
+    const int32_t top = ctx->row_top;
+    const int32_t bottom = (ctx->row_bottom < (ctx->disp_h - 1)) ? ctx->row_bottom : (int32_t)(ctx->disp_h - 1);
+    ctx->row_top = -1;
+
+    if (!bsp_display_lock(0)) {
+        return false;
+    }
+    if (jpg_decode_cancelled(ctx)) {
+        bsp_display_unlock();
+        return false;
+    }
+
+    if (top <= bottom) {
+        esp_lcd_panel_draw_bitmap(ctx->panel, 0, top, (int)ctx->stripe_w, bottom + 1, ctx->stripe[ctx->fill]);
+        ctx->drawn = true;
+
+        lv_area_t btn_area;
+        lv_obj_get_coords(ctx->close_btn, &btn_area);
+        if (btn_area.y1 <= bottom && btn_area.y2 >= top) {
+            lv_obj_invalidate(ctx->close_btn);
+        }
+    }
+    bsp_display_unlock();
+
+    /*
+     * The transfer runs in the background. The next draw call waits for it
+     * before sending its own commands, so fill the other buffer meanwhile.
+     */
+    ctx->fill ^= 1;
+    return true;
+}
+
+static inline bool jpg_decode_cancelled(const jpg_stripe_ctx_t *ctx)
+{
+    return ctx->generation != s_jpg_decode_gen;
+}
+
+static void jpg_decode_free(jpg_stripe_ctx_t *ctx)
+{
+    if (!ctx) {
+        return;
+    }
+
+    if (ctx->drawn && bsp_display_lock(0)) {
+        /* A command transaction waits for queued pixel data, so the stripes are idle afterwards */
+        esp_lcd_panel_disp_on_off(ctx->panel, true);
+        bsp_display_unlock();
+    }
+
+    lv_fs_close(&ctx->file);
+    for (int i = 0; i < 2; i++) {
+        mem_plan_free(MEM_PLAN_IMAGE, ctx->stripe[i]);
+    }
+    mem_plan_free(MEM_PLAN_IMAGE, ctx);
+}
+
 static size_t input_cb(JDEC *jd, uint8_t *buff, size_t nbytes)
 {
     jpg_stripe_ctx_t *ctx = (jpg_stripe_ctx_t *)jd->device;
     if (!ctx) {
         return 0;
     }
+    /* generation is 0 while jpg_decode_prepare() parses the header */
+    if (ctx->generation != 0 && jpg_decode_cancelled(ctx)) {
+        return 0;
+    }
     lv_fs_file_t *f = &ctx->file;
 
     if (buff) {
         uint32_t rn = 0;
+        /* The user is watching the picture build up: ahead of resize jobs and crawls */
+        sd_io_begin(SD_IO_INTERACTIVE);
         lv_fs_res_t res = lv_fs_read(f, buff, (uint32_t)nbytes, &rn);
+        sd_io_end();
         return (res == LV_FS_RES_OK) ? rn : 0;
     }
 
@@ -326,145 +593,45 @@ static int output_cb(JDEC *jd, void *bitmap, JRECT *rect)
         return 0;
     }
 
+    /* tjpgd walks MCUs left to right, so a new top means the previous row is complete */
+    if (ctx->row_top >= 0 && rect->top != ctx->row_top) {
+        if (!jpg_decode_flush_row(ctx)) {
+            return 0;
+        }
+    }
+
     const int w = rect->right - rect->left + 1;
     const int h = rect->bottom - rect->top + 1;
 
     /* Ensure stripe buffer is large enough */
-    if ((uint32_t)w > ctx->stripe_w || (uint32_t)h > ctx->stripe_h) {
+    if ((uint32_t)rect->right >= ctx->stripe_w || (uint32_t)h > ctx->stripe_h) {
         return 0;
     }
 
-    uint8_t *src = (uint8_t *)bitmap; /* RGB888 from tjpgd (JD_FORMAT=0) */
-    uint16_t *dst = ctx->stripe;
-    const int src_stride = (int)(jd->msx * 8); /* tjpgd always outputs full MCU width */
-    const int scale = ctx->scale;
-    for (int y = 0; y < h; y++) {
-        const int sy = y << scale; /* top-left sampling for downscale */
-        uint8_t *src_row = src + (sy * src_stride * 3);
-        uint16_t *dst_row = dst + y * w;
-        for (int x = 0; x < w; x++) {
-            const int sx = x << scale;
-            int idx = sx * 3;
-            /* Panel is configured BGR; swap R and B, then pack RGB565 and swap bytes */
-            uint8_t b = src_row[idx];
-            uint8_t g = src_row[idx + 1];
-            uint8_t r = src_row[idx + 2];
-            uint16_t c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
-            c = (uint16_t)((c >> 8) | (c << 8));
-            dst_row[x] = c;
-        }
+    if (ctx->row_top < 0) {
+        ctx->row_top = rect->top;
+        ctx->row_bottom = rect->bottom;
     }
 
-    /* Clip to panel bounds to avoid wrap-around when images exceed display size */
-    if (rect->left >= ctx->disp_w || rect->top >= ctx->disp_h) {
-        return 1;
-    }
-
-    const int draw_left = rect->left;
-    const int draw_top = rect->top;
-    const int draw_right = (rect->right < (ctx->disp_w - 1)) ? rect->right : (int)(ctx->disp_w - 1);
-    const int draw_bottom = (rect->bottom < (ctx->disp_h - 1)) ? rect->bottom : (int)(ctx->disp_h - 1);
-    const int clipped_w = draw_right - draw_left + 1;
-    const int clipped_h = draw_bottom - draw_top + 1;
-
-    if (clipped_w <= 0 || clipped_h <= 0) {
-        return 1;
-    }
-
-    if (clipped_w == w && clipped_h == h) {
-        esp_lcd_panel_draw_bitmap(ctx->panel,
-                                  draw_left, draw_top,
-                                  draw_right + 1, draw_bottom + 1,
-                                  dst);
-    } else {
-        for (int row = 0; row < clipped_h; row++) {
-            esp_lcd_panel_draw_bitmap(ctx->panel,
-                                      draw_left, draw_top + row,
-                                      draw_left + clipped_w, draw_top + row + 1,
-                                      dst + (row * w));
+    const uint8_t *src = (const uint8_t *)bitmap; /* BGR888 from tjpgd (JD_FORMAT=0), already descaled */
+    uint16_t *dst = ctx->stripe[ctx->fill] + rect->left;
+    for (int y = 0; y < h; y++) {
+        uint16_t *dst_row = dst + y * ctx->stripe_w;
+        for (int x = 0; x < w; x++, src += 3) {
+            /* Panel is configured BGR; swap R and B */
+            dst_row[x] = jpg_pack_panel_rgb565(src[2], src[1], src[0]);
         }
     }
+
     return 1; /* continue */
 }
 
-static esp_err_t jpg_draw_striped(const char *path, esp_lcd_panel_handle_t panel)
+static inline uint16_t jpg_pack_panel_rgb565(uint8_t r, uint8_t g, uint8_t b)
 {
-    esp_err_t err = ESP_OK;
-    jpg_stripe_ctx_t ctx = {
-        .panel = panel,
-        .stripe = NULL,
-        .stripe_w = 0,
-        .stripe_h = 0,
-        .disp_w = BSP_LCD_H_RES,
-        .disp_h = BSP_LCD_V_RES,
-        .scale = 0,
-    };
-
-    lv_fs_res_t res = lv_fs_open(&ctx.file, path, LV_FS_MODE_RD);
-    if (res != LV_FS_RES_OK) {
-        ESP_LOGE(TAG, "Failed to open image file, lv_fs_res: (%d)", res);
-        return ESP_FAIL;
-    }
-
-    uint8_t workb[4096];      /* tjpgd work buffer */
-
-    JDEC jd;
-    JRESULT rc = jd_prepare(&jd, input_cb, workb, sizeof(workb), &ctx);
-    if (rc != JDR_OK) {
-        ESP_LOGE(TAG, "Failed to initialize tjpgd decoder, JRESULT: (%d)", rc);
-        if (rc == JDR_INP || rc == JDR_FMT1 || rc == JDR_FMT2 || rc == JDR_FMT3){
-            err = ESP_ERR_NOT_SUPPORTED;
-        }else{
-            err = ESP_FAIL;
-        }
-        goto cleanup;
-    }
-
-    /* Choose the smallest power-of-two downscale that fits the panel */
-    uint32_t scaled_w = jd.width;
-    uint32_t scaled_h = jd.height;
-    while (ctx.scale < 3 && (scaled_w > ctx.disp_w || scaled_h > ctx.disp_h)) {
-        ctx.scale++;
-        scaled_w = (scaled_w + 1) >> 1;
-        scaled_h = (scaled_h + 1) >> 1;
-    }
-
-    if (scaled_w > ctx.disp_w || scaled_h > ctx.disp_h) {
-        ESP_LOGE(TAG, "Image %ux%u is too large to fit display %ux%u even at 1/%u scale",
-                 jd.width, jd.height, ctx.disp_w, ctx.disp_h, 1U << ctx.scale);
-        err = ESP_ERR_INVALID_SIZE;
-        goto cleanup;
-    }
-
-    ESP_LOGD(TAG, "Drawing JPEG %ux%u scaled 1/%u -> %lux%lu",
-             jd.width, jd.height, 1U << ctx.scale,
-             (unsigned long)scaled_w, (unsigned long)scaled_h);
-
-    /* MCU height = msy * 8 lines; width capped to scaled image width */
-    ctx.stripe_w = scaled_w;
-    ctx.stripe_h = (uint32_t)((jd.msy * 8u) >> ctx.scale);
-    if (ctx.stripe_h == 0) {
-        ctx.stripe_h = 1;
-    }
-    size_t stripe_size = ctx.stripe_w * ctx.stripe_h * sizeof(uint16_t);
-    ESP_LOGW(TAG, "Stripe size is %lu", stripe_size);
-    ctx.stripe = heap_caps_malloc(stripe_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
-    if (!ctx.stripe) {
-        ESP_LOGE(TAG, "Failed to allocate memory for the stripe buffer used for image draw");
-        err = ESP_ERR_NO_MEM;
-        goto cleanup;
-    }
-
-    rc = jd_decomp(&jd, output_cb, ctx.scale); /* scale: 0=full, 1=1/2, 2=1/4, 3=1/8 */
-    if (rc != JDR_OK) {
-        ESP_LOGE(TAG, "Failed to draw image, JRESULT: (%d)", rc);
-        err = ESP_FAIL;
-    }
-
-cleanup:
-    lv_fs_close(&ctx.file);
-    if (ctx.stripe) {
-        free(ctx.stripe);
-    }
-    return err;
+#if BSP_LCD_BIGENDIAN
+    /* High byte (RRRRRGGG) goes first on the wire, so it lives in the low byte */
+    return (uint16_t)(((((g & 0x1C) << 3) | (b >> 3)) << 8) | (r & 0xF8) | (g >> 5));
+#else
+    return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+#endif
 }
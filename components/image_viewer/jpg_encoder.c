@@ -0,0 +1,597 @@
+#include "jpg_encoder.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+
+#define JPG_ENC_MCU_PX      16      /* 4:2:0 MCU: 2x2 luma blocks, one block per chroma plane */
+#define JPG_ENC_OUT_BUF_B   512
+
+typedef struct {
+    uint16_t code[256];
+    uint8_t size[256];
+} jpg_enc_huff_t;
+
+struct jpg_encoder {
+    jpg_encoder_write_cb_t write_cb;
+    void *user_ctx;
+    esp_err_t err;                  /* First sink error; sticky */
+    uint16_t width;
+    uint16_t height;
+    uint16_t padded_w;              /* width rounded up to the MCU size */
+    uint16_t rows_in;               /* Source lines received */
+    uint8_t band_rows;              /* Lines buffered in the current band */
+    uint8_t *plane[3];              /* Y, Cb, Cr; JPG_ENC_MCU_PX lines of padded_w */
+    float fdtbl[2][64];             /* Reciprocal quantizers (incl. AAN scaling), natural order */
+    uint8_t dqt[2][64];             /* Quantizers for the DQT segment, zigzag order */
+    jpg_enc_huff_t huff_dc[2];
+    jpg_enc_huff_t huff_ac[2];
+    int dc_prev[3];
+    uint32_t bit_buf;
+    uint8_t bit_cnt;
+    size_t out_len;
+    uint8_t out[JPG_ENC_OUT_BUF_B];
+};
+
+/* Natural (row-major) index -> zigzag position */
+static const uint8_t s_zigzag[64] = {
+     0,  1,  5,  6, 14, 15, 27, 28,  2,  4,  7, 13, 16, 26, 29, 42,
+     3,  8, 12, 17, 25, 30, 41, 43,  9, 11, 18, 24, 31, 40, 44, 53,
+    10, 19, 23, 32, 39, 45, 52, 54, 20, 22, 33, 38, 46, 51, 55, 60,
+    21, 34, 37, 47, 50, 56, 59, 61, 35, 36, 48, 49, 57, 58, 62, 63,
+};
+
+/* ITU T.81 Annex K.1 quantization tables, natural order */
+static const uint8_t s_std_qt[2][64] = {
+    {
+        16, 11, 10, 16,  24,  40,  51,  61, 12, 12, 14, 19,  26,  58,  60,  55,
+        14, 13, 16, 24,  40,  57,  69,  56, 14, 17, 22, 29,  51,  87,  80,  62,
+        18, 22, 37, 56,  68, 109, 103,  77, 24, 35, 55, 64,  81, 104, 113,  92,
+        49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103,  99,
+    },
+    {
+        17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99,
+        24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+        99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+        99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+    },
+};
+
+/* ITU T.81 Annex K.3 Huffman tables: code counts per length, then symbols */
+static const uint8_t s_dc_bits[2][16] = {
+    { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 },
+};
+static const uint8_t s_dc_vals[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+static const uint8_t s_ac_bits[2][16] = {
+    { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d },
+    { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 },
+};
+static const uint8_t s_ac_vals[2][162] = {
+    {
+        0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+        0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+        0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+        0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+        0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+        0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+        0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+        0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+        0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+        0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+        0xf9, 0xfa,
+    },
+    {
+        0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+        0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+        0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+        0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+        0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+        0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+        0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+        0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+        0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+        0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+        0xf9, 0xfa,
+    },
+};
+
+/* AAN FDCT output scale factors: cos(k*pi/16) * sqrt(2) for k > 0 */
+static const float s_aan_scale[8] = {
+    1.0f, 1.387039845f, 1.306562965f, 1.175875602f, 1.0f, 0.785694958f, 0.541196100f, 0.275899379f,
+};
+
+/************************************** Output ****************************************************/
+
+/**
+ * @brief Hand the buffered bytes to the sink.
+ *
+ * @param enc Encoder.
+ */
+static void jpg_enc_flush_out(jpg_encoder_t *enc);
+
+/**
+ * @brief Append raw bytes (headers) to the output buffer.
+ *
+ * @param enc  Encoder.
+ * @param data Bytes to append.
+ * @param len  Number of bytes.
+ */
+static void jpg_enc_put_bytes(jpg_encoder_t *enc, const uint8_t *data, size_t len);
+
+/**
+ * @brief Append entropy-coded bits, stuffing a zero byte after every 0xFF.
+ *
+ * @param enc  Encoder.
+ * @param code Bits, right aligned.
+ * @param size Number of bits (1..16).
+ */
+static inline void jpg_enc_put_bits(jpg_encoder_t *enc, uint32_t code, uint8_t size);
+
+/**
+ * @brief Write SOI, JFIF APP0, DQT, SOF0, DHT and SOS.
+ *
+ * @param enc Encoder.
+ */
+static void jpg_enc_write_headers(jpg_encoder_t *enc);
+
+/**************************************************************************************************/
+
+
+/************************************** Tables ****************************************************/
+
+/**
+ * @brief Build code/length lookup for a standard Huffman table.
+ *
+ * @param bits  Number of codes of each length 1..16.
+ * @param vals  Symbols in code order.
+ * @param[out] huff Lookup indexed by symbol.
+ */
+static void jpg_enc_build_huff(const uint8_t bits[16], const uint8_t *vals, jpg_enc_huff_t *huff);
+
+/**
+ * @brief Scale the Annex K quantizers for @p quality and precompute the
+ *        reciprocal divisors used after the FDCT.
+ *
+ * @param enc     Encoder.
+ * @param quality Quality 1..100.
+ */
+static void jpg_enc_build_quant(jpg_encoder_t *enc, uint8_t quality);
+
+/**************************************************************************************************/
+
+
+/************************************** Transform & coding ****************************************/
+
+/**
+ * @brief Compress the buffered band, padding missing lines by repeating the last one.
+ *
+ * @param enc Encoder with @c band_rows > 0.
+ */
+static void jpg_enc_encode_band(jpg_encoder_t *enc);
+
+/**
+ * @brief Forward DCT, quantize and Huffman-code one 8x8 block.
+ *
+ * @param enc   Encoder.
+ * @param block Level-shifted samples in natural order; overwritten.
+ * @param comp  Component index (0 = Y, 1 = Cb, 2 = Cr).
+ */
+static void jpg_enc_encode_block(jpg_encoder_t *enc, float block[64], int comp);
+
+/**
+ * @brief In-place 8-point AAN forward DCT.
+ *
+ * @param d      First sample.
+ * @param stride Distance between samples (1 for rows, 8 for columns).
+ */
+static inline void jpg_enc_fdct_1d(float *d, int stride);
+
+/**************************************************************************************************/
+
+esp_err_t jpg_encoder_create(uint16_t width, uint16_t height, uint8_t quality,
+                             jpg_encoder_write_cb_t write_cb, void *user_ctx,
+                             jpg_encoder_t **ret_enc)
+{
+    if (!ret_enc || !write_cb || width == 0 || height == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *ret_enc = NULL;
+
+    jpg_encoder_t *enc = calloc(1, sizeof(*enc));
+    if (!enc) {
+        return ESP_ERR_NO_MEM;
+    }
+    enc->write_cb = write_cb;
+    enc->user_ctx = user_ctx;
+    enc->width = width;
+    enc->height = height;
+    enc->padded_w = (uint16_t)((width + JPG_ENC_MCU_PX - 1) & ~(JPG_ENC_MCU_PX - 1));
+    if (enc->padded_w < width) {
+        /* 65521..65535 wrap around when rounded up */
+        free(enc);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (int c = 0; c < 3; c++) {
+        enc->plane[c] = malloc((size_t)enc->padded_w * JPG_ENC_MCU_PX);
+        if (!enc->plane[c]) {
+            jpg_encoder_delete(enc);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    jpg_enc_build_quant(enc, quality);
+    for (int t = 0; t < 2; t++) {
+        jpg_enc_build_huff(s_dc_bits[t], s_dc_vals, &enc->huff_dc[t]);
+        jpg_enc_build_huff(s_ac_bits[t], s_ac_vals[t], &enc->huff_ac[t]);
+    }
+
+    jpg_enc_write_headers(enc);
+    if (enc->err != ESP_OK) {
+        esp_err_t err = enc->err;
+        jpg_encoder_delete(enc);
+        return err;
+    }
+
+    *ret_enc = enc;
+    return ESP_OK;
+}
+
+esp_err_t jpg_encoder_write_rows(jpg_encoder_t *enc, const uint8_t *rgb, size_t stride, uint16_t rows)
+{
+    if (!enc || (!rgb && rows)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (enc->err != ESP_OK) {
+        return enc->err;
+    }
+    if ((uint32_t)enc->rows_in + rows > enc->height) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    for (uint16_t r = 0; r < rows; r++, rgb += stride) {
+        const size_t off = (size_t)enc->band_rows * enc->padded_w;
+        uint8_t *py = enc->plane[0] + off;
+        uint8_t *pcb = enc->plane[1] + off;
+        uint8_t *pcr = enc->plane[2] + off;
+        const uint8_t *px = rgb;
+        for (uint16_t x = 0; x < enc->width; x++, px += 3) {
+            const int32_t R = px[0];
+            const int32_t G = px[1];
+            const int32_t B = px[2];
+            /* JFIF YCbCr, 16-bit fixed point with rounding */
+            py[x] = (uint8_t)((19595 * R + 38470 * G + 7471 * B + 32768) >> 16);
+            pcb[x] = (uint8_t)((-11059 * R - 21709 * G + 32768 * B + (128 << 16) + 32767) >> 16);
+            pcr[x] = (uint8_t)((32768 * R - 27439 * G - 5329 * B + (128 << 16) + 32767) >> 16);
+        }
+        /* Repeat the last column into the padding */
+        for (uint16_t x = enc->width; x < enc->padded_w; x++) {
+            py[x] = py[enc->width - 1];
+            pcb[x] = pcb[enc->width - 1];
+            pcr[x] = pcr[enc->width - 1];
+        }
+
+        enc->rows_in++;
+        if (++enc->band_rows == JPG_ENC_MCU_PX) {
+            jpg_enc_encode_band(enc);
+            if (enc->err != ESP_OK) {
+                return enc->err;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t jpg_encoder_finish(jpg_encoder_t *enc)
+{
+    if (!enc) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (enc->err != ESP_OK) {
+        return enc->err;
+    }
+    if (enc->rows_in != enc->height) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (enc->band_rows) {
+        jpg_enc_encode_band(enc);
+    }
+    /* Pad the last byte with 1-bits, then EOI */
+    jpg_enc_put_bits(enc, 0x7F, 7);
+    static const uint8_t eoi[] = { 0xFF, 0xD9 };
+    jpg_enc_put_bytes(enc, eoi, sizeof(eoi));
+    jpg_enc_flush_out(enc);
+    return enc->err;
+}
+
+void jpg_encoder_delete(jpg_encoder_t *enc)
+{
+    if (!enc) {
+        return;
+    }
+    for (int c = 0; c < 3; c++) {
+        free(enc->plane[c]);
+    }
+    free(enc);
+}
+
+static void jpg_enc_flush_out(jpg_encoder_t *enc)
+{
+    if (enc->out_len && enc->err == ESP_OK) {
+        enc->err = enc->write_cb(enc->out, enc->out_len, enc->user_ctx);
+    }
+    enc->out_len = 0;
+}
+
+static void jpg_enc_put_bytes(jpg_encoder_t *enc, const uint8_t *data, size_t len)
+{
+    while (len) {
+        size_t n = sizeof(enc->out) - enc->out_len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(enc->out + enc->out_len, data, n);
+        enc->out_len += n;
+        data += n;
+        len -= n;
+        if (enc->out_len == sizeof(enc->out)) {
+            jpg_enc_flush_out(enc);
+        }
+    }
+}
+
+static inline void jpg_enc_put_bits(jpg_encoder_t *enc, uint32_t code, uint8_t size)
+{
+    /* At most 7 pending bits + 16 new ones, so 32 bits never overflow */
+    enc->bit_buf = (enc->bit_buf << size) | (code & ((1u << size) - 1));
+    enc->bit_cnt += size;
+    while (enc->bit_cnt >= 8) {
+        enc->bit_cnt -= 8;
+        const uint8_t byte = (uint8_t)(enc->bit_buf >> enc->bit_cnt);
+        enc->out[enc->out_len++] = byte;
+        if (byte == 0xFF) {
+            enc->out[enc->out_len++] = 0x00;
+        }
+        /* Keep room for a stuffed pair */
+        if (enc->out_len >= sizeof(enc->out) - 1) {
+            jpg_enc_flush_out(enc);
+        }
+    }
+}
+
+static void jpg_enc_write_headers(jpg_encoder_t *enc)
+{
+    static const uint8_t soi_app0[] = {
+        0xFF, 0xD8,
+        0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00,
+    };
+    jpg_enc_put_bytes(enc, soi_app0, sizeof(soi_app0));
+
+    static const uint8_t dqt_hdr[] = { 0xFF, 0xDB, 0x00, 0x84 };
+    jpg_enc_put_bytes(enc, dqt_hdr, sizeof(dqt_hdr));
+    for (uint8_t t = 0; t < 2; t++) {
+        jpg_enc_put_bytes(enc, &t, 1);
+        jpg_enc_put_bytes(enc, enc->dqt[t], 64);
+    }
+
+    const uint8_t sof[] = {
+        0xFF, 0xC0, 0x00, 0x11, 0x08,
+        (uint8_t)(enc->height >> 8), (uint8_t)enc->height,
+        (uint8_t)(enc->width >> 8), (uint8_t)enc->width,
+        0x03,
+        0x01, 0x22, 0x00,   /* Y: 2x2 sampling, table 0 */
+        0x02, 0x11, 0x01,   /* Cb: 1x1, table 1 */
+        0x03, 0x11, 0x01,   /* Cr: 1x1, table 1 */
+    };
+    jpg_enc_put_bytes(enc, sof, sizeof(sof));
+
+    /* 2 + 2 * (17 + 12) + 2 * (17 + 162) */
+    static const uint8_t dht_hdr[] = { 0xFF, 0xC4, 0x01, 0xA2 };
+    jpg_enc_put_bytes(enc, dht_hdr, sizeof(dht_hdr));
+    for (uint8_t t = 0; t < 2; t++) {
+        const uint8_t dc_id = t;
+        jpg_enc_put_bytes(enc, &dc_id, 1);
+        jpg_enc_put_bytes(enc, s_dc_bits[t], 16);
+        jpg_enc_put_bytes(enc, s_dc_vals, sizeof(s_dc_vals));
+        const uint8_t ac_id = 0x10 | t;
+        jpg_enc_put_bytes(enc, &ac_id, 1);
+        jpg_enc_put_bytes(enc, s_ac_bits[t], 16);
+        jpg_enc_put_bytes(enc, s_ac_vals[t], sizeof(s_ac_vals[t]));
+    }
+
+    static const uint8_t sos[] = {
+        0xFF, 0xDA, 0x00, 0x0C, 0x03,
+        0x01, 0x00, 0x02, 0x11, 0x03, 0x11,
+        0x00, 0x3F, 0x00,
+    };
+    jpg_enc_put_bytes(enc, sos, sizeof(sos));
+}
+
+static void jpg_enc_build_huff(const uint8_t bits[16], const uint8_t *vals, jpg_enc_huff_t *huff)
+{
+    memset(huff, 0, sizeof(*huff));
+    uint16_t code = 0;
+    size_t k = 0;
+    for (uint8_t len = 1; len <= 16; len++) {
+        for (uint8_t i = 0; i < bits[len - 1]; i++, k++) {
+            huff->code[vals[k]] = code++;
+            huff->size[vals[k]] = len;
+        }
+        code <<= 1;
+    }
+}
+
+static void jpg_enc_build_quant(jpg_encoder_t *enc, uint8_t quality)
+{
+    if (quality < 1) {
+        quality = 1;
+    } else if (quality > 100) {
+        quality = 100;
+    }
+    const int scale = (quality < 50) ? (5000 / quality) : (200 - quality * 2);
+
+    for (int t = 0; t < 2; t++) {
+        for (int i = 0; i < 64; i++) {
+            int q = (s_std_qt[t][i] * scale + 50) / 100;
+            if (q < 1) {
+                q = 1;
+            } else if (q > 255) {
+                q = 255;
+            }
+            enc->dqt[t][s_zigzag[i]] = (uint8_t)q;
+            enc->fdtbl[t][i] = 1.0f / ((float)q * s_aan_scale[i >> 3] * s_aan_scale[i & 7] * 8.0f);
+        }
+    }
+}
+
+static void jpg_enc_encode_band(jpg_encoder_t *enc)
+{
+    /* Repeat the last line into the rows below the image */
+    for (uint8_t r = enc->band_rows; r < JPG_ENC_MCU_PX; r++) {
+        for (int c = 0; c < 3; c++) {
+            memcpy(enc->plane[c] + (size_t)r * enc->padded_w,
+                   enc->plane[c] + (size_t)(enc->band_rows - 1) * enc->padded_w,
+                   enc->padded_w);
+        }
+    }
+
+    const size_t w = enc->padded_w;
+    float block[64];
+    for (size_t mx = 0; mx < w; mx += JPG_ENC_MCU_PX) {
+        /* Four luma blocks, raster order */
+        for (int b = 0; b < 4; b++) {
+            const uint8_t *src = enc->plane[0] + (size_t)(b >> 1) * 8 * w + mx + (b & 1) * 8;
+            for (int y = 0; y < 8; y++, src += w) {
+                for (int x = 0; x < 8; x++) {
+                    block[y * 8 + x] = (float)src[x] - 128.0f;
+                }
+            }
+            jpg_enc_encode_block(enc, block, 0);
+        }
+        /* Chroma: average each 2x2 square */
+        for (int c = 1; c < 3; c++) {
+            const uint8_t *src = enc->plane[c] + mx;
+            for (int y = 0; y < 8; y++, src += 2 * w) {
+                for (int x = 0; x < 8; x++) {
+                    const int sum = src[2 * x] + src[2 * x + 1] + src[w + 2 * x] + src[w + 2 * x + 1];
+                    block[y * 8 + x] = (float)sum * 0.25f - 128.0f;
+                }
+            }
+            jpg_enc_encode_block(enc, block, c);
+        }
+    }
+    enc->band_rows = 0;
+}
+
+static void jpg_enc_encode_block(jpg_encoder_t *enc, float block[64], int comp)
+{
+    for (int i = 0; i < 64; i += 8) {
+        jpg_enc_fdct_1d(block + i, 1);
+    }
+    for (int i = 0; i < 8; i++) {
+        jpg_enc_fdct_1d(block + i, 8);
+    }
+
+    const int t = comp ? 1 : 0;
+    int zz[64];
+    for (int i = 0; i < 64; i++) {
+        const float v = block[i] * enc->fdtbl[t][i];
+        zz[s_zigzag[i]] = (int)(v < 0.0f ? v - 0.5f : v + 0.5f);
+    }
+
+    /* DC: category + magnitude bits of the difference to the previous block */
+    int diff = zz[0] - enc->dc_prev[comp];
+    enc->dc_prev[comp] = zz[0];
+    int mag = diff < 0 ? -diff : diff;
+    uint8_t cat = 0;
+    while (mag) {
+        cat++;
+        mag >>= 1;
+    }
+    jpg_enc_put_bits(enc, enc->huff_dc[t].code[cat], enc->huff_dc[t].size[cat]);
+    if (cat) {
+        jpg_enc_put_bits(enc, (uint32_t)(diff < 0 ? diff - 1 : diff), cat);
+    }
+
+    /* AC: (zero run, category) symbols, ZRL for runs of 16, EOB for the tail */
+    const jpg_enc_huff_t *ac = &enc->huff_ac[t];
+    int last = 63;
+    while (last > 0 && zz[last] == 0) {
+        last--;
+    }
+    int run = 0;
+    for (int k = 1; k <= last; k++) {
+        const int v = zz[k];
+        if (v == 0) {
+            run++;
+            continue;
+        }
+        while (run > 15) {
+            jpg_enc_put_bits(enc, ac->code[0xF0], ac->size[0xF0]);
+            run -= 16;
+        }
+        mag = v < 0 ? -v : v;
+        cat = 0;
+        while (mag) {
+            cat++;
+            mag >>= 1;
+        }
+        const uint8_t sym = (uint8_t)((run << 4) | cat);
+        jpg_enc_put_bits(enc, ac->code[sym], ac->size[sym]);
+        jpg_enc_put_bits(enc, (uint32_t)(v < 0 ? v - 1 : v), cat);
+        run = 0;
+    }
+    if (last < 63) {
+        jpg_enc_put_bits(enc, ac->code[0x00], ac->size[0x00]);
+    }
+}
+
+static inline void jpg_enc_fdct_1d(float *d, int stride)
+{
+    float *d0 = d, *d1 = d + stride, *d2 = d + 2 * stride, *d3 = d + 3 * stride;
+    float *d4 = d + 4 * stride, *d5 = d + 5 * stride, *d6 = d + 6 * stride, *d7 = d + 7 * stride;
+
+    const float tmp0 = *d0 + *d7;
+    const float tmp7 = *d0 - *d7;
+    const float tmp1 = *d1 + *d6;
+    const float tmp6 = *d1 - *d6;
+    const float tmp2 = *d2 + *d5;
+    const float tmp5 = *d2 - *d5;
+    const float tmp3 = *d3 + *d4;
+    const float tmp4 = *d3 - *d4;
+
+    /* Even part */
+    float tmp10 = tmp0 + tmp3;
+    const float tmp13 = tmp0 - tmp3;
+    float tmp11 = tmp1 + tmp2;
+    float tmp12 = tmp1 - tmp2;
+
+    *d0 = tmp10 + tmp11;
+    *d4 = tmp10 - tmp11;
+    const float z1 = (tmp12 + tmp13) * 0.707106781f;
+    *d2 = tmp13 + z1;
+    *d6 = tmp13 - z1;
+
+    /* Odd part */
+    tmp10 = tmp4 + tmp5;
+    tmp11 = tmp5 + tmp6;
+    tmp12 = tmp6 + tmp7;
+
+    const float z5 = (tmp10 - tmp12) * 0.382683433f;
+    const float z2 = 0.541196100f * tmp10 + z5;
+    const float z4 = 1.306562965f * tmp12 + z5;
+    const float z3 = tmp11 * 0.707106781f;
+
+    const float z11 = tmp7 + z3;
+    const float z13 = tmp7 - z3;
+
+    *d5 = z13 + z2;
+    *d3 = z13 - z2;
+    *d1 = z11 + z4;
+    *d7 = z11 - z4;
+}
@@ -0,0 +1,603 @@
+#include "jpg_resize.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lvgl/src/libs/tjpgd/tjpgd.h"
+
+#include "jpg_encoder.h"
+#include "sd_card.h"
+#include "sd_file.h"
+#include "sd_io.h"
+#include "sd_journal.h"
+#include "worker_pool.h"
+
+#define TAG "jpg_resize"
+
+#define JPG_RESIZE_MAX_PATH         256
+#define JPG_RESIZE_WORKBUF_SIZE_B   (4096)
+#define JPG_RESIZE_IO_BUF_B         (4096)
+
+typedef struct {
+    char src_path[JPG_RESIZE_MAX_PATH];
+    char dest_dir[JPG_RESIZE_MAX_PATH];
+    uint16_t max_w;
+    uint16_t max_h;
+    uint8_t quality;
+    jpg_resize_done_cb_t on_done;
+    void *user_ctx;
+    jpg_resize_stats_t stats;
+} jpg_resize_job_t;
+
+typedef struct {
+    FILE *in;
+    FILE *out;
+    JDEC jd;
+    uint32_t workb[JPG_RESIZE_WORKBUF_SIZE_B / sizeof(uint32_t)];  /* tjpgd work buffer (word aligned) */
+    jpg_encoder_t *enc;
+    uint8_t *stripe;                /* One decoded MCU row, BGR888 as tjpgd emits it */
+    uint32_t src_w;                 /* Decoded size at the chosen DCT scale */
+    uint32_t src_h;
+    uint32_t stripe_h;
+    int32_t row_top;                /* First line of the MCU row being collected, -1 when empty */
+    int32_t row_bottom;
+    uint16_t dst_w;
+    uint16_t dst_h;
+    uint16_t *bin_w;                /* Source pixels averaged into each output column */
+    uint32_t *acc;                  /* Per-channel sums of the output row being built (RGB) */
+    uint8_t *line;                  /* Finished output row, RGB888 */
+    uint32_t acc_lines;             /* Source lines summed into acc */
+    uint32_t out_row;               /* Output row acc belongs to */
+    size_t bytes_out;
+    esp_err_t err;                  /* First error raised inside a tjpgd callback */
+} jpg_resize_image_t;
+
+static volatile bool s_jpg_resize_running;
+static volatile bool s_jpg_resize_stopped;     /* Card users stopped (reformat): no new jobs */
+static bool s_jpg_resize_registered;
+
+/**
+ * @brief Worker pool job: convert the source file or every JPEG in the source folder.
+ *
+ * Runs in the normal class, below the UI and the image viewer decode.
+ *
+ * @param pool_job Pool handle, checked between files for cancellation.
+ * @param arg      Heap-allocated @c jpg_resize_job_t; freed by the job.
+ */
+static void jpg_resize_run(worker_pool_job_t *pool_job, void *arg);
+
+/**
+ * @brief Release a job that was cancelled before it started.
+ *
+ * @param arg Heap-allocated @c jpg_resize_job_t.
+ */
+static void jpg_resize_discard(void *arg);
+
+/**
+ * @brief Card user callback: drop a queued job and refuse new ones until resumed.
+ *
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if a job is already converting.
+ */
+static esp_err_t jpg_resize_on_card_stop(bool stop, void *user_ctx);
+
+/**
+ * @brief Check the name filter for folder jobs.
+ *
+ * @param name File name.
+ * @return true for .jpg/.jpeg names that are not already resized copies.
+ */
+static bool jpg_resize_is_candidate(const char *name);
+
+/**
+ * @brief Convert one image and account for it in the job statistics.
+ *
+ * @param job  Job (statistics are updated).
+ * @param src  Source file path.
+ * @param name Source file name, used for the output name and logs.
+ */
+static void jpg_resize_one(jpg_resize_job_t *job, const char *src, const char *name);
+
+/**
+ * @brief Decode, resample and encode @p img->in into @p img->out.
+ *
+ * @param img     Image state with both files open.
+ * @param max_w   Maximum output width.
+ * @param max_h   Maximum output height.
+ * @param quality JPEG quality.
+ * @param[out] scale DCT scale used (0..3).
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED for JPEG types tjpgd can't read,
+ *         ESP_ERR_NO_MEM, or ESP_FAIL on I/O errors.
+ */
+static esp_err_t jpg_resize_convert(jpg_resize_image_t *img, uint16_t max_w, uint16_t max_h,
+                                    uint8_t quality, uint8_t *scale);
+
+/**
+ * @brief Size of the tjpgd output for one dimension at a DCT scale.
+ *
+ * tjpgd scales every MCU separately and rounds down, so partial edge MCUs
+ * can shrink to nothing.
+ *
+ * @param size  Full-resolution size.
+ * @param mcu   MCU size along that dimension (8 or 16).
+ * @param scale DCT scale (0..3).
+ * @return Decoded size in pixels.
+ */
+static uint32_t jpg_resize_scaled_size(uint32_t size, uint32_t mcu, uint8_t scale);
+
+/**
+ * @brief Feed the collected MCU row, line by line, to the resampler.
+ *
+ * @param img Image state.
+ * @return ESP_OK or the encoder error.
+ */
+static esp_err_t jpg_resize_flush_stripe(jpg_resize_image_t *img);
+
+/**
+ * @brief Add one decoded line to the output row it falls into.
+ *
+ * Lines and columns are box-averaged: source pixel (x, y) contributes to
+ * output pixel (x * dst_w / src_w, y * dst_h / src_h). When @p sy moves to the
+ * next output row, the finished one is sent to the encoder.
+ *
+ * @param img Image state.
+ * @param bgr Decoded line, BGR888, @c src_w pixels.
+ * @param sy  Line index in the decoded image.
+ * @return ESP_OK or the encoder error.
+ */
+static esp_err_t jpg_resize_push_line(jpg_resize_image_t *img, const uint8_t *bgr, uint32_t sy);
+
+/**
+ * @brief Average the accumulated row and pass it to the encoder.
+ *
+ * @param img Image state with @c acc_lines > 0.
+ * @return ESP_OK or the encoder error.
+ */
+static esp_err_t jpg_resize_emit_row(jpg_resize_image_t *img);
+
+/**
+ * @brief tjpgd input callback reading from a stdio file.
+ *
+ * @param jd     Decoder.
+ * @param buff   Destination, or NULL to skip.
+ * @param nbytes Bytes to read or skip.
+ * @return Bytes read or skipped, 0 on error.
+ */
+static size_t jpg_resize_input_cb(JDEC *jd, uint8_t *buff, size_t nbytes);
+
+/**
+ * @brief tjpgd output callback collecting MCUs into the stripe.
+ *
+ * @param jd     Decoder.
+ * @param bitmap Descaled MCU pixels, BGR888, @c rect width per line.
+ * @param rect   Area of the MCU in the decoded image.
+ * @return 1 to continue, 0 to abort.
+ */
+static int jpg_resize_output_cb(JDEC *jd, void *bitmap, JRECT *rect);
+
+/**
+ * @brief Encoder sink writing to the output file.
+ *
+ * @param data     Bytes to write.
+ * @param len      Number of bytes.
+ * @param user_ctx Image state.
+ * @return ESP_OK or ESP_FAIL.
+ */
+static esp_err_t jpg_resize_write_cb(const void *data, size_t len, void *user_ctx);
+
+esp_err_t jpg_resize_start(const jpg_resize_opts_t *opts)
+{
+    if (!opts || !opts->src_path || !opts->dest_dir || opts->src_path[0] == '\0' || opts->dest_dir[0] == '\0' ||
+        opts->max_width == 0 || opts->max_height == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_jpg_resize_running || s_jpg_resize_stopped) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!s_jpg_resize_registered) {
+        /* Registered on first use: until then there is no job to stop */
+        s_jpg_resize_registered = sd_card_register_user(jpg_resize_on_card_stop, NULL) == ESP_OK;
+    }
+
+    jpg_resize_job_t *job = calloc(1, sizeof(*job));
+    if (!job) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (strlcpy(job->src_path, opts->src_path, sizeof(job->src_path)) >= sizeof(job->src_path) ||
+        strlcpy(job->dest_dir, opts->dest_dir, sizeof(job->dest_dir)) >= sizeof(job->dest_dir)) {
+        free(job);
+        return ESP_ERR_INVALID_ARG;
+    }
+    job->max_w = opts->max_width;
+    job->max_h = opts->max_height;
+    job->quality = opts->quality;
+    job->on_done = opts->on_done;
+    job->user_ctx = opts->user_ctx;
+
+    s_jpg_resize_running = true;
+    const worker_pool_submit_opts_t pool_opts = {
+        .name = "jpg_resize",
+        .cls = WORKER_POOL_NORMAL,
+        .fn = jpg_resize_run,
+        .arg = job,
+        .discard = jpg_resize_discard,
+    };
+    esp_err_t err = worker_pool_submit(&pool_opts, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to queue resize job: %s", esp_err_to_name(err));
+        s_jpg_resize_running = false;
+        free(job);
+        return err;
+    }
+    return ESP_OK;
+}
+
+bool jpg_resize_is_running(void)
+{
+    return s_jpg_resize_running;
+}
+
+static void jpg_resize_run(worker_pool_job_t *pool_job, void *arg)
+{
+    jpg_resize_job_t *job = arg;
+    const int64_t start_us = esp_timer_get_time();
+    esp_err_t err = ESP_OK;
+
+    struct stat st;
+    if (stat(job->src_path, &st) != 0) {
+        ESP_LOGE(TAG, "stat(%s) failed (errno=%d)", job->src_path, errno);
+        err = ESP_ERR_NOT_FOUND;
+    } else if (S_ISDIR(st.st_mode)) {
+        DIR *dir = opendir(job->src_path);
+        if (!dir) {
+            ESP_LOGE(TAG, "opendir(%s) failed (errno=%d)", job->src_path, errno);
+            err = ESP_FAIL;
+        } else {
+            struct dirent *dent;
+            char path[JPG_RESIZE_MAX_PATH];
+            while ((dent = readdir(dir)) != NULL) {
+                if (worker_pool_job_cancelled(pool_job)) {
+                    ESP_LOGW(TAG, "Cancelled");
+                    err = ESP_ERR_INVALID_STATE;
+                    break;
+                }
+                if (dent->d_type == DT_DIR || !jpg_resize_is_candidate(dent->d_name)) {
+                    continue;
+                }
+                int needed = snprintf(path, sizeof(path), "%s/%s", job->src_path, dent->d_name);
+                if (needed < 0 || needed >= (int)sizeof(path)) {
+                    job->stats.failed++;
+                    continue;
+                }
+                jpg_resize_one(job, path, dent->d_name);
+            }
+            closedir(dir);
+        }
+    } else {
+        const char *name = strrchr(job->src_path, '/');
+        jpg_resize_one(job, job->src_path, name ? name + 1 : job->src_path);
+    }
+
+    job->stats.elapsed_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+    const uint32_t ms = job->stats.elapsed_ms ? job->stats.elapsed_ms : 1;
+    ESP_LOGI(TAG, "Done: %lu converted, %lu skipped, %lu failed in %lu ms; %llu KB -> %llu KB, %llu kpx/s",
+             (unsigned long)job->stats.converted, (unsigned long)job->stats.skipped,
+             (unsigned long)job->stats.failed, (unsigned long)job->stats.elapsed_ms,
+             (unsigned long long)(job->stats.bytes_in / 1024), (unsigned long long)(job->stats.bytes_out / 1024),
+             (unsigned long long)(job->stats.pixels_in / ms));
+
+    if (job->on_done) {
+        job->on_done(&job->stats, err, job->user_ctx);
+    }
+    free(job);
+    s_jpg_resize_running = false;
+}
+
+static void jpg_resize_discard(void *arg)
+{
+    free(arg);
+    s_jpg_resize_running = false;
+}
+
+static esp_err_t jpg_resize_on_card_stop(bool stop, void *user_ctx)
+{
+    (void)user_ctx;
+    s_jpg_resize_stopped = stop;
+    if (!stop) {
+        return ESP_OK;
+    }
+    esp_err_t err = worker_pool_cancel_queued_key("jpg_resize");
+    if (err == ESP_OK && s_jpg_resize_running) {
+        /* A jpg_resize_start() got past its stopped check and has not queued its job yet */
+        err = ESP_ERR_INVALID_STATE;
+    }
+    if (err != ESP_OK) {
+        s_jpg_resize_stopped = false;
+    }
+    return err;
+}
+
+static bool jpg_resize_is_candidate(const char *name)
+{
+    const char *dot = strrchr(name, '.');
+    if (!dot || (strcasecmp(dot, ".jpg") != 0 && strcasecmp(dot, ".jpeg") != 0)) {
+        return false;
+    }
+    const size_t stem_len = (size_t)(dot - name);
+    const size_t suffix_len = strlen(JPG_RESIZE_SUFFIX);
+    return !(stem_len >= suffix_len && strncasecmp(dot - suffix_len, JPG_RESIZE_SUFFIX, suffix_len) == 0);
+}
+
+static void jpg_resize_one(jpg_resize_job_t *job, const char *src, const char *name)
+{
+    const char *dot = strrchr(name, '.');
+    const int stem_len = dot ? (int)(dot - name) : (int)strlen(name);
+    char dest[JPG_RESIZE_MAX_PATH];
+    int needed = snprintf(dest, sizeof(dest), "%s/%.*s" JPG_RESIZE_SUFFIX ".jpg", job->dest_dir, stem_len, name);
+    if (needed < 0 || needed >= (int)sizeof(dest)) {
+        ESP_LOGE(TAG, "%s: destination path too long", name);
+        job->stats.failed++;
+        return;
+    }
+
+    struct stat st;
+    if (stat(dest, &st) == 0) {
+        ESP_LOGW(TAG, "%s: %s already exists, skipping", name, dest);
+        job->stats.skipped++;
+        return;
+    }
+
+    jpg_resize_image_t *img = calloc(1, sizeof(*img));
+    if (!img) {
+        job->stats.failed++;
+        return;
+    }
+    img->row_top = -1;
+
+    const int64_t t0 = esp_timer_get_time();
+    esp_err_t err = ESP_OK;
+    uint8_t scale = 0;
+    uint64_t bytes_in = 0;
+
+    img->in = fopen(src, "rb");
+    if (!img->in) {
+        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", src, errno);
+        err = ESP_FAIL;
+        goto done;
+    }
+    if (fstat(fileno(img->in), &st) == 0) {
+        bytes_in = sd_file_size(src, &st);
+    }
+    img->out = fopen(dest, "wb");
+    if (!img->out) {
+        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", dest, errno);
+        err = ESP_FAIL;
+        goto done;
+    }
+    setvbuf(img->in, NULL, _IOFBF, JPG_RESIZE_IO_BUF_B);
+    setvbuf(img->out, NULL, _IOFBF, JPG_RESIZE_IO_BUF_B);
+
+    err = jpg_resize_convert(img, job->max_w, job->max_h, job->quality, &scale);
+
+done:
+    if (img->in) {
+        fclose(img->in);
+    }
+    if (img->out) {
+        if (fclose(img->out) != 0 && err == ESP_OK) {
+            err = ESP_FAIL;
+        }
+        if (err != ESP_OK) {
+            remove(dest);
+        }
+    }
+
+    const uint32_t ms = (uint32_t)((esp_timer_get_time() - t0) / 1000);
+    if (err == ESP_OK) {
+        const uint64_t pixels = (uint64_t)img->jd.width * img->jd.height;
+        job->stats.converted++;
+        job->stats.bytes_in += bytes_in;
+        job->stats.bytes_out += img->bytes_out;
+        job->stats.pixels_in += pixels;
+        sd_journal_publish(SD_JOURNAL_CREATED, dest, NULL, false);
+        ESP_LOGI(TAG, "%s: %ux%u -> %ux%u (DCT 1/%u), %u -> %u KB in %lu ms, %llu kpx/s",
+                 name, img->jd.width, img->jd.height, img->dst_w, img->dst_h, 1U << scale,
+                 (unsigned)(bytes_in / 1024), (unsigned)(img->bytes_out / 1024),
+                 (unsigned long)ms, (unsigned long long)(pixels / (ms ? ms : 1)));
+    } else {
+        ESP_LOGE(TAG, "%s: conversion failed (%s)", name, esp_err_to_name(err));
+        job->stats.failed++;
+    }
+
+    jpg_encoder_delete(img->enc);
+    free(img->stripe);
+    free(img->bin_w);
+    free(img->acc);
+    free(img->line);
+    free(img);
+}
+
+static esp_err_t jpg_resize_convert(jpg_resize_image_t *img, uint16_t max_w, uint16_t max_h,
+                                    uint8_t quality, uint8_t *scale)
+{
+    JDEC *jd = &img->jd;
+    JRESULT rc = jd_prepare(jd, jpg_resize_input_cb, img->workb, sizeof(img->workb), img);
+    if (rc != JDR_OK) {
+        ESP_LOGE(TAG, "jd_prepare failed, JRESULT: (%d)", rc);
+        return (rc == JDR_INP || rc == JDR_FMT1 || rc == JDR_FMT2 || rc == JDR_FMT3) ? ESP_ERR_NOT_SUPPORTED : ESP_FAIL;
+    }
+
+    /* Fit in max_w x max_h, keeping the aspect ratio; never enlarge */
+    uint32_t dst_w = jd->width;
+    uint32_t dst_h = jd->height;
+    if (dst_w > max_w || dst_h > max_h) {
+        if ((uint64_t)dst_w * max_h > (uint64_t)dst_h * max_w) {
+            dst_h = (uint32_t)(((uint64_t)dst_h * max_w + dst_w / 2) / dst_w);
+            dst_w = max_w;
+        } else {
+            dst_w = (uint32_t)(((uint64_t)dst_w * max_h + dst_h / 2) / dst_h);
+            dst_h = max_h;
+        }
+    }
+    img->dst_w = (uint16_t)(dst_w ? dst_w : 1);
+    img->dst_h = (uint16_t)(dst_h ? dst_h : 1);
+
+    /* Largest DCT reduction that still leaves at least the target size */
+    const uint32_t mcu_w = jd->msx * 8u;
+    const uint32_t mcu_h = jd->msy * 8u;
+    uint8_t s = 3;
+    while (s > 0 && (jpg_resize_scaled_size(jd->width, mcu_w, s) < img->dst_w ||
+                     jpg_resize_scaled_size(jd->height, mcu_h, s) < img->dst_h)) {
+        s--;
+    }
+    *scale = s;
+    img->src_w = jpg_resize_scaled_size(jd->width, mcu_w, s);
+    img->src_h = jpg_resize_scaled_size(jd->height, mcu_h, s);
+    img->stripe_h = mcu_h >> s;
+
+    img->stripe = malloc((size_t)img->src_w * img->stripe_h * 3);
+    img->bin_w = calloc(img->dst_w, sizeof(uint16_t));
+    img->acc = calloc((size_t)img->dst_w * 3, sizeof(uint32_t));
+    img->line = malloc((size_t)img->dst_w * 3);
+    if (!img->stripe || !img->bin_w || !img->acc || !img->line) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint32_t x = 0; x < img->src_w; x++) {
+        img->bin_w[(uint64_t)x * img->dst_w / img->src_w]++;
+    }
+
+    esp_err_t err = jpg_encoder_create(img->dst_w, img->dst_h, quality, jpg_resize_write_cb, img, &img->enc);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    rc = jd_decomp(jd, jpg_resize_output_cb, s);
+    if (rc != JDR_OK) {
+        ESP_LOGE(TAG, "jd_decomp failed, JRESULT: (%d)", rc);
+        return (img->err != ESP_OK) ? img->err : ESP_FAIL;
+    }
+    err = jpg_resize_flush_stripe(img);
+    if (err == ESP_OK && img->acc_lines) {
+        err = jpg_resize_emit_row(img);
+    }
+    if (err == ESP_OK) {
+        err = jpg_encoder_finish(img->enc);
+    }
+    return err;
+}
+
+static uint32_t jpg_resize_scaled_size(uint32_t size, uint32_t mcu, uint8_t scale)
+{
+    return (size / mcu) * (mcu >> scale) + ((size % mcu) >> scale);
+}
+
+static esp_err_t jpg_resize_flush_stripe(jpg_resize_image_t *img)
+{
+    if (img->row_top < 0) {
+        return ESP_OK;
+    }
+    const uint8_t *bgr = img->stripe;
+    for (int32_t y = img->row_top; y <= img->row_bottom; y++, bgr += (size_t)img->src_w * 3) {
+        esp_err_t err = jpg_resize_push_line(img, bgr, (uint32_t)y);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    img->row_top = -1;
+    return ESP_OK;
+}
+
+static esp_err_t jpg_resize_push_line(jpg_resize_image_t *img, const uint8_t *bgr, uint32_t sy)
+{
+    const uint32_t oy = (uint32_t)((uint64_t)sy * img->dst_h / img->src_h);
+    if (img->acc_lines && oy != img->out_row) {
+        esp_err_t err = jpg_resize_emit_row(img);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    img->out_row = oy;
+
+    uint32_t *acc = img->acc;
+    for (uint16_t b = 0; b < img->dst_w; b++, acc += 3) {
+        for (uint16_t n = img->bin_w[b]; n > 0; n--, bgr += 3) {
+            acc[0] += bgr[2];
+            acc[1] += bgr[1];
+            acc[2] += bgr[0];
+        }
+    }
+    img->acc_lines++;
+    return ESP_OK;
+}
+
+static esp_err_t jpg_resize_emit_row(jpg_resize_image_t *img)
+{
+    uint32_t *acc = img->acc;
+    uint8_t *out = img->line;
+    for (uint16_t b = 0; b < img->dst_w; b++) {
+        const uint32_t div = (uint32_t)img->bin_w[b] * img->acc_lines;
+        for (int c = 0; c < 3; c++, acc++, out++) {
+            *out = (uint8_t)((*acc + div / 2) / div);
+            *acc = 0;
+        }
+    }
+    img->acc_lines = 0;
+    return jpg_encoder_write_rows(img->enc, img->line, (size_t)img->dst_w * 3, 1);
+}
+
+static size_t jpg_resize_input_cb(JDEC *jd, uint8_t *buff, size_t nbytes)
+{
+    jpg_resize_image_t *img = (jpg_resize_image_t *)jd->device;
+    if (buff) {
+        return sd_io_read(buff, nbytes, img->in, SD_IO_BACKGROUND);
+    }
+    return (fseek(img->in, (long)nbytes, SEEK_CUR) == 0) ? nbytes : 0;
+}
+
+static int jpg_resize_output_cb(JDEC *jd, void *bitmap, JRECT *rect)
+{
+    jpg_resize_image_t *img = (jpg_resize_image_t *)jd->device;
+
+    /* tjpgd walks MCUs left to right, so a new top means the previous row is complete */
+    if (img->row_top >= 0 && rect->top != img->row_top) {
+        img->err = jpg_resize_flush_stripe(img);
+        if (img->err != ESP_OK) {
+            return 0;
+        }
+    }
+
+    const uint32_t w = rect->right - rect->left + 1;
+    const uint32_t h = rect->bottom - rect->top + 1;
+    if (rect->right >= img->src_w || h > img->stripe_h) {
+        return 0;
+    }
+    if (img->row_top < 0) {
+        img->row_top = rect->top;
+        img->row_bottom = rect->bottom;
+    }
+
+    const uint8_t *src = (const uint8_t *)bitmap;
+    uint8_t *dst = img->stripe + (size_t)rect->left * 3;
+    for (uint32_t y = 0; y < h; y++, src += w * 3, dst += (size_t)img->src_w * 3) {
+        memcpy(dst, src, w * 3);
+    }
+    return 1;
+}
+
+static esp_err_t jpg_resize_write_cb(const void *data, size_t len, void *user_ctx)
+{
+    jpg_resize_image_t *img = user_ctx;
+    if (sd_io_write(data, len, img->out, SD_IO_BACKGROUND) != len) {
+        ESP_LOGE(TAG, "fwrite failed (errno=%d)", errno);
+        return ESP_FAIL;
+    }
+    img->bytes_out += len;
+    return ESP_OK;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+/*
+ * Working buffers that are allocated and released over and over are served
+ * from one region per subsystem. With CONFIG_MEM_PLAN_STATIC the regions are
+ * reserved once at boot, so their churn cannot fragment the system heap;
+ * without it every call goes straight to heap_caps_*().
+ */
+
+typedef enum {
+    MEM_PLAN_LISTING,   /* directory item arrays, names, bookmark caches */
+    MEM_PLAN_FILE_IO,   /* text viewer chunks, copy buffer */
+    MEM_PLAN_IMAGE,     /* JPEG decoder state and DMA stripes */
+    MEM_PLAN_REGION_COUNT
+} mem_plan_region_id_t;
+
+typedef struct {
+    const char *name;
+    size_t reserved_bytes;      /* usable size, 0 when the region is not reserved */
+    size_t free_bytes;
+    size_t largest_free_block;
+    size_t min_free_bytes;      /* low-water mark since the reservation */
+    uint32_t overflows;         /* allocations served by the heap because the region was full */
+} mem_plan_info_t;
+
+/**
+ * @brief Reserve every region of the plan.
+ *
+ * Call first thing in app_main(), before the display and the SD card take
+ * their share of the heap. Does nothing without CONFIG_MEM_PLAN_STATIC.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if called twice, or ESP_ERR_NO_MEM if
+ *         a region could not be reserved (the others still are).
+ */
+esp_err_t mem_plan_reserve(void);
+
+/**
+ * @brief Allocate @p size bytes from region @p id, or from the heap when it is full.
+ *
+ * @return Pointer, or NULL when neither has room.
+ */
+void *mem_plan_alloc(mem_plan_region_id_t id, size_t size);
+
+/**
+ * @brief Zeroed mem_plan_alloc() of @p n elements of @p size bytes.
+ */
+void *mem_plan_calloc(mem_plan_region_id_t id, size_t n, size_t size);
+
+/**
+ * @brief Resize a block obtained from region @p id.
+ *
+ * A block that no longer fits in the region moves to the heap.
+ *
+ * @return Resized block, or NULL (the original block is left untouched).
+ */
+void *mem_plan_realloc(mem_plan_region_id_t id, void *ptr, size_t size);
+
+/**
+ * @brief Release a block obtained from region @p id (NULL is ignored).
+ */
+void mem_plan_free(mem_plan_region_id_t id, void *ptr);
+
+/**
+ * @brief Usage of region @p id.
+ *
+ * @param[out] info Filled in; all sizes are 0 when the region is not reserved.
+ * @return ESP_OK or ESP_ERR_INVALID_ARG.
+ */
+esp_err_t mem_plan_get_info(mem_plan_region_id_t id, mem_plan_info_t *info);
+
+/**
+ * @brief Log every region and the largest free internal heap block.
+ */
+void mem_plan_log(void);
+
+#ifdef __cplusplus
+}
+#endif
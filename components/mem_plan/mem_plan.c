@@ -0,0 +1,254 @@
+#include "mem_plan.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "multi_heap.h"
+
+static const char *TAG = "mem_plan";
+
+/* TLSF control block of a private heap of a few tens of KB, plus a few block headers */
+#define MEM_PLAN_HEAP_OVERHEAD_B    1536
+
+typedef struct {
+    const char *name;
+    uint32_t caps;              /* where the region (or its fallback allocations) live */
+    size_t plan_bytes;          /* usable size requested by the plan */
+    uint8_t *base;
+    size_t size;
+    multi_heap_handle_t heap;   /* NULL until reserved */
+    portMUX_TYPE lock;
+    uint32_t overflows;
+} mem_plan_region_t;
+
+#if CONFIG_MEM_PLAN_STATIC
+#define MEM_PLAN_BYTES(kb)  ((size_t)(kb) * 1024)
+#else
+#define MEM_PLAN_BYTES(kb)  ((size_t)0)
+#endif
+
+static mem_plan_region_t s_regions[MEM_PLAN_REGION_COUNT] = {
+    [MEM_PLAN_LISTING] = {
+        .name = "listing",
+        .caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+        .plan_bytes = MEM_PLAN_BYTES(CONFIG_MEM_PLAN_LISTING_KB),
+        .lock = portMUX_INITIALIZER_UNLOCKED,
+    },
+    [MEM_PLAN_FILE_IO] = {
+        .name = "file_io",
+        .caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+        .plan_bytes = MEM_PLAN_BYTES(CONFIG_MEM_PLAN_FILE_IO_KB),
+        .lock = portMUX_INITIALIZER_UNLOCKED,
+    },
+    [MEM_PLAN_IMAGE] = {
+        .name = "image",
+        .caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA,
+        .plan_bytes = MEM_PLAN_BYTES(CONFIG_MEM_PLAN_IMAGE_KB),
+        .lock = portMUX_INITIALIZER_UNLOCKED,
+    },
+};
+
+#if CONFIG_MEM_PLAN_STATIC
+static bool s_reserved;
+#endif
+
+/**
+ * @brief Region for @p id, or NULL if out of range.
+ */
+static mem_plan_region_t *mem_plan_region(mem_plan_region_id_t id);
+
+/**
+ * @brief Whether @p ptr lies inside the reserved part of @p region.
+ */
+static bool mem_plan_owns(const mem_plan_region_t *region, const void *ptr);
+
+/**
+ * @brief Count an allocation of @p size bytes the region could not serve.
+ *
+ * Warns on the first one only; the count shows up in mem_plan_log().
+ */
+static void mem_plan_note_overflow(mem_plan_region_t *region, size_t size);
+
+esp_err_t mem_plan_reserve(void)
+{
+#if CONFIG_MEM_PLAN_STATIC
+    if (s_reserved) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_reserved = true;
+
+    /* Largest first, so the small ones fill in around it rather than split the big block */
+    bool done[MEM_PLAN_REGION_COUNT] = {0};
+    esp_err_t result = ESP_OK;
+    for (int pass = 0; pass < MEM_PLAN_REGION_COUNT; pass++) {
+        int pick = -1;
+        for (int i = 0; i < MEM_PLAN_REGION_COUNT; i++) {
+            if (!done[i] && (pick < 0 || s_regions[i].plan_bytes > s_regions[pick].plan_bytes)) {
+                pick = i;
+            }
+        }
+        done[pick] = true;
+
+        mem_plan_region_t *r = &s_regions[pick];
+        size_t size = r->plan_bytes + MEM_PLAN_HEAP_OVERHEAD_B;
+        uint8_t *base = heap_caps_malloc(size, r->caps);
+        multi_heap_handle_t heap = base ? multi_heap_register(base, size) : NULL;
+        if (!heap) {
+            ESP_LOGE(TAG, "Could not reserve %u bytes for \"%s\"", (unsigned)size, r->name);
+            heap_caps_free(base);
+            result = ESP_ERR_NO_MEM;
+            continue;
+        }
+        multi_heap_set_lock(heap, &r->lock);
+        r->base = base;
+        r->size = size;
+        r->heap = heap;
+        ESP_LOGI(TAG, "Reserved \"%s\": %u bytes usable", r->name, (unsigned)multi_heap_free_size(heap));
+    }
+
+    ESP_LOGI(TAG, "Largest free internal block after the plan: %u",
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    return result;
+#else
+    return ESP_OK;
+#endif
+}
+
+void *mem_plan_alloc(mem_plan_region_id_t id, size_t size)
+{
+    mem_plan_region_t *r = mem_plan_region(id);
+    if (!r) {
+        return NULL;
+    }
+    if (r->heap && size > 0) {
+        void *ptr = multi_heap_malloc(r->heap, size);
+        if (ptr) {
+            return ptr;
+        }
+        mem_plan_note_overflow(r, size);
+    }
+    return heap_caps_malloc(size, r->caps);
+}
+
+void *mem_plan_calloc(mem_plan_region_id_t id, size_t n, size_t size)
+{
+    if (size != 0 && n > SIZE_MAX / size) {
+        return NULL;
+    }
+    void *ptr = mem_plan_alloc(id, n * size);
+    if (ptr) {
+        memset(ptr, 0, n * size);
+    }
+    return ptr;
+}
+
+void *mem_plan_realloc(mem_plan_region_id_t id, void *ptr, size_t size)
+{
+    mem_plan_region_t *r = mem_plan_region(id);
+    if (!r) {
+        return NULL;
+    }
+    if (!ptr) {
+        return mem_plan_alloc(id, size);
+    }
+    if (size == 0) {
+        mem_plan_free(id, ptr);
+        return NULL;
+    }
+    if (!mem_plan_owns(r, ptr)) {
+        return heap_caps_realloc(ptr, size, r->caps);
+    }
+
+    void *grown = multi_heap_realloc(r->heap, ptr, size);
+    if (grown) {
+        return grown;
+    }
+    mem_plan_note_overflow(r, size);
+    grown = heap_caps_malloc(size, r->caps);
+    if (!grown) {
+        return NULL;
+    }
+    size_t old_size = multi_heap_get_allocated_size(r->heap, ptr);
+    memcpy(grown, ptr, old_size < size ? old_size : size);
+    multi_heap_free(r->heap, ptr);
+    return grown;
+}
+
+void mem_plan_free(mem_plan_region_id_t id, void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+    mem_plan_region_t *r = mem_plan_region(id);
+    if (r && mem_plan_owns(r, ptr)) {
+        multi_heap_free(r->heap, ptr);
+    } else {
+        heap_caps_free(ptr);
+    }
+}
+
+esp_err_t mem_plan_get_info(mem_plan_region_id_t id, mem_plan_info_t *info)
+{
+    mem_plan_region_t *r = mem_plan_region(id);
+    if (!r || !info) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(info, 0, sizeof(*info));
+    info->name = r->name;
+    info->overflows = r->overflows;
+    if (r->heap) {
+        multi_heap_info_t heap_info;
+        multi_heap_get_info(r->heap, &heap_info);
+        info->reserved_bytes = heap_info.total_free_bytes + heap_info.total_allocated_bytes;
+        info->free_bytes = heap_info.total_free_bytes;
+        info->largest_free_block = heap_info.largest_free_block;
+        info->min_free_bytes = heap_info.minimum_free_bytes;
+    }
+    return ESP_OK;
+}
+
+void mem_plan_log(void)
+{
+    for (int i = 0; i < MEM_PLAN_REGION_COUNT; i++) {
+        mem_plan_info_t info;
+        mem_plan_get_info((mem_plan_region_id_t)i, &info);
+        if (info.reserved_bytes == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%-8s free %6u of %6u, largest %6u, low %6u, overflows %lu", info.name,
+                 (unsigned)info.free_bytes, (unsigned)info.reserved_bytes, (unsigned)info.largest_free_block,
+                 (unsigned)info.min_free_bytes, (unsigned long)info.overflows);
+    }
+    ESP_LOGI(TAG, "heap     free %6u, largest %6u, low %6u",
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),
+             (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+}
+
+static mem_plan_region_t *mem_plan_region(mem_plan_region_id_t id)
+{
+    if ((unsigned)id >= MEM_PLAN_REGION_COUNT) {
+        return NULL;
+    }
+    return &s_regions[id];
+}
+
+static bool mem_plan_owns(const mem_plan_region_t *region, const void *ptr)
+{
+    const uint8_t *p = ptr;
+    return region->heap && p >= region->base && p < region->base + region->size;
+}
+
+static void mem_plan_note_overflow(mem_plan_region_t *region, size_t size)
+{
+    taskENTER_CRITICAL(&region->lock);
+    uint32_t count = ++region->overflows;
+    taskEXIT_CRITICAL(&region->lock);
+    if (count == 1) {
+        ESP_LOGW(TAG, "\"%s\" is full, %u bytes taken from the heap", region->name, (unsigned)size);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+/*
+ * Statistical profiler: every core samples the PC it was interrupted at,
+ * CONFIG_PC_PROFILE_RATE_HZ times a second, and counts samples per distinct
+ * PC. With CONFIG_PC_PROFILE_STALLS each sample also carries the instruction
+ * fetch stall cycles since the previous one, which is where flash cache misses
+ * show up. Addresses are resolved on the host (pc_profile.py), so the tables
+ * hold raw PCs only.
+ */
+
+#if CONFIG_PC_PROFILE
+
+/**
+ * @brief Clear the tables and start sampling on every core.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if already running, ESP_ERR_NO_MEM,
+ *         or the error of the timer setup.
+ */
+esp_err_t pc_profile_start(void);
+
+/**
+ * @brief Stop sampling; the tables are kept for pc_profile_write().
+ *
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if not running.
+ */
+esp_err_t pc_profile_stop(void);
+
+/**
+ * @brief Write the tables of the last run as CSV.
+ *
+ * One "core,pc,samples,stall_cycles" row per PC, preceded by one comment
+ * line per core with the totals (samples, cycles, stall cycles, lost samples).
+ *
+ * @param path Output file, truncated if it exists.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE while running or before the first run,
+ *         or ESP_FAIL on I/O errors.
+ */
+esp_err_t pc_profile_write(const char *path);
+
+#else
+
+static inline esp_err_t pc_profile_start(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline esp_err_t pc_profile_stop(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline esp_err_t pc_profile_write(const char *path)
+{
+    (void)path;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,284 @@
+#include "pc_profile.h"
+
+#if CONFIG_PC_PROFILE
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_ipc.h"
+#include "esp_log.h"
+#include "xtensa_context.h"
+#if CONFIG_PC_PROFILE_STALLS
+#include "perfmon.h"
+#define PC_PROFILE_STALLS       1
+#else
+#define PC_PROFILE_STALLS       0
+#endif
+
+static const char *TAG = "pc_profile";
+
+#define PC_PROFILE_TIMER_HZ     1000000
+#define PC_PROFILE_PROBES       16      /* slots tried before a sample counts as lost */
+#define PC_PROFILE_HASH_MUL     2654435761u
+#define PC_PROFILE_CNT_STALL    0       /* perfmon counter used for I-side stalls */
+
+typedef struct {
+    uint32_t pc;                /* 0: free */
+    uint32_t samples;
+    uint32_t stall_cycles;
+} pc_profile_slot_t;
+
+typedef struct {
+    pc_profile_slot_t *slots;
+    gptimer_handle_t timer;
+    esp_err_t start_err;
+
+    uint32_t samples;
+    uint32_t lost;
+    uint64_t cycles;            /* CPU cycles from the start to the last sample */
+    uint64_t stall_cycles;
+    uint32_t last_ccount;
+    uint32_t last_stall;
+} pc_profile_core_t;
+
+static pc_profile_core_t s_core[portNUM_PROCESSORS];
+static bool s_running;
+static bool s_have_run;
+
+/**
+ * @brief Timer alarm callback: record the interrupted PC of this core.
+ *
+ * @param timer     Unused.
+ * @param edata     Unused.
+ * @param user_ctx  Per-core state of the core the interrupt is allocated on.
+ * @return false, no task to wake.
+ */
+static bool pc_profile_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_ctx);
+
+/**
+ * @brief Set up the sampling timer and the stall counter of the calling core.
+ *
+ * Runs through esp_ipc so that the timer interrupt is allocated on, and the
+ * performance counters are those of, the core being profiled. The result is
+ * left in @c start_err.
+ *
+ * @param arg Per-core state.
+ */
+static void pc_profile_core_start(void *arg);
+
+/**
+ * @brief Tear down what pc_profile_core_start() set up, on the same core.
+ *
+ * @param arg Per-core state.
+ */
+static void pc_profile_core_stop(void *arg);
+
+esp_err_t pc_profile_start(void)
+{
+    if (s_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        pc_profile_core_t *core = &s_core[i];
+        pc_profile_slot_t *slots = core->slots;
+        if (!slots) {
+            slots = heap_caps_malloc(CONFIG_PC_PROFILE_SLOTS * sizeof(*slots), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            if (!slots) {
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        memset(slots, 0, CONFIG_PC_PROFILE_SLOTS * sizeof(*slots));
+        *core = (pc_profile_core_t){ .slots = slots };
+    }
+
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        esp_err_t err = esp_ipc_call_blocking(i, pc_profile_core_start, &s_core[i]);
+        if (err == ESP_OK) {
+            err = s_core[i].start_err;
+        }
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Sampling not started on core %d: %s", i, esp_err_to_name(err));
+            for (int j = 0; j <= i; j++) {
+                esp_ipc_call_blocking(j, pc_profile_core_stop, &s_core[j]);
+            }
+            return err;
+        }
+    }
+
+    s_running = true;
+    s_have_run = true;
+    ESP_LOGI(TAG, "Sampling %d core(s) at %d Hz%s", portNUM_PROCESSORS, CONFIG_PC_PROFILE_RATE_HZ,
+             PC_PROFILE_STALLS ? " with I-side stall counts" : "");
+    return ESP_OK;
+}
+
+esp_err_t pc_profile_stop(void)
+{
+    if (!s_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        esp_ipc_call_blocking(i, pc_profile_core_stop, &s_core[i]);
+    }
+    s_running = false;
+    return ESP_OK;
+}
+
+esp_err_t pc_profile_write(const char *path)
+{
+    if (!path) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_running || !s_have_run) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        return ESP_FAIL;
+    }
+
+    fprintf(f, "# pc_profile rate_hz %d stalls %d\n", CONFIG_PC_PROFILE_RATE_HZ, PC_PROFILE_STALLS);
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        const pc_profile_core_t *core = &s_core[i];
+        fprintf(f, "# core %d samples %lu lost %lu cycles %llu stall_cycles %llu\n", i,
+                (unsigned long)core->samples, (unsigned long)core->lost,
+                (unsigned long long)core->cycles, (unsigned long long)core->stall_cycles);
+    }
+    fprintf(f, "core,pc,samples,stall_cycles\n");
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        const pc_profile_slot_t *slots = s_core[i].slots;
+        for (uint32_t s = 0; s < CONFIG_PC_PROFILE_SLOTS; s++) {
+            if (slots[s].pc != 0) {
+                fprintf(f, "%d,0x%08lx,%lu,%lu\n", i, (unsigned long)slots[s].pc,
+                        (unsigned long)slots[s].samples, (unsigned long)slots[s].stall_cycles);
+            }
+        }
+    }
+
+    bool ok = !ferror(f);
+    if (fclose(f) != 0 || !ok) {
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Profile written to %s", path);
+    return ESP_OK;
+}
+
+static bool IRAM_ATTR pc_profile_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata,
+                                          void *user_ctx)
+{
+    pc_profile_core_t *core = user_ctx;
+    (void)timer;
+    (void)edata;
+
+    /*
+     * Allocated at level 1 (see pc_profile_core_start()), and level-1
+     * interrupts do not nest, so this is the outermost one: the port
+     * saved the interrupted context at the top of the current task's stack,
+     * and pxTopOfStack is the first member of the TCB.
+     */
+    const XtExcFrame *frame = *(XtExcFrame *const *)xTaskGetCurrentTaskHandleForCore(esp_cpu_get_core_id());
+    const uint32_t pc = frame->pc;
+
+    const uint32_t ccount = esp_cpu_get_cycle_count();
+    core->cycles += ccount - core->last_ccount;
+    core->last_ccount = ccount;
+    uint32_t stall = 0;
+#if CONFIG_PC_PROFILE_STALLS
+    /* Everything since the previous sample is charged to this PC; over many samples it averages out */
+    const uint32_t stall_count = xtensa_perfmon_value(PC_PROFILE_CNT_STALL);
+    stall = stall_count - core->last_stall;
+    core->last_stall = stall_count;
+    core->stall_cycles += stall;
+#endif
+    core->samples++;
+
+    uint32_t slot = (pc * PC_PROFILE_HASH_MUL) % CONFIG_PC_PROFILE_SLOTS;
+    for (int probe = 0; probe < PC_PROFILE_PROBES; probe++) {
+        pc_profile_slot_t *entry = &core->slots[slot];
+        if (entry->pc == 0) {
+            entry->pc = pc;
+        }
+        if (entry->pc == pc) {
+            entry->samples++;
+            entry->stall_cycles += stall;
+            return false;
+        }
+        slot = (slot + 1) % CONFIG_PC_PROFILE_SLOTS;
+    }
+    core->lost++;
+    return false;
+}
+
+static void pc_profile_core_start(void *arg)
+{
+    pc_profile_core_t *core = arg;
+
+    const gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = PC_PROFILE_TIMER_HZ,
+        /* Level 1 explicitly: 0 lets the allocator pick up to level 3, which would nest */
+        .intr_priority = 1,
+    };
+    const gptimer_alarm_config_t alarm_config = {
+        .alarm_count = PC_PROFILE_TIMER_HZ / CONFIG_PC_PROFILE_RATE_HZ,
+        .reload_count = 0,
+        .flags.auto_reload_on_alarm = true,
+    };
+    const gptimer_event_callbacks_t cbs = {
+        .on_alarm = pc_profile_on_alarm,
+    };
+
+    esp_err_t err = gptimer_new_timer(&timer_config, &core->timer);
+    if (err == ESP_OK) {
+        err = gptimer_set_alarm_action(core->timer, &alarm_config);
+    }
+    if (err == ESP_OK) {
+        /* Allocates the interrupt, on this core */
+        err = gptimer_register_event_callbacks(core->timer, &cbs, core);
+    }
+    if (err == ESP_OK) {
+        err = gptimer_enable(core->timer);
+    }
+    if (err != ESP_OK) {
+        core->start_err = err;
+        return;
+    }
+
+#if CONFIG_PC_PROFILE_STALLS
+    xtensa_perfmon_stop();
+    xtensa_perfmon_init(PC_PROFILE_CNT_STALL, XTPERF_CNT_I_STALL,
+                        XTPERF_MASK_I_STALL_CACHE_MISS | XTPERF_MASK_I_STALL_BUSY, 0, -1);
+    xtensa_perfmon_reset(PC_PROFILE_CNT_STALL);
+    xtensa_perfmon_start();
+    core->last_stall = xtensa_perfmon_value(PC_PROFILE_CNT_STALL);
+#endif
+    core->last_ccount = esp_cpu_get_cycle_count();
+    core->start_err = gptimer_start(core->timer);
+}
+
+static void pc_profile_core_stop(void *arg)
+{
+    pc_profile_core_t *core = arg;
+    if (!core->timer) {
+        return;
+    }
+    /* Either may fail when the start was cut short; the timer is deleted regardless */
+    gptimer_stop(core->timer);
+    gptimer_disable(core->timer);
+    gptimer_del_timer(core->timer);
+    core->timer = NULL;
+#if CONFIG_PC_PROFILE_STALLS
+    xtensa_perfmon_stop();
+#endif
+}
+
+#endif
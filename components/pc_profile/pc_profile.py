@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""Resolve a pc_profile CSV to functions and rank IRAM placement candidates.
+
+CONFIG_PC_PROFILE writes <trace>.pc.csv next to the input trace after each
+replay: sampled PCs per core, with the instruction-fetch stall cycles charged
+to each. Copy it off the card and run, with the ELF and map of the same build:
+
+    python components/pc_profile/pc_profile.py build/esp32-file-manager.elf input.trc.pc.csv
+    python components/pc_profile/pc_profile.py build/esp32-file-manager.elf a.pc.csv b.pc.csv \\
+           --map build/esp32-file-manager.map --iram-budget 8192 --lf components/pc_profile/iram_hot.lf
+
+Per function it prints the share of samples, the share of its own cycles
+spent stalled on instruction fetch, the IRAM it would take (code plus literal
+pool) and the estimated gain, i.e. the stall cycles that go away when the
+function no longer runs through the flash cache, as a share of all cycles.
+Candidates are picked by gain per byte until the budget is spent; --lf writes
+them as the linker fragment used by CONFIG_PC_PROFILE_IRAM_HOT. Rebuild with it
+and profile again: the gain is an estimate, the second profile is the answer.
+"""
+
+import argparse
+import bisect
+import os
+import re
+import subprocess
+import sys
+
+CORE_LINE = re.compile(r"# core (\d+) samples (\d+) lost (\d+) cycles (\d+) stall_cycles (\d+)")
+# One input section of the linker map; long names put the address on the next line
+MAP_SECTION = re.compile(r"^ \.(literal|text)\.(\S+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S+)$", re.M)
+MAP_OBJECT = re.compile(r"([^/\\]+\.a)\(([^)]+?)(?:\.c|\.cpp|\.S)?\.(?:obj|o)\)")
+LF_HEADER = """\
+# Hot functions moved from flash to IRAM with CONFIG_PC_PROFILE_IRAM_HOT.
+#
+# Generated by pc_profile.py from {sources}
+# ({functions} functions, {cost} B of IRAM, estimated {gain:.1f} % fewer cycles).
+# Objects are source file names without extension; static functions work too
+# since every function gets its own section.
+"""
+
+
+def read_profiles(paths):
+    # Returns ({pc: [samples, stall]}, totals) merged over all files and cores
+    pcs = {}
+    totals = {"samples": 0, "lost": 0, "cycles": 0, "stall_cycles": 0, "stalls": False}
+    for path in paths:
+        with open(path, encoding="utf-8") as f:
+            for line in f:
+                line = line.strip()
+                if line.startswith("# pc_profile"):
+                    totals["stalls"] |= line.endswith("stalls 1")
+                    continue
+                m = CORE_LINE.match(line)
+                if m:
+                    totals["samples"] += int(m.group(2))
+                    totals["lost"] += int(m.group(3))
+                    totals["cycles"] += int(m.group(4))
+                    totals["stall_cycles"] += int(m.group(5))
+                    continue
+                fields = line.split(",")
+                if len(fields) != 4 or not fields[1].startswith("0x"):
+                    continue
+                entry = pcs.setdefault(int(fields[1], 16), [0, 0])
+                entry[0] += int(fields[2])
+                entry[1] += int(fields[3])
+    return pcs, totals
+
+
+def tool_output(cmd):
+    try:
+        return subprocess.run(cmd, check=True, capture_output=True, text=True).stdout
+    except (OSError, subprocess.CalledProcessError) as e:
+        sys.exit("%s failed: %s" % (cmd[0], e))
+
+
+def read_symbols(elf, prefix):
+    # Function symbols as sorted (address, size, name)
+    symbols = []
+    for line in tool_output([prefix + "nm", "-S", "--defined-only", elf]).splitlines():
+        parts = line.split()
+        if len(parts) == 4 and parts[2] in "tTwW":
+            size = int(parts[1], 16)
+            if size:
+                symbols.append((int(parts[0], 16), size, parts[3]))
+    symbols.sort()
+    return symbols
+
+
+def read_regions(elf, prefix):
+    # Executable output sections as sorted (address, end, region)
+    regions = []
+    for line in tool_output([prefix + "readelf", "-SW", elf]).splitlines():
+        m = re.match(r"\s*\[\s*\d+\]\s+(\S+)\s+\S+\s+([0-9a-f]+)\s+[0-9a-f]+\s+([0-9a-f]+)\s+\S+\s+(\S*)", line)
+        if not m or "X" not in m.group(4):
+            continue
+        name, addr, size = m.group(1), int(m.group(2), 16), int(m.group(3), 16)
+        region = "iram" if name.startswith(".iram") else "flash" if name.startswith(".flash") else name.lstrip(".")
+        regions.append((addr, addr + size, region))
+    regions.sort()
+    return regions
+
+
+def read_map(path):
+    # {address: (archive, object)} of .text sections and {(archive, object, name): literal bytes}
+    objects, literals = {}, {}
+    if not path:
+        return objects, literals
+    with open(path, encoding="utf-8", errors="replace") as f:
+        text = f.read()
+    for m in MAP_SECTION.finditer(text):
+        kind, name, addr, size, origin = m.groups()
+        obj = MAP_OBJECT.search(origin)
+        if not obj:
+            continue
+        key = (obj.group(1), obj.group(2))
+        if kind == "text":
+            objects[int(addr, 16)] = key
+        else:
+            literals[key + (name,)] = literals.get(key + (name,), 0) + int(size, 16)
+    return objects, literals
+
+
+def lookup(sorted_list, addr):
+    i = bisect.bisect_right(sorted_list, (addr, float("inf"))) - 1
+    return sorted_list[i] if i >= 0 else None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="application ELF of the profiled build")
+    parser.add_argument("profiles", nargs="+", help="pc_profile CSV files (merged)")
+    parser.add_argument("--map", help="linker map, needed for object names, literal sizes and --lf")
+    parser.add_argument("--toolchain-prefix", default="xtensa-esp32s3-elf-", help="prefix of nm and readelf")
+    parser.add_argument("--top", type=int, default=30, help="rows to print")
+    parser.add_argument("--iram-budget", type=int, default=8192, help="IRAM bytes to spend on candidates")
+    parser.add_argument("--min-samples", type=int, default=5, help="ignore functions sampled fewer times")
+    parser.add_argument("--lf", help="write the selected functions as a linker fragment")
+    args = parser.parse_args()
+
+    pcs, totals = read_profiles(args.profiles)
+    if not totals["samples"]:
+        print("No samples in %s" % ", ".join(args.profiles), file=sys.stderr)
+        return 1
+    symbols = read_symbols(args.elf, args.toolchain_prefix)
+    regions = read_regions(args.elf, args.toolchain_prefix)
+    objects, literals = read_map(args.map)
+    has_stalls = totals["stalls"] and totals["stall_cycles"] > 0
+    cycles_per_sample = totals["cycles"] / totals["samples"]
+
+    funcs = {}
+    for pc, (samples, stall) in pcs.items():
+        sym = lookup(symbols, pc)
+        if sym and pc < sym[0] + sym[1]:
+            addr, size, name = sym
+        else:
+            addr, size, name = pc, 0, "?"
+        region = lookup(regions, pc)
+        f = funcs.setdefault((name, addr), {
+            "name": name, "size": size, "samples": 0, "stall": 0,
+            "region": region[2] if region and pc < region[1] else "rom",
+            "object": objects.get(addr),
+        })
+        f["samples"] += samples
+        f["stall"] += stall
+
+    for f in funcs.values():
+        f["cost"] = f["size"] + (literals.get(f["object"] + (f["name"],), 0) if f["object"] else 0)
+        f["own_stall"] = f["stall"] / (f["samples"] * cycles_per_sample) if f["samples"] else 0
+        f["gain"] = f["stall"] / totals["cycles"] if has_stalls and f["region"] == "flash" else 0.0
+        # Without stall counts, time per byte is the best available ranking
+        weight = f["gain"] if has_stalls else f["samples"] / totals["samples"]
+        f["per_kb"] = weight * 1024 / f["cost"] if f["cost"] else 0.0
+
+    candidates = sorted((f for f in funcs.values()
+                         if f["region"] == "flash" and f["name"] != "?" and f["samples"] >= args.min_samples),
+                        key=lambda f: f["per_kb"], reverse=True)
+    selected, spent = [], 0
+    for f in candidates:
+        if spent + f["cost"] <= args.iram_budget:
+            selected.append(f)
+            spent += f["cost"]
+    chosen = {id(f) for f in selected}
+
+    print(f"{totals['samples']} samples ({totals['lost']} lost), {totals['cycles'] / 1e6:.0f} M cycles, "
+          + (f"{100 * totals['stall_cycles'] / totals['cycles']:.1f} % stalled on instruction fetch"
+             if has_stalls else "no stall counts (CONFIG_PC_PROFILE_STALLS off)"))
+    print(f"{'time%':>6} {'stall%':>6} {'gain%':>6} {'IRAM B':>7} {'gain%/KB':>8}  {'region':<6} function")
+    rows = sorted(funcs.values(), key=lambda f: f["samples"], reverse=True)[:args.top]
+    for f in rows:
+        mark = " *" if id(f) in chosen else ""
+        where = " (%s)" % f["object"][1] if f["object"] else ""
+        gain = f"{100 * f['gain']:6.2f}" if has_stalls else f"{'-':>6}"
+        print(f"{100 * f['samples'] / totals['samples']:6.1f} {100 * f['own_stall']:6.1f} {gain} "
+              f"{f['cost']:7} {100 * f['per_kb']:8.2f}  {f['region']:<6} {f['name']}{where}{mark}")
+
+    total_gain = sum(f["gain"] for f in selected)
+    print(f"* {len(selected)} candidates, {spent} of {args.iram_budget} B IRAM"
+          + (f", estimated {100 * total_gain:.1f} % fewer cycles" if has_stalls else ""))
+
+    if args.lf:
+        if not args.map:
+            sys.exit("--lf needs --map for the object of each function")
+        by_archive = {}
+        for f in selected:
+            if f["object"]:
+                by_archive.setdefault(f["object"][0], []).append(f)
+        with open(args.lf, "w", encoding="utf-8") as out:
+            out.write(LF_HEADER.format(sources=", ".join(os.path.basename(p) for p in args.profiles),
+                                       functions=len(selected), cost=spent, gain=100 * total_gain))
+            for archive in sorted(by_archive):
+                component = re.sub(r"[^A-Za-z0-9_]", "_", archive[3:-2] if archive.startswith("lib") else archive)
+                out.write(f"\n[mapping:pc_profile_hot_{component}]\narchive: {archive}\nentries:\n"
+                          "    if PC_PROFILE_IRAM_HOT = y:\n")
+                for f in sorted(by_archive[archive], key=lambda f: (f["object"][1], f["name"])):
+                    out.write(f"        {f['object'][1]}:{f['name']} (noflash)\n")
+                out.write("    else:\n        * (default)\n")
+        print(f"Wrote {args.lf}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -9,10 +9,18 @@ extern "C" {
 #include "freertos/task.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "esp_err.h"
 
 extern SemaphoreHandle_t reconnection_success;
 
+typedef struct {
+    const char *type;           /* "FAT12", "FAT16", "FAT32" or "exFAT" */
+    uint32_t cluster_bytes;
+    uint64_t total_bytes;
+    uint64_t free_bytes;
+} sd_card_fs_info_t;
+
 /**
  * @brief Initialize (or reinitialize) the SDSPI bus and mount the SD card filesystem.
  *
@@ -32,10 +40,64 @@ esp_err_t init_sdspi(void);
 void retry_init_sdspi(void);
 
  /**
- * @brief Launch the SD retry worker task if one is not already running.
+ * @brief Queue the SD retry job on the worker pool if one is not already queued or running.
  */
 void sdspi_schedule_sd_retry(void);
 
+/**
+ * @brief FatFs physical drive number of the mounted card.
+ *
+ * @param[out] out_pdrv Drive number, usable as the "N:" prefix of FatFs paths.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_INVALID_STATE if no card is mounted.
+ */
+esp_err_t sd_card_get_pdrv(uint8_t *out_pdrv);
+
+/**
+ * @brief Report the filesystem type, cluster size and capacity of the mounted card.
+ *
+ * The free count may walk the whole FAT on the first call after mount when the
+ * FAT32 FSInfo sector is not valid, so call it off the UI task.
+ *
+ * @param[out] out Filesystem description.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE if no card is mounted,
+ *         or ESP_FAIL if FatFs could not read the volume.
+ */
+esp_err_t sd_card_get_fs_info(sd_card_fs_info_t *out);
+
+/**
+ * @brief Stop or resume callback of a background card user.
+ *
+ * @param stop     true: return only once the user no longer touches the card
+ *                 and will not start again until resumed; false: resume.
+ * @param user_ctx Context passed to sd_card_register_user().
+ * @return ESP_OK, or an error if the user cannot stop now; it must then keep
+ *         running as if never asked. Ignored when resuming.
+ */
+typedef esp_err_t (*sd_card_user_cb_t)(bool stop, void *user_ctx);
+
+/**
+ * @brief Register a task or job type that reads or writes the card on its own.
+ *
+ * Such users are stopped before the volume is replaced underneath them (a
+ * reformat) and resumed afterwards.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM if the table is full.
+ */
+esp_err_t sd_card_register_user(sd_card_user_cb_t cb, void *user_ctx);
+
+/**
+ * @brief Stop every registered card user, in registration order.
+ *
+ * @return ESP_OK with all of them stopped, or the error of the first one that
+ *         could not stop; those stopped before it are resumed again.
+ */
+esp_err_t sd_card_stop_users(void);
+
+/**
+ * @brief Resume the users stopped by sd_card_stop_users().
+ */
+void sd_card_resume_users(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,100 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef struct {
+    size_t buf_bytes;           /* Size of each write()/read() request */
+    uint64_t file_bytes;        /* Bytes written and read back */
+    uint32_t write_kbps;        /* KB/s including the final fsync() */
+    uint32_t read_kbps;         /* KB/s */
+} sd_card_bench_result_t;
+
+typedef struct {
+    size_t io_bytes;            /* Size of each request */
+    uint32_t ops;               /* Requests per pass */
+    uint32_t read_iops;
+    uint32_t write_iops;        /* Including the final fsync() */
+} sd_card_bench_random_result_t;
+
+typedef struct {
+    size_t io_bytes;            /* Size of each interactive read */
+    uint32_t ops;               /* Reads per pass */
+    uint32_t idle_avg_us;       /* Read latency with nothing else on the bus */
+    uint32_t idle_max_us;
+    uint32_t loaded_avg_us;     /* Read latency while a background job streams writes */
+    uint32_t loaded_max_us;
+    uint32_t background_kbps;   /* Background write throughput during the loaded pass */
+} sd_card_bench_contention_result_t;
+
+/**
+ * @brief Write then read back a temporary file sequentially and time both passes.
+ *
+ * The file is created in @p dir, filled with a position-dependent pattern,
+ * verified on read and removed afterwards.
+ *
+ * @param dir        Directory on the card to hold the temporary file.
+ * @param file_bytes File size in bytes.
+ * @param buf_bytes  Request size for each write()/read() call.
+ * @param[out] out   Measured throughput.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM, ESP_ERR_INVALID_CRC if the
+ *         data read back differs, or ESP_FAIL on I/O errors.
+ */
+esp_err_t sd_card_bench_sequential(const char *dir, uint64_t file_bytes, size_t buf_bytes,
+                                   sd_card_bench_result_t *out);
+
+/**
+ * @brief Time random reads, then random overwrites, of @p io_bytes at aligned offsets.
+ *
+ * A @p file_bytes file is written first (not timed). The offsets come from a
+ * fixed-seed generator so runs on different card layouts touch the same
+ * sequence. The file is removed afterwards.
+ *
+ * @param dir        Directory on the card to hold the temporary file.
+ * @param file_bytes File size in bytes (below 2 GB).
+ * @param io_bytes   Request size; offsets are multiples of it.
+ * @param ops        Requests per pass.
+ * @param[out] out   Measured rates.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM, or ESP_FAIL on I/O errors.
+ */
+esp_err_t sd_card_bench_random(const char *dir, uint64_t file_bytes, size_t io_bytes, uint32_t ops,
+                               sd_card_bench_random_result_t *out);
+
+/**
+ * @brief Time interactive random reads on an idle bus, then under background write load.
+ *
+ * Reads of @p io_bytes go through sd_io as interactive requests. For the second
+ * pass a worker pool job writes a second file through sd_io as background
+ * traffic until the reads are done. With the scheduler working, the loaded
+ * latency stays within about one background slice of the idle one.
+ *
+ * @param dir        Directory on the card to hold the temporary files.
+ * @param file_bytes Size of the file read from (below 2 GB); the writer wraps at the same size.
+ * @param io_bytes   Read size; offsets are multiples of it.
+ * @param ops        Reads per pass.
+ * @param[out] out   Measured latencies.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM, ESP_ERR_INVALID_STATE if the
+ *         worker pool is not running, or ESP_FAIL on I/O errors.
+ */
+esp_err_t sd_card_bench_contention(const char *dir, uint64_t file_bytes, size_t io_bytes, uint32_t ops,
+                                   sd_card_bench_contention_result_t *out);
+
+/**
+ * @brief Run sd_card_bench_sequential() at 4, 16 and 64 KB request sizes and one
+ *        4 KB sd_card_bench_random() and sd_card_bench_contention() pass in the
+ *        card root, logging one line per run with the filesystem type and cluster size.
+ *
+ * Format the same card FAT32 and exFAT (or with different cluster sizes) and
+ * compare the logged lines. File size is @c CONFIG_SDSPI_BENCHMARK_FILE_MB.
+ */
+void sd_card_bench_run(void);
+
+#ifdef __cplusplus
+}
+#endif
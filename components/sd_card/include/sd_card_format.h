@@ -0,0 +1,79 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "sd_card_bench.h"
+
+typedef struct {
+    uint64_t capacity_bytes;
+    uint32_t au_bytes;          /* Allocation unit from the SD Status register, or the spec default */
+    bool au_from_card;          /* false when the card did not report an AU */
+    uint32_t partition_start;   /* First sector of the partition (a multiple of the AU) */
+    uint32_t partition_sectors; /* Partition length, a whole number of AUs */
+    uint32_t cluster_bytes;
+    const char *fs_type;        /* "FAT", "FAT32" or "exFAT" (FAT picks FAT12/16 by size) */
+} sd_card_format_plan_t;
+
+typedef struct {
+    bool before_valid;          /* Card was mounted with room for the benchmark before formatting */
+    bool after_valid;
+    sd_card_bench_result_t seq_before;
+    sd_card_bench_result_t seq_after;
+    sd_card_bench_random_result_t rnd_before;
+    sd_card_bench_random_result_t rnd_after;
+} sd_card_format_report_t;
+
+/**
+ * @brief Progress callback for sd_card_format_run().
+ *
+ * @param step     Short description of the step that is starting.
+ * @param user_ctx Context passed to sd_card_format_run().
+ */
+typedef void (*sd_card_format_progress_cb_t)(const char *step, void *user_ctx);
+
+/**
+ * @brief Derive the aligned layout for the mounted card without touching it.
+ *
+ * The allocation unit comes from the SD Status register (4 MB for SDHC/SDXC
+ * and 256 KB for SDSC when the card does not report one). The partition
+ * starts one AU into the card and spans whole AUs. The cluster size follows
+ * the SD Association file system table: 16 KB up to 1 GB, 32 KB up to 32 GB,
+ * then 128 KB exFAT (or 64 KB FAT32 when FatFs lacks exFAT).
+ *
+ * @param[out] out Layout.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE if no card is
+ *         mounted, or ESP_ERR_INVALID_SIZE if the card is smaller than 4 AUs.
+ */
+esp_err_t sd_card_format_plan(sd_card_format_plan_t *out);
+
+/**
+ * @brief Benchmark, reformat with @p plan, remount and benchmark again.
+ *
+ * Blocking; run it from a worker task, without the display lock or the SD bus.
+ * The registered card users are stopped for the whole run (see
+ * sd_card_stop_users()) and the SD bus is held from unmounting the old volume
+ * until the new one is mounted. On return the card is mounted again at
+ * @c CONFIG_SDSPI_MOUNT_POINT (unless the remount failed) and all previous
+ * contents are gone.
+ *
+ * @param plan        Layout from sd_card_format_plan().
+ * @param[out] report Benchmark results (optional).
+ * @param progress    Optional step callback.
+ * @param user_ctx    Passed to @p progress.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE if no card is
+ *         mounted or a card user (or an SD retry) could not be stopped, in
+ *         which case nothing was written, ESP_ERR_NO_MEM, or ESP_FAIL if
+ *         writing the card or remounting failed.
+ */
+esp_err_t sd_card_format_run(const sd_card_format_plan_t *plan, sd_card_format_report_t *report,
+                             sd_card_format_progress_cb_t progress, void *user_ctx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,83 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "esp_err.h"
+
+/**
+ * @brief Size of a regular file as an unsigned 64-bit byte count.
+ *
+ * newlib's @c off_t is 32-bit on most ESP-IDF targets, so @c st_size of a FAT32
+ * file between 2 and 4 GB comes back negative. This reinterprets it as unsigned.
+ * When FatFs is built with exFAT support and @c off_t is narrower than 64 bits,
+ * the size is queried from FatFs directly for files on the SD card.
+ *
+ * @param path Absolute path that produced @p st (used only for the FatFs fallback).
+ * @param st   Result of stat() on @p path.
+ * @return File size in bytes.
+ */
+uint64_t sd_file_size(const char *path, const struct stat *st);
+
+/**
+ * @brief Seek @p f to an absolute byte offset that may not fit in a @c long.
+ *
+ * Uses fseeko() when @c off_t is 64-bit. With a 32-bit @c off_t (newlib on
+ * the ESP targets) the stream cannot be positioned at or beyond 2 GB, so such
+ * offsets are refused rather than wrapped; the rest of a larger file stays
+ * unreachable through stdio.
+ *
+ * @param f      Open stream.
+ * @param offset Absolute byte offset.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_SIZE if @p offset does
+ *         not fit the stream position, or ESP_FAIL if the seek failed (errno set).
+ */
+esp_err_t sd_file_seek(FILE *f, uint64_t offset);
+
+typedef struct sd_file_dir sd_file_dir_t;
+
+typedef struct {
+    const char *name;       /* valid until the next sd_file_dir_next() */
+    bool is_dir;
+    uint64_t size;
+    time_t modified;        /* as stat() reports it */
+} sd_file_dirent_t;
+
+/**
+ * @brief Open a directory on the card for listing with metadata.
+ *
+ * Unlike readdir(), every entry comes with its size and mtime straight from the
+ * directory record, so listing N files costs one pass instead of N stat() calls
+ * (each of which searches the directory again).
+ *
+ * @param path     Absolute VFS path below the SD mount point.
+ * @param[out] out Iterator; close with sd_file_dir_close().
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NOT_SUPPORTED if @p path is not on
+ *         the card, ESP_ERR_NO_MEM, or ESP_FAIL if FatFs cannot open it.
+ */
+esp_err_t sd_file_dir_open(const char *path, sd_file_dir_t **out);
+
+/**
+ * @brief Read the next entry, skipping "." and "..".
+ *
+ * @param dir        Iterator.
+ * @param[out] entry Entry.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND at the end, or ESP_FAIL on a read error.
+ */
+esp_err_t sd_file_dir_next(sd_file_dir_t *dir, sd_file_dirent_t *entry);
+
+/**
+ * @brief Close an iterator from sd_file_dir_open() (NULL is ignored).
+ */
+void sd_file_dir_close(sd_file_dir_t *dir);
+
+#ifdef __cplusplus
+}
+#endif
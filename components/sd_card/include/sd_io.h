@@ -0,0 +1,94 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Arbitration for the single SDSPI bus. Every request takes the bus for its
+ * duration; when it is released, waiting interactive requests go first, then
+ * background ones in arrival order. Background transfers are split into
+ * slices of CONFIG_SDSPI_IO_SLICE_KB so an interactive request never waits
+ * behind more than one slice.
+ *
+ * Code that bypasses these calls still works (FatFs serializes it) but is
+ * neither prioritized nor counted. Never take the display lock while holding
+ * the bus: the LVGL task takes the bus with the display lock held.
+ */
+
+typedef enum {
+    SD_IO_INTERACTIVE,          /* the user is waiting for the result */
+    SD_IO_BACKGROUND,           /* crawls, conversions, bulk copies */
+    SD_IO_CLASS_COUNT
+} sd_io_class_t;
+
+typedef struct {
+    uint32_t requests;
+    uint32_t slices;            /* bus acquisitions; more than requests for sliced transfers */
+    uint64_t bytes;             /* through sd_io_read()/sd_io_write() */
+    uint32_t wait_avg_us;       /* per slice, time queued for the bus */
+    uint32_t wait_max_us;
+    uint32_t latency_avg_us;    /* per request, start to finish */
+    uint32_t latency_max_us;
+} sd_io_stats_t;
+
+/**
+ * @brief Create the arbitration primitives. Called by init_sdspi(); safe to call again.
+ *
+ * Until then every call below runs unarbitrated.
+ */
+void sd_io_init(void);
+
+/**
+ * @brief Take the bus for a sequence of VFS calls (stat, readdir loops, ...).
+ *
+ * Nests within the same task; the outermost call sets the class.
+ *
+ * @param cls Request class.
+ */
+void sd_io_begin(sd_io_class_t cls);
+
+/**
+ * @brief Release the bus taken by the matching sd_io_begin().
+ */
+void sd_io_end(void);
+
+/**
+ * @brief fread() through the scheduler; background reads are sliced.
+ *
+ * @return Bytes read, as fread() with an element size of 1.
+ */
+size_t sd_io_read(void *buf, size_t len, FILE *f, sd_io_class_t cls);
+
+/**
+ * @brief fwrite() through the scheduler; background writes are sliced.
+ *
+ * @return Bytes written, as fwrite() with an element size of 1.
+ */
+size_t sd_io_write(const void *buf, size_t len, FILE *f, sd_io_class_t cls);
+
+/**
+ * @brief Copy the counters of one class.
+ *
+ * @param cls      Class.
+ * @param[out] out Counters since boot or the last sd_io_reset_stats().
+ */
+void sd_io_get_stats(sd_io_class_t cls, sd_io_stats_t *out);
+
+/**
+ * @brief Zero the counters of both classes.
+ */
+void sd_io_reset_stats(void);
+
+/**
+ * @brief Log one line of counters per class.
+ */
+void sd_io_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,92 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/*
+ * Change journal of the card. Every code path of this firmware that changes
+ * the card publishes what it did, and caches subscribe to drop exactly what a
+ * change affects instead of rescanning. The sequence number and a fingerprint
+ * of the volume (serial number and free cluster count) are kept in NVS, so a
+ * card that was swapped, formatted or edited elsewhere while out of the
+ * device is reported once, at mount, as SD_JOURNAL_RESET.
+ */
+
+#define SD_JOURNAL_MAX_SUBSCRIBERS 8
+
+typedef enum {
+    SD_JOURNAL_CREATED,
+    SD_JOURNAL_DELETED,         /* a deleted directory takes its subtree with it */
+    SD_JOURNAL_RENAMED,         /* includes moves; a directory moves its subtree */
+    SD_JOURNAL_MODIFIED,        /* contents, size or mtime of a file */
+    SD_JOURNAL_RESET,           /* anything may have changed; no path */
+} sd_journal_op_t;
+
+typedef struct {
+    sd_journal_op_t op;
+    uint32_t seq;               /* increases by one per event, persisted across boots */
+    const char *path;           /* absolute VFS path; NULL for SD_JOURNAL_RESET */
+    const char *new_path;       /* SD_JOURNAL_RENAMED only */
+    bool is_dir;
+} sd_journal_event_t;
+
+/**
+ * @brief Subscriber callback, run synchronously on the publishing task.
+ *
+ * Publishers hold neither the SD bus nor a cache lock when they publish, so a
+ * subscriber may take the display lock or its own mutex. It must not touch
+ * the card. @p event and its strings are only valid during the call.
+ */
+typedef void (*sd_journal_cb_t)(const sd_journal_event_t *event, void *user_ctx);
+
+/**
+ * @brief Add a subscriber.
+ *
+ * @param cb       Callback.
+ * @param user_ctx Passed to @p cb.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM if all slots are taken.
+ */
+esp_err_t sd_journal_subscribe(sd_journal_cb_t cb, void *user_ctx);
+
+/**
+ * @brief Remove a subscriber added with the same @p cb and @p user_ctx.
+ */
+void sd_journal_unsubscribe(sd_journal_cb_t cb, void *user_ctx);
+
+/**
+ * @brief Report a change made to the card.
+ *
+ * Call after the change is complete and outside sd_io_begin()/sd_io_end().
+ * Recursive operations publish once for the top-level path.
+ *
+ * @param op       Kind of change (not SD_JOURNAL_RESET).
+ * @param path     Absolute path that changed.
+ * @param new_path Destination for SD_JOURNAL_RENAMED, otherwise NULL.
+ * @param is_dir   Whether @p path is a directory.
+ */
+void sd_journal_publish(sd_journal_op_t op, const char *path, const char *new_path, bool is_dir);
+
+/**
+ * @brief Sequence number of the last event.
+ */
+uint32_t sd_journal_seq(void);
+
+/**
+ * @brief Whether @p path is directly inside directory @p dir.
+ */
+bool sd_journal_in_dir(const char *path, const char *dir);
+
+/**
+ * @brief Whether @p path is @p dir or anything below it.
+ */
+bool sd_journal_in_tree(const char *path, const char *dir);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,22 +1,30 @@
 #include "sd_card.h"
+#include "sd_card_priv.h"
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "bsp/esp-bsp.h"
-#include "driver/sdspi_host.h"
 #include "esp_log.h"
-#include "esp_vfs_fat.h"
 #include "lvgl.h"
-#include "sdmmc_cmd.h"
+#include "sd_io.h"
 #include "settings.h"
+#include "worker_pool.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "ff.h"
+#endif
+#if !CONFIG_IDF_TARGET_LINUX && !CONFIG_SDSPI_CARD_FLASH
+#include "diskio_sdmmc.h"
+#include "driver/sdspi_host.h"
+#include "esp_vfs_fat.h"
+#include "sdmmc_cmd.h"
+#endif
 
 #define SDSPI_RETRY_UI_STEP_MS  50U
 #define SDSPI_RETRY_DELAY_MS    500U
 #define SDSPI_MAX_RETRIES       10U
-
-#define SD_RETRY_STACK   (6 * 1024)
-#define SD_RETRY_PRIO    (4)
+#define SD_CARD_MAX_USERS       4U
 
 typedef struct {
     SemaphoreHandle_t semaphore;
@@ -30,20 +38,28 @@ typedef struct {
     uint32_t total_duration_ms;
 } sdspi_retry_ui_t;
 
+typedef struct {
+    sd_card_user_cb_t cb;
+    void *user_ctx;
+} sd_card_user_t;
+
 static const char *TAG = "sd_card";
+static portMUX_TYPE s_users_mux = portMUX_INITIALIZER_UNLOCKED;
+static sd_card_user_t s_users[SD_CARD_MAX_USERS];
+#if !CONFIG_IDF_TARGET_LINUX && !CONFIG_SDSPI_CARD_FLASH
 static sdmmc_card_t *sd_card_handle = NULL;
 static bool sd_spi_bus_ready = false;
-static TaskHandle_t s_sd_retry_task = NULL;
+#endif
 
 SemaphoreHandle_t reconnection_success = NULL;
 
 /**
- * @brief Blocking worker task used to retry SDSPI init without stalling LVGL callbacks.
+ * @brief Worker pool job used to retry SDSPI init without stalling LVGL callbacks.
  *
- * Running the retry flow in its own FreeRTOS task keeps the UI responsive while the
+ * Running the retry flow on a pool worker keeps the UI responsive while the
  * modal dialog waits for user confirmation and the SDSPI driver reinitializes.
  */
-static void sd_retry_task(void *param);
+static void sd_retry_job(worker_pool_job_t *job, void *arg);
 
 /**
  * @brief LVGL callback fired when the retry dialog button is tapped.
@@ -110,10 +126,23 @@ static void sdspi_retry_ui_destroy(sdspi_retry_ui_t *ui);
  */
 static void sdspi_retry_ui_create(sdspi_retry_ui_t *ui, uint32_t total_duration_ms);
 
+#if !CONFIG_IDF_TARGET_LINUX && !CONFIG_SDSPI_CARD_FLASH
+/* The linux target mounts a host directory instead (sd_card_host.c), QEMU builds a flash partition (sd_card_flash.c) */
 esp_err_t init_sdspi(void)
+{
+    esp_err_t err = sd_card_mount();
+    if (err == ESP_OK) {
+        sd_journal_volume_mounted();
+    }
+    return err;
+}
+
+esp_err_t sd_card_mount(void)
 {
     const char *TAG_INIT_SDSPI = "init_sdspi";
 
+    sd_io_init();
+
     if (sd_card_handle){
         esp_vfs_fat_sdcard_unmount(CONFIG_SDSPI_MOUNT_POINT, sd_card_handle);
         sd_card_handle = NULL;
@@ -168,10 +197,124 @@ esp_err_t init_sdspi(void)
         reconnection_success = xSemaphoreCreateBinary();
         xSemaphoreTake(reconnection_success, 0);
     }
+    return ESP_OK;
+}
+
+sdmmc_card_t *sd_card_get_card_handle(void)
+{
+    return sd_card_handle;
+}
+
+esp_err_t sd_card_get_pdrv(uint8_t *out_pdrv)
+{
+    if (!out_pdrv) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!sd_card_handle) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    BYTE pdrv = ff_diskio_get_pdrv_card(sd_card_handle);
+    if (pdrv == 0xFF) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *out_pdrv = (uint8_t)pdrv;
+    return ESP_OK;
+}
+#endif
+
+#if !CONFIG_IDF_TARGET_LINUX
+esp_err_t sd_card_get_fs_info(sd_card_fs_info_t *out)
+{
+    if (!out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t pdrv = 0;
+    esp_err_t err = sd_card_get_pdrv(&pdrv);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    char drv[4];
+    snprintf(drv, sizeof(drv), "%u:", (unsigned)pdrv);
+    FATFS *fs = NULL;
+    DWORD free_clusters = 0;
+    FRESULT res = f_getfree(drv, &free_clusters, &fs);
+    if (res != FR_OK || !fs) {
+        ESP_LOGE(TAG, "f_getfree(%s) failed (%d)", drv, (int)res);
+        return ESP_FAIL;
+    }
+
+#if FF_MAX_SS != FF_MIN_SS
+    uint32_t sector_bytes = fs->ssize;
+#else
+    uint32_t sector_bytes = FF_MAX_SS;
+#endif
+    switch (fs->fs_type) {
+    case FS_FAT12: out->type = "FAT12"; break;
+    case FS_FAT16: out->type = "FAT16"; break;
+    case FS_FAT32: out->type = "FAT32"; break;
+    case FS_EXFAT: out->type = "exFAT"; break;
+    default:       out->type = "?";     break;
+    }
+    out->cluster_bytes = (uint32_t)fs->csize * sector_bytes;
+    out->total_bytes = (uint64_t)(fs->n_fatent - 2) * out->cluster_bytes;
+    out->free_bytes = (uint64_t)free_clusters * out->cluster_bytes;
+    return ESP_OK;
+}
+#endif
+
+esp_err_t sd_card_register_user(sd_card_user_cb_t cb, void *user_ctx)
+{
+    if (!cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = ESP_ERR_NO_MEM;
+    taskENTER_CRITICAL(&s_users_mux);
+    for (size_t i = 0; i < SD_CARD_MAX_USERS; i++) {
+        if (!s_users[i].cb) {
+            s_users[i] = (sd_card_user_t){ .cb = cb, .user_ctx = user_ctx };
+            err = ESP_OK;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&s_users_mux);
+    return err;
+}
 
+esp_err_t sd_card_stop_users(void)
+{
+    /* The callbacks block, so they run on a copy of the table */
+    sd_card_user_t users[SD_CARD_MAX_USERS];
+    taskENTER_CRITICAL(&s_users_mux);
+    memcpy(users, s_users, sizeof(users));
+    taskEXIT_CRITICAL(&s_users_mux);
+
+    for (size_t i = 0; i < SD_CARD_MAX_USERS && users[i].cb; i++) {
+        esp_err_t err = users[i].cb(true, users[i].user_ctx);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Card user %u cannot stop now (%s)", (unsigned)i, esp_err_to_name(err));
+            while (i-- > 0) {
+                users[i].cb(false, users[i].user_ctx);
+            }
+            return err;
+        }
+    }
     return ESP_OK;
 }
 
+void sd_card_resume_users(void)
+{
+    sd_card_user_t users[SD_CARD_MAX_USERS];
+    taskENTER_CRITICAL(&s_users_mux);
+    memcpy(users, s_users, sizeof(users));
+    taskEXIT_CRITICAL(&s_users_mux);
+
+    for (size_t i = 0; i < SD_CARD_MAX_USERS && users[i].cb; i++) {
+        users[i].cb(false, users[i].user_ctx);
+    }
+}
+
 void retry_init_sdspi(void)
 {
     sdspi_retry_wait_for_confirmation();
@@ -218,28 +361,22 @@ void retry_init_sdspi(void)
 
 void sdspi_schedule_sd_retry(void)
 {
-    if (s_sd_retry_task) {
-        return;
-    }
-
-    BaseType_t res = xTaskCreatePinnedToCore(sd_retry_task,
-                                             "sd_retry",
-                                             SD_RETRY_STACK,
-                                             NULL,
-                                             SD_RETRY_PRIO,
-                                             &s_sd_retry_task,
-                                             tskNO_AFFINITY);
-    if (res != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create SD retry task");
-        s_sd_retry_task = NULL;
+    /* Keyed by name: a second request while the prompt is up joins the running job */
+    const worker_pool_submit_opts_t opts = {
+        .name = "sd_retry",
+        .join_running = true,
+        .cls = WORKER_POOL_INTERACTIVE,
+        .fn = sd_retry_job,
+    };
+    esp_err_t err = worker_pool_submit(&opts, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to queue SD retry: %s", esp_err_to_name(err));
     }
 }
 
-static void sd_retry_task(void *param)
+static void sd_retry_job(worker_pool_job_t *job, void *arg)
 {
     retry_init_sdspi();
-    s_sd_retry_task = NULL;
-    vTaskDelete(NULL);
 }
 
 static void sdspi_retry_prompt_event_cb(lv_event_t *e)
@@ -324,7 +461,7 @@ static void sdspi_retry_ui_set_attempt(sdspi_retry_ui_t *ui, uint32_t attempt)
     if (!bsp_display_lock(0)) {
         return;
     }
-    lv_label_set_text_fmt(ui->attempt_label, "Attempt %lu/%d", attempt, SDSPI_MAX_RETRIES);
+    lv_label_set_text_fmt(ui->attempt_label, "Attempt %lu/%d", (unsigned long)attempt, SDSPI_MAX_RETRIES);
     bsp_display_unlock();
 }
 
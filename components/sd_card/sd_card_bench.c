@@ -0,0 +1,509 @@
+#include "sd_card_bench.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sd_card.h"
+#include "sd_io.h"
+#include "sdkconfig.h"
+#include "worker_pool.h"
+
+#ifndef CONFIG_SDSPI_BENCHMARK_FILE_MB
+#define CONFIG_SDSPI_BENCHMARK_FILE_MB 16
+#endif
+
+#define SD_BENCH_FILE_NAME  ".sdbench.tmp"
+#define SD_BENCH_RANDOM_IO  (4 * 1024)
+#define SD_BENCH_RANDOM_OPS 256
+#define SD_BENCH_RANDOM_MAX (8ull * 1024 * 1024)
+#define SD_BENCH_BG_NAME    ".sdbench_bg.tmp"
+#define SD_BENCH_BG_IO      (16 * 1024)
+
+typedef struct {
+    char path[128];
+    uint64_t wrap_bytes;        /* The writer rewinds here to bound the space it uses */
+    volatile bool stop;
+    SemaphoreHandle_t done;
+    uint64_t bytes;
+    int64_t elapsed_us;
+    esp_err_t err;
+} sd_bench_writer_t;
+
+static const char *TAG = "sd_bench";
+
+/**
+ * @brief Fill @p buf with a pattern derived from its absolute file offset.
+ *
+ * @param buf    Word-aligned buffer.
+ * @param len    Length in bytes (multiple of 4).
+ * @param offset File offset of @p buf[0].
+ */
+static void sd_bench_fill(uint32_t *buf, size_t len, uint64_t offset);
+
+/**
+ * @brief Check a block read back against the pattern written by sd_bench_fill().
+ *
+ * Only the first and last word of the block are compared so the check does
+ * not dominate the measured read time.
+ *
+ * @return true if the block matches.
+ */
+static bool sd_bench_check(const uint32_t *buf, size_t len, uint64_t offset);
+
+/**
+ * @brief Convert a byte count and elapsed microseconds to KB/s.
+ */
+static uint32_t sd_bench_kbps(uint64_t bytes, int64_t us);
+
+/**
+ * @brief Next value of the xorshift32 sequence in @p state.
+ */
+static uint32_t sd_bench_rand(uint32_t *state);
+
+/**
+ * @brief Time @p ops interactive reads at random aligned offsets of @p fd.
+ *
+ * @param[out] avg_us Mean latency.
+ * @param[out] max_us Worst latency.
+ * @return ESP_OK or ESP_FAIL.
+ */
+static esp_err_t sd_bench_interactive_reads(int fd, uint32_t *buf, size_t io_bytes, uint32_t slots, uint32_t ops,
+                                            uint32_t *avg_us, uint32_t *max_us);
+
+/**
+ * @brief Worker pool job streaming background writes until told to stop.
+ *
+ * @param job Unused.
+ * @param arg sd_bench_writer_t owned by sd_card_bench_contention().
+ */
+static void sd_bench_writer_job(worker_pool_job_t *job, void *arg);
+
+/****** Benchmark ******/
+
+esp_err_t sd_card_bench_sequential(const char *dir, uint64_t file_bytes, size_t buf_bytes,
+                                   sd_card_bench_result_t *out)
+{
+    if (!dir || !out || file_bytes == 0 || buf_bytes < 512 || (buf_bytes % 4) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char path[128];
+    int n = snprintf(path, sizeof(path), "%s/%s", dir, SD_BENCH_FILE_NAME);
+    if (n < 0 || n >= (int)sizeof(path)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* DMA-capable and word aligned so the SDSPI driver transfers straight from it */
+    uint32_t *buf = heap_caps_malloc(buf_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (!buf) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->buf_bytes = buf_bytes;
+    out->file_bytes = file_bytes;
+
+    esp_err_t err = ESP_OK;
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0664);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "open(%s) failed (errno=%d)", path, errno);
+        free(buf);
+        return ESP_FAIL;
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    uint64_t done = 0;
+    while (done < file_bytes) {
+        size_t chunk = (file_bytes - done < buf_bytes) ? (size_t)(file_bytes - done) : buf_bytes;
+        sd_bench_fill(buf, chunk, done);
+        ssize_t w = write(fd, buf, chunk);
+        if (w != (ssize_t)chunk) {
+            ESP_LOGE(TAG, "write failed at %" PRIu64 " (errno=%d)", done, errno);
+            err = ESP_FAIL;
+            break;
+        }
+        done += chunk;
+    }
+    if (err == ESP_OK && fsync(fd) != 0) {
+        ESP_LOGE(TAG, "fsync failed (errno=%d)", errno);
+        err = ESP_FAIL;
+    }
+    close(fd);
+    out->write_kbps = sd_bench_kbps(done, esp_timer_get_time() - t0);
+
+    if (err == ESP_OK) {
+        fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            ESP_LOGE(TAG, "open(%s) failed (errno=%d)", path, errno);
+            err = ESP_FAIL;
+        }
+    }
+    if (err == ESP_OK) {
+        t0 = esp_timer_get_time();
+        done = 0;
+        while (done < file_bytes) {
+            size_t chunk = (file_bytes - done < buf_bytes) ? (size_t)(file_bytes - done) : buf_bytes;
+            ssize_t r = read(fd, buf, chunk);
+            if (r != (ssize_t)chunk) {
+                ESP_LOGE(TAG, "read failed at %" PRIu64 " (errno=%d)", done, errno);
+                err = ESP_FAIL;
+                break;
+            }
+            if (!sd_bench_check(buf, chunk, done)) {
+                ESP_LOGE(TAG, "data mismatch at %" PRIu64, done);
+                err = ESP_ERR_INVALID_CRC;
+                break;
+            }
+            done += chunk;
+        }
+        out->read_kbps = sd_bench_kbps(done, esp_timer_get_time() - t0);
+        close(fd);
+    }
+
+    unlink(path);
+    free(buf);
+    return err;
+}
+
+esp_err_t sd_card_bench_random(const char *dir, uint64_t file_bytes, size_t io_bytes, uint32_t ops,
+                               sd_card_bench_random_result_t *out)
+{
+    if (!dir || !out || ops == 0 || io_bytes < 512 || (io_bytes % 4) != 0 ||
+        file_bytes < io_bytes || file_bytes >= 0x80000000ull) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char path[128];
+    int n = snprintf(path, sizeof(path), "%s/%s", dir, SD_BENCH_FILE_NAME);
+    if (n < 0 || n >= (int)sizeof(path)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t *buf = heap_caps_malloc(io_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (!buf) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->io_bytes = io_bytes;
+    out->ops = ops;
+
+    esp_err_t err = ESP_OK;
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0664);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "open(%s) failed (errno=%d)", path, errno);
+        free(buf);
+        return ESP_FAIL;
+    }
+
+    const uint32_t slots = (uint32_t)(file_bytes / io_bytes);
+    for (uint32_t i = 0; i < slots && err == ESP_OK; i++) {
+        sd_bench_fill(buf, io_bytes, (uint64_t)i * io_bytes);
+        if (write(fd, buf, io_bytes) != (ssize_t)io_bytes) {
+            ESP_LOGE(TAG, "prefill write failed (errno=%d)", errno);
+            err = ESP_FAIL;
+        }
+    }
+    if (err == ESP_OK && fsync(fd) != 0) {
+        err = ESP_FAIL;
+    }
+
+    if (err == ESP_OK) {
+        uint32_t seed = 0x9E3779B9u;
+        int64_t t0 = esp_timer_get_time();
+        for (uint32_t i = 0; i < ops; i++) {
+            off_t off = (off_t)(sd_bench_rand(&seed) % slots) * (off_t)io_bytes;
+            if (lseek(fd, off, SEEK_SET) != off || read(fd, buf, io_bytes) != (ssize_t)io_bytes) {
+                ESP_LOGE(TAG, "random read failed at %ld (errno=%d)", (long)off, errno);
+                err = ESP_FAIL;
+                break;
+            }
+        }
+        out->read_iops = (uint32_t)(((uint64_t)ops * 1000000u) / (uint64_t)(esp_timer_get_time() - t0 + 1));
+    }
+
+    if (err == ESP_OK) {
+        uint32_t seed = 0x7F4A7C15u;
+        int64_t t0 = esp_timer_get_time();
+        for (uint32_t i = 0; i < ops; i++) {
+            uint32_t slot = sd_bench_rand(&seed) % slots;
+            off_t off = (off_t)slot * (off_t)io_bytes;
+            sd_bench_fill(buf, io_bytes, (uint64_t)slot * io_bytes);
+            if (lseek(fd, off, SEEK_SET) != off || write(fd, buf, io_bytes) != (ssize_t)io_bytes) {
+                ESP_LOGE(TAG, "random write failed at %ld (errno=%d)", (long)off, errno);
+                err = ESP_FAIL;
+                break;
+            }
+        }
+        if (err == ESP_OK && fsync(fd) != 0) {
+            err = ESP_FAIL;
+        }
+        out->write_iops = (uint32_t)(((uint64_t)ops * 1000000u) / (uint64_t)(esp_timer_get_time() - t0 + 1));
+    }
+
+    close(fd);
+    unlink(path);
+    free(buf);
+    return err;
+}
+
+esp_err_t sd_card_bench_contention(const char *dir, uint64_t file_bytes, size_t io_bytes, uint32_t ops,
+                                   sd_card_bench_contention_result_t *out)
+{
+    if (!dir || !out || ops == 0 || io_bytes < 512 || (io_bytes % 4) != 0 ||
+        file_bytes < io_bytes || file_bytes >= 0x80000000ull) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char path[128];
+    sd_bench_writer_t writer = { .wrap_bytes = file_bytes };
+    int n = snprintf(path, sizeof(path), "%s/%s", dir, SD_BENCH_FILE_NAME);
+    int m = snprintf(writer.path, sizeof(writer.path), "%s/%s", dir, SD_BENCH_BG_NAME);
+    if (n < 0 || n >= (int)sizeof(path) || m < 0 || m >= (int)sizeof(writer.path)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t *buf = heap_caps_malloc(io_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    writer.done = xSemaphoreCreateBinary();
+    if (!buf || !writer.done) {
+        free(buf);
+        if (writer.done) {
+            vSemaphoreDelete(writer.done);
+        }
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->io_bytes = io_bytes;
+    out->ops = ops;
+
+    esp_err_t err = ESP_OK;
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0664);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "open(%s) failed (errno=%d)", path, errno);
+        vSemaphoreDelete(writer.done);
+        free(buf);
+        return ESP_FAIL;
+    }
+
+    const uint32_t slots = (uint32_t)(file_bytes / io_bytes);
+    for (uint32_t i = 0; i < slots && err == ESP_OK; i++) {
+        sd_bench_fill(buf, io_bytes, (uint64_t)i * io_bytes);
+        if (write(fd, buf, io_bytes) != (ssize_t)io_bytes) {
+            ESP_LOGE(TAG, "prefill write failed (errno=%d)", errno);
+            err = ESP_FAIL;
+        }
+    }
+    if (err == ESP_OK && fsync(fd) != 0) {
+        err = ESP_FAIL;
+    }
+
+    if (err == ESP_OK) {
+        err = sd_bench_interactive_reads(fd, buf, io_bytes, slots, ops, &out->idle_avg_us, &out->idle_max_us);
+    }
+
+    if (err == ESP_OK) {
+        const worker_pool_submit_opts_t opts = {
+            .name = "sd_bench_bg",
+            .cls = WORKER_POOL_NORMAL,
+            .fn = sd_bench_writer_job,
+            .arg = &writer,
+        };
+        err = worker_pool_submit(&opts, NULL);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Background writer not queued: %s", esp_err_to_name(err));
+        }
+    }
+    if (err == ESP_OK) {
+        /* Let the writer get going so every read competes with it */
+        vTaskDelay(pdMS_TO_TICKS(100));
+        err = sd_bench_interactive_reads(fd, buf, io_bytes, slots, ops, &out->loaded_avg_us, &out->loaded_max_us);
+        writer.stop = true;
+        xSemaphoreTake(writer.done, portMAX_DELAY);
+        out->background_kbps = sd_bench_kbps(writer.bytes, writer.elapsed_us);
+        if (err == ESP_OK) {
+            err = writer.err;
+        }
+    }
+
+    close(fd);
+    unlink(path);
+    vSemaphoreDelete(writer.done);
+    free(buf);
+    return err;
+}
+
+void sd_card_bench_run(void)
+{
+    static const size_t buf_sizes[] = { 4 * 1024, 16 * 1024, 64 * 1024 };
+
+    sd_card_fs_info_t info = {0};
+    esp_err_t err = sd_card_get_fs_info(&info);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Filesystem info unavailable: %s", esp_err_to_name(err));
+        return;
+    }
+
+    uint64_t file_bytes = (uint64_t)CONFIG_SDSPI_BENCHMARK_FILE_MB * 1024u * 1024u;
+    ESP_LOGI(TAG, "%s, %" PRIu32 " KB clusters, %" PRIu64 " MB total, %" PRIu64 " MB free, %u MB file",
+             info.type, info.cluster_bytes / 1024u,
+             info.total_bytes >> 20, info.free_bytes >> 20,
+             (unsigned)CONFIG_SDSPI_BENCHMARK_FILE_MB);
+    if (info.free_bytes < file_bytes) {
+        ESP_LOGW(TAG, "Not enough free space for the benchmark file");
+        return;
+    }
+
+    for (size_t i = 0; i < sizeof(buf_sizes) / sizeof(buf_sizes[0]); i++) {
+        sd_card_bench_result_t res;
+        err = sd_card_bench_sequential(CONFIG_SDSPI_MOUNT_POINT, file_bytes, buf_sizes[i], &res);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "%u KB requests: %s", (unsigned)(buf_sizes[i] / 1024u), esp_err_to_name(err));
+            continue;
+        }
+        ESP_LOGI(TAG, "%s cluster=%" PRIu32 "K req=%uK write=%" PRIu32 " KB/s read=%" PRIu32 " KB/s",
+                 info.type, info.cluster_bytes / 1024u, (unsigned)(res.buf_bytes / 1024u),
+                 res.write_kbps, res.read_kbps);
+    }
+
+    sd_card_bench_random_result_t rnd;
+    uint64_t rnd_bytes = (file_bytes < SD_BENCH_RANDOM_MAX) ? file_bytes : SD_BENCH_RANDOM_MAX;
+    err = sd_card_bench_random(CONFIG_SDSPI_MOUNT_POINT, rnd_bytes, SD_BENCH_RANDOM_IO, SD_BENCH_RANDOM_OPS, &rnd);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "random %u KB: %s", (unsigned)(SD_BENCH_RANDOM_IO / 1024u), esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGI(TAG, "%s cluster=%" PRIu32 "K random %uK read=%" PRIu32 " IOPS write=%" PRIu32 " IOPS",
+             info.type, info.cluster_bytes / 1024u, (unsigned)(rnd.io_bytes / 1024u),
+             rnd.read_iops, rnd.write_iops);
+
+    sd_card_bench_contention_result_t con;
+    err = sd_card_bench_contention(CONFIG_SDSPI_MOUNT_POINT, rnd_bytes, SD_BENCH_RANDOM_IO, SD_BENCH_RANDOM_OPS,
+                                   &con);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "contention %u KB: %s", (unsigned)(SD_BENCH_RANDOM_IO / 1024u), esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGI(TAG, "%s cluster=%" PRIu32 "K interactive %uK read idle avg/max=%" PRIu32 "/%" PRIu32
+             " us, loaded avg/max=%" PRIu32 "/%" PRIu32 " us, background write=%" PRIu32 " KB/s",
+             info.type, info.cluster_bytes / 1024u, (unsigned)(con.io_bytes / 1024u),
+             con.idle_avg_us, con.idle_max_us, con.loaded_avg_us, con.loaded_max_us, con.background_kbps);
+    sd_io_log_stats();
+}
+
+static void sd_bench_fill(uint32_t *buf, size_t len, uint64_t offset)
+{
+    uint32_t word = (uint32_t)(offset / 4u);
+    for (size_t i = 0; i < len / 4u; i++) {
+        buf[i] = (word + (uint32_t)i) * 2654435761u;
+    }
+}
+
+static bool sd_bench_check(const uint32_t *buf, size_t len, uint64_t offset)
+{
+    size_t words = len / 4u;
+    if (words == 0) {
+        return true;
+    }
+    uint32_t word = (uint32_t)(offset / 4u);
+    return buf[0] == word * 2654435761u &&
+           buf[words - 1] == (word + (uint32_t)(words - 1)) * 2654435761u;
+}
+
+static uint32_t sd_bench_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static esp_err_t sd_bench_interactive_reads(int fd, uint32_t *buf, size_t io_bytes, uint32_t slots, uint32_t ops,
+                                            uint32_t *avg_us, uint32_t *max_us)
+{
+    uint32_t seed = 0x2545F491u;
+    uint64_t total_us = 0;
+    *max_us = 0;
+    for (uint32_t i = 0; i < ops; i++) {
+        off_t off = (off_t)(sd_bench_rand(&seed) % slots) * (off_t)io_bytes;
+        int64_t t0 = esp_timer_get_time();
+        sd_io_begin(SD_IO_INTERACTIVE);
+        bool ok = lseek(fd, off, SEEK_SET) == off && read(fd, buf, io_bytes) == (ssize_t)io_bytes;
+        sd_io_end();
+        uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+        if (!ok) {
+            ESP_LOGE(TAG, "interactive read failed at %ld (errno=%d)", (long)off, errno);
+            return ESP_FAIL;
+        }
+        total_us += us;
+        if (us > *max_us) {
+            *max_us = us;
+        }
+    }
+    *avg_us = (uint32_t)(total_us / ops);
+    return ESP_OK;
+}
+
+static void sd_bench_writer_job(worker_pool_job_t *job, void *arg)
+{
+    sd_bench_writer_t *w = arg;
+    w->err = ESP_OK;
+
+    uint32_t *buf = heap_caps_malloc(SD_BENCH_BG_IO, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    FILE *f = buf ? fopen(w->path, "wb") : NULL;
+    if (!f) {
+        ESP_LOGE(TAG, "Background writer could not start (errno=%d)", errno);
+        w->err = buf ? ESP_FAIL : ESP_ERR_NO_MEM;
+        free(buf);
+        xSemaphoreGive(w->done);
+        return;
+    }
+
+    uint64_t pos = 0;
+    int64_t t0 = esp_timer_get_time();
+    while (!w->stop) {
+        if (pos + SD_BENCH_BG_IO > w->wrap_bytes) {
+            if (fseek(f, 0, SEEK_SET) != 0) {
+                w->err = ESP_FAIL;
+                break;
+            }
+            pos = 0;
+        }
+        sd_bench_fill(buf, SD_BENCH_BG_IO, pos);
+        if (sd_io_write(buf, SD_BENCH_BG_IO, f, SD_IO_BACKGROUND) != SD_BENCH_BG_IO) {
+            ESP_LOGE(TAG, "background write failed (errno=%d)", errno);
+            w->err = ESP_FAIL;
+            break;
+        }
+        pos += SD_BENCH_BG_IO;
+        w->bytes += SD_BENCH_BG_IO;
+    }
+    w->elapsed_us = esp_timer_get_time() - t0;
+
+    fclose(f);
+    unlink(w->path);
+    free(buf);
+    xSemaphoreGive(w->done);
+}
+
+static uint32_t sd_bench_kbps(uint64_t bytes, int64_t us)
+{
+    if (us <= 0) {
+        return 0;
+    }
+    return (uint32_t)((bytes * 1000000u / 1024u) / (uint64_t)us);
+}
@@ -0,0 +1,82 @@
+#include "sd_card.h"
+#include "sd_card_format.h"
+#include "sd_card_priv.h"
+
+#include "diskio_wl.h"
+#include "esp_log.h"
+#include "esp_vfs_fat.h"
+#include "sd_io.h"
+#include "sdkconfig.h"
+
+/*
+ * CONFIG_SDSPI_CARD_FLASH: the "card" is a wear-levelled FAT partition of the
+ * flash, so the firmware runs unmodified in QEMU, which has no SPI card. All
+ * file access still goes through the FAT VFS and FatFs, only the block device
+ * below differs.
+ */
+
+static const char *TAG = "sd_card_flash";
+static wl_handle_t s_wl_handle = WL_INVALID_HANDLE;
+
+esp_err_t init_sdspi(void)
+{
+    sd_io_init();
+
+    if (s_wl_handle != WL_INVALID_HANDLE) {
+        esp_vfs_fat_spiflash_unmount_rw_wl(CONFIG_SDSPI_MOUNT_POINT, s_wl_handle);
+        s_wl_handle = WL_INVALID_HANDLE;
+    }
+
+    const esp_vfs_fat_mount_config_t mount_config = {
+        .format_if_mount_failed = false,
+        .max_files = 5,
+        .allocation_unit_size = 0,
+    };
+    esp_err_t err = esp_vfs_fat_spiflash_mount_rw_wl(CONFIG_SDSPI_MOUNT_POINT, CONFIG_SDSPI_CARD_FLASH_PARTITION,
+                                                     &mount_config, &s_wl_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to mount partition \"%s\": (%s)", CONFIG_SDSPI_CARD_FLASH_PARTITION, esp_err_to_name(err));
+        return err;
+    }
+    ESP_LOGI(TAG, "Partition \"%s\" mounted at %s", CONFIG_SDSPI_CARD_FLASH_PARTITION, CONFIG_SDSPI_MOUNT_POINT);
+
+    if (!reconnection_success){
+        reconnection_success = xSemaphoreCreateBinary();
+        xSemaphoreTake(reconnection_success, 0);
+    }
+
+    sd_journal_volume_mounted();
+    return ESP_OK;
+}
+
+esp_err_t sd_card_get_pdrv(uint8_t *out_pdrv)
+{
+    if (!out_pdrv) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_wl_handle == WL_INVALID_HANDLE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    BYTE pdrv = ff_diskio_get_pdrv_wl(s_wl_handle);
+    if (pdrv == 0xFF) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *out_pdrv = (uint8_t)pdrv;
+    return ESP_OK;
+}
+
+esp_err_t sd_card_format_plan(sd_card_format_plan_t *out)
+{
+    (void)out;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t sd_card_format_run(const sd_card_format_plan_t *plan, sd_card_format_report_t *report,
+                             sd_card_format_progress_cb_t progress, void *user_ctx)
+{
+    (void)plan;
+    (void)report;
+    (void)progress;
+    (void)user_ctx;
+    return ESP_ERR_NOT_SUPPORTED;
+}
@@ -0,0 +1,419 @@
+#include "sd_card_format.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diskio_impl.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "ff.h"
+#include "sd_card.h"
+#include "sd_card_priv.h"
+#include "sd_io.h"
+#include "sdkconfig.h"
+#include "sdmmc_cmd.h"
+#include "worker_pool.h"
+
+#define SD_FORMAT_SECTOR_BYTES      512u
+#define SD_FORMAT_WORK_BYTES        (16 * 1024)
+#define SD_FORMAT_BENCH_BYTES       (4ull * 1024 * 1024)
+#define SD_FORMAT_BENCH_SEQ_IO      (64 * 1024)
+#define SD_FORMAT_BENCH_RND_IO      (4 * 1024)
+#define SD_FORMAT_BENCH_RND_OPS     128u
+#define SD_FORMAT_MAX_ALIGN_SECTORS 32768u      /* FatFs ignores larger data-area alignments */
+
+#define SD_FORMAT_MB                (1024ull * 1024ull)
+#define SD_FORMAT_GB                (1024ull * SD_FORMAT_MB)
+
+static const char *TAG = "sd_format";
+
+/* Sector window exposed to FatFs while f_mkfs() runs: [s_fmt_base, s_fmt_base + s_fmt_count) */
+static sdmmc_card_t *s_fmt_card = NULL;
+static uint32_t s_fmt_base = 0;
+static uint32_t s_fmt_count = 0;
+static uint32_t s_fmt_align = 1;
+
+/**
+ * @brief FatFs disk driver callbacks for the partition window.
+ *
+ * Registered on a spare FatFs drive so f_mkfs() can lay out the volume inside
+ * an aligned partition as if it were a whole disk (FatFs itself always starts
+ * its own partitions at sector 63).
+ */
+static DSTATUS sd_format_disk_init(unsigned char pdrv);
+static DSTATUS sd_format_disk_status(unsigned char pdrv);
+static DRESULT sd_format_disk_read(unsigned char pdrv, unsigned char *buff, uint32_t sector, unsigned count);
+static DRESULT sd_format_disk_write(unsigned char pdrv, const unsigned char *buff, uint32_t sector, unsigned count);
+static DRESULT sd_format_disk_ioctl(unsigned char pdrv, unsigned char cmd, void *buff);
+
+/**
+ * @brief Run f_mkfs() over the partition window and fix up the boot sector.
+ *
+ * @param plan        Layout.
+ * @param sector      512-byte DMA-capable scratch buffer.
+ * @param[out] sys_id MBR partition type matching the filesystem FatFs wrote.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if no FatFs drive slot is free,
+ *         ESP_ERR_NO_MEM, or ESP_FAIL.
+ */
+static esp_err_t sd_format_mkfs(const sd_card_format_plan_t *plan, uint8_t *sector, uint8_t *sys_id);
+
+/**
+ * @brief Write a single-entry MBR for the planned partition to sector 0.
+ */
+static esp_err_t sd_format_write_mbr(sdmmc_card_t *card, const sd_card_format_plan_t *plan,
+                                     uint8_t sys_id, uint8_t *sector);
+
+/**
+ * @brief Time a 64 KB sequential pass and a 4 KB random pass in the card root.
+ *
+ * @return true if both passes completed.
+ */
+static bool sd_format_bench(sd_card_bench_result_t *seq, sd_card_bench_random_result_t *rnd);
+
+static void sd_format_put_le32(uint8_t *p, uint32_t v);
+
+/****** Plan ******/
+
+esp_err_t sd_card_format_plan(sd_card_format_plan_t *out)
+{
+    if (!out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sdmmc_card_t *card = sd_card_get_card_handle();
+    if (!card) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (card->csd.sector_size != SD_FORMAT_SECTOR_BYTES) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    memset(out, 0, sizeof(*out));
+    const uint32_t sectors = (uint32_t)card->csd.capacity;
+    const bool high_capacity = (card->ocr & SD_OCR_SDHC_CAP) != 0;
+    out->capacity_bytes = (uint64_t)sectors * SD_FORMAT_SECTOR_BYTES;
+
+    out->au_bytes = (uint32_t)card->ssr.alloc_unit_kb * 1024u;
+    out->au_from_card = out->au_bytes != 0;
+    if (!out->au_from_card) {
+        out->au_bytes = high_capacity ? 4u * 1024u * 1024u : 256u * 1024u;
+    }
+
+    const uint32_t au_sectors = out->au_bytes / SD_FORMAT_SECTOR_BYTES;
+    if (au_sectors == 0 || sectors / au_sectors < 4) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    out->partition_start = au_sectors;
+    out->partition_sectors = ((sectors - au_sectors) / au_sectors) * au_sectors;
+
+    if (!high_capacity) {
+        out->fs_type = "FAT";
+        out->cluster_bytes = (out->capacity_bytes <= SD_FORMAT_GB) ? 16u * 1024u : 32u * 1024u;
+    } else if (out->capacity_bytes <= 32ull * SD_FORMAT_GB) {
+        out->fs_type = "FAT32";
+        out->cluster_bytes = 32u * 1024u;
+    } else {
+#if FF_FS_EXFAT
+        out->fs_type = "exFAT";
+        out->cluster_bytes = 128u * 1024u;
+#else
+        out->fs_type = "FAT32";
+        out->cluster_bytes = 64u * 1024u;
+#endif
+    }
+    return ESP_OK;
+}
+
+/****** Format ******/
+
+esp_err_t sd_card_format_run(const sd_card_format_plan_t *plan, sd_card_format_report_t *report,
+                             sd_card_format_progress_cb_t progress, void *user_ctx)
+{
+    if (!plan || plan->partition_sectors == 0 || plan->partition_start == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sdmmc_card_t *card = sd_card_get_card_handle();
+    if (!card || s_fmt_card) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* A retry would remount the card halfway through; a queued one is moot once it is reformatted */
+    esp_err_t err = worker_pool_cancel_queued_key("sd_retry");
+    if (err == ESP_OK) {
+        err = sd_card_stop_users();
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Card in use, not formatting: %s", esp_err_to_name(err));
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    sd_card_format_report_t scratch;
+    if (!report) {
+        report = &scratch;
+    }
+    memset(report, 0, sizeof(*report));
+
+    sd_card_fs_info_t info;
+    if (sd_card_get_fs_info(&info) == ESP_OK && info.free_bytes >= 2 * SD_FORMAT_BENCH_BYTES) {
+        if (progress) {
+            progress("Measuring current layout...", user_ctx);
+        }
+        report->before_valid = sd_format_bench(&report->seq_before, &report->rnd_before);
+    }
+
+    uint8_t *sector = heap_caps_calloc(1, SD_FORMAT_SECTOR_BYTES, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (!sector) {
+        sd_card_resume_users();
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (progress) {
+        progress("Formatting...", user_ctx);
+    }
+    ESP_LOGI(TAG, "Formatting: AU %" PRIu32 " KB%s, partition at sector %" PRIu32 " (%" PRIu32 " sectors), %s %" PRIu32 " KB clusters",
+             plan->au_bytes / 1024u, plan->au_from_card ? "" : " (default)",
+             plan->partition_start, plan->partition_sectors, plan->fs_type, plan->cluster_bytes / 1024u);
+
+    /*
+     * From here until the new volume is mounted nobody else may reach the card:
+     * taking the bus waits for the request in flight, and later ones queue
+     * behind the format. No progress callbacks while it is held, they take the
+     * display lock.
+     */
+    sd_io_begin(SD_IO_INTERACTIVE);
+
+    /* Drop FatFs' view of the old volume; sd_card_mount() below replaces the whole mount */
+    uint8_t pdrv = 0;
+    if (sd_card_get_pdrv(&pdrv) == ESP_OK) {
+        char drv[4];
+        snprintf(drv, sizeof(drv), "%u:", (unsigned)pdrv);
+        f_mount(NULL, drv, 0);
+    }
+
+    /* Invalidate the old partition table first so an interrupted format is not mounted half-written */
+    err = sdmmc_write_sectors(card, sector, 0, 1);
+    uint8_t sys_id = 0;
+    if (err == ESP_OK) {
+        s_fmt_card = card;
+        err = sd_format_mkfs(plan, sector, &sys_id);
+        s_fmt_card = NULL;
+    }
+    if (err == ESP_OK) {
+        err = sd_format_write_mbr(card, plan, sys_id, sector);
+    }
+    free(sector);
+    if (err != ESP_OK) {
+        sd_io_end();
+        sd_card_resume_users();
+        ESP_LOGE(TAG, "Format failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    err = sd_card_mount();
+    sd_io_end();
+    if (err != ESP_OK) {
+        sd_card_resume_users();
+        ESP_LOGE(TAG, "Remount after format failed: %s", esp_err_to_name(err));
+        return ESP_FAIL;
+    }
+    sd_journal_volume_mounted();
+
+    if (progress) {
+        progress("Measuring new layout...", user_ctx);
+    }
+    report->after_valid = sd_format_bench(&report->seq_after, &report->rnd_after);
+    sd_card_resume_users();
+    return ESP_OK;
+}
+
+static esp_err_t sd_format_mkfs(const sd_card_format_plan_t *plan, uint8_t *sector, uint8_t *sys_id)
+{
+    BYTE pdrv = 0xFF;
+    if (ff_diskio_get_drive(&pdrv) != ESP_OK || pdrv == 0xFF) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const uint32_t au_sectors = plan->au_bytes / SD_FORMAT_SECTOR_BYTES;
+    s_fmt_base = plan->partition_start;
+    s_fmt_count = plan->partition_sectors;
+    /* FatFs needs a power of two: use the largest one dividing the AU */
+    s_fmt_align = au_sectors & (~au_sectors + 1u);
+    if (s_fmt_align > SD_FORMAT_MAX_ALIGN_SECTORS) {
+        s_fmt_align = SD_FORMAT_MAX_ALIGN_SECTORS;
+    }
+
+    static const ff_diskio_impl_t impl = {
+        .init = sd_format_disk_init,
+        .status = sd_format_disk_status,
+        .read = sd_format_disk_read,
+        .write = sd_format_disk_write,
+        .ioctl = sd_format_disk_ioctl,
+    };
+    ff_diskio_register(pdrv, &impl);
+
+    esp_err_t err = ESP_OK;
+    void *work = heap_caps_malloc(SD_FORMAT_WORK_BYTES, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (!work) {
+        err = ESP_ERR_NO_MEM;
+        goto out;
+    }
+
+    BYTE fmt = FM_FAT;
+    if (strcmp(plan->fs_type, "FAT32") == 0) {
+        fmt = FM_FAT32;
+    }
+#if FF_FS_EXFAT
+    else if (strcmp(plan->fs_type, "exFAT") == 0) {
+        fmt = FM_EXFAT;
+    }
+#endif
+
+    char drv[4];
+    snprintf(drv, sizeof(drv), "%u:", (unsigned)pdrv);
+    MKFS_PARM opt = {
+        .fmt = fmt | FM_SFD,            /* The window is the partition; the MBR is written separately */
+        .n_fat = 2,
+        .align = s_fmt_align,
+        .n_root = 0,
+        .au_size = plan->cluster_bytes,
+    };
+    FRESULT res = f_mkfs(drv, &opt, work, SD_FORMAT_WORK_BYTES);
+    if (res == FR_MKFS_ABORTED) {
+        /* Cluster count out of range for the requested type; let FatFs choose */
+        ESP_LOGW(TAG, "f_mkfs(%s) rejected the layout, retrying with any FAT type", plan->fs_type);
+        opt.fmt = FM_ANY | FM_SFD;
+        res = f_mkfs(drv, &opt, work, SD_FORMAT_WORK_BYTES);
+    }
+    free(work);
+    if (res != FR_OK) {
+        ESP_LOGE(TAG, "f_mkfs failed (%d)", (int)res);
+        err = ESP_FAIL;
+        goto out;
+    }
+
+    if (sd_format_disk_read(pdrv, sector, 0, 1) != RES_OK) {
+        err = ESP_FAIL;
+        goto out;
+    }
+    if (memcmp(sector + 3, "EXFAT   ", 8) == 0) {
+        /* VolumeOffset stays 0; hosts and FatFs locate the volume through the MBR */
+        *sys_id = 0x07;
+    } else {
+        bool fat32 = memcmp(sector + 82, "FAT32   ", 8) == 0;
+        bool fat12 = !fat32 && memcmp(sector + 54, "FAT12   ", 8) == 0;
+        *sys_id = fat32 ? 0x0C : fat12 ? 0x01 : (plan->partition_sectors < 65536u ? 0x04 : 0x06);
+
+        /* BPB_HiddSec: sectors preceding the volume, 0 as written for a superfloppy */
+        sd_format_put_le32(sector + 28, plan->partition_start);
+        if (sd_format_disk_write(pdrv, sector, 0, 1) != RES_OK) {
+            err = ESP_FAIL;
+            goto out;
+        }
+        uint16_t backup = (uint16_t)(sector[50] | (sector[51] << 8));
+        if (fat32 && backup != 0 && sd_format_disk_write(pdrv, sector, backup, 1) != RES_OK) {
+            err = ESP_FAIL;
+        }
+    }
+
+out:
+    ff_diskio_register(pdrv, NULL);
+    return err;
+}
+
+static esp_err_t sd_format_write_mbr(sdmmc_card_t *card, const sd_card_format_plan_t *plan,
+                                     uint8_t sys_id, uint8_t *sector)
+{
+    memset(sector, 0, SD_FORMAT_SECTOR_BYTES);
+    sd_format_put_le32(sector + 440, esp_random());     /* Disk signature */
+
+    uint8_t *pte = sector + 446;
+    pte[0] = 0x00;
+    pte[1] = 0xFE; pte[2] = 0xFF; pte[3] = 0xFF;        /* CHS unused: LBA only */
+    pte[4] = sys_id;
+    pte[5] = 0xFE; pte[6] = 0xFF; pte[7] = 0xFF;
+    sd_format_put_le32(pte + 8, plan->partition_start);
+    sd_format_put_le32(pte + 12, plan->partition_sectors);
+
+    sector[510] = 0x55;
+    sector[511] = 0xAA;
+    return sdmmc_write_sectors(card, sector, 0, 1);
+}
+
+/****** Partition window disk driver ******/
+
+static DSTATUS sd_format_disk_init(unsigned char pdrv)
+{
+    return s_fmt_card ? 0 : STA_NOINIT;
+}
+
+static DSTATUS sd_format_disk_status(unsigned char pdrv)
+{
+    return s_fmt_card ? 0 : STA_NOINIT;
+}
+
+static DRESULT sd_format_disk_read(unsigned char pdrv, unsigned char *buff, uint32_t sector, unsigned count)
+{
+    if (!s_fmt_card || sector >= s_fmt_count || count > s_fmt_count - sector) {
+        return RES_PARERR;
+    }
+    esp_err_t err = sdmmc_read_sectors(s_fmt_card, buff, s_fmt_base + sector, count);
+    return (err == ESP_OK) ? RES_OK : RES_ERROR;
+}
+
+static DRESULT sd_format_disk_write(unsigned char pdrv, const unsigned char *buff, uint32_t sector, unsigned count)
+{
+    if (!s_fmt_card || sector >= s_fmt_count || count > s_fmt_count - sector) {
+        return RES_PARERR;
+    }
+    esp_err_t err = sdmmc_write_sectors(s_fmt_card, buff, s_fmt_base + sector, count);
+    return (err == ESP_OK) ? RES_OK : RES_ERROR;
+}
+
+static DRESULT sd_format_disk_ioctl(unsigned char pdrv, unsigned char cmd, void *buff)
+{
+    switch (cmd) {
+    case CTRL_SYNC:
+        return RES_OK;
+    case GET_SECTOR_COUNT:
+        *(LBA_t *)buff = s_fmt_count;
+        return RES_OK;
+    case GET_SECTOR_SIZE:
+        *(WORD *)buff = SD_FORMAT_SECTOR_BYTES;
+        return RES_OK;
+    case GET_BLOCK_SIZE:
+        *(DWORD *)buff = s_fmt_align;
+        return RES_OK;
+    default:
+        return RES_PARERR;
+    }
+}
+
+/****** Helpers ******/
+
+static bool sd_format_bench(sd_card_bench_result_t *seq, sd_card_bench_random_result_t *rnd)
+{
+    esp_err_t err = sd_card_bench_sequential(CONFIG_SDSPI_MOUNT_POINT, SD_FORMAT_BENCH_BYTES,
+                                             SD_FORMAT_BENCH_SEQ_IO, seq);
+    if (err == ESP_OK) {
+        err = sd_card_bench_random(CONFIG_SDSPI_MOUNT_POINT, SD_FORMAT_BENCH_BYTES,
+                                   SD_FORMAT_BENCH_RND_IO, SD_FORMAT_BENCH_RND_OPS, rnd);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Benchmark failed: %s", esp_err_to_name(err));
+        return false;
+    }
+    ESP_LOGI(TAG, "seq %uK: write %" PRIu32 " KB/s, read %" PRIu32 " KB/s; random %uK: read %" PRIu32 " IOPS, write %" PRIu32 " IOPS",
+             (unsigned)(seq->buf_bytes / 1024u), seq->write_kbps, seq->read_kbps,
+             (unsigned)(rnd->io_bytes / 1024u), rnd->read_iops, rnd->write_iops);
+    return true;
+}
+
+static void sd_format_put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
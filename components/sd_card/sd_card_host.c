@@ -0,0 +1,80 @@
+#include "sd_card.h"
+#include "sd_card_format.h"
+#include "sd_card_priv.h"
+
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+
+#include "esp_log.h"
+#include "sd_io.h"
+#include "sdkconfig.h"
+
+/*
+ * Linux target: the "card" is whatever is found at CONFIG_SDSPI_MOUNT_POINT on
+ * the host, either a plain directory or a FAT image loop-mounted there. The VFS
+ * of the host serves every fopen()/stat() of the app, so only the mount, the
+ * FatFs drive number and the volume figures need a stand-in.
+ */
+
+static const char *TAG = "sd_card_host";
+
+esp_err_t init_sdspi(void)
+{
+    sd_io_init();
+
+    struct stat st;
+    if (stat(CONFIG_SDSPI_MOUNT_POINT, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        ESP_LOGE(TAG, "%s is not a directory; create it or loop-mount a card image there", CONFIG_SDSPI_MOUNT_POINT);
+        return ESP_ERR_NOT_FOUND;
+    }
+    ESP_LOGI(TAG, "Using host directory %s as the SD card", CONFIG_SDSPI_MOUNT_POINT);
+
+    if (!reconnection_success){
+        reconnection_success = xSemaphoreCreateBinary();
+        xSemaphoreTake(reconnection_success, 0);
+    }
+
+    sd_journal_volume_mounted();
+    return ESP_OK;
+}
+
+esp_err_t sd_card_get_pdrv(uint8_t *out_pdrv)
+{
+    /* No FatFs drive behind the host VFS; callers fall back to the POSIX calls */
+    (void)out_pdrv;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t sd_card_get_fs_info(sd_card_fs_info_t *out)
+{
+    if (!out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct statvfs st;
+    if (statvfs(CONFIG_SDSPI_MOUNT_POINT, &st) != 0) {
+        ESP_LOGE(TAG, "statvfs(%s) failed", CONFIG_SDSPI_MOUNT_POINT);
+        return ESP_FAIL;
+    }
+    out->type = "host";
+    out->cluster_bytes = (uint32_t)st.f_frsize;
+    out->total_bytes = (uint64_t)st.f_blocks * st.f_frsize;
+    out->free_bytes = (uint64_t)st.f_bavail * st.f_frsize;
+    return ESP_OK;
+}
+
+esp_err_t sd_card_format_plan(sd_card_format_plan_t *out)
+{
+    (void)out;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t sd_card_format_run(const sd_card_format_plan_t *plan, sd_card_format_report_t *report,
+                             sd_card_format_progress_cb_t progress, void *user_ctx)
+{
+    (void)plan;
+    (void)report;
+    (void)progress;
+    (void)user_ctx;
+    return ESP_ERR_NOT_SUPPORTED;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "sdkconfig.h"
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "sd_protocol_types.h"
+
+/**
+ * @brief Card handle of the current mount, or NULL when unmounted.
+ *
+ * Only for code inside the sd_card component; the handle is freed and
+ * replaced by every init_sdspi().
+ */
+sdmmc_card_t *sd_card_get_card_handle(void);
+#endif
+
+#if !CONFIG_IDF_TARGET_LINUX && !CONFIG_SDSPI_CARD_FLASH
+/**
+ * @brief init_sdspi() without the journal check that follows the mount.
+ *
+ * For callers holding the SD bus: sd_journal_volume_mounted() notifies
+ * subscribers that take the display lock, so it must run after sd_io_end().
+ *
+ * @return As init_sdspi().
+ */
+esp_err_t sd_card_mount(void);
+#endif
+
+/**
+ * @brief Compare the freshly mounted volume with the persisted journal state.
+ *
+ * Called by init_sdspi() after every mount. Publishes SD_JOURNAL_RESET when the
+ * card is another one or was changed while out of the device, then persists the
+ * new fingerprint.
+ */
+void sd_journal_volume_mounted(void);
@@ -0,0 +1,255 @@
+#include "sd_file.h"
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sd_card.h"
+#include "sdkconfig.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <dirent.h>
+#include <fcntl.h>
+#else
+#include "ff.h"
+#endif
+
+#if CONFIG_IDF_TARGET_LINUX
+/* Host build: no FatFs underneath, so the listing comes from readdir() and one fstatat() per entry */
+struct sd_file_dir {
+    DIR *dir;
+};
+#else
+struct sd_file_dir {
+    FF_DIR dir;
+    FILINFO info;
+};
+#endif
+
+#if !CONFIG_IDF_TARGET_LINUX
+/**
+ * @brief Turn an absolute VFS path below the SD mount point into a FatFs path ("N:/...").
+ *
+ * @param path    Absolute VFS path.
+ * @param out     Buffer for the FatFs path.
+ * @param out_len Size of @p out.
+ * @return true if @p path is on the card and fits.
+ */
+static bool sd_file_fatfs_path(const char *path, char *out, size_t out_len);
+#endif
+
+/****** 64-bit sizes ******/
+
+#if FF_FS_EXFAT
+/**
+ * @brief Ask FatFs for the size of a file below the SD mount point.
+ *
+ * @param path Absolute VFS path.
+ * @param[out] size Size in bytes.
+ * @return true if @p path is on the card and f_stat() succeeded.
+ */
+static bool sd_file_fatfs_size(const char *path, uint64_t *size);
+#endif
+
+uint64_t sd_file_size(const char *path, const struct stat *st)
+{
+    if (!st) {
+        return 0;
+    }
+#if FF_FS_EXFAT
+    if (sizeof(st->st_size) < sizeof(uint64_t) && path && S_ISREG(st->st_mode)) {
+        uint64_t size = 0;
+        if (sd_file_fatfs_size(path, &size)) {
+            return size;
+        }
+    }
+#else
+    (void)path;
+#endif
+    if (sizeof(st->st_size) < sizeof(uint64_t)) {
+        /* FAT32 caps files at 4 GB - 1, so the unsigned view of a 32-bit off_t is exact */
+        return (uint64_t)(uint32_t)st->st_size;
+    }
+    return (st->st_size > 0) ? (uint64_t)st->st_size : 0;
+}
+
+esp_err_t sd_file_seek(FILE *f, uint64_t offset)
+{
+    if (!f) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (sizeof(off_t) >= sizeof(uint64_t)) {
+        return (fseeko(f, (off_t)offset, SEEK_SET) == 0) ? ESP_OK : ESP_FAIL;
+    }
+
+    /*
+     * The stream position is an off_t, so a 32-bit one cannot get past 2 GB - 1
+     * however the seek is split up; a SEEK_CUR walk beyond it would only wrap.
+     */
+    if (offset > (uint64_t)LONG_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return (fseek(f, (long)offset, SEEK_SET) == 0) ? ESP_OK : ESP_FAIL;
+}
+
+/****** Directory listing ******/
+
+#if CONFIG_IDF_TARGET_LINUX
+esp_err_t sd_file_dir_open(const char *path, sd_file_dir_t **out)
+{
+    if (!path || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out = NULL;
+
+    sd_file_dir_t *dir = calloc(1, sizeof(*dir));
+    if (!dir) {
+        return ESP_ERR_NO_MEM;
+    }
+    dir->dir = opendir(path);
+    if (!dir->dir) {
+        free(dir);
+        return ESP_FAIL;
+    }
+    *out = dir;
+    return ESP_OK;
+}
+
+esp_err_t sd_file_dir_next(sd_file_dir_t *dir, sd_file_dirent_t *entry)
+{
+    if (!dir || !entry) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (;;) {
+        struct dirent *de = readdir(dir->dir);
+        if (!de) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0) {
+            continue;
+        }
+        struct stat st;
+        if (fstatat(dirfd(dir->dir), de->d_name, &st, 0) != 0) {
+            /* Dangling symlink or removed meanwhile; the card would not have it either */
+            continue;
+        }
+        entry->name = de->d_name;
+        entry->is_dir = S_ISDIR(st.st_mode);
+        entry->size = entry->is_dir ? 0 : sd_file_size(NULL, &st);
+        entry->modified = st.st_mtime;
+        return ESP_OK;
+    }
+}
+
+void sd_file_dir_close(sd_file_dir_t *dir)
+{
+    if (!dir) {
+        return;
+    }
+    closedir(dir->dir);
+    free(dir);
+}
+#else
+esp_err_t sd_file_dir_open(const char *path, sd_file_dir_t **out)
+{
+    if (!path || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out = NULL;
+
+    char ff_path[FF_MAX_LFN + 8];
+    if (!sd_file_fatfs_path(path, ff_path, sizeof(ff_path))) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    sd_file_dir_t *dir = calloc(1, sizeof(*dir));
+    if (!dir) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (f_opendir(&dir->dir, ff_path) != FR_OK) {
+        free(dir);
+        return ESP_FAIL;
+    }
+    *out = dir;
+    return ESP_OK;
+}
+
+esp_err_t sd_file_dir_next(sd_file_dir_t *dir, sd_file_dirent_t *entry)
+{
+    if (!dir || !entry) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    FILINFO *info = &dir->info;
+    for (;;) {
+        if (f_readdir(&dir->dir, info) != FR_OK) {
+            return ESP_FAIL;
+        }
+        if (info->fname[0] == '\0') {
+            return ESP_ERR_NOT_FOUND;
+        }
+        if (strcmp(info->fname, ".") != 0 && strcmp(info->fname, "..") != 0) {
+            break;
+        }
+    }
+
+    /* Same conversion as the FAT VFS uses for st_mtime */
+    struct tm tm = {
+        .tm_sec = (info->ftime & 0x1f) * 2,
+        .tm_min = (info->ftime >> 5) & 0x3f,
+        .tm_hour = info->ftime >> 11,
+        .tm_mday = info->fdate & 0x1f,
+        .tm_mon = ((info->fdate >> 5) & 0x0f) - 1,
+        .tm_year = (info->fdate >> 9) + 80,
+    };
+    entry->name = info->fname;
+    entry->is_dir = (info->fattrib & AM_DIR) != 0;
+    entry->size = entry->is_dir ? 0 : (uint64_t)info->fsize;
+    entry->modified = mktime(&tm);
+    return ESP_OK;
+}
+
+void sd_file_dir_close(sd_file_dir_t *dir)
+{
+    if (!dir) {
+        return;
+    }
+    f_closedir(&dir->dir);
+    free(dir);
+}
+#endif
+
+#if FF_FS_EXFAT
+static bool sd_file_fatfs_size(const char *path, uint64_t *size)
+{
+    char ff_path[FF_MAX_LFN + 8];
+    if (!sd_file_fatfs_path(path, ff_path, sizeof(ff_path))) {
+        return false;
+    }
+
+    FILINFO info;
+    if (f_stat(ff_path, &info) != FR_OK) {
+        return false;
+    }
+    *size = (uint64_t)info.fsize;
+    return true;
+}
+#endif
+
+#if !CONFIG_IDF_TARGET_LINUX
+static bool sd_file_fatfs_path(const char *path, char *out, size_t out_len)
+{
+    const char *mount = CONFIG_SDSPI_MOUNT_POINT;
+    size_t mount_len = strlen(mount);
+    if (strncmp(path, mount, mount_len) != 0 || (path[mount_len] != '/' && path[mount_len] != '\0')) {
+        return false;
+    }
+
+    uint8_t pdrv = 0xFF;
+    if (sd_card_get_pdrv(&pdrv) != ESP_OK) {
+        return false;
+    }
+
+    int n = snprintf(out, out_len, "%u:%s", (unsigned)pdrv, path[mount_len] ? path + mount_len : "/");
+    return n >= 0 && n < (int)out_len;
+}
+#endif
@@ -0,0 +1,291 @@
+#include "sd_io.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#ifndef CONFIG_SDSPI_IO_SLICE_KB
+#define CONFIG_SDSPI_IO_SLICE_KB 8
+#endif
+
+#define SD_IO_SLICE_B           ((size_t)CONFIG_SDSPI_IO_SLICE_KB * 1024u)
+#define SD_IO_MAX_WAITERS       16      /* tasks that can queue for the bus at once, per class */
+
+/* Owner value while the bus is being handed to a waiter that has not woken yet */
+#define SD_IO_HANDOFF           ((TaskHandle_t)1)
+
+typedef struct {
+    uint32_t requests;
+    uint32_t slices;
+    uint64_t bytes;
+    uint64_t wait_us_total;
+    uint64_t latency_us_total;
+    uint32_t wait_us_max;
+    uint32_t latency_us_max;
+} sd_io_counters_t;
+
+static const char *TAG = "sd_io";
+static const char *const s_class_names[SD_IO_CLASS_COUNT] = { "interactive", "background" };
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;      /* guards everything below */
+static SemaphoreHandle_t s_turn[SD_IO_CLASS_COUNT];             /* given once per hand-off to that class */
+static TaskHandle_t s_owner;
+static uint32_t s_depth;                                        /* nesting level of the owner */
+static sd_io_class_t s_owner_cls;
+static int64_t s_begin_us;                                      /* outermost sd_io_begin(), before queueing */
+static uint32_t s_waiting[SD_IO_CLASS_COUNT];
+static sd_io_counters_t s_counters[SD_IO_CLASS_COUNT];
+
+/**
+ * @brief Take the bus, queueing behind the owner if needed.
+ *
+ * @param cls Class of the request.
+ * @return true if this call took the bus, false if the caller already owned it
+ *         (nested) or the scheduler is not initialized.
+ */
+static bool sd_io_acquire(sd_io_class_t cls);
+
+/**
+ * @brief Release one level of ownership; the outermost release hands the bus on.
+ *
+ * Interactive waiters are served before background ones.
+ *
+ * @param bytes Bytes moved under this level, for the counters.
+ */
+static void sd_io_release(size_t bytes);
+
+/**
+ * @brief Count one finished request of @p cls that took @p latency_us.
+ */
+static void sd_io_note_request(sd_io_class_t cls, uint32_t latency_us);
+
+/**
+ * @brief Shared body of sd_io_read() and sd_io_write().
+ */
+static size_t sd_io_transfer(void *buf, size_t len, FILE *f, sd_io_class_t cls, bool write);
+
+void sd_io_init(void)
+{
+    for (int i = 0; i < SD_IO_CLASS_COUNT; i++) {
+        if (!s_turn[i]) {
+            s_turn[i] = xSemaphoreCreateCounting(SD_IO_MAX_WAITERS, 0);
+            if (!s_turn[i]) {
+                ESP_LOGE(TAG, "Failed to create the %s queue; its requests bypass the scheduler", s_class_names[i]);
+            }
+        }
+    }
+}
+
+void sd_io_begin(sd_io_class_t cls)
+{
+    if ((unsigned)cls >= SD_IO_CLASS_COUNT) {
+        cls = SD_IO_INTERACTIVE;
+    }
+    const int64_t t0 = esp_timer_get_time();
+    if (sd_io_acquire(cls)) {
+        /* Only the owner touches it, the lock just keeps the counters consistent */
+        taskENTER_CRITICAL(&s_mux);
+        s_begin_us = t0;
+        taskEXIT_CRITICAL(&s_mux);
+    }
+}
+
+void sd_io_end(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    bool outermost = false;
+    sd_io_class_t cls = SD_IO_INTERACTIVE;
+    int64_t begin_us = 0;
+
+    taskENTER_CRITICAL(&s_mux);
+    if (s_owner == self && s_depth == 1) {
+        outermost = true;
+        cls = s_owner_cls;
+        begin_us = s_begin_us;
+    }
+    taskEXIT_CRITICAL(&s_mux);
+
+    sd_io_release(0);
+    if (outermost) {
+        sd_io_note_request(cls, (uint32_t)(esp_timer_get_time() - begin_us));
+    }
+}
+
+size_t sd_io_read(void *buf, size_t len, FILE *f, sd_io_class_t cls)
+{
+    return sd_io_transfer(buf, len, f, cls, false);
+}
+
+size_t sd_io_write(const void *buf, size_t len, FILE *f, sd_io_class_t cls)
+{
+    return sd_io_transfer((void *)buf, len, f, cls, true);
+}
+
+void sd_io_get_stats(sd_io_class_t cls, sd_io_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    if ((unsigned)cls >= SD_IO_CLASS_COUNT) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_mux);
+    sd_io_counters_t c = s_counters[cls];
+    taskEXIT_CRITICAL(&s_mux);
+
+    out->requests = c.requests;
+    out->slices = c.slices;
+    out->bytes = c.bytes;
+    out->wait_avg_us = c.slices ? (uint32_t)(c.wait_us_total / c.slices) : 0;
+    out->wait_max_us = c.wait_us_max;
+    out->latency_avg_us = c.requests ? (uint32_t)(c.latency_us_total / c.requests) : 0;
+    out->latency_max_us = c.latency_us_max;
+}
+
+void sd_io_reset_stats(void)
+{
+    taskENTER_CRITICAL(&s_mux);
+    memset(s_counters, 0, sizeof(s_counters));
+    taskEXIT_CRITICAL(&s_mux);
+}
+
+void sd_io_log_stats(void)
+{
+    for (int i = 0; i < SD_IO_CLASS_COUNT; i++) {
+        sd_io_stats_t st;
+        sd_io_get_stats((sd_io_class_t)i, &st);
+        ESP_LOGI(TAG, "%-11s req %6lu slices %6lu KB %7lu wait avg/max %6lu/%6lu us latency avg/max %7lu/%7lu us",
+                 s_class_names[i], (unsigned long)st.requests, (unsigned long)st.slices,
+                 (unsigned long)(st.bytes / 1024u), (unsigned long)st.wait_avg_us, (unsigned long)st.wait_max_us,
+                 (unsigned long)st.latency_avg_us, (unsigned long)st.latency_max_us);
+    }
+}
+
+static bool sd_io_acquire(sd_io_class_t cls)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    const int64_t t0 = esp_timer_get_time();
+    bool queued = false;
+
+    taskENTER_CRITICAL(&s_mux);
+    if (!s_turn[cls]) {
+        taskEXIT_CRITICAL(&s_mux);
+        return false;
+    }
+    if (s_owner == self) {
+        s_depth++;
+        taskEXIT_CRITICAL(&s_mux);
+        return false;
+    }
+    if (s_owner == NULL) {
+        /* Nobody can be waiting on a free bus: the last release would have handed it over */
+        s_owner = self;
+    } else {
+        s_waiting[cls]++;
+        queued = true;
+    }
+    taskEXIT_CRITICAL(&s_mux);
+
+    if (queued) {
+        xSemaphoreTake(s_turn[cls], portMAX_DELAY);
+    }
+
+    const uint32_t wait_us = (uint32_t)(esp_timer_get_time() - t0);
+    taskENTER_CRITICAL(&s_mux);
+    s_owner = self;
+    s_depth = 1;
+    s_owner_cls = cls;
+    sd_io_counters_t *c = &s_counters[cls];
+    c->slices++;
+    c->wait_us_total += wait_us;
+    if (wait_us > c->wait_us_max) {
+        c->wait_us_max = wait_us;
+    }
+    taskEXIT_CRITICAL(&s_mux);
+    return true;
+}
+
+static void sd_io_release(size_t bytes)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    SemaphoreHandle_t wake = NULL;
+
+    taskENTER_CRITICAL(&s_mux);
+    if (s_owner != self) {
+        /* Not initialized, or an unbalanced sd_io_end() */
+        taskEXIT_CRITICAL(&s_mux);
+        return;
+    }
+    s_counters[s_owner_cls].bytes += bytes;
+    if (--s_depth > 0) {
+        taskEXIT_CRITICAL(&s_mux);
+        return;
+    }
+    for (int i = 0; i < SD_IO_CLASS_COUNT; i++) {
+        if (s_waiting[i] > 0) {
+            s_waiting[i]--;
+            wake = s_turn[i];
+            break;
+        }
+    }
+    s_owner = wake ? SD_IO_HANDOFF : NULL;
+    taskEXIT_CRITICAL(&s_mux);
+
+    if (wake) {
+        xSemaphoreGive(wake);
+    }
+}
+
+static void sd_io_note_request(sd_io_class_t cls, uint32_t latency_us)
+{
+    taskENTER_CRITICAL(&s_mux);
+    sd_io_counters_t *c = &s_counters[cls];
+    c->requests++;
+    c->latency_us_total += latency_us;
+    if (latency_us > c->latency_us_max) {
+        c->latency_us_max = latency_us;
+    }
+    taskEXIT_CRITICAL(&s_mux);
+}
+
+static size_t sd_io_transfer(void *buf, size_t len, FILE *f, sd_io_class_t cls, bool write)
+{
+    if (!buf || !f || len == 0) {
+        return 0;
+    }
+    if ((unsigned)cls >= SD_IO_CLASS_COUNT) {
+        cls = SD_IO_INTERACTIVE;
+    }
+    const int64_t t0 = esp_timer_get_time();
+    /* Interactive requests go in one piece; background ones give the bus back between slices */
+    const size_t slice = (cls == SD_IO_BACKGROUND) ? SD_IO_SLICE_B : len;
+    uint8_t *p = buf;
+    size_t done = 0;
+    bool nested = false;
+
+    while (done < len) {
+        size_t chunk = (len - done < slice) ? (len - done) : slice;
+        if (!sd_io_acquire(cls)) {
+            /* Inside an sd_io_begin() of this task (or unarbitrated): counted there */
+            nested = true;
+        }
+        size_t n = write ? fwrite(p + done, 1, chunk, f) : fread(p + done, 1, chunk, f);
+        sd_io_release(n);
+        done += n;
+        if (n < chunk) {
+            break;
+        }
+    }
+
+    if (!nested) {
+        sd_io_note_request(cls, (uint32_t)(esp_timer_get_time() - t0));
+    }
+    return done;
+}
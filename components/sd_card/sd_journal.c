@@ -0,0 +1,368 @@
+#include "sd_journal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_crc.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "nvs.h"
+#include "sd_card.h"
+#include "sd_card_priv.h"
+#include "sd_io.h"
+#include "sdkconfig.h"
+#include "worker_pool.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <sys/statvfs.h>
+#else
+#include "diskio_impl.h"
+#include "ff.h"
+#endif
+
+#define SD_JOURNAL_NVS_NAMESPACE    "sdjournal"
+#define SD_JOURNAL_NVS_KEY          "state_v1"
+#define SD_JOURNAL_MAGIC            0x534A524Eu
+#define SD_JOURNAL_VERSION          1u
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;
+    uint32_t vsn;               /* volume serial number from the boot sector */
+    uint32_t free_clusters;     /* moves with nearly every write made elsewhere */
+    uint32_t crc32;
+} sd_journal_blob_t;
+
+typedef struct {
+    sd_journal_cb_t cb;
+    void *user_ctx;
+} sd_journal_sub_t;
+
+static const char *TAG = "sd_journal";
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;      /* guards everything below */
+static sd_journal_sub_t s_subs[SD_JOURNAL_MAX_SUBSCRIBERS];
+static uint32_t s_seq;
+static uint32_t s_vsn;
+static bool s_volume_known;                                     /* s_vsn belongs to the mounted card */
+
+/**
+ * @brief Hand one event to every subscriber.
+ */
+static void sd_journal_dispatch(sd_journal_op_t op, const char *path, const char *new_path, bool is_dir);
+
+/**
+ * @brief Read the serial number and free cluster count of the mounted volume.
+ *
+ * The free count may walk the whole FAT when the FAT32 FSInfo sector is not valid.
+ *
+ * @param[out] vsn           Volume serial number.
+ * @param[out] free_clusters Free clusters.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if no card is mounted, ESP_ERR_NO_MEM, or ESP_FAIL.
+ */
+static esp_err_t sd_journal_fingerprint(uint32_t *vsn, uint32_t *free_clusters);
+
+/**
+ * @brief Load the persisted state and validate magic, version and CRC.
+ */
+static esp_err_t sd_journal_load(sd_journal_blob_t *blob);
+
+/**
+ * @brief Persist @p seq with the current fingerprint of the card.
+ */
+static esp_err_t sd_journal_store(uint32_t seq);
+
+/**
+ * @brief Worker pool job persisting the sequence number of the last event.
+ */
+static void sd_journal_save_job(worker_pool_job_t *job, void *arg);
+
+esp_err_t sd_journal_subscribe(sd_journal_cb_t cb, void *user_ctx)
+{
+    if (!cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = ESP_ERR_NO_MEM;
+    taskENTER_CRITICAL(&s_mux);
+    for (size_t i = 0; i < SD_JOURNAL_MAX_SUBSCRIBERS; i++) {
+        if (!s_subs[i].cb) {
+            s_subs[i] = (sd_journal_sub_t){ .cb = cb, .user_ctx = user_ctx };
+            err = ESP_OK;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&s_mux);
+    return err;
+}
+
+void sd_journal_unsubscribe(sd_journal_cb_t cb, void *user_ctx)
+{
+    taskENTER_CRITICAL(&s_mux);
+    for (size_t i = 0; i < SD_JOURNAL_MAX_SUBSCRIBERS; i++) {
+        if (s_subs[i].cb == cb && s_subs[i].user_ctx == user_ctx) {
+            s_subs[i].cb = NULL;
+            s_subs[i].user_ctx = NULL;
+        }
+    }
+    taskEXIT_CRITICAL(&s_mux);
+}
+
+void sd_journal_publish(sd_journal_op_t op, const char *path, const char *new_path, bool is_dir)
+{
+    if (!path || op == SD_JOURNAL_RESET || (op == SD_JOURNAL_RENAMED && !new_path)) {
+        return;
+    }
+    sd_journal_dispatch(op, path, op == SD_JOURNAL_RENAMED ? new_path : NULL, is_dir);
+
+    /*
+     * Keyed by name: events while a save is queued join it. One arriving while a
+     * save runs may come after that save read the sequence number, so it queues
+     * the next save, which the pool starts only once the running one returned.
+     */
+    const worker_pool_submit_opts_t opts = {
+        .name = "sd_journal_save",
+        .cls = WORKER_POOL_IDLE,
+        .fn = sd_journal_save_job,
+    };
+    esp_err_t err = worker_pool_submit(&opts, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Journal not persisted (%s); the next mount will report a reset", esp_err_to_name(err));
+    }
+}
+
+uint32_t sd_journal_seq(void)
+{
+    taskENTER_CRITICAL(&s_mux);
+    uint32_t seq = s_seq;
+    taskEXIT_CRITICAL(&s_mux);
+    return seq;
+}
+
+bool sd_journal_in_dir(const char *path, const char *dir)
+{
+    if (!path || !dir) {
+        return false;
+    }
+    const char *slash = strrchr(path, '/');
+    if (!slash) {
+        return false;
+    }
+    size_t dir_len = strlen(dir);
+    while (dir_len > 1 && dir[dir_len - 1] == '/') {
+        dir_len--;
+    }
+    size_t parent_len = (slash == path) ? 1 : (size_t)(slash - path);
+    return parent_len == dir_len && strncmp(path, dir, dir_len) == 0;
+}
+
+bool sd_journal_in_tree(const char *path, const char *dir)
+{
+    if (!path || !dir) {
+        return false;
+    }
+    size_t dir_len = strlen(dir);
+    while (dir_len > 1 && dir[dir_len - 1] == '/') {
+        dir_len--;
+    }
+    if (strncmp(path, dir, dir_len) != 0) {
+        return false;
+    }
+    return path[dir_len] == '\0' || path[dir_len] == '/' || (dir_len == 1 && dir[0] == '/');
+}
+
+void sd_journal_volume_mounted(void)
+{
+    uint32_t vsn = 0;
+    uint32_t free_clusters = 0;
+    esp_err_t err = sd_journal_fingerprint(&vsn, &free_clusters);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "No volume fingerprint (%s), treating the card as changed", esp_err_to_name(err));
+    }
+
+    sd_journal_blob_t blob = {0};
+    esp_err_t load_err = sd_journal_load(&blob);
+
+    taskENTER_CRITICAL(&s_mux);
+    if (load_err == ESP_OK && blob.seq > s_seq) {
+        s_seq = blob.seq;   /* first mount since boot */
+    }
+    s_vsn = vsn;
+    s_volume_known = (err == ESP_OK);
+    taskEXIT_CRITICAL(&s_mux);
+
+    const char *reason = NULL;
+    if (err != ESP_OK) {
+        reason = "fingerprint unavailable";
+    } else if (load_err != ESP_OK) {
+        reason = "no journal state";
+    } else if (blob.vsn != vsn) {
+        reason = "different volume";
+    } else if (blob.free_clusters != free_clusters) {
+        reason = "written elsewhere";
+    }
+
+    if (reason) {
+        ESP_LOGI(TAG, "Card %08lX: %s, dropping cached card state", (unsigned long)vsn, reason);
+        sd_journal_dispatch(SD_JOURNAL_RESET, NULL, NULL, false);
+    } else {
+        ESP_LOGI(TAG, "Card %08lX unchanged since event %lu", (unsigned long)vsn, (unsigned long)blob.seq);
+    }
+
+    if (err == ESP_OK && (reason || blob.seq != sd_journal_seq())) {
+        esp_err_t store_err = sd_journal_store(sd_journal_seq());
+        if (store_err != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to persist the journal (%s)", esp_err_to_name(store_err));
+        }
+    }
+}
+
+static void sd_journal_dispatch(sd_journal_op_t op, const char *path, const char *new_path, bool is_dir)
+{
+    sd_journal_sub_t subs[SD_JOURNAL_MAX_SUBSCRIBERS];
+    taskENTER_CRITICAL(&s_mux);
+    uint32_t seq = ++s_seq;
+    memcpy(subs, s_subs, sizeof(subs));
+    taskEXIT_CRITICAL(&s_mux);
+
+    const sd_journal_event_t event = {
+        .op = op,
+        .seq = seq,
+        .path = path,
+        .new_path = new_path,
+        .is_dir = is_dir,
+    };
+    ESP_LOGD(TAG, "#%lu op %d %s%s%s", (unsigned long)seq, (int)op, path ? path : "",
+             new_path ? " -> " : "", new_path ? new_path : "");
+    for (size_t i = 0; i < SD_JOURNAL_MAX_SUBSCRIBERS; i++) {
+        if (subs[i].cb) {
+            subs[i].cb(&event, subs[i].user_ctx);
+        }
+    }
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+static esp_err_t sd_journal_fingerprint(uint32_t *vsn, uint32_t *free_clusters)
+{
+    /* Host build: the file system id and free block count play the serial number and free clusters */
+    struct statvfs st;
+    if (statvfs(CONFIG_SDSPI_MOUNT_POINT, &st) != 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    *vsn = (uint32_t)st.f_fsid;
+    *free_clusters = (uint32_t)st.f_bfree;
+    return ESP_OK;
+}
+#else
+static esp_err_t sd_journal_fingerprint(uint32_t *vsn, uint32_t *free_clusters)
+{
+    uint8_t pdrv = 0;
+    esp_err_t err = sd_card_get_pdrv(&pdrv);
+    if (err != ESP_OK) {
+        return err;
+    }
+    uint8_t *sector = heap_caps_malloc(FF_MAX_SS, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (!sector) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    char drv[4];
+    snprintf(drv, sizeof(drv), "%u:", (unsigned)pdrv);
+    FATFS *fs = NULL;
+    DWORD free_clst = 0;
+
+    sd_io_begin(SD_IO_INTERACTIVE);
+    FRESULT res = f_getfree(drv, &free_clst, &fs);
+    if (res == FR_OK && fs) {
+        /* Through the FatFs disk driver, so an SD card and a flash partition read alike */
+        err = (ff_disk_read(pdrv, sector, fs->volbase, 1) == RES_OK) ? ESP_OK : ESP_FAIL;
+    } else {
+        ESP_LOGE(TAG, "f_getfree(%s) failed (%d)", drv, (int)res);
+        err = ESP_FAIL;
+    }
+    sd_io_end();
+
+    if (err == ESP_OK) {
+        /* BS_VolID sits after the BPB, whose length depends on the FAT type */
+        size_t off = (fs->fs_type == FS_EXFAT) ? 100 : (fs->fs_type == FS_FAT32) ? 67 : 39;
+        *vsn = (uint32_t)sector[off] | ((uint32_t)sector[off + 1] << 8) |
+               ((uint32_t)sector[off + 2] << 16) | ((uint32_t)sector[off + 3] << 24);
+        *free_clusters = (uint32_t)free_clst;
+    }
+    heap_caps_free(sector);
+    return err;
+}
+#endif
+
+static esp_err_t sd_journal_load(sd_journal_blob_t *blob)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(SD_JOURNAL_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    size_t blob_size = sizeof(*blob);
+    err = nvs_get_blob(handle, SD_JOURNAL_NVS_KEY, blob, &blob_size);
+    nvs_close(handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (blob_size != sizeof(*blob)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (blob->magic != SD_JOURNAL_MAGIC || blob->version != SD_JOURNAL_VERSION) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    uint32_t crc = esp_crc32_le(0, (const uint8_t *)blob, sizeof(*blob) - sizeof(blob->crc32));
+    return (crc == blob->crc32) ? ESP_OK : ESP_ERR_INVALID_CRC;
+}
+
+static esp_err_t sd_journal_store(uint32_t seq)
+{
+    uint32_t vsn = 0;
+    uint32_t free_clusters = 0;
+    esp_err_t err = sd_journal_fingerprint(&vsn, &free_clusters);
+    if (err != ESP_OK) {
+        return err;
+    }
+    taskENTER_CRITICAL(&s_mux);
+    bool same_volume = s_volume_known && s_vsn == vsn;
+    taskEXIT_CRITICAL(&s_mux);
+    if (!same_volume) {
+        /* Swapped since the mount check; the remount will sort it out */
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    sd_journal_blob_t blob = {
+        .magic = SD_JOURNAL_MAGIC,
+        .version = SD_JOURNAL_VERSION,
+        .seq = seq,
+        .vsn = vsn,
+        .free_clusters = free_clusters,
+    };
+    blob.crc32 = esp_crc32_le(0, (const uint8_t *)&blob, sizeof(blob) - sizeof(blob.crc32));
+
+    nvs_handle_t handle;
+    err = nvs_open(SD_JOURNAL_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_set_blob(handle, SD_JOURNAL_NVS_KEY, &blob, sizeof(blob));
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return err;
+}
+
+static void sd_journal_save_job(worker_pool_job_t *job, void *arg)
+{
+    (void)job;
+    (void)arg;
+    /* Later events have queued a save of their own (see sd_journal_publish()), so one store is enough */
+    uint32_t seq = sd_journal_seq();
+    esp_err_t err = sd_journal_store(seq);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to persist event %lu (%s)", (unsigned long)seq, esp_err_to_name(err));
+    }
+}
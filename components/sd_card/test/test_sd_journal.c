@@ -0,0 +1,63 @@
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "sd_card.h"
+#include "sd_journal.h"
+#include "sdkconfig.h"
+#include "unity.h"
+#include "worker_pool.h"
+
+#define TEST_PATH       CONFIG_SDSPI_MOUNT_POINT "/.test_journal"
+#define TEST_EVENTS     200
+#define TEST_DRAIN_MS   5000
+
+/* Layout of the persisted state (sd_journal_blob_t in sd_journal.c) */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;
+    uint32_t vsn;
+    uint32_t free_clusters;
+    uint32_t crc32;
+} test_journal_blob_t;
+
+static uint32_t test_persisted_seq(void)
+{
+    nvs_handle_t handle;
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_open("sdjournal", NVS_READONLY, &handle));
+    test_journal_blob_t blob = {0};
+    size_t size = sizeof(blob);
+    esp_err_t err = nvs_get_blob(handle, "state_v1", &blob, &size);
+    nvs_close(handle);
+    TEST_ASSERT_EQUAL(ESP_OK, err);
+    TEST_ASSERT_EQUAL(sizeof(blob), size);
+    return blob.seq;
+}
+
+TEST_CASE("events published while the journal is saved are persisted", "[sd_journal]")
+{
+    esp_err_t err = nvs_flash_init();
+    TEST_ASSERT_TRUE(err == ESP_OK || err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND);
+    err = worker_pool_start();
+    TEST_ASSERT_TRUE(err == ESP_OK || err == ESP_ERR_INVALID_STATE);
+    TEST_ASSERT_EQUAL(ESP_OK, init_sdspi());
+
+    /* Events keep arriving while saves run, so they land before, during and after the stores */
+    for (int i = 0; i < TEST_EVENTS; i++) {
+        sd_journal_publish(SD_JOURNAL_MODIFIED, TEST_PATH, NULL, false);
+        if (i % 4 == 0) {
+            vTaskDelay(1);
+        }
+    }
+
+    int waited_ms = 0;
+    while (worker_pool_is_active("sd_journal_save") && waited_ms < TEST_DRAIN_MS) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+        waited_ms += 10;
+    }
+    TEST_ASSERT_FALSE(worker_pool_is_active("sd_journal_save"));
+    TEST_ASSERT_EQUAL(sd_journal_seq(), test_persisted_seq());
+}
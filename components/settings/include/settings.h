@@ -87,6 +87,35 @@ int settings_get_active_brightness(void);
  */
 bool settings_get_brightness_state(void);
 
+/**
+ * @brief Check whether LVGL rendering is suspended because the backlight is off.
+ * @return true while the screen is dark and refresh/animations are paused.
+ */
+bool settings_is_render_suspended(void);
+
+/**
+ * @brief Resume LVGL rendering after a screen-off suspend.
+ *
+ * Restarts the refresh and animation timers, notifies the resume listener and
+ * renders the areas invalidated while dark, so the first frame is on the panel
+ * before the backlight fades up. No-op if rendering is not suspended.
+ *
+ * @note Takes the display lock (recursive), safe from the LVGL task.
+ */
+void settings_render_resume(void);
+
+/**
+ * @brief Register callbacks for render suspend/resume (backlight off / wake).
+ *
+ * Used to stop UI-only work (e.g. clock refresh) that nobody can see.
+ * Both run in LVGL context.
+ *
+ * @param on_suspend Called after rendering is suspended.
+ * @param on_resume  Called right before the wake frame is rendered.
+ */
+void settings_register_render_callbacks(void (*on_suspend)(void),
+                                        void (*on_resume)(void));
+
 /**
  * @brief Get the stored preference for prompting calibration at startup.
  *
@@ -19,8 +19,11 @@
 #include "nvs.h"
 
 #include "calibration_xpt2046.h"
+#include "jpg_resize.h"
+#include "sd_card_format.h"
 #include "touch_xpt2046.h"
 #include "styles.h"
+#include "worker_pool.h"
 
 #define SETTINGS_NVS_NS                 "settings"
 #define SETTINGS_NVS_ROT_KEY            "rotation_step"
@@ -38,8 +41,6 @@
 #define SETTINGS_MINIMUM_BRIGHTNESS      1   /**< Lowest brightness percentage to avoid black screen */
 #define SETTINGS_DEFAULT_BRIGHTNESS      100
 
-#define SETTINGS_CALIBRATION_TASK_STACK  (10 * 1024)
-#define SETTINGS_CALIBRATION_TASK_PRIO   (5)
 #define SETTINGS_DIM_FADE_MS             500
 #define SETTINGS_OFF_FADE_MS             500
 #define SETTINGS_UP_FADE_MS              250
@@ -77,6 +78,7 @@ typedef struct{
     lv_obj_t *brightness_slider;        /**< Slider to pick brightness percent */
     lv_obj_t *restart_confirm_mbox;     /**< Active restart confirmation dialog (NULL when closed) */
     lv_obj_t *reset_confirm_mbox;       /**< Active reset confirmation dialog (NULL when closed) */
+    lv_obj_t *format_confirm_mbox;      /**< Active format confirmation dialog (NULL when closed) */
     lv_obj_t *datetime_overlay;         /**< Active date/time overlay (NULL when closed) */
     lv_obj_t *screensaver_overlay;      /**< Active screensaver overlay (NULL when closed) */
     lv_obj_t *dt_month_ta;              /**< Month input (MM) */
@@ -106,6 +108,10 @@ typedef struct{
 }settings_ctx_t;
 
 static settings_ctx_t s_settings_ctx;
+
+static lv_obj_t *s_format_status_mbox = NULL;   /**< Progress/result dialog of the running format */
+static lv_obj_t *s_format_status_label = NULL;
+static sd_card_format_plan_t s_format_plan;
 static const char *TAG = "settings";
 static esp_timer_handle_t s_ss_off_timer = NULL;
 static esp_timer_handle_t s_ss_dim_timer = NULL;
@@ -114,6 +120,8 @@ static int s_fade_target = 0;
 static int s_fade_steps_left = 0;
 static int s_fade_direction = 0;
 static bool s_wake_in_progress = false;
+static volatile bool s_render_suspended = false;
+static bool s_render_hook_installed = false;
 
 /**
  * @brief Build the settings screen (header + scrollable settings list).
@@ -223,11 +231,59 @@ static void settings_reset_confirm(lv_event_t *e);
  */
 static void settings_close_reset(lv_event_t *e);
 
+/**
+ * @brief Show the card format confirmation with the planned layout.
+ *
+ * Refuses (with an explanation) while a resize job is writing to the card.
+ *
+ * @param e LVGL event (CLICKED) with user data = settings_ctx_t*.
+ */
+static void settings_format_card(lv_event_t *e);
+
+/**
+ * @brief Confirm formatting: swap the dialog for a progress box and start the worker.
+ *
+ * @param e LVGL event (CLICKED) with user data = settings_ctx_t*.
+ */
+static void settings_format_confirm(lv_event_t *e);
+
+/**
+ * @brief Close the format confirmation dialog without formatting.
+ *
+ * @param e LVGL event (CLICKED) with user data = settings_ctx_t*.
+ */
+static void settings_close_format(lv_event_t *e);
+
+/**
+ * @brief Close the format status dialog after a format that was refused.
+ *
+ * @param e LVGL event (CLICKED).
+ */
+static void settings_close_format_status(lv_event_t *e);
+
+/**
+ * @brief Worker pool job running @ref sd_card_format_run and posting the before/after report.
+ *
+ * Ends with a Restart button: the browser state refers to the old filesystem.
+ *
+ * @param job Unused.
+ * @param arg Unused.
+ */
+static void settings_format_job(worker_pool_job_t *job, void *arg);
+
+/**
+ * @brief Progress callback from the format worker; updates the status dialog.
+ *
+ * @param step     Step description.
+ * @param user_ctx Unused.
+ */
+static void settings_format_progress(const char *step, void *user_ctx);
+
 /**
  * @brief Launch touch calibration from Settings (async).
  *
- * Cleans the current settings screen, marks the context inactive, and spawns a
- * FreeRTOS task to run the calibration flow without blocking the LVGL handler.
+ * Cleans the current settings screen, marks the context inactive, and queues a
+ * worker pool job to run the calibration flow without blocking the LVGL handler.
  *
  * @param e LVGL event (CLICKED) with user data = settings_ctx_t*.
  */
@@ -265,14 +321,15 @@ static void settings_apply_screensaver(lv_event_t *e);
 static void settings_close_screensaver(lv_event_t *e);
 
 /**
- * @brief Background task to run touch calibration and restore UI state.
+ * @brief Worker pool job to run touch calibration and restore UI state.
  *
  * Temporarily forces default rotation for calibration, runs @ref run_calibration,
  * restores the previous rotation, and reopens the settings screen.
  *
- * @param param settings_ctx_t* passed from @ref settings_run_calibration.
+ * @param job Unused.
+ * @param arg settings_ctx_t* passed from @ref settings_run_calibration.
  */
-static void settings_calibration_task(void *param);
+static void settings_calibration_job(worker_pool_job_t *job, void *arg);
 
 /**
  * @brief Clear cached LVGL object pointers in the settings context.
@@ -594,6 +651,33 @@ static void settings_fade_brightness(int target_pct, uint32_t duration_ms);
  */
 static void settings_fade_step_cb(void *arg);
 
+/**
+ * @brief LVGL-context worker that suspends rendering once the backlight is off.
+ *
+ * Pauses the display refresh timer and the animation timer, then notifies the
+ * render listener. Skipped if a wake started before this ran.
+ *
+ * @param arg Unused.
+ */
+static void settings_render_suspend_async(void *arg);
+
+/**
+ * @brief LVGL-context wrapper around @ref settings_render_resume for esp_timer callers.
+ * @param arg Unused.
+ */
+static void settings_render_resume_async(void *arg);
+
+/**
+ * @brief Display event hook that keeps the refresh timer paused while suspended.
+ *
+ * LVGL resumes the refresh timer on every invalidation (LV_EVENT_REFR_REQUEST).
+ * This runs after LVGL's own handler and pauses it again; the invalidated
+ * areas are kept and rendered on wake.
+ *
+ * @param e LVGL display event.
+ */
+static void settings_on_refr_request(lv_event_t *e);
+
 /**
  * @brief Sync brightness slider/label to the current brightness value.
  * @param ctx Settings context.
@@ -657,6 +741,10 @@ static void settings_clear_time_in_nvs(void);
 static void (*s_time_set_cb)(void) = NULL;
 static void (*s_time_reset_cb)(void) = NULL;
 
+/* Callbacks registered by other modules to pause/resume UI-only work while the screen is off. */
+static void (*s_render_suspend_cb)(void) = NULL;
+static void (*s_render_resume_cb)(void) = NULL;
+
 static void build_splash_screen(void)
 {
     lv_obj_t *scr = lv_screen_active();
@@ -822,6 +910,46 @@ bool settings_get_brightness_state(void)
     return s_settings_ctx.changing_brightness; 
 }
 
+void settings_register_render_callbacks(void (*on_suspend)(void),
+                                        void (*on_resume)(void))
+{
+    s_render_suspend_cb = on_suspend;
+    s_render_resume_cb = on_resume;
+}
+
+bool settings_is_render_suspended(void)
+{
+    return s_render_suspended;
+}
+
+void settings_render_resume(void)
+{
+    if (!s_render_suspended) {
+        return;
+    }
+
+    lv_display_t *disp = lv_display_get_default();
+    if (!disp) {
+        s_render_suspended = false;
+        return;
+    }
+
+    bsp_display_lock(0);
+    s_render_suspended = false;
+    lv_timer_t *anim_timer = lv_anim_get_timer();
+    if (anim_timer) {
+        lv_timer_resume(anim_timer);
+    }
+    if (s_render_resume_cb) {
+        s_render_resume_cb();
+    }
+    /* The panel kept its content; render what changed while dark before the fade-up starts. */
+    lv_timer_resume(lv_display_get_refr_timer(disp));
+    lv_refr_now(disp);
+    bsp_display_unlock();
+    ESP_LOGD(TAG, "Rendering resumed");
+}
+
 bool settings_get_calibration_prompt_enabled(void)
 {
     return s_settings_ctx.settings.calibration_prompt_enabled;
@@ -1049,6 +1177,26 @@ static void settings_build_screen(settings_ctx_t *ctx)
     lv_obj_t *reset_lbl = lv_label_create(reset_button);
     lv_label_set_text(reset_lbl, "Reset");
     lv_obj_center(reset_lbl);  
+
+    /* Row: Format card */
+    lv_obj_t *row_actions3 = lv_obj_create(settings_list);
+    lv_obj_remove_style_all(row_actions3);
+    lv_obj_set_flex_flow(row_actions3, LV_FLEX_FLOW_ROW);
+    lv_obj_set_width(row_actions3, LV_PCT(100));
+    lv_obj_set_style_pad_gap(row_actions3, 6, 0);
+    lv_obj_set_style_pad_all(row_actions3, 0, 0);
+    lv_obj_set_height(row_actions3, LV_SIZE_CONTENT);
+
+    lv_obj_t *format_button = lv_button_create(row_actions3);
+    lv_obj_set_flex_grow(format_button, 1);
+    lv_obj_set_style_radius(format_button, 8, 0);
+    lv_obj_set_style_pad_all(format_button, 10, 0);
+    styles_build_button(format_button);
+    lv_obj_add_event_cb(format_button, settings_format_card, LV_EVENT_CLICKED, ctx);
+    lv_obj_set_style_align(format_button, LV_ALIGN_CENTER, 0);
+    lv_obj_t *format_lbl = lv_label_create(format_button);
+    lv_label_set_text(format_lbl, "Format SD Card");
+    lv_obj_center(format_lbl);
 }
 
 static void settings_on_about(lv_event_t *e)
@@ -1098,6 +1246,7 @@ static void settings_on_about(lv_event_t *e)
         "Run Calibration: starts the touch calibration wizard and saves the new calibration data. Also offers startup calibration toggle.",
         "Restart: reboots the device after saving system changes. Note: settings are also saved by simply leaving settings.",
         "Reset: restores and saves screensaver, brightness, rotation and date/time to defaults.",
+        "Format SD Card: erases the card and lays it out aligned to its allocation unit with a cluster size chosen by capacity, measuring throughput before and after.",
     };
 
     for (size_t i = 0; i < sizeof(lines)/sizeof(lines[0]); i++) {
@@ -1217,7 +1366,7 @@ static void apply_default_font_theme(bool lock_display)
         return;
     }
 
-    lv_display_set_theme(disp, theme);
+    lv_display_set_theme(disp, styles_extend_theme(theme));
 
     /* Ensure overlay/system layers also inherit the font (dialogs, prompts, etc.) */
     lv_obj_t *act_scr = lv_display_get_screen_active(disp);
@@ -2210,6 +2359,10 @@ static void settings_fade_brightness(int target_pct, uint32_t duration_ms)
     settings_ctx_t *ctx = &s_settings_ctx;
     int start = ctx->settings.brightness;
     bool rising = target_pct > start;
+    if (rising && s_render_suspended) {
+        lv_async_call(settings_render_resume_async, NULL);
+    }
+
     if (duration_ms == 0 || start == target_pct) {
         ctx->settings.brightness = target_pct;
         bsp_display_brightness_set(target_pct);
@@ -2217,6 +2370,9 @@ static void settings_fade_brightness(int target_pct, uint32_t duration_ms)
         if (!rising) {
             s_wake_in_progress = false;
         }
+        if (target_pct <= 0) {
+            lv_async_call(settings_render_suspend_async, NULL);
+        }
         return;
     }
 
@@ -2257,7 +2413,7 @@ static void settings_fade_brightness(int target_pct, uint32_t duration_ms)
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start fade timer: %s", esp_err_to_name(err));
     } else {
-        ESP_LOGD(TAG, "Fade start: %d -> %d over %ums (step %lldus)", start, target_pct, duration_ms, interval_us);
+        ESP_LOGD(TAG, "Fade start: %d -> %d over %ums (step %lldus)", start, target_pct, duration_ms, (long long)interval_us);
     }
 }
 
@@ -2273,6 +2429,9 @@ static void settings_fade_step_cb(void *arg)
         settings_sync_brightness_ui(&s_settings_ctx, s_fade_target);
         ESP_LOGD(TAG, "Fade complete -> %d", s_fade_target);
         s_wake_in_progress = false;
+        if (s_fade_target <= 0) {
+            lv_async_call(settings_render_suspend_async, NULL);
+        }
         return;
     }
 
@@ -2284,6 +2443,50 @@ static void settings_fade_step_cb(void *arg)
     s_fade_steps_left--;
 }
 
+static void settings_render_suspend_async(void *arg)
+{
+    (void)arg;
+    if (s_render_suspended || s_wake_in_progress || s_settings_ctx.settings.brightness > 0) {
+        return;
+    }
+
+    lv_display_t *disp = lv_display_get_default();
+    if (!disp) {
+        return;
+    }
+
+    if (!s_render_hook_installed) {
+        lv_display_add_event_cb(disp, settings_on_refr_request, LV_EVENT_REFR_REQUEST, NULL);
+        s_render_hook_installed = true;
+    }
+
+    s_render_suspended = true;
+    lv_timer_pause(lv_display_get_refr_timer(disp));
+    lv_timer_t *anim_timer = lv_anim_get_timer();
+    if (anim_timer) {
+        lv_timer_pause(anim_timer);
+    }
+    if (s_render_suspend_cb) {
+        s_render_suspend_cb();
+    }
+    ESP_LOGD(TAG, "Backlight off: rendering suspended");
+}
+
+static void settings_render_resume_async(void *arg)
+{
+    (void)arg;
+    settings_render_resume();
+}
+
+static void settings_on_refr_request(lv_event_t *e)
+{
+    if (!s_render_suspended) {
+        return;
+    }
+    lv_display_t *disp = lv_event_get_target(e);
+    lv_timer_pause(lv_display_get_refr_timer(disp));
+}
+
 static void settings_sync_brightness_ui(settings_ctx_t *ctx, int val)
 {
     (void)ctx;
@@ -2619,6 +2822,205 @@ static void settings_close_reset(lv_event_t *e)
     }    
 }
 
+static void settings_format_card(lv_event_t *e)
+{
+    settings_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || ctx->format_confirm_mbox || worker_pool_is_active("sd_format"))
+    {
+        return;
+    }
+
+    char text[256];
+    bool can_format = false;
+    esp_err_t err = ESP_OK;
+    if (jpg_resize_is_running())
+    {
+        lv_snprintf(text, sizeof(text), "A resize job is writing to the card. Format it once the job has finished.");
+    }
+    else if ((err = sd_card_format_plan(&s_format_plan)) != ESP_OK)
+    {
+        lv_snprintf(text, sizeof(text), "Cannot format this card (%s).", esp_err_to_name(err));
+    }
+    else
+    {
+        lv_snprintf(text, sizeof(text),
+                    "Format the SD card? All files will be erased.\n\n"
+                    "%lu MB, allocation unit %lu KB%s\n%s with %lu KB clusters",
+                    (unsigned long)(s_format_plan.capacity_bytes >> 20),
+                    (unsigned long)(s_format_plan.au_bytes / 1024u),
+                    s_format_plan.au_from_card ? "" : " (default)",
+                    s_format_plan.fs_type,
+                    (unsigned long)(s_format_plan.cluster_bytes / 1024u));
+        can_format = true;
+    }
+
+    lv_obj_t *mbox = lv_msgbox_create(NULL);
+    styles_build_msgbox(mbox);
+    ctx->format_confirm_mbox = mbox;
+    lv_obj_set_style_max_width(mbox, LV_PCT(80), 0);
+    lv_obj_center(mbox);
+
+    lv_obj_t *label = lv_label_create(mbox);
+    lv_label_set_text(label, text);
+    lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
+    lv_obj_set_width(label, LV_PCT(100));
+    lv_obj_set_style_text_color(label, UI_COLOR_TEXT_DARK, 0);
+    lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_CENTER, 0);
+
+    if (can_format)
+    {
+        lv_obj_t *yes_btn = lv_msgbox_add_footer_button(mbox, "Format");
+        styles_build_button(yes_btn);
+        lv_obj_add_event_cb(yes_btn, settings_format_confirm, LV_EVENT_CLICKED, ctx);
+    }
+
+    lv_obj_t *cancel_btn = lv_msgbox_add_footer_button(mbox, can_format ? "Cancel" : "OK");
+    styles_build_button(cancel_btn);
+    lv_obj_add_event_cb(cancel_btn, settings_close_format, LV_EVENT_CLICKED, ctx);
+}
+
+static void settings_format_confirm(lv_event_t *e)
+{
+    settings_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->format_confirm_mbox || worker_pool_is_active("sd_format"))
+    {
+        return;
+    }
+    lv_msgbox_close(ctx->format_confirm_mbox);
+    ctx->format_confirm_mbox = NULL;
+
+    lv_obj_t *mbox = lv_msgbox_create(NULL);
+    styles_build_msgbox(mbox);
+    lv_obj_set_style_max_width(mbox, LV_PCT(80), 0);
+    lv_obj_center(mbox);
+
+    lv_obj_t *label = lv_label_create(mbox);
+    lv_label_set_text(label, "Preparing...");
+    lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
+    lv_obj_set_width(label, LV_PCT(100));
+    lv_obj_set_style_text_color(label, UI_COLOR_TEXT_DARK, 0);
+    lv_obj_set_style_text_align(label, LV_TEXT_ALIGN_CENTER, 0);
+
+    s_format_status_mbox = mbox;
+    s_format_status_label = label;
+
+    const worker_pool_submit_opts_t opts = {
+        .name = "sd_format",
+        .cls = WORKER_POOL_INTERACTIVE,
+        .fn = settings_format_job,
+    };
+    esp_err_t err = worker_pool_submit(&opts, NULL);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to queue format job: %s", esp_err_to_name(err));
+        lv_obj_del(mbox);
+        s_format_status_mbox = NULL;
+        s_format_status_label = NULL;
+    }
+}
+
+static void settings_close_format(lv_event_t *e)
+{
+    settings_ctx_t *ctx = lv_event_get_user_data(e);
+    if (!ctx || !ctx->format_confirm_mbox)
+    {
+        return;
+    }
+    lv_msgbox_close(ctx->format_confirm_mbox);
+    ctx->format_confirm_mbox = NULL;
+}
+
+static void settings_close_format_status(lv_event_t *e)
+{
+    (void)e;
+    if (s_format_status_mbox)
+    {
+        lv_msgbox_close(s_format_status_mbox);
+        s_format_status_mbox = NULL;
+        s_format_status_label = NULL;
+    }
+}
+
+static void settings_format_progress(const char *step, void *user_ctx)
+{
+    (void)user_ctx;
+    if (!step || !bsp_display_lock(0))
+    {
+        return;
+    }
+    if (s_format_status_label)
+    {
+        lv_label_set_text(s_format_status_label, step);
+    }
+    bsp_display_unlock();
+}
+
+static void settings_format_job(worker_pool_job_t *job, void *arg)
+{
+    sd_card_format_report_t report;
+    esp_err_t err = sd_card_format_run(&s_format_plan, &report, settings_format_progress, NULL);
+
+    char text[320];
+    if (err == ESP_ERR_INVALID_STATE)
+    {
+        lv_snprintf(text, sizeof(text), "The card is busy and was not formatted.\nTry again once background work has finished.");
+    }
+    else if (err != ESP_OK)
+    {
+        lv_snprintf(text, sizeof(text), "Format failed (%s).\nThe card may need to be formatted on a PC.",
+                    esp_err_to_name(err));
+    }
+    else
+    {
+        char before[96];
+        char after[96];
+        if (report.before_valid)
+        {
+            lv_snprintf(before, sizeof(before), "W %lu / R %lu KB/s, 4K %lu / %lu IOPS",
+                        (unsigned long)report.seq_before.write_kbps, (unsigned long)report.seq_before.read_kbps,
+                        (unsigned long)report.rnd_before.read_iops, (unsigned long)report.rnd_before.write_iops);
+        }
+        else
+        {
+            lv_snprintf(before, sizeof(before), "not measured");
+        }
+        if (report.after_valid)
+        {
+            lv_snprintf(after, sizeof(after), "W %lu / R %lu KB/s, 4K %lu / %lu IOPS",
+                        (unsigned long)report.seq_after.write_kbps, (unsigned long)report.seq_after.read_kbps,
+                        (unsigned long)report.rnd_after.read_iops, (unsigned long)report.rnd_after.write_iops);
+        }
+        else
+        {
+            lv_snprintf(after, sizeof(after), "not measured");
+        }
+        lv_snprintf(text, sizeof(text), "Card formatted.\n\nBefore: %s\nAfter: %s\n\nRestart to reload the browser.",
+                    before, after);
+    }
+
+    if (bsp_display_lock(0))
+    {
+        if (s_format_status_label)
+        {
+            lv_label_set_text(s_format_status_label, text);
+        }
+        if (s_format_status_mbox && err == ESP_ERR_INVALID_STATE)
+        {
+            /* Nothing was written: the card and the browser are as they were */
+            lv_obj_t *ok_btn = lv_msgbox_add_footer_button(s_format_status_mbox, "OK");
+            styles_build_button(ok_btn);
+            lv_obj_add_event_cb(ok_btn, settings_close_format_status, LV_EVENT_CLICKED, NULL);
+        }
+        else if (s_format_status_mbox)
+        {
+            lv_obj_t *restart_btn = lv_msgbox_add_footer_button(s_format_status_mbox, "Restart");
+            styles_build_button(restart_btn);
+            lv_obj_add_event_cb(restart_btn, settings_restart_confirm, LV_EVENT_CLICKED, &s_settings_ctx);
+        }
+        bsp_display_unlock();
+    }
+}
+
 static void settings_run_calibration(lv_event_t *e)
 {
     settings_ctx_t *ctx = lv_event_get_user_data(e);
@@ -2640,26 +3042,27 @@ static void settings_run_calibration(lv_event_t *e)
     settings_clear_ui_refs(ctx);
 
     /* Run calibration asynchronously to avoid blocking the LVGL task/UI thread. */
-    BaseType_t task_ok = xTaskCreate(settings_calibration_task,
-                                     "settings_calibration",
-                                     SETTINGS_CALIBRATION_TASK_STACK,
-                                     ctx,
-                                     SETTINGS_CALIBRATION_TASK_PRIO,
-                                     NULL);
-    if (task_ok != pdPASS)
+    const worker_pool_submit_opts_t opts = {
+        .name = "settings_calibration",
+        .join_running = true,
+        .cls = WORKER_POOL_INTERACTIVE,
+        .fn = settings_calibration_job,
+        .arg = ctx,
+    };
+    esp_err_t err = worker_pool_submit(&opts, NULL);
+    if (err != ESP_OK)
     {
-        ESP_LOGE(TAG, "Failed to start calibration task");
+        ESP_LOGE(TAG, "Failed to queue calibration job: %s", esp_err_to_name(err));
         settings_set_running_calibration(false);
     }
 }
 
-static void settings_calibration_task(void *param)
+static void settings_calibration_job(worker_pool_job_t *job, void *arg)
 {
-    settings_ctx_t *ctx = (settings_ctx_t *)param;
+    settings_ctx_t *ctx = (settings_ctx_t *)arg;
 
     if (!ctx || !ctx->return_screen){
         settings_set_running_calibration(false);
-        vTaskDelete(NULL);
         return;
     }
 
@@ -2699,7 +3102,6 @@ static void settings_calibration_task(void *param)
     bsp_display_unlock();
     
     settings_set_running_calibration(false);
-    vTaskDelete(NULL);
 }
 
 static void settings_clear_ui_refs(settings_ctx_t *ctx)
@@ -2713,6 +3115,7 @@ static void settings_clear_ui_refs(settings_ctx_t *ctx)
     ctx->brightness_slider = NULL;
     ctx->restart_confirm_mbox = NULL;
     ctx->reset_confirm_mbox = NULL;
+    ctx->format_confirm_mbox = NULL;
     ctx->datetime_overlay = NULL;
     ctx->screensaver_overlay = NULL;
     ctx->dt_month_ta = NULL;
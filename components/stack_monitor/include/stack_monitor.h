@@ -0,0 +1,81 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#define STACK_MONITOR_MAX_TASKS     24
+#define STACK_MONITOR_NAME_LEN      16
+
+typedef struct {
+    char name[STACK_MONITOR_NAME_LEN];
+    uint32_t stack_bytes;       /* size given to xTaskCreate, 0 if nobody declared it */
+    uint32_t min_free_bytes;    /* lowest high-water mark seen this session */
+    uint32_t samples;
+    bool alive;                 /* present in the latest sample */
+} stack_monitor_entry_t;
+
+#if CONFIG_STACK_MONITOR
+
+/**
+ * @brief Start the sampler task.
+ *
+ * Every CONFIG_STACK_MONITOR_PERIOD_MS the high-water mark of every task is
+ * folded into a per-name minimum; every CONFIG_STACK_MONITOR_REPORT_S the
+ * table is logged with a suggested size per task.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if already running, or ESP_ERR_NO_MEM.
+ */
+esp_err_t stack_monitor_start(void);
+
+/**
+ * @brief Declare the stack size a task was created with, for the headroom report.
+ *
+ * @param name        Task name as passed to xTaskCreate.
+ * @param stack_bytes Stack depth in bytes.
+ */
+void stack_monitor_note_task(const char *name, uint32_t stack_bytes);
+
+/**
+ * @brief Sample the calling task one last time; call right before vTaskDelete(NULL).
+ *
+ * Short-lived workers may come and go between two periodic samples.
+ */
+void stack_monitor_task_exit(void);
+
+/**
+ * @brief Copy the current table.
+ *
+ * @param[out] out Entries.
+ * @param max      Capacity of @p out.
+ * @return Number of entries written.
+ */
+size_t stack_monitor_snapshot(stack_monitor_entry_t *out, size_t max);
+
+/**
+ * @brief Log the headroom table now.
+ */
+void stack_monitor_log_report(void);
+
+#else
+
+static inline void stack_monitor_note_task(const char *name, uint32_t stack_bytes)
+{
+    (void)name;
+    (void)stack_bytes;
+}
+
+static inline void stack_monitor_task_exit(void) {}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
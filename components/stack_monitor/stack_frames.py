@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""List the largest stack frames from GCC's -fstack-usage output.
+
+With CONFIG_STACK_MONITOR the build adds -fstack-usage, which leaves a .su
+file next to every object. Run after `idf.py build`:
+
+    python components/stack_monitor/stack_frames.py build
+    python components/stack_monitor/stack_frames.py build --all --threshold 512
+
+Frames above the threshold and frames GCC could not bound (alloca/VLA) are
+flagged; compare them against the used bytes in the runtime report of the
+task that calls them.
+"""
+
+import argparse
+import os
+import sys
+
+
+def read_su(path):
+    # Line format: "file.c:123:45:function_name\t240\tstatic"
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            parts = line.rstrip("\n").split("\t")
+            if len(parts) != 3:
+                continue
+            location, size, kind = parts
+            try:
+                yield location, int(size), kind
+            except ValueError:
+                continue
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("build_dir", help="IDF build directory")
+    parser.add_argument("--threshold", type=int, default=1024, help="flag frames of at least this many bytes")
+    parser.add_argument("--all", action="store_true", help="include IDF and third_party components")
+    parser.add_argument("--top", type=int, default=40, help="rows to print")
+    args = parser.parse_args()
+
+    frames = []
+    for root, _, files in os.walk(args.build_dir):
+        for name in files:
+            if not name.endswith(".su"):
+                continue
+            for location, size, kind in read_su(os.path.join(root, name)):
+                if not args.all and "third_party" in location:
+                    continue
+                if not args.all and "/components/" not in location and "/main/" not in location:
+                    continue
+                frames.append((size, kind, location))
+
+    if not frames:
+        print("No .su files found; build with CONFIG_STACK_MONITOR first", file=sys.stderr)
+        return 1
+
+    frames.sort(reverse=True)
+    flagged = 0
+    print(f"{'bytes':>7}  {'kind':<16} function")
+    for size, kind, location in frames[:args.top]:
+        mark = ""
+        if kind == "dynamic":
+            mark = "  <-- unbounded"
+        elif size >= args.threshold:
+            mark = "  <-- large"
+        if mark:
+            flagged += 1
+        print(f"{size:>7}  {kind:<16} {location}{mark}")
+    print(f"{flagged} of the top {min(args.top, len(frames))} frames flagged (threshold {args.threshold} B)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
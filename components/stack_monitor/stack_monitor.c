@@ -0,0 +1,197 @@
+#include "stack_monitor.h"
+
+#if CONFIG_STACK_MONITOR
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+static const char *TAG = "stack_mon";
+
+#define STACK_MONITOR_TASK_STACK    (3 * 1024)
+#define STACK_MONITOR_TASK_PRIO     (1)
+#define STACK_MONITOR_ROUND_BYTES   256
+#define STACK_MONITOR_SHRINK_SLACK  1024    /* don't suggest shrinking by less than this */
+
+static stack_monitor_entry_t s_entries[STACK_MONITOR_MAX_TASKS];
+static size_t s_entry_count;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_task;
+static TaskStatus_t s_status[STACK_MONITOR_MAX_TASKS];
+
+/**
+ * @brief Find or add the entry for @p name. Call with @c s_lock held.
+ *
+ * @param name Task name.
+ * @return Entry, or NULL when the table is full.
+ */
+static stack_monitor_entry_t *stack_monitor_entry(const char *name);
+
+/**
+ * @brief Fold one high-water mark into the table. Call with @c s_lock held.
+ *
+ * @param name      Task name.
+ * @param free_bytes High-water mark (bytes never used).
+ */
+static void stack_monitor_record(const char *name, uint32_t free_bytes);
+
+/**
+ * @brief Sample every task, then sleep; logs the report periodically.
+ *
+ * @param arg Unused.
+ */
+static void stack_monitor_task(void *arg);
+
+esp_err_t stack_monitor_start(void)
+{
+    if (s_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    stack_monitor_note_task("stack_mon", STACK_MONITOR_TASK_STACK);
+    BaseType_t res = xTaskCreatePinnedToCore(stack_monitor_task,
+                                             "stack_mon",
+                                             STACK_MONITOR_TASK_STACK,
+                                             NULL,
+                                             STACK_MONITOR_TASK_PRIO,
+                                             &s_task,
+                                             tskNO_AFFINITY);
+    if (res != pdPASS) {
+        s_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void stack_monitor_note_task(const char *name, uint32_t stack_bytes)
+{
+    if (!name) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_lock);
+    stack_monitor_entry_t *entry = stack_monitor_entry(name);
+    if (entry) {
+        entry->stack_bytes = stack_bytes;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+void stack_monitor_task_exit(void)
+{
+    const char *name = pcTaskGetName(NULL);
+    uint32_t free_bytes = uxTaskGetStackHighWaterMark(NULL);
+    taskENTER_CRITICAL(&s_lock);
+    stack_monitor_record(name, free_bytes);
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+size_t stack_monitor_snapshot(stack_monitor_entry_t *out, size_t max)
+{
+    if (!out) {
+        return 0;
+    }
+    taskENTER_CRITICAL(&s_lock);
+    size_t count = s_entry_count < max ? s_entry_count : max;
+    memcpy(out, s_entries, count * sizeof(out[0]));
+    taskEXIT_CRITICAL(&s_lock);
+    return count;
+}
+
+void stack_monitor_log_report(void)
+{
+    static stack_monitor_entry_t snap[STACK_MONITOR_MAX_TASKS];
+    size_t count = stack_monitor_snapshot(snap, STACK_MONITOR_MAX_TASKS);
+
+    ESP_LOGI(TAG, "%-16s %6s %6s %6s %7s", "task", "size", "used", "free", "suggest");
+    for (size_t i = 0; i < count; i++) {
+        const stack_monitor_entry_t *e = &snap[i];
+        if (e->samples == 0) {
+            continue;
+        }
+        if (e->stack_bytes == 0) {
+            ESP_LOGI(TAG, "%-16s %6s %6s %6lu %7s %s", e->name, "?", "?", (unsigned long)e->min_free_bytes, "-",
+                     e->min_free_bytes < CONFIG_STACK_MONITOR_MARGIN ? "LOW" : "");
+            continue;
+        }
+
+        uint32_t used = e->stack_bytes > e->min_free_bytes ? e->stack_bytes - e->min_free_bytes : e->stack_bytes;
+        uint32_t suggest = used + CONFIG_STACK_MONITOR_MARGIN;
+        suggest = (suggest + STACK_MONITOR_ROUND_BYTES - 1) / STACK_MONITOR_ROUND_BYTES * STACK_MONITOR_ROUND_BYTES;
+
+        const char *verdict = "";
+        if (e->min_free_bytes < CONFIG_STACK_MONITOR_MARGIN) {
+            verdict = "LOW";
+        } else if (suggest + STACK_MONITOR_SHRINK_SLACK <= e->stack_bytes) {
+            verdict = "shrink";
+        }
+        if (verdict[0] == 'L') {
+            ESP_LOGW(TAG, "%-16s %6lu %6lu %6lu %7lu %s", e->name, (unsigned long)e->stack_bytes, (unsigned long)used,
+                     (unsigned long)e->min_free_bytes, (unsigned long)suggest, verdict);
+        } else {
+            ESP_LOGI(TAG, "%-16s %6lu %6lu %6lu %7lu %s", e->name, (unsigned long)e->stack_bytes, (unsigned long)used,
+                     (unsigned long)e->min_free_bytes, (unsigned long)suggest, verdict);
+        }
+    }
+}
+
+static stack_monitor_entry_t *stack_monitor_entry(const char *name)
+{
+    for (size_t i = 0; i < s_entry_count; i++) {
+        if (strncmp(s_entries[i].name, name, STACK_MONITOR_NAME_LEN - 1) == 0) {
+            return &s_entries[i];
+        }
+    }
+    if (s_entry_count >= STACK_MONITOR_MAX_TASKS) {
+        return NULL;
+    }
+    stack_monitor_entry_t *entry = &s_entries[s_entry_count++];
+    memset(entry, 0, sizeof(*entry));
+    strlcpy(entry->name, name, sizeof(entry->name));
+    entry->min_free_bytes = UINT32_MAX;
+    return entry;
+}
+
+static void stack_monitor_record(const char *name, uint32_t free_bytes)
+{
+    stack_monitor_entry_t *entry = stack_monitor_entry(name);
+    if (!entry) {
+        return;
+    }
+    if (free_bytes < entry->min_free_bytes) {
+        entry->min_free_bytes = free_bytes;
+    }
+    entry->samples++;
+}
+
+static void stack_monitor_task(void *arg)
+{
+    TickType_t last_report = xTaskGetTickCount();
+    for (;;) {
+        UBaseType_t count = uxTaskGetSystemState(s_status, STACK_MONITOR_MAX_TASKS, NULL);
+        if (count == 0) {
+            ESP_LOGW(TAG, "More than %d tasks, sampling skipped", STACK_MONITOR_MAX_TASKS);
+        }
+
+        taskENTER_CRITICAL(&s_lock);
+        for (size_t i = 0; i < s_entry_count; i++) {
+            s_entries[i].alive = false;
+        }
+        for (UBaseType_t i = 0; i < count; i++) {
+            stack_monitor_record(s_status[i].pcTaskName, s_status[i].usStackHighWaterMark);
+            stack_monitor_entry_t *entry = stack_monitor_entry(s_status[i].pcTaskName);
+            if (entry) {
+                entry->alive = true;
+            }
+        }
+        taskEXIT_CRITICAL(&s_lock);
+
+        if (xTaskGetTickCount() - last_report >= pdMS_TO_TICKS(CONFIG_STACK_MONITOR_REPORT_S * 1000)) {
+            last_report = xTaskGetTickCount();
+            stack_monitor_log_report();
+        }
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_STACK_MONITOR_PERIOD_MS));
+    }
+}
+
+#endif
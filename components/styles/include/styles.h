@@ -6,18 +6,45 @@ extern "C" {
 
 #include "lvgl.h"
 
-#define UI_COLOR_BG_DARK             lv_color_hex(0x101214)
-#define UI_COLOR_CARD_DARK           lv_color_hex(0x202327)
-#define UI_COLOR_BORDER_DARK         lv_color_hex(0x2D3034)
-#define UI_COLOR_BUTTON_BORDER_DARK  lv_color_hex(0xBBAAFF)
-#define UI_COLOR_INDICATOR_OFF_DARK  lv_color_hex(0x00055F)
-#define UI_COLOR_TEXT_DARK           lv_color_hex(0xDCDCDC)
-#define UI_COLOR_ACCENT_BLUE_DARK    lv_color_hex(0x7D5FFF)
-#define UI_COLOR_ACCENT_BLUE_DARK_2  lv_color_hex(0x347AFF)
-#define UI_COLOR_ACCENT_GREEN_DARK   lv_color_hex(0x37B24D)
-
-
-
+#define UI_HEX_BG_DARK               0x101214
+#define UI_HEX_CARD_DARK             0x202327
+#define UI_HEX_FIELD_DARK            0x4B4E51   /* lv_color_lighten(CARD, 50), precomputed */
+#define UI_HEX_BORDER_DARK           0x2D3034
+#define UI_HEX_BUTTON_BORDER_DARK    0xBBAAFF
+#define UI_HEX_INDICATOR_OFF_DARK    0x00055F
+#define UI_HEX_TEXT_DARK             0xDCDCDC
+#define UI_HEX_ACCENT_BLUE_DARK      0x7D5FFF
+#define UI_HEX_ACCENT_BLUE_DARK_2    0x347AFF
+#define UI_HEX_ACCENT_GREEN_DARK     0x37B24D
+
+#define UI_COLOR_BG_DARK             lv_color_hex(UI_HEX_BG_DARK)
+#define UI_COLOR_CARD_DARK           lv_color_hex(UI_HEX_CARD_DARK)
+#define UI_COLOR_FIELD_DARK          lv_color_hex(UI_HEX_FIELD_DARK)
+#define UI_COLOR_BORDER_DARK         lv_color_hex(UI_HEX_BORDER_DARK)
+#define UI_COLOR_BUTTON_BORDER_DARK  lv_color_hex(UI_HEX_BUTTON_BORDER_DARK)
+#define UI_COLOR_INDICATOR_OFF_DARK  lv_color_hex(UI_HEX_INDICATOR_OFF_DARK)
+#define UI_COLOR_TEXT_DARK           lv_color_hex(UI_HEX_TEXT_DARK)
+#define UI_COLOR_ACCENT_BLUE_DARK    lv_color_hex(UI_HEX_ACCENT_BLUE_DARK)
+#define UI_COLOR_ACCENT_BLUE_DARK_2  lv_color_hex(UI_HEX_ACCENT_BLUE_DARK_2)
+#define UI_COLOR_ACCENT_GREEN_DARK   lv_color_hex(UI_HEX_ACCENT_GREEN_DARK)
+
+/**
+ * @brief Wrap @p base in the app theme and return the theme to install.
+ *
+ * The returned theme keeps @p base as its parent and additionally attaches the
+ * shared list-row style to every `lv_list` button, so rows created with
+ * lv_list_add_btn() need no per-object styling. Call with the display lock held.
+ *
+ * @param base Theme returned by lv_theme_default_init() (or any other theme).
+ * @return Pointer to a static theme suitable for lv_display_set_theme(), or
+ *         @p base unchanged when it is NULL.
+ */
+lv_theme_t *styles_extend_theme(lv_theme_t *base);
+
+/*
+ * The builders below attach shared, constant styles with lv_obj_add_style().
+ * Nothing is allocated per object besides the style-list slot itself.
+ */
 void styles_build_button(lv_obj_t *button);
 void styles_build_switch(lv_obj_t *switch_button);
 void styles_build_textarea(lv_obj_t *textarea);
@@ -27,4 +54,4 @@ void styles_build_keyboard(lv_obj_t *kbd);
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
@@ -1,17 +1,132 @@
 #include "styles.h"
 
+#include "src/themes/lv_theme_private.h"
+
+/* Compile-time colour from a 0xRRGGBB literal, usable inside const style tables. */
+#define STYLES_COLOR(hex) LV_COLOR_MAKE(((hex) >> 16) & 0xFF, ((hex) >> 8) & 0xFF, (hex) & 0xFF)
+
+/* lv_obj_add_style() takes a mutable pointer but never writes to a const style. */
+#define STYLES_REF(style) ((lv_style_t *)&(style))
+
+/* ----- Button ----- */
+static const lv_style_const_prop_t s_button_props[] = {
+    LV_STYLE_CONST_BG_COLOR(STYLES_COLOR(UI_HEX_ACCENT_BLUE_DARK)),
+    LV_STYLE_CONST_BG_OPA(LV_OPA_COVER),
+    LV_STYLE_CONST_BORDER_COLOR(STYLES_COLOR(UI_HEX_BUTTON_BORDER_DARK)),
+    LV_STYLE_CONST_BORDER_WIDTH(1),
+    LV_STYLE_CONST_SHADOW_WIDTH(0),
+    LV_STYLE_CONST_TEXT_COLOR(STYLES_COLOR(UI_HEX_TEXT_DARK)),
+    LV_STYLE_CONST_PROPS_END
+};
+static LV_STYLE_CONST_INIT(s_button_style, s_button_props);
+
+/* ----- Switch ----- */
+static const lv_style_const_prop_t s_switch_main_props[] = {
+    LV_STYLE_CONST_BG_COLOR(STYLES_COLOR(UI_HEX_CARD_DARK)),
+    LV_STYLE_CONST_PROPS_END
+};
+static LV_STYLE_CONST_INIT(s_switch_main_style, s_switch_main_props);
+
+static const lv_style_const_prop_t s_switch_indicator_props[] = {
+    LV_STYLE_CONST_BG_COLOR(STYLES_COLOR(UI_HEX_INDICATOR_OFF_DARK)),
+    LV_STYLE_CONST_BG_OPA(LV_OPA_COVER),
+    LV_STYLE_CONST_PROPS_END
+};
+static LV_STYLE_CONST_INIT(s_switch_indicator_style, s_switch_indicator_props);
+
+static const lv_style_const_prop_t s_switch_knob_props[] = {
+    LV_STYLE_CONST_BG_COLOR(STYLES_COLOR(UI_HEX_ACCENT_BLUE_DARK)),
+    LV_STYLE_CONST_BORDER_COLOR(STYLES_COLOR(UI_HEX_BUTTON_BORDER_DARK)),
+    LV_STYLE_CONST_BORDER_WIDTH(2),
+    LV_STYLE_CONST_PROPS_END
+};
+static LV_STYLE_CONST_INIT(s_switch_knob_style, s_switch_knob_props);
+
+/* ----- Textarea ----- */
+static const lv_style_const_prop_t s_textarea_props[] = {
+    LV_STYLE_CONST_BG_COLOR(STYLES_COLOR(UI_HEX_FIELD_DARK)),
+    LV_STYLE_CONST_BG_OPA(LV_OPA_COVER),
+    LV_STYLE_CONST_BORDER_COLOR(STYLES_COLOR(UI_HEX_BORDER_DARK)),
+    LV_STYLE_CONST_BORDER_WIDTH(1),
+    LV_STYLE_CONST_TEXT_COLOR(STYLES_COLOR(UI_HEX_TEXT_DARK)),
+    LV_STYLE_CONST_PROPS_END
+};
+static LV_STYLE_CONST_INIT(s_textarea_style, s_textarea_props);
+
+/* ----- Card (msgbox body, keyboard background and keys) ----- */
+static const lv_style_const_prop_t s_card_props[] = {
+    LV_STYLE_CONST_BG_COLOR(STYLES_COLOR(UI_HEX_CARD_DARK)),
+    LV_STYLE_CONST_BG_OPA(LV_OPA_COVER),
+    LV_STYLE_CONST_BORDER_COLOR(STYLES_COLOR(UI_HEX_BORDER_DARK)),
+    LV_STYLE_CONST_BORDER_WIDTH(1),
+    LV_STYLE_CONST_TEXT_COLOR(STYLES_COLOR(UI_HEX_TEXT_DARK)),
+    LV_STYLE_CONST_PROPS_END
+};
+static LV_STYLE_CONST_INIT(s_card_style, s_card_props);
+
+static const lv_style_const_prop_t s_text_props[] = {
+    LV_STYLE_CONST_TEXT_COLOR(STYLES_COLOR(UI_HEX_TEXT_DARK)),
+    LV_STYLE_CONST_PROPS_END
+};
+static LV_STYLE_CONST_INIT(s_text_style, s_text_props);
+
+/* ----- Keyboard ----- */
+static const lv_style_const_prop_t s_keyboard_main_props[] = {
+    LV_STYLE_CONST_RADIUS(6),
+    LV_STYLE_CONST_PROPS_END
+};
+static LV_STYLE_CONST_INIT(s_keyboard_main_style, s_keyboard_main_props);
+
+/* Pressed/checked/focused keys: subtle dark instead of accent */
+static const lv_style_const_prop_t s_keyboard_key_active_props[] = {
+    LV_STYLE_CONST_BG_COLOR(STYLES_COLOR(UI_HEX_BORDER_DARK)),
+    LV_STYLE_CONST_BG_OPA(LV_OPA_COVER),
+    LV_STYLE_CONST_TEXT_COLOR(STYLES_COLOR(UI_HEX_TEXT_DARK)),
+    LV_STYLE_CONST_PROPS_END
+};
+static LV_STYLE_CONST_INIT(s_keyboard_key_active_style, s_keyboard_key_active_props);
+
+/* ----- List rows (attached by the theme) ----- */
+static const lv_style_const_prop_t s_list_row_props[] = {
+    LV_STYLE_CONST_PAD_TOP(3),
+    LV_STYLE_CONST_PAD_BOTTOM(3),
+    LV_STYLE_CONST_PAD_LEFT(3),
+    LV_STYLE_CONST_PAD_RIGHT(3),
+    LV_STYLE_CONST_PROPS_END
+};
+static LV_STYLE_CONST_INIT(s_list_row_style, s_list_row_props);
+
+static lv_theme_t s_theme;
+
+/**
+ * @brief Theme apply callback: adds the shared styles on top of the parent theme.
+ *
+ * @param theme Unused (always @ref s_theme).
+ * @param obj   Freshly created object.
+ */
+static void styles_theme_apply_cb(lv_theme_t *theme, lv_obj_t *obj);
+
+lv_theme_t *styles_extend_theme(lv_theme_t *base)
+{
+    if (!base) {
+        return NULL;
+    }
+    if (base == &s_theme) {
+        return &s_theme;
+    }
+
+    s_theme = *base;
+    lv_theme_set_parent(&s_theme, base);
+    lv_theme_set_apply_cb(&s_theme, styles_theme_apply_cb);
+    return &s_theme;
+}
+
 void styles_build_button(lv_obj_t *button)
 {
     if (!button) {
         return;
     }
-    lv_obj_set_style_bg_color(button, UI_COLOR_ACCENT_BLUE_DARK, LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(button, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_border_color(button, UI_COLOR_BUTTON_BORDER_DARK, LV_PART_MAIN);
-    lv_obj_set_style_border_width(button, 1, LV_PART_MAIN);
-    lv_obj_set_style_shadow_width(button, 0, LV_PART_MAIN);
-    lv_obj_set_style_text_color(button, UI_COLOR_TEXT_DARK, LV_PART_MAIN);
-    lv_obj_set_style_text_color(button, UI_COLOR_TEXT_DARK, LV_PART_MAIN);
+    lv_obj_add_style(button, STYLES_REF(s_button_style), LV_PART_MAIN);
 }
 
 void styles_build_switch(lv_obj_t *switch_button)
@@ -19,24 +134,17 @@ void styles_build_switch(lv_obj_t *switch_button)
     if (!switch_button) {
         return;
     }
-    lv_obj_set_style_bg_color(switch_button, UI_COLOR_CARD_DARK, LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(switch_button, LV_OPA_COVER, LV_PART_INDICATOR);
-    lv_obj_set_style_bg_color(switch_button, UI_COLOR_ACCENT_BLUE_DARK, LV_PART_KNOB);
-    lv_obj_set_style_border_color(switch_button, UI_COLOR_BUTTON_BORDER_DARK, LV_PART_KNOB);
-    lv_obj_set_style_bg_color(switch_button, UI_COLOR_INDICATOR_OFF_DARK, LV_PART_INDICATOR | LV_STATE_DEFAULT);
-    lv_obj_set_style_border_width(switch_button, 2, LV_PART_KNOB);  
+    lv_obj_add_style(switch_button, STYLES_REF(s_switch_main_style), LV_PART_MAIN);
+    lv_obj_add_style(switch_button, STYLES_REF(s_switch_indicator_style), LV_PART_INDICATOR);
+    lv_obj_add_style(switch_button, STYLES_REF(s_switch_knob_style), LV_PART_KNOB);
 }
 
 void styles_build_textarea(lv_obj_t *textarea)
 {
     if (!textarea) {
         return;
-    }    
-    lv_obj_set_style_bg_color(textarea, lv_color_lighten(UI_COLOR_CARD_DARK, 50), 0);
-    lv_obj_set_style_bg_opa(textarea, LV_OPA_COVER, 0);
-    lv_obj_set_style_border_color(textarea, UI_COLOR_BORDER_DARK, 0);
-    lv_obj_set_style_border_width(textarea, 1, 0);
-    lv_obj_set_style_text_color(textarea, UI_COLOR_TEXT_DARK, 0);
+    }
+    lv_obj_add_style(textarea, STYLES_REF(s_textarea_style), LV_PART_MAIN);
 }
 
 void styles_build_msgbox(lv_obj_t *mbox)
@@ -44,12 +152,8 @@ void styles_build_msgbox(lv_obj_t *mbox)
     if (!mbox) {
         return;
     }
-    lv_obj_set_style_bg_color(mbox, UI_COLOR_CARD_DARK, LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(mbox, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_border_color(mbox, UI_COLOR_BORDER_DARK, LV_PART_MAIN);
-    lv_obj_set_style_border_width(mbox, 1, LV_PART_MAIN);
-    lv_obj_set_style_text_color(mbox, UI_COLOR_TEXT_DARK, LV_PART_MAIN);
-    lv_obj_set_style_text_color(mbox, UI_COLOR_TEXT_DARK, LV_PART_ITEMS);
+    lv_obj_add_style(mbox, STYLES_REF(s_card_style), LV_PART_MAIN);
+    lv_obj_add_style(mbox, STYLES_REF(s_text_style), LV_PART_ITEMS);
 }
 
 void styles_build_keyboard(lv_obj_t *kbd)
@@ -57,28 +161,20 @@ void styles_build_keyboard(lv_obj_t *kbd)
     if (!kbd) {
         return;
     }
-    lv_obj_set_style_bg_color(kbd, UI_COLOR_CARD_DARK, LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(kbd, LV_OPA_COVER, LV_PART_MAIN);
-    lv_obj_set_style_border_color(kbd, UI_COLOR_BORDER_DARK, LV_PART_MAIN);
-    lv_obj_set_style_border_width(kbd, 1, LV_PART_MAIN);
-    lv_obj_set_style_radius(kbd, 6, LV_PART_MAIN);
-    lv_obj_set_style_text_color(kbd, UI_COLOR_TEXT_DARK, LV_PART_MAIN);
+    lv_obj_add_style(kbd, STYLES_REF(s_card_style), LV_PART_MAIN);
+    lv_obj_add_style(kbd, STYLES_REF(s_keyboard_main_style), LV_PART_MAIN);
 
     /* Keys */
-    lv_obj_set_style_bg_color(kbd, UI_COLOR_CARD_DARK, LV_PART_ITEMS);
-    lv_obj_set_style_bg_opa(kbd, LV_OPA_COVER, LV_PART_ITEMS);
-    lv_obj_set_style_border_color(kbd, UI_COLOR_BORDER_DARK, LV_PART_ITEMS);
-    lv_obj_set_style_border_width(kbd, 1, LV_PART_ITEMS);
-    lv_obj_set_style_text_color(kbd, UI_COLOR_TEXT_DARK, LV_PART_ITEMS);
-
-    /* Pressed/checked/focused keys: subtle dark instead of accent */
-    lv_obj_set_style_bg_color(kbd, UI_COLOR_BORDER_DARK, LV_PART_ITEMS | LV_STATE_PRESSED);
-    lv_obj_set_style_bg_color(kbd, UI_COLOR_BORDER_DARK, LV_PART_ITEMS | LV_STATE_CHECKED);
-    lv_obj_set_style_bg_color(kbd, UI_COLOR_BORDER_DARK, LV_PART_ITEMS | LV_STATE_FOCUSED);
-    lv_obj_set_style_bg_opa(kbd, LV_OPA_COVER, LV_PART_ITEMS | LV_STATE_PRESSED);
-    lv_obj_set_style_bg_opa(kbd, LV_OPA_COVER, LV_PART_ITEMS | LV_STATE_CHECKED);
-    lv_obj_set_style_bg_opa(kbd, LV_OPA_COVER, LV_PART_ITEMS | LV_STATE_FOCUSED);
-    lv_obj_set_style_text_color(kbd, UI_COLOR_TEXT_DARK, LV_PART_ITEMS | LV_STATE_PRESSED);
-    lv_obj_set_style_text_color(kbd, UI_COLOR_TEXT_DARK, LV_PART_ITEMS | LV_STATE_CHECKED);
-    lv_obj_set_style_text_color(kbd, UI_COLOR_TEXT_DARK, LV_PART_ITEMS | LV_STATE_FOCUSED);
-}
\ No newline at end of file
+    lv_obj_add_style(kbd, STYLES_REF(s_card_style), LV_PART_ITEMS);
+    lv_obj_add_style(kbd, STYLES_REF(s_keyboard_key_active_style), LV_PART_ITEMS | LV_STATE_PRESSED);
+    lv_obj_add_style(kbd, STYLES_REF(s_keyboard_key_active_style), LV_PART_ITEMS | LV_STATE_CHECKED);
+    lv_obj_add_style(kbd, STYLES_REF(s_keyboard_key_active_style), LV_PART_ITEMS | LV_STATE_FOCUSED);
+}
+
+static void styles_theme_apply_cb(lv_theme_t *theme, lv_obj_t *obj)
+{
+    (void)theme;
+    if (lv_obj_check_type(obj, &lv_list_button_class)) {
+        lv_obj_add_style(obj, STYLES_REF(s_list_row_style), LV_PART_MAIN);
+    }
+}
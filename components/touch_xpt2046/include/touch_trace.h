@@ -0,0 +1,128 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+#define TOUCH_TRACE_TAG_LEN     128     /* free-form start state stored in the trace header */
+#define TOUCH_TRACE_MAX_TAPS    64      /* taps with individual latencies in a report */
+#define TOUCH_TRACE_SETTLE_MS   300     /* quiet time after which a tap counts as settled */
+
+/*
+ * Input traces record what the pointer indev handed to LVGL, one sample per
+ * change, with a millisecond timestamp. Replaying one feeds the same samples
+ * back through the indev read callback, one per read, so every press/release
+ * edge reaches LVGL exactly once. When the UI falls behind the time base is
+ * shifted rather than samples dropped, so gaps between samples are preserved
+ * and the scenario just takes longer.
+ *
+ * The recorder and the player only depend on LVGL and stdio; any read
+ * callback can call touch_trace_filter(), including a headless host build.
+ */
+
+typedef struct {
+    uint32_t at_ms;             /* release time since replay start */
+    int16_t x;
+    int16_t y;
+    uint32_t first_frame_ms;    /* release -> end of the first frame rendered after it; 0 if none */
+    uint32_t settle_ms;         /* release -> end of the last frame before the UI went quiet */
+} touch_trace_tap_t;
+
+typedef struct {
+    uint32_t duration_ms;       /* first replayed sample to settle after the last one */
+    uint32_t samples;
+    uint32_t frames;            /* refresh cycles that rendered something */
+    uint32_t frame_avg_us;
+    uint32_t frame_max_us;
+    uint32_t frame_p50_ms;
+    uint32_t frame_p95_ms;
+    uint32_t slow_frames;       /* frames longer than 33 ms */
+    uint32_t lag_ms;            /* total delay added because the UI could not keep up */
+    uint32_t taps;              /* all taps; only the first TOUCH_TRACE_MAX_TAPS are in @c tap */
+    touch_trace_tap_t tap[TOUCH_TRACE_MAX_TAPS];
+} touch_trace_report_t;
+
+/**
+ * @brief Called once a replay finished and the UI settled.
+ *
+ * Runs in the LVGL task from the indev read callback, with the display lock held.
+ *
+ * @param report   Measurements of the run.
+ * @param user_ctx Context passed to touch_trace_replay_start().
+ */
+typedef void (*touch_trace_done_cb_t)(const touch_trace_report_t *report, void *user_ctx);
+
+/**
+ * @brief Start recording pointer samples to @p path.
+ *
+ * @param path Trace file, truncated if it exists.
+ * @param tag  Optional start state (e.g. the folder shown), returned on replay.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if a recording or replay is active, or ESP_FAIL on I/O errors.
+ */
+esp_err_t touch_trace_record_start(const char *path, const char *tag);
+
+/**
+ * @brief Stop recording and finalize the trace header.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if not recording, or ESP_FAIL on I/O errors.
+ */
+esp_err_t touch_trace_record_stop(void);
+
+/**
+ * @brief Start replaying @p path on the default display.
+ *
+ * Samples start flowing at the next indev read, so the caller can restore
+ * the start state described by @p tag_out first (call with the display lock held).
+ *
+ * @param path     Trace file.
+ * @param on_done  Optional completion callback.
+ * @param user_ctx Passed to @p on_done.
+ * @param[out] tag_out Optional buffer for the tag stored at recording time.
+ * @param tag_len  Size of @p tag_out.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if busy or the display resolution differs
+ *         from the recording, ESP_ERR_INVALID_VERSION for foreign files,
+ *         ESP_ERR_NO_MEM, or ESP_FAIL on I/O errors.
+ */
+esp_err_t touch_trace_replay_start(const char *path, touch_trace_done_cb_t on_done, void *user_ctx,
+                                   char *tag_out, size_t tag_len);
+
+/**
+ * @brief Whether a replay is in progress (hardware input should be ignored).
+ */
+bool touch_trace_is_replaying(void);
+
+/**
+ * @brief Indev read hook: record @p data, or replace it with the replayed sample.
+ *
+ * Call at the end of the pointer read callback with the sample that would be
+ * handed to LVGL. Does nothing when neither recording nor replaying.
+ *
+ * @param[in,out] data Indev data.
+ */
+void touch_trace_filter(lv_indev_data_t *data);
+
+/**
+ * @brief Write a human-readable report to @p path.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_FAIL on I/O errors.
+ */
+esp_err_t touch_trace_write_report(const char *path, const touch_trace_report_t *report);
+
+/**
+ * @brief Print the same report to an open stream (e.g. stdout for a runner).
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_FAIL on I/O errors.
+ */
+esp_err_t touch_trace_print_report(FILE *f, const touch_trace_report_t *report);
+
+#ifdef __cplusplus
+}
+#endif
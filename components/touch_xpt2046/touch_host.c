@@ -0,0 +1,330 @@
+#include "touch_xpt2046.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bsp/esp-bsp.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "calibration_xpt2046.h"
+#include "settings.h"
+#include "touch_trace.h"
+
+/*
+ * CONFIG_TOUCH_SCRIPTED (linux target, QEMU): stands in for touch_xpt2046.c and
+ * calibration_xpt2046.c. There is no controller to read, so the pointer follows
+ * CONFIG_TOUCH_HOST_SCRIPT; an input trace replay still takes over exactly as
+ * on the device.
+ */
+
+#define TOUCH_HOST_TAP_MS       80U     /* held long enough for LVGL to see a click, short of a long press */
+#define TOUCH_HOST_MOVE_MS      20U     /* interval between the points of a drag */
+#define TOUCH_HOST_ARG_LEN      64
+
+typedef enum {
+    TOUCH_HOST_WAIT,
+    TOUCH_HOST_PRESS,           /* press, or move while pressed */
+    TOUCH_HOST_RELEASE,
+    TOUCH_HOST_DUMP,
+    TOUCH_HOST_EXIT,
+} touch_host_op_t;
+
+typedef struct {
+    touch_host_op_t op;
+    int16_t x;
+    int16_t y;
+    uint32_t ms;
+    char arg[TOUCH_HOST_ARG_LEN];
+} touch_host_step_t;
+
+const char* TAG_TOUCH = "touch_host";
+static lv_indev_t *touch_indev = NULL;
+
+static touch_host_step_t *s_steps;
+static size_t s_step_count;
+static size_t s_step_next;
+static int64_t s_wait_until_us;         /* 0 while the current wait has not started */
+static lv_point_t s_point;
+static bool s_pressed;
+
+/**
+ * @brief Parse the input script into @ref s_steps.
+ *
+ * Taps and drags are expanded into presses, moves, waits and a release here,
+ * so playback only ever deals with one primitive at a time.
+ *
+ * @param path Script file.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if the file does not exist, or ESP_ERR_NO_MEM.
+ */
+static esp_err_t touch_host_load_script(const char *path);
+
+/**
+ * @brief Append one step to @ref s_steps.
+ *
+ * @return false if out of memory.
+ */
+static bool touch_host_add(touch_host_op_t op, int x, int y, uint32_t ms, const char *arg);
+
+/**
+ * @brief Advance the script to the current time.
+ *
+ * Stops after each press, move or release so that LVGL reads every pointer
+ * state at least once, and at a wait that has not elapsed yet.
+ */
+static void touch_host_play(void);
+
+/**
+ * @brief LVGL input device read callback for the scripted pointer.
+ *
+ * Same contract as the device callback: a replayed input trace wins, presses
+ * keep rendering on and push the screensaver back, and every sample handed to
+ * LVGL passes through touch_trace_filter() so it can be recorded.
+ *
+ * @param indev Unused LVGL input device handle.
+ * @param data  LVGL input data to fill.
+ */
+static void lvgl_touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data);
+
+esp_err_t init_touch(void)
+{
+    ESP_LOGI(TAG_TOUCH, "No touch controller on this target; input comes from a script");
+    return ESP_OK;
+}
+
+esp_err_t register_touch_to_lvgl(void)
+{
+    if (CONFIG_TOUCH_HOST_SCRIPT[0] != '\0') {
+        char path[128];
+        if (CONFIG_TOUCH_HOST_SCRIPT[0] == '/') {
+            snprintf(path, sizeof(path), "%s", CONFIG_TOUCH_HOST_SCRIPT);
+        } else {
+            snprintf(path, sizeof(path), "%s/%s", CONFIG_SDSPI_MOUNT_POINT, CONFIG_TOUCH_HOST_SCRIPT);
+        }
+        esp_err_t err = touch_host_load_script(path);
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG_TOUCH, "Input script %s: %u steps", path, (unsigned)s_step_count);
+        } else {
+            ESP_LOGW(TAG_TOUCH, "Input script %s not loaded (%s)", path, esp_err_to_name(err));
+        }
+    }
+
+    bsp_display_lock(0);
+    touch_indev = lv_indev_create();
+    if (touch_indev == NULL) {
+        bsp_display_unlock();
+        ESP_LOGE(TAG_TOUCH, "Input device not created");
+        return ESP_FAIL;
+    }
+    lv_indev_set_type(touch_indev, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(touch_indev, lvgl_touch_read_cb);
+    bsp_display_unlock();
+    return ESP_OK;
+}
+
+lv_indev_t *touch_get_indev(void)
+{
+    return touch_indev;
+}
+
+esp_lcd_touch_handle_t touch_get_handle(void)
+{
+    return NULL;
+}
+
+void touch_log_press(uint16_t x, uint16_t y)
+{
+    ESP_LOGD(TAG_TOUCH, "Touch press: x=%u y=%u", (unsigned)x, (unsigned)y);
+}
+
+/****** Calibration (nothing to calibrate) ******/
+
+void load_nvs_calibration(bool *calibration_found)
+{
+    *calibration_found = true;
+}
+
+esp_err_t run_calibration(bool calibration_found)
+{
+    (void)calibration_found;
+    return ESP_OK;
+}
+
+void calibration_set_show_loader(bool enable)
+{
+    (void)enable;
+}
+
+void apply_touch_calibration(uint16_t raw_x, uint16_t raw_y, lv_point_t *out_point, int xmax, int ymax)
+{
+    out_point->x = (raw_x < xmax) ? raw_x : xmax - 1;
+    out_point->y = (raw_y < ymax) ? raw_y : ymax - 1;
+}
+
+/****** Script ******/
+
+static esp_err_t touch_host_load_script(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    char line[160];
+    unsigned line_no = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        line_no++;
+        char cmd[16] = "";
+        char arg[TOUCH_HOST_ARG_LEN] = "";
+        int x1, y1, x2, y2;
+        unsigned ms;
+        if (sscanf(line, "%15s", cmd) != 1 || cmd[0] == '#') {
+            continue;
+        }
+
+        if (strcmp(cmd, "wait") == 0 && sscanf(line, "%*s %u", &ms) == 1) {
+            ok = touch_host_add(TOUCH_HOST_WAIT, 0, 0, ms, NULL);
+        } else if (strcmp(cmd, "tap") == 0 && sscanf(line, "%*s %d %d", &x1, &y1) == 2) {
+            ok = touch_host_add(TOUCH_HOST_PRESS, x1, y1, 0, NULL) &&
+                 touch_host_add(TOUCH_HOST_WAIT, 0, 0, TOUCH_HOST_TAP_MS, NULL) &&
+                 touch_host_add(TOUCH_HOST_RELEASE, 0, 0, 0, NULL);
+        } else if (strcmp(cmd, "press") == 0 && sscanf(line, "%*s %d %d", &x1, &y1) == 2) {
+            ok = touch_host_add(TOUCH_HOST_PRESS, x1, y1, 0, NULL);
+        } else if (strcmp(cmd, "release") == 0) {
+            ok = touch_host_add(TOUCH_HOST_RELEASE, 0, 0, 0, NULL);
+        } else if (strcmp(cmd, "drag") == 0 &&
+                   sscanf(line, "%*s %d %d %d %d %u", &x1, &y1, &x2, &y2, &ms) == 5) {
+            uint32_t n = ms / TOUCH_HOST_MOVE_MS;
+            if (n == 0) {
+                n = 1;
+            }
+            for (uint32_t i = 0; ok && i <= n; i++) {
+                ok = touch_host_add(TOUCH_HOST_PRESS, x1 + (x2 - x1) * (int)i / (int)n,
+                                    y1 + (y2 - y1) * (int)i / (int)n, 0, NULL) &&
+                     touch_host_add(TOUCH_HOST_WAIT, 0, 0, TOUCH_HOST_MOVE_MS, NULL);
+            }
+            ok = ok && touch_host_add(TOUCH_HOST_RELEASE, 0, 0, 0, NULL);
+        } else if (strcmp(cmd, "dump") == 0 && sscanf(line, "%*s %63s", arg) == 1) {
+            ok = touch_host_add(TOUCH_HOST_DUMP, 0, 0, 0, arg);
+        } else if (strcmp(cmd, "exit") == 0) {
+            ok = touch_host_add(TOUCH_HOST_EXIT, 0, 0, 0, NULL);
+        } else {
+            ESP_LOGW(TAG_TOUCH, "%s:%u: ignoring \"%s\"", path, line_no, cmd);
+        }
+    }
+    fclose(f);
+
+    if (!ok) {
+        free(s_steps);
+        s_steps = NULL;
+        s_step_count = 0;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static bool touch_host_add(touch_host_op_t op, int x, int y, uint32_t ms, const char *arg)
+{
+    touch_host_step_t *steps = realloc(s_steps, (s_step_count + 1) * sizeof(*steps));
+    if (!steps) {
+        return false;
+    }
+    s_steps = steps;
+    touch_host_step_t *step = &s_steps[s_step_count++];
+    *step = (touch_host_step_t){
+        .op = op,
+        .x = (int16_t)((x < 0) ? 0 : (x >= TOUCH_X_MAX) ? TOUCH_X_MAX - 1 : x),
+        .y = (int16_t)((y < 0) ? 0 : (y >= TOUCH_Y_MAX) ? TOUCH_Y_MAX - 1 : y),
+        .ms = ms,
+    };
+    if (arg) {
+        snprintf(step->arg, sizeof(step->arg), "%s", arg);
+    }
+    return true;
+}
+
+static void touch_host_play(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    while (s_step_next < s_step_count) {
+        const touch_host_step_t *step = &s_steps[s_step_next];
+        switch (step->op) {
+        case TOUCH_HOST_WAIT:
+            if (s_wait_until_us == 0) {
+                s_wait_until_us = now_us + (int64_t)step->ms * 1000;
+            }
+            if (now_us < s_wait_until_us) {
+                return;
+            }
+            s_wait_until_us = 0;
+            s_step_next++;
+            break;
+        case TOUCH_HOST_PRESS:
+            s_point.x = step->x;
+            s_point.y = step->y;
+            s_pressed = true;
+            s_step_next++;
+            return;
+        case TOUCH_HOST_RELEASE:
+            s_pressed = false;
+            s_step_next++;
+            return;
+        case TOUCH_HOST_DUMP: {
+            /* Called from the LVGL task, so the frame on the panel is the last one rendered */
+#ifdef BSP_BOARD_HOST
+            esp_err_t err = bsp_host_dump_ppm(step->arg);
+            if (err != ESP_OK) {
+                ESP_LOGW(TAG_TOUCH, "dump %s failed (%s)", step->arg, esp_err_to_name(err));
+            }
+#else
+            /* QEMU: host/qemu_bench.py answers this line with a monitor screendump */
+            ESP_LOGI(TAG_TOUCH, "screendump %s", step->arg);
+#endif
+            s_step_next++;
+            break;
+        }
+        case TOUCH_HOST_EXIT:
+            ESP_LOGI(TAG_TOUCH, "Input script finished");
+            fflush(stdout);
+#if CONFIG_IDF_TARGET_LINUX
+            exit(0);
+#else
+            s_step_next = s_step_count;     /* the QEMU runner stops the emulator on the line above */
+            return;
+#endif
+        }
+    }
+}
+
+static void lvgl_touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    if (touch_trace_is_replaying()) {
+        static bool replay_prev_pressed = false;
+        touch_trace_filter(data);
+        bool replay_pressed = data->state == LV_INDEV_STATE_PRESSED;
+        if (replay_pressed && !replay_prev_pressed) {
+            settings_render_resume();
+            settings_start_screensaver_timers();
+        }
+        replay_prev_pressed = replay_pressed;
+        return;
+    }
+
+    static bool prev_pressed = false;
+    touch_host_play();
+
+    data->point = s_point;
+    data->state = s_pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    if (s_pressed && !prev_pressed) {
+        /* Like a replay: scripted presses never wake-swallow and keep the screensaver away */
+        touch_log_press((uint16_t)s_point.x, (uint16_t)s_point.y);
+        settings_render_resume();
+        settings_start_screensaver_timers();
+    }
+    prev_pressed = s_pressed;
+    touch_trace_filter(data);
+    (void)indev;
+}
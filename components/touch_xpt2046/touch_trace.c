@@ -0,0 +1,493 @@
+#include "touch_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "touch_trace";
+
+#define TOUCH_TRACE_MAGIC       0x43525454u     /* "TTRC" */
+#define TOUCH_TRACE_VERSION     1u
+#define TOUCH_TRACE_CHUNK       128             /* samples read from the file at a time during replay */
+#define TOUCH_TRACE_HIST_MS     250             /* frame-time histogram range, last bucket collects the rest */
+#define TOUCH_TRACE_SLOW_US     33000
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t sample_size;
+    uint16_t hor_res;
+    uint16_t ver_res;
+    uint32_t count;
+    char tag[TOUCH_TRACE_TAG_LEN];
+} touch_trace_header_t;
+
+typedef struct {
+    uint32_t t_ms;
+    int16_t x;
+    int16_t y;
+    uint8_t pressed;
+    uint8_t reserved[3];
+} touch_trace_sample_t;
+
+typedef struct {
+    FILE *file;
+    uint32_t start_tick;
+    uint32_t count;
+    bool have_last;
+    touch_trace_sample_t last;
+} touch_trace_recorder_t;
+
+typedef struct {
+    FILE *file;
+    lv_display_t *disp;
+    touch_trace_done_cb_t on_done;
+    void *user_ctx;
+
+    touch_trace_sample_t chunk[TOUCH_TRACE_CHUNK];
+    size_t chunk_len;
+    size_t chunk_pos;
+    uint32_t remaining;
+    bool drained;
+
+    bool started;
+    uint32_t base_tick;
+    int64_t start_us;
+    int64_t drained_us;
+    touch_trace_sample_t current;
+
+    int64_t frame_start_us;
+    int64_t last_frame_end_us;
+    uint64_t frame_sum_us;
+    uint32_t hist[TOUCH_TRACE_HIST_MS + 1];
+
+    bool tap_open;
+    int64_t tap_release_us;
+    touch_trace_report_t report;
+} touch_trace_player_t;
+
+static touch_trace_recorder_t s_rec;
+static touch_trace_player_t *s_play;
+
+/**
+ * @brief Append @p data to the recording if it differs from the last sample.
+ *
+ * @param data Sample handed to LVGL.
+ */
+static void touch_trace_record_sample(const lv_indev_data_t *data);
+
+/**
+ * @brief Replace @p data with the replayed sample and advance the replay.
+ *
+ * @param[out] data Indev data.
+ */
+static void touch_trace_replay_sample(lv_indev_data_t *data);
+
+/**
+ * @brief Return the next replay sample, reading the next chunk from the file if needed.
+ *
+ * @return Sample, or NULL when the trace is exhausted (or unreadable).
+ */
+static const touch_trace_sample_t *touch_trace_peek(void);
+
+/**
+ * @brief Display event hook measuring frame times and tap latencies.
+ *
+ * @param e LV_EVENT_RENDER_START or LV_EVENT_REFR_READY on the replay display.
+ */
+static void touch_trace_display_event_cb(lv_event_t *e);
+
+/**
+ * @brief Finalize the report, release the player and invoke the completion callback.
+ */
+static void touch_trace_replay_finish(void);
+
+/**
+ * @brief Percentile of the frame-time histogram in milliseconds.
+ *
+ * @param hist  Histogram with TOUCH_TRACE_HIST_MS + 1 buckets.
+ * @param total Number of frames in the histogram.
+ * @param pct   Percentile (1..100).
+ */
+static uint32_t touch_trace_hist_percentile(const uint32_t *hist, uint32_t total, uint32_t pct);
+
+esp_err_t touch_trace_record_start(const char *path, const char *tag)
+{
+    if (!path) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_rec.file || s_play) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        ESP_LOGE(TAG, "Cannot create %s", path);
+        return ESP_FAIL;
+    }
+
+    lv_display_t *disp = lv_display_get_default();
+    touch_trace_header_t hdr = {
+        .magic = TOUCH_TRACE_MAGIC,
+        .version = TOUCH_TRACE_VERSION,
+        .sample_size = sizeof(touch_trace_sample_t),
+        .hor_res = disp ? (uint16_t)lv_display_get_horizontal_resolution(disp) : 0,
+        .ver_res = disp ? (uint16_t)lv_display_get_vertical_resolution(disp) : 0,
+    };
+    if (tag) {
+        strlcpy(hdr.tag, tag, sizeof(hdr.tag));
+    }
+    if (fwrite(&hdr, sizeof(hdr), 1, f) != 1) {
+        fclose(f);
+        return ESP_FAIL;
+    }
+
+    memset(&s_rec, 0, sizeof(s_rec));
+    s_rec.file = f;
+    s_rec.start_tick = lv_tick_get();
+    ESP_LOGI(TAG, "Recording input to %s", path);
+    return ESP_OK;
+}
+
+esp_err_t touch_trace_record_stop(void)
+{
+    if (!s_rec.file) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    FILE *f = s_rec.file;
+    s_rec.file = NULL;
+
+    /* The count in the header marks the trace as complete. */
+    esp_err_t err = ESP_OK;
+    const size_t count_offset = offsetof(touch_trace_header_t, count);
+    if (fflush(f) != 0 || fseek(f, (long)count_offset, SEEK_SET) != 0 ||
+        fwrite(&s_rec.count, sizeof(s_rec.count), 1, f) != 1) {
+        err = ESP_FAIL;
+    }
+    if (fclose(f) != 0) {
+        err = ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Recorded %lu samples over %lu ms (%s)", (unsigned long)s_rec.count,
+             (unsigned long)lv_tick_elaps(s_rec.start_tick), esp_err_to_name(err));
+    return err;
+}
+
+esp_err_t touch_trace_replay_start(const char *path, touch_trace_done_cb_t on_done, void *user_ctx,
+                                   char *tag_out, size_t tag_len)
+{
+    if (!path) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_rec.file || s_play) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    lv_display_t *disp = lv_display_get_default();
+    if (!disp) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return ESP_FAIL;
+    }
+
+    touch_trace_header_t hdr;
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1) {
+        fclose(f);
+        return ESP_FAIL;
+    }
+    if (hdr.magic != TOUCH_TRACE_MAGIC || hdr.version != TOUCH_TRACE_VERSION ||
+        hdr.sample_size != sizeof(touch_trace_sample_t)) {
+        fclose(f);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (hdr.hor_res != lv_display_get_horizontal_resolution(disp) ||
+        hdr.ver_res != lv_display_get_vertical_resolution(disp)) {
+        ESP_LOGE(TAG, "Trace recorded at %ux%u, display is %ldx%ld", hdr.hor_res, hdr.ver_res,
+                 (long)lv_display_get_horizontal_resolution(disp), (long)lv_display_get_vertical_resolution(disp));
+        fclose(f);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (hdr.count == 0) {
+        ESP_LOGW(TAG, "%s was not finalized, replaying up to the end of the file", path);
+        hdr.count = UINT32_MAX;
+    }
+
+    touch_trace_player_t *play = calloc(1, sizeof(*play));
+    if (!play) {
+        fclose(f);
+        return ESP_ERR_NO_MEM;
+    }
+    play->file = f;
+    play->disp = disp;
+    play->on_done = on_done;
+    play->user_ctx = user_ctx;
+    play->remaining = hdr.count;
+    s_play = play;
+
+    lv_display_add_event_cb(disp, touch_trace_display_event_cb, LV_EVENT_RENDER_START, play);
+    lv_display_add_event_cb(disp, touch_trace_display_event_cb, LV_EVENT_REFR_READY, play);
+
+    if (tag_out && tag_len) {
+        hdr.tag[sizeof(hdr.tag) - 1] = '\0';
+        strlcpy(tag_out, hdr.tag, tag_len);
+    }
+    ESP_LOGI(TAG, "Replaying %s", path);
+    return ESP_OK;
+}
+
+bool touch_trace_is_replaying(void)
+{
+    return s_play != NULL;
+}
+
+void touch_trace_filter(lv_indev_data_t *data)
+{
+    if (!data) {
+        return;
+    }
+    if (s_play) {
+        touch_trace_replay_sample(data);
+    } else if (s_rec.file) {
+        touch_trace_record_sample(data);
+    }
+}
+
+esp_err_t touch_trace_write_report(const char *path, const touch_trace_report_t *report)
+{
+    if (!path || !report) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        return ESP_FAIL;
+    }
+
+    esp_err_t err = touch_trace_print_report(f, report);
+    return (fclose(f) == 0) ? err : ESP_FAIL;
+}
+
+esp_err_t touch_trace_print_report(FILE *f, const touch_trace_report_t *report)
+{
+    if (!f || !report) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    fprintf(f, "duration_ms %lu\nsamples %lu\nlag_ms %lu\n",
+            (unsigned long)report->duration_ms, (unsigned long)report->samples, (unsigned long)report->lag_ms);
+    fprintf(f, "frames %lu\nframe_avg_us %lu\nframe_p50_ms %lu\nframe_p95_ms %lu\nframe_max_us %lu\nslow_frames %lu\n",
+            (unsigned long)report->frames, (unsigned long)report->frame_avg_us,
+            (unsigned long)report->frame_p50_ms, (unsigned long)report->frame_p95_ms,
+            (unsigned long)report->frame_max_us, (unsigned long)report->slow_frames);
+    fprintf(f, "taps %lu\n# tap at_ms x y first_frame_ms settle_ms\n", (unsigned long)report->taps);
+    uint32_t listed = report->taps < TOUCH_TRACE_MAX_TAPS ? report->taps : TOUCH_TRACE_MAX_TAPS;
+    for (uint32_t i = 0; i < listed; i++) {
+        const touch_trace_tap_t *tap = &report->tap[i];
+        fprintf(f, "tap %lu %d %d %lu %lu\n", (unsigned long)tap->at_ms, tap->x, tap->y,
+                (unsigned long)tap->first_frame_ms, (unsigned long)tap->settle_ms);
+    }
+
+    return ferror(f) ? ESP_FAIL : ESP_OK;
+}
+
+static void touch_trace_record_sample(const lv_indev_data_t *data)
+{
+    touch_trace_sample_t s = {
+        .t_ms = lv_tick_elaps(s_rec.start_tick),
+        .x = (int16_t)data->point.x,
+        .y = (int16_t)data->point.y,
+        .pressed = data->state == LV_INDEV_STATE_PRESSED,
+    };
+
+    if (s_rec.have_last && s.pressed == s_rec.last.pressed &&
+        (!s.pressed || (s.x == s_rec.last.x && s.y == s_rec.last.y))) {
+        return;
+    }
+    if (fwrite(&s, sizeof(s), 1, s_rec.file) != 1) {
+        ESP_LOGE(TAG, "Write failed, recording stopped");
+        touch_trace_record_stop();
+        return;
+    }
+    s_rec.last = s;
+    s_rec.have_last = true;
+    s_rec.count++;
+}
+
+static const touch_trace_sample_t *touch_trace_peek(void)
+{
+    touch_trace_player_t *play = s_play;
+    if (play->chunk_pos < play->chunk_len) {
+        return &play->chunk[play->chunk_pos];
+    }
+    if (play->remaining == 0 || !play->file) {
+        return NULL;
+    }
+
+    size_t want = play->remaining < TOUCH_TRACE_CHUNK ? play->remaining : TOUCH_TRACE_CHUNK;
+    play->chunk_len = fread(play->chunk, sizeof(play->chunk[0]), want, play->file);
+    play->chunk_pos = 0;
+    if (play->chunk_len < want) {
+        play->remaining = 0;
+    } else if (play->remaining != UINT32_MAX) {
+        play->remaining -= (uint32_t)play->chunk_len;
+    }
+    return play->chunk_len ? &play->chunk[0] : NULL;
+}
+
+static void touch_trace_replay_sample(lv_indev_data_t *data)
+{
+    touch_trace_player_t *play = s_play;
+    int64_t now_us = esp_timer_get_time();
+
+    if (!play->started) {
+        play->started = true;
+        play->base_tick = lv_tick_get();
+        play->start_us = now_us;
+    }
+
+    if (!play->drained) {
+        const touch_trace_sample_t *next = touch_trace_peek();
+        uint32_t elapsed = lv_tick_elaps(play->base_tick);
+        if (!next) {
+            play->drained = true;
+            play->drained_us = now_us;
+        } else if (next->t_ms <= elapsed) {
+            /* One sample per read; shift the time base by however late we are. */
+            uint32_t lag = elapsed - next->t_ms;
+            play->base_tick += lag;
+            play->report.lag_ms += lag;
+
+            bool was_pressed = play->current.pressed;
+            play->current = *next;
+            play->chunk_pos++;
+            play->report.samples++;
+
+            if (!was_pressed && play->current.pressed) {
+                play->tap_open = false;
+            } else if (was_pressed && !play->current.pressed) {
+                touch_trace_report_t *r = &play->report;
+                if (r->taps < TOUCH_TRACE_MAX_TAPS) {
+                    touch_trace_tap_t *tap = &r->tap[r->taps];
+                    tap->at_ms = (uint32_t)((now_us - play->start_us) / 1000);
+                    tap->x = play->current.x;
+                    tap->y = play->current.y;
+                    play->tap_open = true;
+                    play->tap_release_us = now_us;
+                }
+                r->taps++;
+            }
+        }
+    }
+
+    data->point.x = play->current.x;
+    data->point.y = play->current.y;
+    data->state = play->current.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+
+    int64_t last_activity = play->last_frame_end_us;
+    if (play->tap_open && play->tap_release_us > last_activity) {
+        last_activity = play->tap_release_us;
+    }
+    bool quiet = now_us - last_activity >= (int64_t)TOUCH_TRACE_SETTLE_MS * 1000;
+    if (quiet) {
+        play->tap_open = false;
+    }
+    if (play->drained && !play->current.pressed && quiet &&
+        now_us - play->drained_us >= (int64_t)TOUCH_TRACE_SETTLE_MS * 1000) {
+        touch_trace_replay_finish();
+    }
+}
+
+static void touch_trace_display_event_cb(lv_event_t *e)
+{
+    touch_trace_player_t *play = lv_event_get_user_data(e);
+    if (!play || play != s_play || !play->started) {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START) {
+        if (play->frame_start_us == 0) {
+            play->frame_start_us = now_us;
+        }
+        return;
+    }
+
+    /* LV_EVENT_REFR_READY: only cycles that rendered count as frames. */
+    if (play->frame_start_us == 0) {
+        return;
+    }
+    int64_t frame_start_us = play->frame_start_us;
+    uint32_t frame_us = (uint32_t)(now_us - frame_start_us);
+    play->frame_start_us = 0;
+    play->last_frame_end_us = now_us;
+
+    touch_trace_report_t *r = &play->report;
+    r->frames++;
+    play->frame_sum_us += frame_us;
+    if (frame_us > r->frame_max_us) {
+        r->frame_max_us = frame_us;
+    }
+    if (frame_us > TOUCH_TRACE_SLOW_US) {
+        r->slow_frames++;
+    }
+    uint32_t bucket = frame_us / 1000;
+    play->hist[bucket > TOUCH_TRACE_HIST_MS ? TOUCH_TRACE_HIST_MS : bucket]++;
+
+    /* A frame already in flight when the finger lifted doesn't show the tap's effect. */
+    if (play->tap_open && frame_start_us >= play->tap_release_us &&
+        r->taps > 0 && r->taps <= TOUCH_TRACE_MAX_TAPS) {
+        touch_trace_tap_t *tap = &r->tap[r->taps - 1];
+        uint32_t since_ms = (uint32_t)((now_us - play->tap_release_us) / 1000);
+        if (tap->first_frame_ms == 0) {
+            tap->first_frame_ms = since_ms ? since_ms : 1;
+        }
+        tap->settle_ms = since_ms;
+    }
+}
+
+static void touch_trace_replay_finish(void)
+{
+    touch_trace_player_t *play = s_play;
+    s_play = NULL;
+
+    lv_display_remove_event_cb_with_user_data(play->disp, touch_trace_display_event_cb, play);
+    if (play->file) {
+        fclose(play->file);
+    }
+
+    touch_trace_report_t *r = &play->report;
+    r->duration_ms = (uint32_t)((esp_timer_get_time() - play->start_us) / 1000);
+    if (r->frames) {
+        r->frame_avg_us = (uint32_t)(play->frame_sum_us / r->frames);
+        r->frame_p50_ms = touch_trace_hist_percentile(play->hist, r->frames, 50);
+        r->frame_p95_ms = touch_trace_hist_percentile(play->hist, r->frames, 95);
+    }
+    ESP_LOGI(TAG, "Replay done: %lu samples, %lu frames (avg %lu us, p95 %lu ms, max %lu us), %lu taps, lag %lu ms",
+             (unsigned long)r->samples, (unsigned long)r->frames, (unsigned long)r->frame_avg_us,
+             (unsigned long)r->frame_p95_ms, (unsigned long)r->frame_max_us,
+             (unsigned long)r->taps, (unsigned long)r->lag_ms);
+
+    if (play->on_done) {
+        play->on_done(r, play->user_ctx);
+    }
+    free(play);
+}
+
+static uint32_t touch_trace_hist_percentile(const uint32_t *hist, uint32_t total, uint32_t pct)
+{
+    uint64_t target = ((uint64_t)total * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (uint32_t ms = 0; ms <= TOUCH_TRACE_HIST_MS; ms++) {
+        seen += hist[ms];
+        if (seen >= target) {
+            return ms;
+        }
+    }
+    return TOUCH_TRACE_HIST_MS;
+}
@@ -10,6 +10,7 @@
 #include "esp_lcd_touch_xpt2046.h"
 #include "calibration_xpt2046.h"
 #include "settings.h"
+#include "touch_trace.h"
 
 const char* TAG_TOUCH = "touch_driver";
 static esp_lcd_touch_handle_t touch_handle = NULL;
@@ -29,7 +30,9 @@ static lv_indev_t *register_touch_with_lvgl(void);
  * @brief LVGL input device read callback for the touch controller.
  *
  * Reads the latest touch sample from the XPT2046 via esp_lcd_touch, applies calibration,
- * and fills @p data with pointer position and state.
+ * and fills @p data with pointer position and state. While an input trace is replayed the
+ * controller is ignored and the recorded samples are passed on instead; while recording,
+ * every sample handed to LVGL is logged.
  *
  * @param indev Unused LVGL input device handle.
  * @param data  LVGL input data to fill.
@@ -169,6 +172,19 @@ static lv_indev_t *register_touch_with_lvgl(void)
 
 static void lvgl_touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
 {
+    if (touch_trace_is_replaying()) {
+        static bool replay_prev_pressed = false;
+        touch_trace_filter(data);
+        bool replay_pressed = data->state == LV_INDEV_STATE_PRESSED;
+        if (replay_pressed && !replay_prev_pressed) {
+            /* Keep rendering and the screensaver away for the whole run; replayed presses never wake-swallow. */
+            settings_render_resume();
+            settings_start_screensaver_timers();
+        }
+        replay_prev_pressed = replay_pressed;
+        return;
+    }
+
     if (!touch_handle){
         return;
     }
@@ -183,11 +199,14 @@ static void lvgl_touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
         if (settings_get_active_brightness() <= 0 || settings_is_wake_in_progress()) {
             /* Wake screen but ignore this press for LVGL until fade-up completes */
             if (!prev_pressed && settings_get_active_brightness() <= 0) {
+                /* Render the pending frame while still dark, then fade up */
+                settings_render_resume();
                 settings_fade_to_saved_brightness();
                 settings_start_screensaver_timers();
             }
             data->state = LV_INDEV_STATE_RELEASED;
             prev_pressed = false;
+            touch_trace_filter(data);
             (void)indev;
             return;
         } else {
@@ -200,10 +219,12 @@ static void lvgl_touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
     if (pressed && !prev_pressed) {
         touch_log_press(x, y);
         if (!settings_get_brightness_state()){
+            settings_render_resume();
             settings_fade_to_saved_brightness();
             settings_start_screensaver_timers();
         }
     }
     prev_pressed = pressed;
+    touch_trace_filter(data);
     (void)indev;
 }
@@ -0,0 +1,141 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define WORKER_POOL_KEY_LEN     24
+
+/*
+ * A fixed set of worker tasks shared by all background work. Jobs are picked
+ * by class first, then in submission order, and each runs at its class's
+ * FreeRTOS priority. Cancellation is cooperative: a running job sees it via
+ * worker_pool_job_cancelled() and returns early.
+ */
+
+typedef enum {
+    WORKER_POOL_INTERACTIVE,    /* the user is waiting for it */
+    WORKER_POOL_NORMAL,         /* started by the user, finishes in the background */
+    WORKER_POOL_IDLE,           /* housekeeping, runs when nothing else is queued */
+    WORKER_POOL_CLASS_COUNT
+} worker_pool_class_t;
+
+typedef struct worker_pool_job worker_pool_job_t;
+
+/**
+ * @brief Job body, run on a worker task.
+ *
+ * @param job Handle for worker_pool_job_cancelled(); valid until the function returns.
+ * @param arg Argument given at submission.
+ */
+typedef void (*worker_pool_fn_t)(worker_pool_job_t *job, void *arg);
+
+/**
+ * @brief Releases the argument of a job that will never run (cancelled while queued or coalesced).
+ */
+typedef void (*worker_pool_discard_fn_t)(void *arg);
+
+typedef struct {
+    const char *name;                   /* stats bucket; must be a string literal or otherwise outlive the pool */
+    const char *key;                    /* coalescing key; NULL uses @c name, "" never coalesces */
+    bool join_running;                  /* also coalesce into a running job: for jobs that must not run twice in a row */
+    worker_pool_class_t cls;
+    worker_pool_fn_t fn;
+    void *arg;
+    worker_pool_discard_fn_t discard;   /* optional */
+} worker_pool_submit_opts_t;
+
+typedef struct {
+    const char *name;
+    uint32_t runs;
+    uint32_t cancelled;         /* dropped while queued or stopped early */
+    uint32_t coalesced;         /* submissions merged into a job already queued (or running, with join_running) */
+    uint32_t wait_avg_ms;       /* submission -> start */
+    uint32_t wait_max_ms;
+    uint32_t run_avg_ms;
+    uint32_t run_max_ms;
+} worker_pool_stats_t;
+
+/**
+ * @brief Create the worker tasks.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if already started, or ESP_ERR_NO_MEM.
+ */
+esp_err_t worker_pool_start(void);
+
+/**
+ * @brief Queue a job.
+ *
+ * When a job with the same key is already queued, nothing new is queued:
+ * @p out_id receives the existing job and @c opts->arg is discarded. A running
+ * job with the key only absorbs the submission with @c opts->join_running;
+ * otherwise the new job is queued and starts once the running one returns, so
+ * work submitted after a job has read its inputs is not lost. Jobs with the
+ * same non-empty key never run concurrently.
+ *
+ * @param opts       Job description.
+ * @param[out] out_id Optional job id for worker_pool_cancel().
+ * @return ESP_OK (the pool owns @c opts->arg), ESP_ERR_INVALID_ARG,
+ *         ESP_ERR_INVALID_STATE if the pool is not started, or
+ *         ESP_ERR_NO_MEM if the queue is full (the caller keeps @c opts->arg).
+ */
+esp_err_t worker_pool_submit(const worker_pool_submit_opts_t *opts, uint32_t *out_id);
+
+/**
+ * @brief Cancel a job: drop it if queued, flag it if running.
+ *
+ * @return true if the job was still queued or running.
+ */
+bool worker_pool_cancel(uint32_t id);
+
+/**
+ * @brief Cancel every queued or running job with @p key.
+ *
+ * @return Number of jobs affected.
+ */
+size_t worker_pool_cancel_key(const char *key);
+
+/**
+ * @brief Drop the queued jobs with @p key, unless one with it is running.
+ *
+ * For callers that need the work behind a key stopped now: a running job may
+ * be halfway through and is left alone, so nothing is dropped in that case.
+ *
+ * @return ESP_OK (no job with @p key remains), ESP_ERR_INVALID_ARG, or
+ *         ESP_ERR_INVALID_STATE if one is running, cancelled or not.
+ */
+esp_err_t worker_pool_cancel_queued_key(const char *key);
+
+/**
+ * @brief Whether a job with @p key is queued or running.
+ */
+bool worker_pool_is_active(const char *key);
+
+/**
+ * @brief Whether the running job was asked to stop.
+ */
+bool worker_pool_job_cancelled(const worker_pool_job_t *job);
+
+/**
+ * @brief Copy the per-name timing stats.
+ *
+ * @param[out] out Entries.
+ * @param max      Capacity of @p out.
+ * @return Number of entries written.
+ */
+size_t worker_pool_get_stats(worker_pool_stats_t *out, size_t max);
+
+/**
+ * @brief Log the per-name timing stats.
+ */
+void worker_pool_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,487 @@
+#include "worker_pool.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "stack_monitor.h"
+
+static const char *TAG = "worker_pool";
+
+#define WORKER_POOL_MAX_STATS   16
+
+struct worker_pool_job {
+    bool used;
+    bool running;
+    volatile bool cancel;
+    uint32_t id;
+    uint32_t seq;               /* submission order within a class */
+    worker_pool_class_t cls;
+    char key[WORKER_POOL_KEY_LEN];
+    const char *name;
+    worker_pool_fn_t fn;
+    void *arg;
+    worker_pool_discard_fn_t discard;
+    int64_t queued_us;
+};
+
+typedef struct {
+    const char *name;
+    uint32_t runs;
+    uint32_t cancelled;
+    uint32_t coalesced;
+    uint64_t wait_us_total;
+    uint64_t run_us_total;
+    uint32_t wait_us_max;
+    uint32_t run_us_max;
+} worker_pool_stat_entry_t;
+
+static worker_pool_job_t s_jobs[CONFIG_WORKER_POOL_QUEUE_LEN];
+static worker_pool_stat_entry_t s_stats[WORKER_POOL_MAX_STATS];
+static SemaphoreHandle_t s_lock;        /* guards s_jobs, s_stats and the counters below */
+static SemaphoreHandle_t s_pending;     /* wake-up hint, given once per submitted job */
+static TaskHandle_t s_workers[CONFIG_WORKER_POOL_WORKERS];
+static uint32_t s_next_id = 1;
+static uint32_t s_next_seq;
+
+static const UBaseType_t s_class_prio[WORKER_POOL_CLASS_COUNT] = {
+    [WORKER_POOL_INTERACTIVE] = CONFIG_WORKER_POOL_PRIO_INTERACTIVE,
+    [WORKER_POOL_NORMAL] = CONFIG_WORKER_POOL_PRIO_NORMAL,
+    [WORKER_POOL_IDLE] = CONFIG_WORKER_POOL_PRIO_IDLE,
+};
+
+/**
+ * @brief Worker loop: take the next job, run it at its class priority, record its timing.
+ *
+ * @param arg Unused.
+ */
+static void worker_pool_task(void *arg);
+
+/**
+ * @brief Next job to run: highest class, then oldest. Call with @c s_lock held.
+ *
+ * A queued job waits while another job with its key is running, so jobs with
+ * one key never run concurrently and run in submission order.
+ *
+ * @return Job, or NULL if nothing is waiting or runnable.
+ */
+static worker_pool_job_t *worker_pool_pick(void);
+
+/**
+ * @brief Job with @p key that is not cancelled. Call with @c s_lock held.
+ *
+ * @param key     Non-empty key.
+ * @param running true to also match a running job, false for queued ones only.
+ * @return Job, or NULL.
+ */
+static worker_pool_job_t *worker_pool_find_key(const char *key, bool running);
+
+/**
+ * @brief Stats entry for @p name, added if missing. Call with @c s_lock held.
+ *
+ * @return Entry, or NULL when the table is full.
+ */
+static worker_pool_stat_entry_t *worker_pool_stat(const char *name);
+
+/**
+ * @brief Drop a queued job and release its argument. Call with @c s_lock held.
+ *
+ * @param job Queued (not running) job.
+ * @param[out] discard Receives the discard callback to run once the lock is released.
+ * @param[out] arg     Receives its argument.
+ */
+static void worker_pool_drop(worker_pool_job_t *job, worker_pool_discard_fn_t *discard, void **arg);
+
+esp_err_t worker_pool_start(void)
+{
+    if (s_lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    s_pending = xSemaphoreCreateCounting(CONFIG_WORKER_POOL_QUEUE_LEN * 2, 0);
+    if (!s_lock || !s_pending) {
+        ESP_LOGE(TAG, "Failed to create the pool semaphores");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < CONFIG_WORKER_POOL_WORKERS; i++) {
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "worker%d", i);
+        stack_monitor_note_task(name, CONFIG_WORKER_POOL_STACK_B);
+        BaseType_t res = xTaskCreatePinnedToCore(worker_pool_task,
+                                                 name,
+                                                 CONFIG_WORKER_POOL_STACK_B,
+                                                 NULL,
+                                                 CONFIG_WORKER_POOL_PRIO_INTERACTIVE,
+                                                 &s_workers[i],
+                                                 i % portNUM_PROCESSORS);
+        if (res != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create %s", name);
+            s_workers[i] = NULL;
+            return i > 0 ? ESP_OK : ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t worker_pool_submit(const worker_pool_submit_opts_t *opts, uint32_t *out_id)
+{
+    if (!opts || !opts->fn || !opts->name || (unsigned)opts->cls >= WORKER_POOL_CLASS_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const char *key = opts->key ? opts->key : opts->name;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    /*
+     * A running job may already have read what this submission is about, so by
+     * default only a queued one absorbs it; the new job otherwise runs after it.
+     */
+    worker_pool_job_t *existing = key[0] != '\0' ? worker_pool_find_key(key, opts->join_running) : NULL;
+    if (existing) {
+        uint32_t id = existing->id;
+        worker_pool_stat_entry_t *stat = worker_pool_stat(opts->name);
+        if (stat) {
+            stat->coalesced++;
+        }
+        xSemaphoreGive(s_lock);
+        if (opts->discard) {
+            opts->discard(opts->arg);
+        }
+        if (out_id) {
+            *out_id = id;
+        }
+        return ESP_OK;
+    }
+
+    worker_pool_job_t *job = NULL;
+    for (size_t i = 0; i < CONFIG_WORKER_POOL_QUEUE_LEN; i++) {
+        if (!s_jobs[i].used) {
+            job = &s_jobs[i];
+            break;
+        }
+    }
+    if (!job) {
+        xSemaphoreGive(s_lock);
+        ESP_LOGW(TAG, "Queue full, \"%s\" not queued", opts->name);
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(job, 0, sizeof(*job));
+    job->used = true;
+    job->id = s_next_id++;
+    if (s_next_id == 0) {
+        s_next_id = 1;
+    }
+    job->seq = s_next_seq++;
+    job->cls = opts->cls;
+    strlcpy(job->key, key, sizeof(job->key));
+    job->name = opts->name;
+    job->fn = opts->fn;
+    job->arg = opts->arg;
+    job->discard = opts->discard;
+    job->queued_us = esp_timer_get_time();
+    uint32_t id = job->id;
+    xSemaphoreGive(s_lock);
+
+    xSemaphoreGive(s_pending);
+    if (out_id) {
+        *out_id = id;
+    }
+    return ESP_OK;
+}
+
+bool worker_pool_cancel(uint32_t id)
+{
+    if (!s_lock || id == 0) {
+        return false;
+    }
+    worker_pool_discard_fn_t discard = NULL;
+    void *arg = NULL;
+    bool found = false;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (size_t i = 0; i < CONFIG_WORKER_POOL_QUEUE_LEN; i++) {
+        worker_pool_job_t *job = &s_jobs[i];
+        if (!job->used || job->id != id) {
+            continue;
+        }
+        found = true;
+        if (job->running) {
+            job->cancel = true;
+        } else {
+            worker_pool_drop(job, &discard, &arg);
+        }
+        break;
+    }
+    xSemaphoreGive(s_lock);
+
+    if (discard) {
+        discard(arg);
+    }
+    return found;
+}
+
+size_t worker_pool_cancel_key(const char *key)
+{
+    if (!s_lock || !key || key[0] == '\0') {
+        return 0;
+    }
+    size_t count = 0;
+    for (;;) {
+        worker_pool_discard_fn_t discard = NULL;
+        void *arg = NULL;
+        bool dropped = false;
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        for (size_t i = 0; i < CONFIG_WORKER_POOL_QUEUE_LEN; i++) {
+            worker_pool_job_t *job = &s_jobs[i];
+            if (!job->used || strcmp(job->key, key) != 0) {
+                continue;
+            }
+            if (job->running) {
+                if (!job->cancel) {
+                    job->cancel = true;
+                    count++;
+                }
+                continue;
+            }
+            worker_pool_drop(job, &discard, &arg);
+            dropped = true;
+            count++;
+            break;
+        }
+        xSemaphoreGive(s_lock);
+
+        /* Discard callbacks run unlocked, one dropped job per pass */
+        if (discard) {
+            discard(arg);
+        }
+        if (!dropped) {
+            return count;
+        }
+    }
+}
+
+esp_err_t worker_pool_cancel_queued_key(const char *key)
+{
+    if (!key || key[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_lock) {
+        return ESP_OK;
+    }
+    for (;;) {
+        worker_pool_discard_fn_t discard = NULL;
+        void *arg = NULL;
+        worker_pool_job_t *queued = NULL;
+        bool running = false;
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        for (size_t i = 0; i < CONFIG_WORKER_POOL_QUEUE_LEN; i++) {
+            worker_pool_job_t *job = &s_jobs[i];
+            if (!job->used || strcmp(job->key, key) != 0) {
+                continue;
+            }
+            if (job->running) {
+                running = true;
+                break;
+            }
+            if (!queued) {
+                queued = job;
+            }
+        }
+        if (queued && !running) {
+            worker_pool_drop(queued, &discard, &arg);
+        }
+        xSemaphoreGive(s_lock);
+
+        if (discard) {
+            discard(arg);
+        }
+        if (running) {
+            /* Also when an earlier pass dropped one and the next was picked meanwhile */
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (!queued) {
+            return ESP_OK;
+        }
+    }
+}
+
+bool worker_pool_is_active(const char *key)
+{
+    if (!s_lock || !key || key[0] == '\0') {
+        return false;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool active = worker_pool_find_key(key, true) != NULL;
+    xSemaphoreGive(s_lock);
+    return active;
+}
+
+bool worker_pool_job_cancelled(const worker_pool_job_t *job)
+{
+    return job && job->cancel;
+}
+
+size_t worker_pool_get_stats(worker_pool_stats_t *out, size_t max)
+{
+    if (!out || !s_lock) {
+        return 0;
+    }
+    size_t count = 0;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (size_t i = 0; i < WORKER_POOL_MAX_STATS && count < max; i++) {
+        const worker_pool_stat_entry_t *e = &s_stats[i];
+        if (!e->name) {
+            break;
+        }
+        worker_pool_stats_t *o = &out[count++];
+        o->name = e->name;
+        o->runs = e->runs;
+        o->cancelled = e->cancelled;
+        o->coalesced = e->coalesced;
+        o->wait_avg_ms = e->runs ? (uint32_t)(e->wait_us_total / e->runs / 1000) : 0;
+        o->wait_max_ms = e->wait_us_max / 1000;
+        o->run_avg_ms = e->runs ? (uint32_t)(e->run_us_total / e->runs / 1000) : 0;
+        o->run_max_ms = e->run_us_max / 1000;
+    }
+    xSemaphoreGive(s_lock);
+    return count;
+}
+
+void worker_pool_log_stats(void)
+{
+    worker_pool_stats_t stats[WORKER_POOL_MAX_STATS];
+    size_t count = worker_pool_get_stats(stats, WORKER_POOL_MAX_STATS);
+    ESP_LOGI(TAG, "%-16s %5s %5s %5s %8s %8s %8s %8s", "job", "runs", "canc", "merg", "wait_avg", "wait_max",
+             "run_avg", "run_max");
+    for (size_t i = 0; i < count; i++) {
+        const worker_pool_stats_t *s = &stats[i];
+        ESP_LOGI(TAG, "%-16s %5lu %5lu %5lu %8lu %8lu %8lu %8lu", s->name, (unsigned long)s->runs,
+                 (unsigned long)s->cancelled, (unsigned long)s->coalesced, (unsigned long)s->wait_avg_ms,
+                 (unsigned long)s->wait_max_ms, (unsigned long)s->run_avg_ms, (unsigned long)s->run_max_ms);
+    }
+}
+
+static void worker_pool_task(void *arg)
+{
+    for (;;) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        worker_pool_job_t *job = worker_pool_pick();
+        if (job) {
+            job->running = true;
+        }
+        xSemaphoreGive(s_lock);
+        if (!job) {
+            /*
+             * Counts are only hints: jobs cancelled while queued leave theirs
+             * behind, and a worker back from a job picks the next one without
+             * taking one. A stale count costs one empty pick.
+             */
+            xSemaphoreTake(s_pending, portMAX_DELAY);
+            continue;
+        }
+
+        const int64_t start_us = esp_timer_get_time();
+        vTaskPrioritySet(NULL, s_class_prio[job->cls]);
+        job->fn(job, job->arg);
+        /* Back to the highest class priority so the next pick is not delayed */
+        vTaskPrioritySet(NULL, CONFIG_WORKER_POOL_PRIO_INTERACTIVE);
+        const int64_t end_us = esp_timer_get_time();
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        worker_pool_stat_entry_t *stat = worker_pool_stat(job->name);
+        if (stat) {
+            uint32_t wait_us = (uint32_t)(start_us - job->queued_us);
+            uint32_t run_us = (uint32_t)(end_us - start_us);
+            stat->runs++;
+            stat->wait_us_total += wait_us;
+            stat->run_us_total += run_us;
+            if (wait_us > stat->wait_us_max) {
+                stat->wait_us_max = wait_us;
+            }
+            if (run_us > stat->run_us_max) {
+                stat->run_us_max = run_us;
+            }
+            if (job->cancel) {
+                stat->cancelled++;
+            }
+        }
+        job->used = false;
+        job->running = false;
+        xSemaphoreGive(s_lock);
+    }
+}
+
+static worker_pool_job_t *worker_pool_pick(void)
+{
+    worker_pool_job_t *best = NULL;
+    for (size_t i = 0; i < CONFIG_WORKER_POOL_QUEUE_LEN; i++) {
+        worker_pool_job_t *job = &s_jobs[i];
+        if (!job->used || job->running) {
+            continue;
+        }
+        /* seq wraps after 2^32 submissions; the signed difference keeps the order */
+        if (best && (job->cls > best->cls || (job->cls == best->cls && (int32_t)(job->seq - best->seq) > 0))) {
+            continue;
+        }
+        bool blocked = false;
+        for (size_t j = 0; j < CONFIG_WORKER_POOL_QUEUE_LEN && job->key[0] != '\0'; j++) {
+            const worker_pool_job_t *other = &s_jobs[j];
+            if (other->used && other->running && strcmp(other->key, job->key) == 0) {
+                blocked = true;
+                break;
+            }
+        }
+        if (!blocked) {
+            best = job;
+        }
+    }
+    return best;
+}
+
+static worker_pool_job_t *worker_pool_find_key(const char *key, bool running)
+{
+    for (size_t i = 0; i < CONFIG_WORKER_POOL_QUEUE_LEN; i++) {
+        worker_pool_job_t *job = &s_jobs[i];
+        if (job->used && !job->cancel && (running || !job->running) && strcmp(job->key, key) == 0) {
+            return job;
+        }
+    }
+    return NULL;
+}
+
+static worker_pool_stat_entry_t *worker_pool_stat(const char *name)
+{
+    for (size_t i = 0; i < WORKER_POOL_MAX_STATS; i++) {
+        worker_pool_stat_entry_t *e = &s_stats[i];
+        if (!e->name) {
+            e->name = name;
+            return e;
+        }
+        if (e->name == name || strcmp(e->name, name) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void worker_pool_drop(worker_pool_job_t *job, worker_pool_discard_fn_t *discard, void **arg)
+{
+    worker_pool_stat_entry_t *stat = worker_pool_stat(job->name);
+    if (stat) {
+        stat->cancelled++;
+    }
+    *discard = job->discard;
+    *arg = job->arg;
+    job->used = false;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_lcd_types.h"
+
+/*
+ * Host stand-in for the panel: an RGB565 framebuffer in memory, kept in the
+ * byte order the ILI9341 expects so everything that draws into it (LVGL's
+ * flush and the JPEG viewer's direct stripes) runs the same code as on the
+ * board.
+ */
+
+#define ESP_LCD_COLOR_FORMAT_RGB565    (1)
+
+#define BSP_LCD_COLOR_FORMAT        (ESP_LCD_COLOR_FORMAT_RGB565)
+#define BSP_LCD_BIGENDIAN           (1)
+#define BSP_LCD_BITS_PER_PIXEL      (16)
+
+#define BSP_LCD_H_RES              (CONFIG_BSP_DISPLAY_WIDTH)
+#define BSP_LCD_V_RES              (CONFIG_BSP_DISPLAY_HEIGHT)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Set the simulated backlight level (0-100). Only recorded in frame dumps.
+ */
+esp_err_t bsp_display_brightness_set(int brightness_percent);
+
+/**
+ * @brief Same as bsp_display_brightness_set(100).
+ */
+esp_err_t bsp_display_backlight_on(void);
+
+/**
+ * @brief Same as bsp_display_brightness_set(0).
+ */
+esp_err_t bsp_display_backlight_off(void);
+
+#ifdef __cplusplus
+}
+#endif
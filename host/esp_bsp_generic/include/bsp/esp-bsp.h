@@ -0,0 +1,3 @@
+#pragma once
+
+#include "bsp/esp_bsp_generic.h"
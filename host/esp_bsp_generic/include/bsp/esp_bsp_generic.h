@@ -0,0 +1,73 @@
+/**
+ * @file
+ * @brief Host BSP: runs the firmware on the ESP-IDF linux target.
+ *
+ * Implements the part of the generic BSP this firmware uses. The display is
+ * a framebuffer that can be written to PPM files, bsp_display_lock() is a
+ * recursive mutex around an LVGL task like esp_lvgl_port's, and there is no
+ * touch controller of the BSP's own (touch_xpt2046 brings its scripted
+ * input on this target).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "lvgl.h"
+#include "bsp/display.h"
+
+#define BSP_BOARD_GENERIC
+#define BSP_BOARD_HOST
+
+#define BSP_CAPS_DISPLAY        1
+#define BSP_CAPS_TOUCH          0
+#define BSP_CAPS_SDCARD         0
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create the LVGL display on the framebuffer and start the LVGL task.
+ *
+ * @return The display, or NULL on failure.
+ */
+lv_display_t *bsp_display_start(void);
+
+/**
+ * @brief Handle of the simulated panel, for code that draws around LVGL.
+ *
+ * @return Panel handle, NULL before bsp_display_start().
+ */
+esp_lcd_panel_handle_t bsp_display_get_panel(void);
+
+/**
+ * @brief Take the LVGL lock (recursive).
+ *
+ * @param timeout_ms Timeout in milliseconds; 0 waits forever.
+ * @return true if the lock was taken.
+ */
+bool bsp_display_lock(uint32_t timeout_ms);
+
+/**
+ * @brief Release the LVGL lock.
+ */
+void bsp_display_unlock(void);
+
+/**
+ * @brief Write the framebuffer to a binary PPM (P6) file.
+ *
+ * The image is turned back to the orientation the UI is laid out in, so a
+ * rotated display reads upright.
+ *
+ * @param path File to write; relative paths go below CONFIG_BSP_HOST_PPM_DIR.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE before bsp_display_start(), ESP_ERR_NO_MEM, or ESP_FAIL.
+ */
+esp_err_t bsp_host_dump_ppm(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
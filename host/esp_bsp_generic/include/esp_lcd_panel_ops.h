@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "esp_err.h"
+#include "esp_lcd_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Copy a block of pixels into the host framebuffer.
+ *
+ * Same contract as esp_lcd: the end coordinates are exclusive and the pixels
+ * are in panel byte order.
+ *
+ * @param panel        Handle from bsp_display_get_panel().
+ * @param x_start      First column.
+ * @param y_start      First row.
+ * @param x_end        Column after the last one.
+ * @param y_end        Row after the last one.
+ * @param color_data   (x_end - x_start) * (y_end - y_start) RGB565 pixels.
+ * @return ESP_OK or ESP_ERR_INVALID_ARG.
+ */
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                    const void *color_data);
+
+/**
+ * @brief Turn the simulated panel on or off; an off panel dumps as black.
+ */
+esp_err_t esp_lcd_panel_disp_on_off(esp_lcd_panel_handle_t panel, bool on_off);
+
+#ifdef __cplusplus
+}
+#endif
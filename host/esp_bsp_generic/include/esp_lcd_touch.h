@@ -0,0 +1,9 @@
+#pragma once
+
+/*
+ * Only the handle type: the touch_xpt2046 headers name it, but on the host
+ * there is no controller behind it and touch_get_handle() returns NULL.
+ */
+
+typedef struct esp_lcd_touch_s esp_lcd_touch_t;
+typedef esp_lcd_touch_t *esp_lcd_touch_handle_t;
@@ -0,0 +1,6 @@
+#pragma once
+
+/* The subset of esp_lcd's types the firmware refers to; the host panel has no IO layer */
+
+typedef struct esp_lcd_panel_t esp_lcd_panel_t;
+typedef esp_lcd_panel_t *esp_lcd_panel_handle_t;
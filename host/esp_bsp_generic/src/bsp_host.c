@@ -0,0 +1,357 @@
+#include "bsp/esp-bsp.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "esp_lcd_panel_ops.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#define BSP_HOST_LVGL_TASK_STACK_B  12288       /* as esp_lvgl_port is configured on the board */
+#define BSP_HOST_LVGL_TASK_PRIO     4
+#define BSP_HOST_TASK_MIN_DELAY_MS  1
+#define BSP_HOST_TASK_MAX_DELAY_MS  500
+#define BSP_HOST_PATH_LEN           256
+
+struct esp_lcd_panel_t {
+    uint16_t *fb;               /* BSP_LCD_H_RES x BSP_LCD_V_RES in panel byte order */
+    bool on;
+};
+
+static const char *TAG = "bsp_host";
+
+static struct esp_lcd_panel_t s_panel;
+static lv_display_t *s_disp;
+static SemaphoreHandle_t s_lvgl_lock;           /* recursive, what bsp_display_lock() takes */
+static SemaphoreHandle_t s_fb_lock;             /* flushes and direct draws against dumps */
+static int s_brightness;
+#if CONFIG_BSP_HOST_PPM_INTERVAL_MS > 0
+static int64_t s_next_dump_us;
+static uint32_t s_dump_seq;
+#endif
+
+/**
+ * @brief LVGL tick source.
+ */
+static uint32_t bsp_host_tick_ms(void);
+
+/**
+ * @brief Task running lv_timer_handler() under the display lock, like esp_lvgl_port's.
+ */
+static void bsp_host_lvgl_task(void *arg);
+
+/**
+ * @brief LVGL flush callback: copies a rendered area into the framebuffer.
+ *
+ * Rotated displays are turned back into panel orientation on the way, the
+ * job the panel's scan direction does on the board.
+ *
+ * @param disp   Display.
+ * @param area   Area in display (rotated) coordinates.
+ * @param px_map Rendered pixels.
+ */
+static void bsp_host_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
+
+/**
+ * @brief Framebuffer index of a pixel given in display (rotated) coordinates.
+ */
+static size_t bsp_host_panel_index(lv_display_rotation_t rotation, int32_t x, int32_t y);
+
+#if CONFIG_BSP_HOST_PPM_INTERVAL_MS > 0
+/**
+ * @brief Write frame_NNNNNN.ppm if CONFIG_BSP_HOST_PPM_INTERVAL_MS has passed since the last one.
+ */
+static void bsp_host_auto_dump(void);
+#endif
+
+lv_display_t *bsp_display_start(void)
+{
+    if (s_disp) {
+        return s_disp;
+    }
+
+    s_lvgl_lock = xSemaphoreCreateRecursiveMutex();
+    s_fb_lock = xSemaphoreCreateMutex();
+    s_panel.fb = calloc((size_t)BSP_LCD_H_RES * BSP_LCD_V_RES, sizeof(uint16_t));
+    if (!s_lvgl_lock || !s_fb_lock || !s_panel.fb) {
+        ESP_LOGE(TAG, "Out of memory for the framebuffer");
+        return NULL;
+    }
+    s_panel.on = true;
+
+    lv_init();
+    lv_tick_set_cb(bsp_host_tick_ms);
+
+    const size_t buf_bytes = (size_t)BSP_LCD_H_RES * CONFIG_BSP_LCD_DRAW_BUF_HEIGHT * sizeof(uint16_t);
+    void *buf1 = malloc(buf_bytes);
+#if CONFIG_BSP_LCD_DRAW_BUF_DOUBLE
+    void *buf2 = malloc(buf_bytes);
+#else
+    void *buf2 = NULL;
+#endif
+    if (!buf1 || (CONFIG_BSP_LCD_DRAW_BUF_DOUBLE && !buf2)) {
+        ESP_LOGE(TAG, "Out of memory for the draw buffers");
+        free(buf1);
+        free(buf2);
+        return NULL;
+    }
+
+    lv_display_t *disp = lv_display_create(BSP_LCD_H_RES, BSP_LCD_V_RES);
+#if CONFIG_BSP_LCD_RENDER_SWAPPED
+    lv_display_set_color_format(disp, LV_COLOR_FORMAT_RGB565_SWAPPED);
+#else
+    lv_display_set_color_format(disp, LV_COLOR_FORMAT_RGB565);
+#endif
+    lv_display_set_buffers(disp, buf1, buf2, buf_bytes, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_cb(disp, bsp_host_flush_cb);
+
+    if (xTaskCreate(bsp_host_lvgl_task, "taskLVGL", BSP_HOST_LVGL_TASK_STACK_B, NULL,
+                    BSP_HOST_LVGL_TASK_PRIO, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start the LVGL task");
+        lv_display_delete(disp);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "Host display %dx%d, frames go to %s", BSP_LCD_H_RES, BSP_LCD_V_RES, CONFIG_BSP_HOST_PPM_DIR);
+    s_disp = disp;
+    return disp;
+}
+
+esp_lcd_panel_handle_t bsp_display_get_panel(void)
+{
+    return s_disp ? &s_panel : NULL;
+}
+
+bool bsp_display_lock(uint32_t timeout_ms)
+{
+    if (!s_lvgl_lock) {
+        return false;
+    }
+    const TickType_t ticks = (timeout_ms == 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    return xSemaphoreTakeRecursive(s_lvgl_lock, ticks) == pdTRUE;
+}
+
+void bsp_display_unlock(void)
+{
+    if (s_lvgl_lock) {
+        xSemaphoreGiveRecursive(s_lvgl_lock);
+    }
+}
+
+esp_err_t bsp_display_brightness_set(int brightness_percent)
+{
+    if (brightness_percent < 0) {
+        brightness_percent = 0;
+    } else if (brightness_percent > 100) {
+        brightness_percent = 100;
+    }
+    s_brightness = brightness_percent;
+    ESP_LOGD(TAG, "Backlight %d%%", brightness_percent);
+    return ESP_OK;
+}
+
+esp_err_t bsp_display_backlight_on(void)
+{
+    return bsp_display_brightness_set(100);
+}
+
+esp_err_t bsp_display_backlight_off(void)
+{
+    return bsp_display_brightness_set(0);
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                    const void *color_data)
+{
+    if (!panel || !panel->fb || !color_data || x_start < 0 || y_start < 0 ||
+        x_end > BSP_LCD_H_RES || y_end > BSP_LCD_V_RES || x_start >= x_end || y_start >= y_end) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const size_t w = (size_t)(x_end - x_start);
+    const uint16_t *src = color_data;
+    xSemaphoreTake(s_fb_lock, portMAX_DELAY);
+    for (int y = y_start; y < y_end; y++, src += w) {
+        memcpy(&panel->fb[(size_t)y * BSP_LCD_H_RES + x_start], src, w * sizeof(uint16_t));
+    }
+    xSemaphoreGive(s_fb_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_disp_on_off(esp_lcd_panel_handle_t panel, bool on_off)
+{
+    if (!panel) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    panel->on = on_off;
+    return ESP_OK;
+}
+
+esp_err_t bsp_host_dump_ppm(const char *path)
+{
+    if (!s_disp) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!path || path[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char full[BSP_HOST_PATH_LEN];
+    if (path[0] == '/') {
+        strlcpy(full, path, sizeof(full));
+    } else {
+        if (mkdir(CONFIG_BSP_HOST_PPM_DIR, 0775) != 0 && errno != EEXIST) {
+            ESP_LOGE(TAG, "mkdir(%s) failed (errno=%d)", CONFIG_BSP_HOST_PPM_DIR, errno);
+            return ESP_FAIL;
+        }
+        int n = snprintf(full, sizeof(full), "%s/%s", CONFIG_BSP_HOST_PPM_DIR, path);
+        if (n < 0 || n >= (int)sizeof(full)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    /* Read the geometry under the LVGL lock: a rotation changes both at once */
+    bsp_display_lock(0);
+    const lv_display_rotation_t rotation = lv_display_get_rotation(s_disp);
+    const int32_t w = lv_display_get_horizontal_resolution(s_disp);
+    const int32_t h = lv_display_get_vertical_resolution(s_disp);
+    bsp_display_unlock();
+
+    uint8_t *rgb = malloc((size_t)w * h * 3);
+    if (!rgb) {
+        return ESP_ERR_NO_MEM;
+    }
+    xSemaphoreTake(s_fb_lock, portMAX_DELAY);
+    uint8_t *out = rgb;
+    for (int32_t y = 0; y < h; y++) {
+        for (int32_t x = 0; x < w; x++, out += 3) {
+            uint16_t px = s_panel.on ? s_panel.fb[bsp_host_panel_index(rotation, x, y)] : 0;
+            px = (uint16_t)((px << 8) | (px >> 8));     /* panel order is big-endian */
+            const uint8_t r = (px >> 11) & 0x1F;
+            const uint8_t g = (px >> 5) & 0x3F;
+            const uint8_t b = px & 0x1F;
+            out[0] = (uint8_t)((r << 3) | (r >> 2));
+            out[1] = (uint8_t)((g << 2) | (g >> 4));
+            out[2] = (uint8_t)((b << 3) | (b >> 2));
+        }
+    }
+    xSemaphoreGive(s_fb_lock);
+
+    esp_err_t err = ESP_OK;
+    FILE *f = fopen(full, "wb");
+    if (!f) {
+        ESP_LOGE(TAG, "fopen(%s) failed (errno=%d)", full, errno);
+        err = ESP_FAIL;
+    } else {
+        fprintf(f, "P6\n# backlight %d%%\n%ld %ld\n255\n", s_brightness, (long)w, (long)h);
+        if (fwrite(rgb, 3, (size_t)w * h, f) != (size_t)w * h) {
+            err = ESP_FAIL;
+        }
+        if (fclose(f) != 0) {
+            err = ESP_FAIL;
+        }
+    }
+    free(rgb);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Frame written to %s", full);
+    }
+    return err;
+}
+
+static uint32_t bsp_host_tick_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void bsp_host_lvgl_task(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        uint32_t delay_ms = BSP_HOST_TASK_MAX_DELAY_MS;
+        if (bsp_display_lock(0)) {
+            delay_ms = lv_timer_handler();
+            bsp_display_unlock();
+        }
+        if (delay_ms > BSP_HOST_TASK_MAX_DELAY_MS) {
+            delay_ms = BSP_HOST_TASK_MAX_DELAY_MS;      /* also LV_NO_TIMER_READY */
+        } else if (delay_ms < BSP_HOST_TASK_MIN_DELAY_MS) {
+            delay_ms = BSP_HOST_TASK_MIN_DELAY_MS;
+        }
+        vTaskDelay(pdMS_TO_TICKS(delay_ms));
+    }
+}
+
+static void bsp_host_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    const lv_color_format_t cf = lv_display_get_color_format(disp);
+    const int32_t w = lv_area_get_width(area);
+    const int32_t h = lv_area_get_height(area);
+    const uint32_t stride = lv_draw_buf_width_to_stride((uint32_t)w, cf);
+    if (cf == LV_COLOR_FORMAT_RGB565) {
+        /* What esp_lvgl_port's swap_bytes does on the board */
+        lv_draw_sw_rgb565_swap(px_map, (uint32_t)(stride / sizeof(uint16_t)) * (uint32_t)h);
+    }
+
+    const lv_display_rotation_t rotation = lv_display_get_rotation(disp);
+    xSemaphoreTake(s_fb_lock, portMAX_DELAY);
+    if (rotation == LV_DISPLAY_ROTATION_0) {
+        for (int32_t y = 0; y < h; y++) {
+            memcpy(&s_panel.fb[(size_t)(area->y1 + y) * BSP_LCD_H_RES + area->x1], px_map + (size_t)y * stride,
+                   (size_t)w * sizeof(uint16_t));
+        }
+    } else {
+        lv_area_t panel_area = *area;
+        lv_display_rotate_area(disp, &panel_area);
+        /* 16-bit pixels move the same whatever their byte order */
+        lv_draw_sw_rotate(px_map, &s_panel.fb[(size_t)panel_area.y1 * BSP_LCD_H_RES + panel_area.x1], w, h,
+                          (int32_t)stride, BSP_LCD_H_RES * (int32_t)sizeof(uint16_t), rotation,
+                          LV_COLOR_FORMAT_RGB565);
+    }
+    xSemaphoreGive(s_fb_lock);
+
+#if CONFIG_BSP_HOST_PPM_INTERVAL_MS > 0
+    if (lv_display_flush_is_last(disp)) {
+        bsp_host_auto_dump();
+    }
+#endif
+    lv_display_flush_ready(disp);
+}
+
+static size_t bsp_host_panel_index(lv_display_rotation_t rotation, int32_t x, int32_t y)
+{
+    /* Single-pixel case of lv_display_rotate_area() */
+    switch (rotation) {
+    case LV_DISPLAY_ROTATION_90:
+        return (size_t)(BSP_LCD_V_RES - x - 1) * BSP_LCD_H_RES + (size_t)y;
+    case LV_DISPLAY_ROTATION_180:
+        return (size_t)(BSP_LCD_V_RES - y - 1) * BSP_LCD_H_RES + (size_t)(BSP_LCD_H_RES - x - 1);
+    case LV_DISPLAY_ROTATION_270:
+        return (size_t)x * BSP_LCD_H_RES + (size_t)(BSP_LCD_H_RES - y - 1);
+    default:
+        return (size_t)y * BSP_LCD_H_RES + (size_t)x;
+    }
+}
+
+#if CONFIG_BSP_HOST_PPM_INTERVAL_MS > 0
+static void bsp_host_auto_dump(void)
+{
+    const int64_t now_us = esp_timer_get_time();
+    if (now_us < s_next_dump_us) {
+        return;
+    }
+    s_next_dump_us = now_us + (int64_t)CONFIG_BSP_HOST_PPM_INTERVAL_MS * 1000;
+
+    char name[32];
+    snprintf(name, sizeof(name), "frame_%06lu.ppm", (unsigned long)s_dump_seq++);
+    esp_err_t err = bsp_host_dump_ppm(name);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Frame dump failed (%s)", esp_err_to_name(err));
+    }
+}
+#endif
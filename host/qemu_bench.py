@@ -0,0 +1,308 @@
+#!/usr/bin/env python3
+"""Run benchmark scenarios of the firmware under Espressif's QEMU.
+
+QEMU has no SPI card and no touch controller, so the QEMU configuration
+(sdkconfig.defaults.qemu) mounts a FAT partition of the flash as the card and
+replays an input trace at boot. For every scenario this script writes a card
+image with the test data and the trace, merges it with the firmware into one
+flash image, boots it with instruction counting (-icount), so that timings are
+repeatable from run to run, and collects the "boot <stage>" marks and the
+replay report from the console. A scenario only passes once the console has
+shown both the card partition mounted and the virtual panel initialised:
+
+    python host/qemu_bench.py --build
+    python host/qemu_bench.py --scenario enter_5k_folder --icount-shift 2 -o bench.json
+
+Needs an ESP-IDF environment (IDF_PATH, esptool.py) and qemu-system-xtensa
+from Espressif's fork (idf_tools.py install qemu-xtensa). Timings are
+instruction counts scaled by the shift, not cache- or flash-accurate: compare
+runs with each other, not with the board.
+"""
+
+import argparse
+import json
+import os
+import queue
+import re
+import shutil
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+PARTITIONS = os.path.join(REPO, "partitions_qemu.csv")
+CARD_PARTITION = "sdcard"
+MOUNT_POINT = "/sdcard"
+TRACE_NAME = "input.trc"
+WL_SECTOR_SIZE = 4096   # CONFIG_WL_SECTOR_SIZE in sdkconfig.defaults.qemu
+
+# touch_trace.c file format
+TRACE_MAGIC = 0x43525454
+TRACE_VERSION = 1
+TRACE_HEADER = struct.Struct("<IHHHHI128s")
+TRACE_SAMPLE = struct.Struct("<IhhB3x")
+
+TAP_AT_MS = 500         # idle lead-in so the first frame is not counted against the tap
+TAP_HOLD_MS = 80        # same as a scripted "tap"
+
+ANSI = re.compile(r"\x1b\[[0-9;]*m")
+BOOT_MARK = re.compile(r"boot (\w+) (\d+) us")
+SCREENDUMP = re.compile(r"screendump (\S+)")
+REPORT_BEGIN = "----- REPLAY REPORT -----"
+REPORT_END = "----- REPLAY REPORT END -----"
+CRASH = ("Guru Meditation", "abort() was called", "Backtrace:")
+# Bring-up lines that a result has to show, and the failures that end a run early
+CARD_MOUNTED = 'Partition "%s" mounted at %s' % (CARD_PARTITION, MOUNT_POINT)
+CARD_FAILED = 'Failed to mount partition "%s"' % CARD_PARTITION
+PANEL_UP = "Initialize LCD: QEMU virtual RGB"
+PANEL_FAILED = "New panel failed"
+
+# name -> (folder the replay starts in, whether the first row is tapped)
+SCENARIOS = {
+    "boot": (None, False),
+    "enter_5k_folder": ("bench/enter", True),
+    "open_text": ("bench/text", True),
+    "decode_jpeg": ("bench/jpeg", True),
+}
+
+
+def run(cmd, cwd=None):
+    print("+ " + " ".join(cmd), file=sys.stderr)
+    subprocess.run(cmd, cwd=cwd, check=True)
+
+
+def build(build_dir):
+    run(["idf.py", "-B", build_dir, "-D", "SDKCONFIG=" + os.path.join(build_dir, "sdkconfig"),
+         "-D", "SDKCONFIG_DEFAULTS=sdkconfig.defaults;sdkconfig.defaults.qemu", "build"], cwd=REPO)
+
+
+def card_partition():
+    # Returns (offset, size) of the card partition in partitions_qemu.csv
+    with open(PARTITIONS, encoding="utf-8") as f:
+        for line in f:
+            fields = [x.strip() for x in line.split("#")[0].split(",")]
+            if len(fields) >= 5 and fields[0] == CARD_PARTITION:
+                return int(fields[3], 0), int(fields[4], 0)
+    sys.exit("no %s partition in %s" % (CARD_PARTITION, PARTITIONS))
+
+
+def write_card_tree(root, jpeg):
+    # Short upper-case names fit 8.3 entries, which keeps the 5000-entry directory small
+    big = os.path.join(root, "bench", "enter", "BIG5K")
+    os.makedirs(big)
+    for i in range(5000):
+        open(os.path.join(big, "F%05d.TXT" % i), "wb").close()
+
+    text = os.path.join(root, "bench", "text")
+    os.makedirs(text)
+    with open(os.path.join(text, "sample.txt"), "w", encoding="utf-8") as f:
+        for i in range(2000):
+            f.write("%04d The quick brown fox jumps over the lazy dog.\n" % i)
+
+    photo = os.path.join(root, "bench", "jpeg")
+    os.makedirs(photo)
+    if jpeg:
+        shutil.copyfile(jpeg, os.path.join(photo, "photo.jpg"))
+        return True
+    try:
+        from PIL import Image
+    except ImportError:
+        return False
+    # Gradient rather than a flat colour, so the decoder sees realistic entropy
+    img = Image.new("RGB", (1024, 768))
+    img.putdata([((x * 255) // 1023, (y * 255) // 767, ((x ^ y) & 0xFF)) for y in range(768) for x in range(1024)])
+    img.save(os.path.join(photo, "photo.jpg"), quality=85)
+    return True
+
+
+def write_trace(path, folder, tap, width, height):
+    x, y = tap or (0, 0)
+    samples = [(0, x, y, 0)]
+    if tap:
+        samples += [(TAP_AT_MS, x, y, 1), (TAP_AT_MS + TAP_HOLD_MS, x, y, 0)]
+    tag = ("%s/%s" % (MOUNT_POINT, folder)).encode()
+    with open(path, "wb") as f:
+        f.write(TRACE_HEADER.pack(TRACE_MAGIC, TRACE_VERSION, TRACE_SAMPLE.size, width, height, len(samples), tag))
+        for sample in samples:
+            f.write(TRACE_SAMPLE.pack(*sample))
+
+
+def make_flash(build_dir, card_root, work):
+    offset, size = card_partition()
+    card_bin = os.path.join(work, "card.bin")
+    flash_bin = os.path.join(work, "flash.bin")
+    wl_fatfsgen = os.path.join(os.environ["IDF_PATH"], "components", "fatfs", "wl_fatfsgen.py")
+    run([sys.executable, wl_fatfsgen, card_root, "--output_file", card_bin,
+         "--partition_size", str(size), "--sector_size", str(WL_SECTOR_SIZE), "--long_name_support"])
+    run(["esptool.py", "--chip", "esp32s3", "merge_bin", "--fill-flash-size", "8MB", "-o", flash_bin,
+         "@flash_args", hex(offset), card_bin], cwd=build_dir)
+    return flash_bin
+
+
+def monitor_command(sock_path, command):
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as s:
+        s.connect(sock_path)
+        s.sendall((command + "\n").encode())
+        time.sleep(0.2)
+
+
+def boot(args, name, flash_bin, work, wait_for_report):
+    """Boot one flash image, return the parsed console results."""
+    sock_path = os.path.join(work, "monitor.sock")
+    cmd = [args.qemu, "-machine", "esp32s3", "-display", "none", "-serial", "stdio",
+           "-drive", "file=%s,if=mtd,format=raw" % flash_bin,
+           "-icount", "shift=%d,align=off,sleep=off" % args.icount_shift,
+           "-global", "driver=timer.esp32s3.timg,property=wdt_disable,value=true",
+           "-monitor", "unix:%s,server,nowait" % sock_path]
+    print("+ " + " ".join(cmd), file=sys.stderr)
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stdin=subprocess.DEVNULL)
+
+    lines = queue.Queue()
+
+    def reader():
+        for raw in proc.stdout:
+            lines.put(ANSI.sub("", raw.decode(errors="replace")).rstrip())
+        lines.put(None)
+
+    threading.Thread(target=reader, daemon=True).start()
+
+    result = {"status": "timeout", "boot_us": {}, "card_mounted": False, "panel_up": False}
+    report = None
+    started = time.monotonic()
+    settle_at = None
+    try:
+        while True:
+            now = time.monotonic()
+            if now - started > args.timeout:
+                break
+            if settle_at is not None and now >= settle_at:
+                result["status"] = "ok"
+                break
+            try:
+                line = lines.get(timeout=0.2)
+            except queue.Empty:
+                continue
+            if line is None:
+                result["status"] = "exited"
+                break
+            if args.verbose:
+                print(line, file=sys.stderr)
+
+            if any(marker in line for marker in CRASH):
+                result["status"] = "crash"
+                result["crash"] = line
+                break
+            if CARD_FAILED in line or PANEL_FAILED in line:
+                result["status"] = "no_card" if CARD_FAILED in line else "no_panel"
+                result["error"] = line
+                break
+            if CARD_MOUNTED in line:
+                result["card_mounted"] = True
+            elif PANEL_UP in line:
+                result["panel_up"] = True
+            m = BOOT_MARK.search(line)
+            if m:
+                result["boot_us"][m.group(1)] = int(m.group(2))
+                if m.group(1) == "listing" and not wait_for_report:
+                    settle_at = now + args.settle
+                continue
+            m = SCREENDUMP.search(line)
+            if m and args.screendump_dir:
+                monitor_command(sock_path, "screendump %s" % os.path.join(
+                    os.path.abspath(args.screendump_dir), "%s-%s" % (name, m.group(1))))
+                continue
+            if line.endswith(REPORT_BEGIN):
+                report = {"taps": []}
+            elif line.endswith(REPORT_END) and report is not None:
+                result["report"] = report
+                result["status"] = "ok"
+                break
+            elif report is not None:
+                fields = line.split()
+                if fields and fields[0] == "tap" and len(fields) == 6:
+                    report["taps"].append(dict(zip(("at_ms", "x", "y", "first_frame_ms", "settle_ms"),
+                                                   map(int, fields[1:]))))
+                elif len(fields) == 2 and fields[1].isdigit():
+                    report[fields[0]] = int(fields[1])
+
+        # A run only counts when it went through the emulated card and panel, not a fallback
+        if result["status"] == "ok" and not (result["card_mounted"] and result["panel_up"]):
+            result["status"] = "no_bringup"
+        if args.screendump_dir and result["status"] == "ok":
+            monitor_command(sock_path, "screendump %s" % os.path.join(
+                os.path.abspath(args.screendump_dir), "%s-end.ppm" % name))
+    finally:
+        proc.terminate()
+        try:
+            proc.wait(timeout=5)
+        except subprocess.TimeoutExpired:
+            proc.kill()
+    result["wall_s"] = round(time.monotonic() - started, 1)
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--build-dir", default=os.path.join(REPO, "build_qemu"), help="IDF build directory")
+    parser.add_argument("--build", action="store_true", help="run idf.py build with the QEMU defaults first")
+    parser.add_argument("--qemu", default="qemu-system-xtensa", help="QEMU binary")
+    parser.add_argument("--scenario", action="append", choices=sorted(SCENARIOS),
+                        help="scenario to run (repeatable, default: all)")
+    parser.add_argument("--icount-shift", type=int, default=2,
+                        help="one guest instruction takes 2^N ns of virtual time")
+    parser.add_argument("--first-row", type=int, nargs=2, default=(160, 112), metavar=("X", "Y"),
+                        help="panel coordinates of the first list row")
+    parser.add_argument("--size", type=int, nargs=2, default=(320, 240), metavar=("W", "H"),
+                        help="display resolution the firmware is built for")
+    parser.add_argument("--jpeg", help="photo for decode_jpeg (default: generated with PIL)")
+    parser.add_argument("--timeout", type=float, default=180, help="seconds per scenario")
+    parser.add_argument("--settle", type=float, default=2, help="seconds to keep running after boot")
+    parser.add_argument("--screendump-dir", help="save the final frame (and script dumps) as PPM here")
+    parser.add_argument("-o", "--output", help="JSON results file (default: stdout)")
+    parser.add_argument("-v", "--verbose", action="store_true", help="echo the console")
+    args = parser.parse_args()
+
+    if "IDF_PATH" not in os.environ:
+        sys.exit("IDF_PATH is not set; run from an ESP-IDF environment")
+    if args.build:
+        build(args.build_dir)
+    if not os.path.exists(os.path.join(args.build_dir, "flash_args")):
+        sys.exit("%s has no flash_args; build first (--build)" % args.build_dir)
+    if args.screendump_dir:
+        os.makedirs(args.screendump_dir, exist_ok=True)
+
+    results = {"icount_shift": args.icount_shift, "scenarios": {}}
+    with tempfile.TemporaryDirectory(prefix="qemu_bench_") as work:
+        card_root = os.path.join(work, "card")
+        os.makedirs(card_root)
+        have_jpeg = write_card_tree(card_root, args.jpeg)
+
+        for name in args.scenario or list(SCENARIOS):
+            folder, tap = SCENARIOS[name]
+            if name == "decode_jpeg" and not have_jpeg:
+                results["scenarios"][name] = {"status": "skipped", "reason": "no --jpeg and no PIL"}
+                continue
+            trace = os.path.join(card_root, TRACE_NAME)
+            if os.path.exists(trace):
+                os.remove(trace)
+            if folder:
+                write_trace(trace, folder, tuple(args.first_row) if tap else None, *args.size)
+            flash_bin = make_flash(args.build_dir, card_root, work)
+            results["scenarios"][name] = boot(args, name, flash_bin, work, wait_for_report=folder is not None)
+            print("%s: %s" % (name, results["scenarios"][name]["status"]), file=sys.stderr)
+
+    text = json.dumps(results, indent=2)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            f.write(text + "\n")
+    else:
+        print(text)
+    return 0 if all(r["status"] in ("ok", "skipped") for r in results["scenarios"].values()) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -3,38 +3,249 @@
 
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_heap_caps.h"
 
 #include "file_manager.h"
+#include "mem_plan.h"
+#include "pc_profile.h"
 #include "settings.h"
 #include "sd_card.h"
+#include "sd_card_bench.h"
+#include "sd_io.h"
+#include "stack_monitor.h"
+#include "worker_pool.h"
+
+#include "esp_timer.h"
+
+#if CONFIG_TOUCH_TRACE
+#include <stdio.h>
+
+#include "bsp/esp-bsp.h"
+#include "touch_trace.h"
+#endif
 
 static char *TAG = "app_main";
 
 #define LOG_MEM_INFO    (0)
+#define MAIN_TASK_STACK_B   (8 * 1024)
+
+/* Boot stage timestamps; host/qemu_bench.py picks these lines out of the console */
+static void boot_mark(const char *stage)
+{
+    ESP_LOGI(TAG, "boot %s %lld us", stage, (long long)esp_timer_get_time());
+}
+
+#if CONFIG_TOUCH_TRACE
+#define INPUT_TRACE_PATH    CONFIG_SDSPI_MOUNT_POINT "/" CONFIG_TOUCH_TRACE_FILE
+
+#if CONFIG_TOUCH_TRACE_REPLAY
+static void input_trace_replay_done(const touch_trace_report_t *report, void *user_ctx);
+
+/* Start (or restart) the replay in the folder it was recorded in; call with the display lock held */
+static esp_err_t input_trace_replay_begin(void)
+{
+    /* Replays only reproduce if they start in the folder the recording started in. */
+    char start_path[TOUCH_TRACE_TAG_LEN] = "";
+    esp_err_t err = touch_trace_replay_start(INPUT_TRACE_PATH, input_trace_replay_done, NULL,
+                                             start_path, sizeof(start_path));
+    if (err == ESP_OK && start_path[0] != '\0' && file_manager_open_path(start_path) != ESP_OK) {
+        ESP_LOGW(TAG, "Replay start folder %s is unavailable", start_path);
+    }
+#if CONFIG_PC_PROFILE
+    /* After the start folder is restored, so only the replayed interaction is profiled */
+    if (err == ESP_OK && pc_profile_start() != ESP_OK) {
+        ESP_LOGW(TAG, "Replay runs without the PC profile");
+    }
+#endif
+    return err;
+}
+
+#if CONFIG_TOUCH_TRACE_SOAK_HOURS > 0
+#define INPUT_TRACE_SOAK_PATH       INPUT_TRACE_PATH ".soak.csv"
+#define INPUT_TRACE_SOAK_PAUSE_MS   2000
+#define INPUT_TRACE_HEAP_CAPS       (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+static uint32_t s_soak_lap;
+static size_t s_soak_first_largest;
+static size_t s_soak_min_largest = SIZE_MAX;
+
+static void input_trace_soak_next(lv_timer_t *timer)
+{
+    esp_err_t err = input_trace_replay_begin();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Soak stopped after lap %lu: %s", (unsigned long)s_soak_lap, esp_err_to_name(err));
+    }
+}
+
+/* One CSV row per lap: internal heap, then free/largest/overflows of every planned region */
+static bool input_trace_soak_log_lap(void)
+{
+    s_soak_lap++;
+    uint32_t uptime_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    size_t largest = heap_caps_get_largest_free_block(INPUT_TRACE_HEAP_CAPS);
+    if (s_soak_lap == 1) {
+        s_soak_first_largest = largest;
+    }
+    if (largest < s_soak_min_largest) {
+        s_soak_min_largest = largest;
+    }
+
+    FILE *f = fopen(INPUT_TRACE_SOAK_PATH, s_soak_lap == 1 ? "w" : "a");
+    if (f) {
+        if (s_soak_lap == 1) {
+            fprintf(f, "lap,uptime_s,heap_free,heap_largest,heap_min");
+            for (int i = 0; i < MEM_PLAN_REGION_COUNT; i++) {
+                mem_plan_info_t info;
+                mem_plan_get_info((mem_plan_region_id_t)i, &info);
+                fprintf(f, ",%s_free,%s_largest,%s_overflows", info.name, info.name, info.name);
+            }
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+            fprintf(f, ",lv_free,lv_largest,lv_frag_pct");
+#endif
+            fprintf(f, "\n");
+        }
+        fprintf(f, "%lu,%lu,%u,%u,%u", (unsigned long)s_soak_lap, (unsigned long)uptime_s,
+                (unsigned)heap_caps_get_free_size(INPUT_TRACE_HEAP_CAPS), (unsigned)largest,
+                (unsigned)heap_caps_get_minimum_free_size(INPUT_TRACE_HEAP_CAPS));
+        for (int i = 0; i < MEM_PLAN_REGION_COUNT; i++) {
+            mem_plan_info_t info;
+            mem_plan_get_info((mem_plan_region_id_t)i, &info);
+            fprintf(f, ",%u,%u,%lu", (unsigned)info.free_bytes, (unsigned)info.largest_free_block,
+                    (unsigned long)info.overflows);
+        }
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+        lv_mem_monitor_t mon;
+        lv_mem_monitor(&mon);
+        fprintf(f, ",%u,%u,%u", (unsigned)mon.free_size, (unsigned)mon.free_biggest_size, (unsigned)mon.frag_pct);
+#endif
+        fprintf(f, "\n");
+        fclose(f);
+    } else {
+        ESP_LOGW(TAG, "Cannot append to %s", INPUT_TRACE_SOAK_PATH);
+    }
+
+    ESP_LOGI(TAG, "Soak lap %lu at %lus: largest free block %u (first %u, lowest %u)",
+             (unsigned long)s_soak_lap, (unsigned long)uptime_s, (unsigned)largest,
+             (unsigned)s_soak_first_largest, (unsigned)s_soak_min_largest);
+    mem_plan_log();
+    worker_pool_log_stats();
+    sd_io_log_stats();
+    return uptime_s < CONFIG_TOUCH_TRACE_SOAK_HOURS * 3600u;
+}
+#endif
+
+static void input_trace_replay_done(const touch_trace_report_t *report, void *user_ctx)
+{
+    esp_err_t err = touch_trace_write_report(INPUT_TRACE_PATH ".txt", report);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write the replay report: %s", esp_err_to_name(err));
+    }
+    /* Also on the console, for runs without access to the card afterwards (QEMU) */
+    printf("----- REPLAY REPORT -----\n");
+    touch_trace_print_report(stdout, report);
+    printf("----- REPLAY REPORT END -----\n");
+#if CONFIG_PC_PROFILE
+    if (pc_profile_stop() == ESP_OK) {
+        err = pc_profile_write(INPUT_TRACE_PATH ".pc.csv");
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to write the PC profile: %s", esp_err_to_name(err));
+        }
+    }
+#endif
+#if CONFIG_TOUCH_TRACE_SOAK_HOURS > 0
+    if (input_trace_soak_log_lap()) {
+        /* Not from here: this runs inside the indev read of the replay that just ended */
+        lv_timer_t *next = lv_timer_create(input_trace_soak_next, INPUT_TRACE_SOAK_PAUSE_MS, NULL);
+        lv_timer_set_repeat_count(next, 1);
+    } else {
+        ESP_LOGI(TAG, "Soak done after %lu laps; largest free block went from %u to %u (lowest %u)",
+                 (unsigned long)s_soak_lap, (unsigned)s_soak_first_largest,
+                 (unsigned)heap_caps_get_largest_free_block(INPUT_TRACE_HEAP_CAPS), (unsigned)s_soak_min_largest);
+    }
+#endif
+}
+#else
+static void input_trace_record_timeout(lv_timer_t *timer)
+{
+    touch_trace_record_stop();
+}
+#endif
+
+static void input_trace_start(void)
+{
+    bsp_display_lock(0);
+#if CONFIG_TOUCH_TRACE_REPLAY
+    esp_err_t err = input_trace_replay_begin();
+#else
+    esp_err_t err = touch_trace_record_start(INPUT_TRACE_PATH, file_manager_current_path());
+    if (err == ESP_OK) {
+        lv_timer_t *stop = lv_timer_create(input_trace_record_timeout, CONFIG_TOUCH_TRACE_RECORD_SECONDS * 1000, NULL);
+        lv_timer_set_repeat_count(stop, 1);
+    }
+#endif
+    bsp_display_unlock();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Input trace not started: %s", esp_err_to_name(err));
+    }
+}
+#endif
 
 static void main_task(void *arg)
 {
     ESP_LOGI(TAG, "\n\n ********** LVGL File Display ********** \n");
 
     starting_routine();
+    boot_mark("ui");
+
+#if CONFIG_STACK_MONITOR
+    /* Created outside this tree: esp_lvgl_port (size set in the BSP) and LVGL's draw threads */
+    stack_monitor_note_task("taskLVGL", 12288);
+#ifdef CONFIG_LV_DRAW_THREAD_STACK_SIZE
+    stack_monitor_note_task("swdraw", CONFIG_LV_DRAW_THREAD_STACK_SIZE);
+#endif
+    if (stack_monitor_start() != ESP_OK) {
+        ESP_LOGW(TAG, "Stack monitor not started");
+    }
+#endif
 
     esp_err_t err = init_sdspi();
     if (err != ESP_OK){
         retry_init_sdspi();
     }    
+    boot_mark("card");
+
+#if CONFIG_SDSPI_BENCHMARK
+    sd_card_bench_run();
+#endif
 
     esp_err_t fb_err = file_manager_start();
     if (fb_err != ESP_OK) {
         ESP_LOGE(TAG, "file_manager_start failed: %s (waiting for SD retry)", esp_err_to_name(fb_err));
+        stack_monitor_task_exit();
         vTaskDelete(NULL);
     }
+    boot_mark("listing");
 
+#if CONFIG_TOUCH_TRACE
+    input_trace_start();
+#endif
+
+    stack_monitor_task_exit();
     vTaskDelete(NULL);
 }
 
 void app_main(void)
 {
-    xTaskCreatePinnedToCore(main_task, "MyTask", 8 * 1024, NULL, 1, NULL, 0);
+    boot_mark("app_main");
+    /* Before anything else takes its share of the heap (no-op unless CONFIG_MEM_PLAN_STATIC) */
+    mem_plan_reserve();
+    /* Worker stacks are allocated once here instead of per background job */
+    if (worker_pool_start() != ESP_OK) {
+        ESP_LOGE(TAG, "Worker pool not started; background jobs will fail to queue");
+    }
+
+    stack_monitor_note_task("MyTask", MAIN_TASK_STACK_B);
+    xTaskCreatePinnedToCore(main_task, "MyTask", MAIN_TASK_STACK_B, NULL, 1, NULL, 0);
     size_t last_free_heap = 0;
     size_t min_free_heap = UINT_MAX;
     size_t max_free_heap = 0;
@@ -51,7 +262,7 @@ void app_main(void)
         }
 
         if (free_heap != last_free_heap){
-            printf("----- HEAP INFO ----- free=%u  min_free_heap_ever=%u max_free_heap_ever=%u ----- HEAP INFO ----- \n", free_heap, min_free_heap, max_free_heap);
+            printf("----- HEAP INFO ----- free=%u  min_free_heap_ever=%u max_free_heap_ever=%u ----- HEAP INFO ----- \n", (unsigned)free_heap, (unsigned)min_free_heap, (unsigned)max_free_heap);
             last_free_heap = free_heap;
         }
 
@@ -25,7 +25,11 @@
 /* LCD display color format */
 #define BSP_LCD_COLOR_FORMAT        (ESP_LCD_COLOR_FORMAT_RGB565)
 /* LCD display color bytes endianess */
+#if CONFIG_BSP_DISPLAY_INTERFACE_QEMU_RGB
+#define BSP_LCD_BIGENDIAN           (0)
+#else
 #define BSP_LCD_BIGENDIAN           (1)
+#endif
 /* LCD display color bits */
 #define BSP_LCD_BITS_PER_PIXEL      (16)
 /* LCD display color space */
@@ -32,6 +32,11 @@
 #elif CONFIG_BSP_DISPLAY_DRIVER_GC9A01
 #include "esp_lcd_gc9a01.h"
 #endif
+#if CONFIG_BSP_DISPLAY_INTERFACE_QEMU_RGB
+#include <stdlib.h>
+#include "esp_heap_caps.h"
+#include "esp_lcd_qemu_rgb.h"
+#endif
 
 #endif
 
@@ -57,6 +62,47 @@ static lv_display_t *disp;
 static lv_indev_t *disp_indev = NULL;
 #endif
 
+#if CONFIG_BSP_DISPLAY_FLUSH_STATS
+#include <inttypes.h>
+#include "esp_timer.h"
+#define BSP_FLUSH_STATS_PERIOD  (200)   // Flush calls between two log lines
+#if CONFIG_BSP_LCD_RENDER_SWAPPED
+#define BSP_FLUSH_STATS_MODE    "RGB565_SWAPPED"
+#else
+#define BSP_FLUSH_STATS_MODE    "RGB565 + swap"
+#endif
+static int64_t s_flush_start_us;
+static uint64_t s_flush_total_us;
+static uint64_t s_flush_total_px;
+static uint32_t s_flush_calls;
+static int64_t s_render_start_us;
+static int64_t s_refr_max_us;
+#endif
+
+#if CONFIG_BSP_LCD_PSRAM_FRAMEBUFFER
+#include <inttypes.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_lcd_panel_commands.h"
+#define BSP_LCD_FB_FORMAT       "PSRAM direct"
+/* The port's swap_bytes only applies to its own flush callback, which direct mode replaces */
+#define BSP_LCD_FB_SWAP         (BSP_LCD_BIGENDIAN && !CONFIG_BSP_LCD_RENDER_SWAPPED)
+typedef struct {
+    esp_lcd_panel_handle_t panel;
+    esp_lcd_panel_io_handle_t io;
+    uint8_t *fb;                    // Screen-sized framebuffer in PSRAM
+    uint8_t *bounce[2];             // Two halves of the internal DMA bounce buffer
+    size_t bounce_bytes;            // Size of one half
+    SemaphoreHandle_t free_halves;  // Counts bounce halves not owned by an SPI transfer
+    volatile bool flushing;         // Completions belong to bounce transfers (set under the display lock)
+} bsp_lcd_fb_ctx_t;
+static bsp_lcd_fb_ctx_t s_lcd_fb;
+#else
+#define BSP_LCD_FB_FORMAT       "partial"
+#endif
+
 #if CONFIG_BSP_TOUCH_ENABLED
 static esp_lcd_touch_handle_t tp;   // LCD touch handle
 #endif
@@ -482,6 +528,27 @@ esp_err_t bsp_display_backlight_on(void)
     return bsp_display_brightness_set(100);
 }
 
+#if CONFIG_BSP_DISPLAY_INTERFACE_QEMU_RGB
+esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_handle_t *ret_panel, esp_lcd_panel_io_handle_t *ret_io)
+{
+    assert(config != NULL);
+
+    ESP_RETURN_ON_ERROR(bsp_display_brightness_init(), TAG, "Brightness init failed");
+
+    /* No bus and no panel IO: the emulator exposes the framebuffer directly */
+    const esp_lcd_rgb_qemu_config_t panel_config = {
+        .width = BSP_LCD_H_RES,
+        .height = BSP_LCD_V_RES,
+        .bpp = RGB_QEMU_BPP_16,
+    };
+    ESP_RETURN_ON_ERROR(esp_lcd_new_rgb_qemu(&panel_config, ret_panel), TAG, "New panel failed");
+    ESP_LOGI(TAG, "Initialize LCD: QEMU virtual RGB");
+    *ret_io = NULL;
+    esp_lcd_panel_reset(*ret_panel);
+    esp_lcd_panel_init(*ret_panel);
+    return ESP_OK;
+}
+#else
 esp_err_t bsp_display_new(const bsp_display_config_t *config, esp_lcd_panel_handle_t *ret_panel, esp_lcd_panel_io_handle_t *ret_io)
 {
     esp_err_t ret = ESP_OK;
@@ -563,7 +630,193 @@ err:
     spi_bus_free(BSP_LCD_SPI_NUM);
     return ret;
 }
+#endif // CONFIG_BSP_DISPLAY_INTERFACE_QEMU_RGB
+
+#if CONFIG_BSP_DISPLAY_FLUSH_STATS
+static void bsp_display_flush_stats_cb(lv_event_t *e)
+{
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code == LV_EVENT_RENDER_START) {
+        s_render_start_us = esp_timer_get_time();
+        return;
+    }
+    if (code == LV_EVENT_REFR_READY) {
+        if (s_render_start_us) {
+            int64_t refr_us = esp_timer_get_time() - s_render_start_us;
+            if (refr_us > s_refr_max_us) {
+                s_refr_max_us = refr_us;
+            }
+            s_render_start_us = 0;
+        }
+        return;
+    }
+    if (code == LV_EVENT_FLUSH_START) {
+        s_flush_start_us = esp_timer_get_time();
+        return;
+    }
+    if (code != LV_EVENT_FLUSH_FINISH) {
+        return;
+    }
+
+    const lv_area_t *area = lv_event_get_param(e);
+    s_flush_total_us += (uint64_t)(esp_timer_get_time() - s_flush_start_us);
+    s_flush_total_px += area ? (uint64_t)lv_area_get_size(area) : 0;
+    if (++s_flush_calls < BSP_FLUSH_STATS_PERIOD) {
+        return;
+    }
+
+    /* Normalize to a full frame so partial and full refreshes are comparable */
+    uint64_t frame_px = (uint64_t)BSP_LCD_H_RES * BSP_LCD_V_RES;
+    uint64_t per_frame_us = s_flush_total_px ? (s_flush_total_us * frame_px) / s_flush_total_px : 0;
+    ESP_LOGI(TAG, "Flush: %"PRIu32" calls, avg %"PRIu64" us/call, %"PRIu64" us per full frame, "
+             "slowest refresh %"PRId64" us (%s, %s)",
+             s_flush_calls, s_flush_total_us / s_flush_calls, per_frame_us, s_refr_max_us,
+             BSP_FLUSH_STATS_MODE, BSP_LCD_FB_FORMAT);
+    s_flush_total_us = 0;
+    s_flush_total_px = 0;
+    s_flush_calls = 0;
+    s_refr_max_us = 0;
+}
+#endif
+
+#if CONFIG_BSP_LCD_PSRAM_FRAMEBUFFER
+static bool bsp_lcd_fb_trans_done_cb(esp_lcd_panel_io_handle_t io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+    /* The panel IO is shared with direct draws such as jpg.c's stripes, which own no bounce half */
+    if (!s_lcd_fb.flushing) {
+        return false;
+    }
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR(s_lcd_fb.free_halves, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+/* Direct mode: px_map is the whole framebuffer, area is the dirty rectangle to send */
+static void bsp_lcd_fb_flush_cb(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+    const uint32_t stride = lv_draw_buf_width_to_stride(lv_display_get_horizontal_resolution(display),
+                                                        lv_display_get_color_format(display));
+    const size_t row_bytes = (size_t)lv_area_get_width(area) * sizeof(uint16_t);
+    int32_t chunk_rows = (int32_t)(s_lcd_fb.bounce_bytes / row_bytes);
+    if (chunk_rows < 1) {
+        chunk_rows = 1;
+    }
+
+    /*
+     * Draws made under the display lock may still be on the bus. A command waits for queued pixel data,
+     * so after it every completion up to the end of this flush is one of the bounce transfers below.
+     */
+    esp_lcd_panel_io_tx_param(s_lcd_fb.io, LCD_CMD_NOP, NULL, 0);
+    s_lcd_fb.flushing = true;
+
+    int half = 0;
+    for (int32_t y = area->y1; y <= area->y2; y += chunk_rows) {
+        int32_t rows = LV_MIN(chunk_rows, area->y2 - y + 1);
+        const uint8_t *src = px_map + (size_t)y * stride + (size_t)area->x1 * sizeof(uint16_t);
+        uint8_t *dst = s_lcd_fb.bounce[half];
+
+        /* Wait until this half is no longer being sent, then refill it while the other one is on the bus */
+        xSemaphoreTake(s_lcd_fb.free_halves, portMAX_DELAY);
+        for (int32_t r = 0; r < rows; r++) {
+            memcpy(dst + (size_t)r * row_bytes, src + (size_t)r * stride, row_bytes);
+        }
+#if BSP_LCD_FB_SWAP
+        lv_draw_sw_rgb565_swap(dst, (uint32_t)(rows * lv_area_get_width(area)));
+#endif
+        esp_lcd_panel_draw_bitmap(s_lcd_fb.panel, area->x1, y, area->x2 + 1, y + rows, dst);
+        half ^= 1;
+    }
+
+    /* Drain both halves so LVGL can draw into the framebuffer again */
+    xSemaphoreTake(s_lcd_fb.free_halves, portMAX_DELAY);
+    xSemaphoreTake(s_lcd_fb.free_halves, portMAX_DELAY);
+    s_lcd_fb.flushing = false;
+    xSemaphoreGive(s_lcd_fb.free_halves);
+    xSemaphoreGive(s_lcd_fb.free_halves);
+
+    lv_display_flush_ready(display);
+}
+
+/**
+ * Switch a display registered by esp_lvgl_port to direct mode on a PSRAM framebuffer.
+ * The port's (small) draw buffer is kept and reused as the DMA bounce buffer.
+ */
+static esp_err_t bsp_lcd_fb_attach(lv_display_t *display, esp_lcd_panel_io_handle_t io_handle)
+{
+    lv_draw_buf_t *port_buf = lv_display_get_buf_active(display);
+    ESP_RETURN_ON_FALSE(port_buf && port_buf->data, ESP_ERR_INVALID_STATE, TAG, "No draw buffer to reuse");
+
+    uint32_t hor_res = lv_display_get_original_horizontal_resolution(display);
+    uint32_t ver_res = lv_display_get_original_vertical_resolution(display);
+    uint32_t fb_size = lv_draw_buf_width_to_stride(hor_res, lv_display_get_color_format(display)) * ver_res;
+
+    s_lcd_fb.panel = s_panel_handle;
+    s_lcd_fb.io = io_handle;
+    s_lcd_fb.bounce_bytes = port_buf->data_size / 2;
+    s_lcd_fb.bounce[0] = port_buf->data;
+    s_lcd_fb.bounce[1] = port_buf->data + s_lcd_fb.bounce_bytes;
+    s_lcd_fb.free_halves = xSemaphoreCreateCounting(2, 2);
+    ESP_RETURN_ON_FALSE(s_lcd_fb.free_halves, ESP_ERR_NO_MEM, TAG, "No memory for bounce semaphore");
+
+    s_lcd_fb.fb = heap_caps_aligned_calloc(LV_DRAW_BUF_ALIGN, 1, fb_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_lcd_fb.fb) {
+        vSemaphoreDelete(s_lcd_fb.free_halves);
+        s_lcd_fb.free_halves = NULL;
+        ESP_LOGE(TAG, "No PSRAM for %"PRIu32" B framebuffer, staying in partial mode", fb_size);
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* Completion now releases a bounce half; the flush callback signals LVGL itself */
+    const esp_lcd_panel_io_callbacks_t cbs = {
+        .on_color_trans_done = bsp_lcd_fb_trans_done_cb,
+    };
+    esp_lcd_panel_io_register_event_callbacks(io_handle, &cbs, NULL);
+
+    lv_display_set_buffers(display, s_lcd_fb.fb, NULL, fb_size, LV_DISPLAY_RENDER_MODE_DIRECT);
+    lv_display_set_flush_cb(display, bsp_lcd_fb_flush_cb);
+    ESP_LOGI(TAG, "Direct mode: %"PRIu32" B framebuffer in PSRAM, %u B DMA bounce",
+             fb_size, (unsigned)(2 * s_lcd_fb.bounce_bytes));
+    return ESP_OK;
+}
+#endif
+
+#if CONFIG_BSP_DISPLAY_INTERFACE_QEMU_RGB
+static uint8_t *s_qemu_rotate_buf;  // Rotated copy of a draw buffer, allocated on the first rotated flush
+static size_t s_qemu_draw_buf_bytes;
+
+/* The virtual panel copies synchronously, so the buffer is free again on return */
+static void bsp_qemu_flush_cb(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+    const lv_display_rotation_t rotation = lv_display_get_rotation(display);
+    if (rotation == LV_DISPLAY_ROTATION_0) {
+        esp_lcd_panel_draw_bitmap(s_panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map);
+        lv_display_flush_ready(display);
+        return;
+    }
+
+    if (!s_qemu_rotate_buf) {
+        s_qemu_rotate_buf = heap_caps_malloc(s_qemu_draw_buf_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (s_qemu_rotate_buf) {
+        const int32_t w = lv_area_get_width(area);
+        const int32_t h = lv_area_get_height(area);
+        lv_area_t panel_area = *area;
+        lv_display_rotate_area(display, &panel_area);
+        lv_draw_sw_rotate(px_map, s_qemu_rotate_buf, w, h,
+                          (int32_t)lv_draw_buf_width_to_stride((uint32_t)w, LV_COLOR_FORMAT_RGB565),
+                          lv_area_get_width(&panel_area) * (int32_t)sizeof(uint16_t), rotation, LV_COLOR_FORMAT_RGB565);
+        esp_lcd_panel_draw_bitmap(s_panel_handle, panel_area.x1, panel_area.y1, panel_area.x2 + 1, panel_area.y2 + 1,
+                                  s_qemu_rotate_buf);
+    } else {
+        ESP_LOGE(TAG, "No memory to rotate a frame");
+    }
+    lv_display_flush_ready(display);
+}
 
+/**
+ * esp_lvgl_port only registers displays that have a panel IO or an RGB peripheral, so the
+ * QEMU display is created here; the port's task and lock still drive it like any other.
+ */
 static lv_display_t *bsp_display_lcd_init(void)
 {
     esp_lcd_panel_io_handle_t io_handle = NULL;
@@ -572,6 +825,52 @@ static lv_display_t *bsp_display_lcd_init(void)
     };
     BSP_ERROR_CHECK_RETURN_NULL(bsp_display_new(&bsp_disp_cfg, &s_panel_handle, &io_handle));
 
+    s_qemu_draw_buf_bytes = bsp_disp_cfg.max_transfer_sz;
+    void *buf1 = heap_caps_malloc(s_qemu_draw_buf_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#if CONFIG_BSP_LCD_DRAW_BUF_DOUBLE
+    void *buf2 = heap_caps_malloc(s_qemu_draw_buf_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#else
+    void *buf2 = NULL;
+#endif
+    if (!buf1 || (CONFIG_BSP_LCD_DRAW_BUF_DOUBLE && !buf2)) {
+        ESP_LOGE(TAG, "No memory for LVGL draw buffers");
+        free(buf1);
+        free(buf2);
+        return NULL;
+    }
+
+    lvgl_port_lock(0);
+    lv_display_t *display = lv_display_create(BSP_LCD_H_RES, BSP_LCD_V_RES);
+    if (display) {
+        lv_display_set_color_format(display, LV_COLOR_FORMAT_RGB565);
+        lv_display_set_buffers(display, buf1, buf2, s_qemu_draw_buf_bytes, LV_DISPLAY_RENDER_MODE_PARTIAL);
+        lv_display_set_flush_cb(display, bsp_qemu_flush_cb);
+#if CONFIG_BSP_DISPLAY_FLUSH_STATS
+        lv_display_add_event_cb(display, bsp_display_flush_stats_cb, LV_EVENT_ALL, NULL);
+#endif
+    }
+    lvgl_port_unlock();
+    if (!display) {
+        free(buf1);
+        free(buf2);
+    }
+    return display;
+}
+#else
+static lv_display_t *bsp_display_lcd_init(void)
+{
+    esp_lcd_panel_io_handle_t io_handle = NULL;
+#if CONFIG_BSP_LCD_PSRAM_FRAMEBUFFER
+    /* The port's draw buffer only serves as the DMA bounce buffer in this mode */
+    const uint32_t draw_buf_height = CONFIG_BSP_LCD_BOUNCE_BUF_HEIGHT;
+#else
+    const uint32_t draw_buf_height = CONFIG_BSP_LCD_DRAW_BUF_HEIGHT;
+#endif
+    const bsp_display_config_t bsp_disp_cfg = {
+        .max_transfer_sz = (BSP_LCD_H_RES * draw_buf_height) * sizeof(uint16_t),
+    };
+    BSP_ERROR_CHECK_RETURN_NULL(bsp_display_new(&bsp_disp_cfg, &s_panel_handle, &io_handle));
+
     esp_lcd_panel_disp_on_off(s_panel_handle, true);
 
     /* Add LCD screen */
@@ -579,8 +878,8 @@ static lv_display_t *bsp_display_lcd_init(void)
     const lvgl_port_display_cfg_t disp_cfg = {
         .io_handle = io_handle,
         .panel_handle = s_panel_handle,
-        .buffer_size = BSP_LCD_H_RES * CONFIG_BSP_LCD_DRAW_BUF_HEIGHT,
-#if CONFIG_BSP_LCD_DRAW_BUF_DOUBLE
+        .buffer_size = BSP_LCD_H_RES * draw_buf_height,
+#if CONFIG_BSP_LCD_DRAW_BUF_DOUBLE && !CONFIG_BSP_LCD_PSRAM_FRAMEBUFFER
         .double_buffer = 1,
 #else
         .double_buffer = 0,
@@ -588,6 +887,10 @@ static lv_display_t *bsp_display_lcd_init(void)
         .hres = BSP_LCD_H_RES,
         .vres = BSP_LCD_V_RES,
         .monochrome = false,
+#if LVGL_VERSION_MAJOR >= 9 && CONFIG_BSP_LCD_RENDER_SWAPPED
+        /* Draw straight into the panel's byte order so the flush needs no swap pass */
+        .color_format = (BSP_LCD_BIGENDIAN ? LV_COLOR_FORMAT_RGB565_SWAPPED : LV_COLOR_FORMAT_RGB565),
+#endif
         /* Rotation values must be same as used in esp_lcd for initial settings of the screen */
         .rotation = {
 #if CONFIG_BSP_DISPLAY_ROTATION_SWAP_XY
@@ -603,15 +906,31 @@ static lv_display_t *bsp_display_lcd_init(void)
         .flags = {
             .buff_dma = true,
 #if LVGL_VERSION_MAJOR >= 9
+#if CONFIG_BSP_LCD_RENDER_SWAPPED
+            .swap_bytes = false,
+#else
             .swap_bytes = (BSP_LCD_BIGENDIAN ? true : false),
+#endif
 #endif
         }
     };
 #if BSP_LCD_H_OFFSET || BSP_LCD_V_OFFSET
     esp_lcd_panel_set_gap(s_panel_handle, (BSP_LCD_H_OFFSET), (BSP_LCD_V_OFFSET));
 #endif
-    return lvgl_port_add_disp(&disp_cfg);
+    lv_display_t *display = lvgl_port_add_disp(&disp_cfg);
+#if CONFIG_BSP_LCD_PSRAM_FRAMEBUFFER
+    if (display) {
+        bsp_lcd_fb_attach(display, io_handle);
+    }
+#endif
+#if CONFIG_BSP_DISPLAY_FLUSH_STATS
+    if (display) {
+        lv_display_add_event_cb(display, bsp_display_flush_stats_cb, LV_EVENT_ALL, NULL);
+    }
+#endif
+    return display;
 }
+#endif // CONFIG_BSP_DISPLAY_INTERFACE_QEMU_RGB
 
 #if CONFIG_BSP_TOUCH_ENABLED
 esp_err_t bsp_touch_new(const bsp_touch_config_t *config, esp_lcd_touch_handle_t *ret_touch)
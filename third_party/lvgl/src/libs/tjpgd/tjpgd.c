@@ -888,6 +888,62 @@ JRESULT jd_mcu_output(
                 }
             }
         }
+
+        /* Descale the MCU rectangular if needed */
+        if(JD_USE_SCALE && jd->scale) {
+            unsigned int sx, sy, r, g, b, s, w, a;
+            uint8_t * op;
+
+            /* Get averaged RGB value of each square corresponds to a pixel */
+            s = jd->scale * 2;  /* Number of shifts for averaging */
+            w = 1 << jd->scale; /* Width of square */
+            a = (mx - w) * (JD_FORMAT != 2 ? 3 : 1);    /* Bytes to skip for next line in the square */
+            op = (uint8_t *)jd->workbuf;
+            for(iy = 0; iy < my; iy += w) {
+                for(ix = 0; ix < mx; ix += w) {
+                    pix = (uint8_t *)jd->workbuf + (iy * mx + ix) * (JD_FORMAT != 2 ? 3 : 1);
+                    r = g = b = 0;
+                    for(sy = 0; sy < w; sy++) {   /* Accumulate RGB value in the square */
+                        for(sx = 0; sx < w; sx++) {
+                            r += *pix++;    /* Accumulate B or Y (monochrome output) */
+                            if(JD_FORMAT != 2) {    /* RGB output? */
+                                g += *pix++;    /* Accumulate G */
+                                b += *pix++;    /* Accumulate R */
+                            }
+                        }
+                        pix += a;
+                    }               /* Put the averaged pixel value */
+                    *op++ = (uint8_t)(r >> s);  /* Put B or Y (monochrome output) */
+                    if(JD_FORMAT != 2) {    /* RGB output? */
+                        *op++ = (uint8_t)(g >> s);  /* Put G */
+                        *op++ = (uint8_t)(b >> s);  /* Put R */
+                    }
+                }
+            }
+        }
+    }
+    else {  /* For only 1/8 scaling (left-top pixel in each block are the DC value of the block) */
+        /* Build a 1/8 descaled RGB MCU from discrete components */
+        pix = (uint8_t *)jd->workbuf;
+        pc = jd->mcubuf + mx * my;
+        cb = pc[0] - 128;       /* Get Cb/Cr component and restore right level */
+        cr = pc[64] - 128;
+        for(iy = 0; iy < my; iy += 8) {
+            py = jd->mcubuf;
+            if(iy == 8) py += 64 * 2;
+            for(ix = 0; ix < mx; ix += 8) {
+                yy = *py;   /* Get Y component */
+                py += 64;
+                if(JD_FORMAT != 2) {
+                    *pix++ = /*B*/ BYTECLIP(yy + ((int)(1.772 * CVACC) * cb) / CVACC);
+                    *pix++ = /*G*/ BYTECLIP(yy - ((int)(0.344 * CVACC) * cb + (int)(0.714 * CVACC) * cr) / CVACC);
+                    *pix++ = /*R*/ BYTECLIP(yy + ((int)(1.402 * CVACC) * cr) / CVACC);
+                }
+                else {
+                    *pix++ = yy;
+                }
+            }
+        }
     }
 
     /* Squeeze up pixel table if a part of MCU is to be truncated */